@@ -1947,10 +1947,12 @@ double getObsData(string tag, RinexSatID sat, Rinex3ObsHeader& Rhead,
       RinexObsID obsid(tag, C.useVersion);         // ObsID for this tag
 
       // find it in the header
+      const Rinex3ObsHeader::SysObsTypes *sot(Rhead.getSysObsTypes(sat.system));
+      if(!sot) return data;                        // system not in header
       vector<RinexObsID>::const_iterator jt(
-         find(Rhead.mapObsTypes[sys].begin(),Rhead.mapObsTypes[sys].end(),obsid));
-      if(jt != Rhead.mapObsTypes[sys].end()) {     // its in the header
-         int j = jt - Rhead.mapObsTypes[sys].begin();
+         find(sot->obsTypes.begin(),sot->obsTypes.end(),obsid));
+      if(jt != sot->obsTypes.end()) {              // its in the header
+         int j = jt - sot->obsTypes.begin();
          data = vrdata[j].data;
       }
 
@@ -2395,6 +2397,9 @@ double LinCom::Compute(const RinexSatID sat, Rinex3ObsHeader& Rhead,
    if(sysConsts.count(sys1) == 0)
       { LOG(DEBUG2) << msg << " System not found"; return 0.0; }
 
+   // this system's obs types in the header
+   const Rinex3ObsHeader::SysObsTypes *sot(Rhead.getSysObsTypes(sat.system));
+
    // sum up the terms
    value = 0.0;      // member
    for(size_t i=0; i<sysConsts[sys1].size(); i++) {
@@ -2429,14 +2434,14 @@ double LinCom::Compute(const RinexSatID sat, Rinex3ObsHeader& Rhead,
       vector<RinexObsID>::const_iterator jt;
       for(size_t k=0; k<allObsIDs.size(); k++) {
          string oi(sys1 + allObsIDs[k].asString());
-         jt = find(Rhead.mapObsTypes[sys1].begin(),
-                   Rhead.mapObsTypes[sys1].end(), allObsIDs[k]);
-         if(jt == Rhead.mapObsTypes[sys1].end()) {
+         if(sot) jt = find(sot->obsTypes.begin(), sot->obsTypes.end(),
+                           allObsIDs[k]);
+         if(!sot || jt == sot->obsTypes.end()) {
             LOG(DEBUG2) << msg << " obs >" << oi << "< obsid not in header";
             continue;                                    // not in header
          }
 
-         int j = jt - Rhead.mapObsTypes[sys1].begin();
+         int j = jt - sot->obsTypes.begin();
          data = vrdata[j].data;
          if(data == 0.0) {
             LOG(DEBUG2) << msg << " obs >" << oi << "< data is zero";
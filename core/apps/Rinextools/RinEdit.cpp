@@ -576,6 +576,8 @@ int processFiles(void)
             }
             RHout.prepareVer2Write();
          }
+         else
+            RHout.buildObsTypeIndex();   // mapObsTypes may have been edited
          
             // NB. header will be written by executeEditCmd
             // -----------------------------------------------------------------
@@ -1086,6 +1086,8 @@ int ProcessFiles()
                   // first, find the current system...
                char sysCode = sat.systemChar();
                string sysStr(string(1,sysCode));
+               const Rinex3ObsHeader::SysObsTypes *sot =
+                  Rhead.getSysObsTypes(sat.system);
 
                   // update Obs data totals
                for(size_t index=0; index != vecData.size(); index++)
@@ -1103,18 +1105,18 @@ int ProcessFiles()
                   }
 
                      // if looking for milliseconds, update handler
-                  if(C.doms && vecData[index].data != 0)
+                  if(C.doms && sot && vecData[index].data != 0)
                   {
-                     tag = sysStr + Rhead.mapObsTypes[sysStr][index].asString();
+                     tag = sysStr + sot->obsTypes[index].asString();
                      if(vectorindex(msots,tag) != -1)
                      {
                         C.msh.add(lastObsTime, sat, tag, vecData[index].data);
                      }
                   }
 
-                  if(C.debug > -1)
+                  if(C.debug > -1 && sot)
                      oss << fixed << setprecision(3)
-                         << " " << asString(Rhead.mapObsTypes[sysStr][index])
+                         << " " << asString(sot->obsTypes[index])
                          << " " << setw(13) << vecData[index].data
                          << " " << vecData[index].lli
                          << " " << vecData[index].ssi;
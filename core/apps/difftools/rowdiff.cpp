@@ -137,6 +137,8 @@ void ROWDiff::process()
          }
          header1.mapObsTypes["G"] = r3ov;
          ff1.frontHeader().mapObsTypes["G"] = r3ov;
+         header1.buildObsTypeIndex();
+         ff1.frontHeader().buildObsTypeIndex();
       }
       else if (header2.version < 3 && header1.version >= 3)
       {
@@ -150,6 +152,8 @@ void ROWDiff::process()
          }
          header2.mapObsTypes["G"] = r3ov;
          ff2.frontHeader().mapObsTypes["G"] = r3ov;
+         header2.buildObsTypeIndex();
+         ff2.frontHeader().buildObsTypeIndex();
       }
    }
 
@@ -52,6 +52,7 @@
 #include "RinexNavData.hpp"
 #include "XvtStore.hpp"
 #include "GPSEphemerisStore.hpp"
+#include "ChebyshevEphemerisStore.hpp"
 #include "SP3Stream.hpp"
 #include "SP3Header.hpp"
 #include "SP3Data.hpp"
@@ -77,6 +78,8 @@ int main(int argc, char *argv[])
       "  --cs <sec>     Cadence of epochs in seconds (300s)\n"
       "  --outputC     Output version c (no correlation) (otherwise a)\n"
       "  --msg \"...\"   Add ... as a comment to the output header (repeatable)\n"
+      "  --cheb <file> Also write the orbits and clocks from tb to te as a\n"
+      "                 compact Chebyshev product to <file>\n"
       "  --verbose     Output to screen: dump headers, data, etc\n"
       "  --help        Print this message and quit\n"
    );
@@ -94,6 +97,7 @@ int main(int argc, char *argv[])
       int i,j;
       size_t k,nfile;
       string fileout("sp3.out");
+      string chebout;
       vector<string> inputFiles;
       vector<string> comments;
       map<SatID,long> IODEmap;
@@ -130,6 +134,12 @@ int main(int argc, char *argv[])
                if(verbose)
                   cout << " Output file name " << fileout << endl;
             }
+            else if(arg == string("--cheb"))
+            {
+               chebout = string(argv[++i]);
+               if(verbose)
+                  cout << " Chebyshev output file name " << chebout << endl;
+            }
             else if(arg == string("--tb"))
             {
                arg = string(argv[++i]);
@@ -424,6 +434,15 @@ int main(int argc, char *argv[])
 
       if(verbose)
          cout << "Wrote " << sp3header.numberOfEpochs << " records" << endl;
+
+      if(!chebout.empty())
+      {
+         ChebyshevEphemerisStore chebEph;
+         chebEph.fit(BCEph, begTime, endTime);
+         chebEph.writeFile(chebout);
+         if(verbose)
+            chebEph.dump(cout, 1);
+      }
    }
    catch (Exception& e)
    {
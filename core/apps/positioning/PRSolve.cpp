@@ -47,6 +47,12 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
 
 // GPSTK
 #include "Exception.hpp"
@@ -205,6 +211,10 @@ public:
    int maxReject;             // Max number of sats to reject [-1 for no limit]
    int nIter;                 // Maximum iteration count in linearized LS
    double convLimit;          // Minimum convergence criterion in estimation (meters)
+   int RAIMThreads;           // Number of threads in RAIM [0 for one per core]
+   double RAIMTimeLimit;      // Limit on RAIM search per epoch (sec) [0 for none]
+   bool RAIMDowndate;         // Score RAIM combinations by downdating
+   int nThreads;              // Number of threads processing epochs [0 per core]
 
    string TropStr;            // temp used to parse --trop
 
@@ -451,6 +461,29 @@ public:
 
 }; // end class SolutionData
 
+//------------------------------------------------------------------------------------
+// The data of one SolutionObject that changes each epoch; SolutionObject swaps it
+// with an EpochData so that epochs can be prepared in other threads.
+class EpochData {
+public:
+   EpochData() throw() : isPrepared(false), NPrepare(0) { }
+
+   vector<SatID> Satellites;                 // see SolutionObject
+   vector<double> PRanges;
+   vector<double> Elevations;
+   vector<double> ERanges;
+   vector<double> RIono;
+   vector<double> R1,R2;
+   multimap<RinexSatID,string> UsedObsIDs;
+
+   // output of PRSolution::PreparePRSolution(), if isPrepared
+   bool isPrepared;
+   int NPrepare;
+   vector<SatID> PreparedSats;
+   Matrix<double> SVP;
+
+}; // end class EpochData
+
 //------------------------------------------------------------------------------------
 //------------------------------------------------------------------------------------
 // Object to encapsulate everything for one solution (system:freq:code[+s:f:c])
@@ -482,6 +515,8 @@ public:
       ParseDescriptor();
 
       nepochs = 0;
+      isPrepared = false;
+      NPrepare = 0;
 
       // for initialization of constants and PRSolution
       Configuration& C(Configuration::Instance());
@@ -492,6 +527,9 @@ public:
       prs.NSatsReject = C.maxReject;
       prs.MaxNIterations = C.nIter;
       prs.ConvergenceLimit = C.convLimit;
+      prs.RAIMThreads = C.RAIMThreads;
+      prs.RAIMTimeLimit = C.RAIMTimeLimit;
+      prs.RAIMDowndate = C.RAIMDowndate;
 
       // initialize apriori solution
       if(C.knownPos.getCoordinateSystem() != Position::Unknown)
@@ -517,6 +555,12 @@ public:
    // reset the object before each epoch
    void EpochReset(void) throw();
 
+   // swap the data of this epoch (Satellites, PRanges, etc) with ed
+   void SwapEpochData(EpochData& ed) throw();
+
+   // remove a satellite from the data of this epoch, undoing PrepareSolution()
+   void RemoveSat(const RinexSatID& sat) throw();
+
    // Given a RINEX data object, pull out the data to be used, and set the flag
    // indicating whether there is sufficient good data.
    void CollectData(const RinexSatID& s,
@@ -529,6 +573,13 @@ public:
        */
    int ComputeSolution(const CommonTime& t);
 
+      /** Call PRSolution::PreparePRSolution() ahead of ComputeSolution(),
+       * which will then skip it; used by worker threads. Does nothing
+       * if there is too little data or the SPS solution is output.
+       * @throw Exception
+       */
+   void PrepareSolution(const CommonTime& t);
+
       /** Write out ORDs - call after ComputeSolution pass it iret
        * from ComputeSolution
        * @throw Exception
@@ -566,6 +617,12 @@ public:
    vector<double> R1,R2;                     // raw ranges, parallel to Satellites
    multimap<RinexSatID,string> UsedObsIDs;   // valid or not; may be comma-sep. list
 
+   // output of PRSolution::PreparePRSolution(), if called by PrepareSolution()
+   bool isPrepared;                          // else ComputeSolution() calls it
+   int NPrepare;                             // return value
+   vector<SatID> PreparedSats;               // Satellites, marked
+   Matrix<double> SVP;                       // sat positions and corrected ranges
+
    // the PRS itself
    PRSolution prs;
 
@@ -587,6 +644,73 @@ int Initialize(string& errors);
  * @throw Exception */
 int ProcessFiles(void);
 
+//------------------------------------------------------------------------------------
+// One epoch of data, passed from the reader to a worker, which collects the data
+// of each solution, and then to ProcessEpoch(), which computes the solutions and
+// writes the output, in time order. The workers save their LOG messages here.
+class EpochJob {
+public:
+   EpochJob() throw() : done(false) { }
+
+   // save a LOG message, to be written in order by WriteLog()
+   void Log(LogLevel level, const string& msg)
+   { Messages.push_back(pair<LogLevel,string>(level,msg)); }
+
+   // write the saved LOG messages
+   void WriteLog(void)
+   {
+      for(size_t i=0; i<Messages.size(); i++)
+         LOG(Messages[i].first) << Messages[i].second;
+   }
+
+   Rinex3ObsData Rdata;                      // the data, corrected for DCB
+   vector<pair<LogLevel,string> > Messages;  // saved LOG messages
+
+   // used when the epoch is prepared by a worker thread
+   vector<EpochData> SolData;                // parallel to C.SolObjs
+   // a sat whose ORDs need a trop correction, which must be computed in order
+   class TropSat {
+   public:
+      RinexSatID sat;
+      Triple svPos;                          // sat position
+      size_t nmsg;                           // where its messages start
+      bool rejected;                         // rejected for elevation
+      bool logged;                           // rejection message saved at nmsg
+   };
+   vector<TropSat> TropSats;
+   bool done;                                // set by the worker when done
+   std::exception_ptr error;                 // thrown by the worker
+}; // end class EpochJob
+
+// one line of LOG output saved in an EpochJob; used by the JOBLOG macro
+class EpochJobLogLine {
+public:
+   EpochJobLogLine(EpochJob& j, LogLevel l) throw() : job(j), level(l) { }
+   ~EpochJobLogLine() { job.Log(level, oss.str()); }
+   ostringstream& get(void) { return oss; }
+private:
+   EpochJob& job;
+   LogLevel level;
+   ostringstream oss;
+};
+
+// like LOG(level), but save the message in the EpochJob job
+#define JOBLOG(job,level) \
+   if(level <= ConfigureLOG::ReportingLevel()) EpochJobLogLine(job,level).get()
+
+/**
+ * @throw Exception */
+int ReadEpoch(Rinex3ObsStream& istrm, Rinex3ObsData& Rdata, string& errmsg);
+/**
+ * @throw Exception */
+void PrepareEpoch(EpochJob& job, vector<SolutionObject>& SolObjs,
+                  const Rinex3ObsHeader& Rhead, const map<string,int>& mapDCBindex,
+                  bool inOrder);
+/**
+ * @throw Exception */
+void ProcessEpoch(EpochJob& job, Rinex3ObsHeader& Rhead,
+                  Rinex3ObsStream& ostrm, bool firstepoch);
+
 //------------------------------------------------------------------------------------
 //------------------------------------------------------------------------------------
 int main(int argc, char **argv)
@@ -1238,7 +1362,6 @@ try {
    bool firstepoch(true);
    int k,iret,nfiles;
    size_t i,j,nfile;
-   Position PrevPos(C.knownPos);
    Rinex3ObsStream ostrm;
 
    for(nfiles=0,nfile=0; nfile<C.InputObsFiles.size(); nfile++) {
@@ -1284,7 +1407,6 @@ try {
       }
 
       // does header include C1C (for DCB correction)?
-      bool DCBcorr(false);
       map<string,int> mapDCBindex;
       for(;;) {
          map<string,vector<RinexObsID> >::const_iterator sit;
@@ -1292,7 +1414,6 @@ try {
          for( ; sit != Rhead.mapObsTypes.end(); ++sit) {
             for(i=0; i<sit->second.size(); i++) {
                if(asString(sit->second[i]) == string("C1C")) {
-                  DCBcorr = true;
                   mapDCBindex.insert(map<string,int>::value_type(sit->first,i));
                   LOG(DEBUG) << "Correct for DCB: found " << asString(sit->second[i])
                      << " for system " << sit->first << " at index " << i;
@@ -1369,239 +1490,459 @@ try {
       }
 
       // loop over epochs ---------------------------------------------
-      while(1) {
-         try { istrm >> Rdata; }
-         catch(Exception& e) {
-            LOG(WARNING) << " Warning : Failed to read obs data (Exception "
-               << e.getText(0) << "); dump follows.";
-            Rdata.dump(LOGstrm,Rhead);
-            istrm.close();
-            iret = 3;
-            break;
+      // The reader (this thread) keeps up to maxJobs epochs in the window; the
+      // workers collect their data (corrected ranges, elevations, ephemeris),
+      // which does not depend on other epochs, while this thread computes the
+      // solutions, which do (e.g. the apriori solution and the trop model),
+      // and writes the output, in time order. With one thread, each epoch
+      // is read, prepared and processed in turn.
+      unsigned nthreads(C.nThreads > 0 ? unsigned(C.nThreads)
+                                       : std::thread::hardware_concurrency());
+      if(nthreads == 0 || C.debug > -1) nthreads = 1;   // keep debug in order
+      const size_t maxJobs(nthreads == 1 ? 1 : 8*nthreads);
+
+      deque< std::unique_ptr<EpochJob> > window;   // jobs in time order
+      deque<EpochJob *> queue;                     // jobs waiting for a worker
+      std::mutex mtx;
+      std::condition_variable cvQueue,cvDone;
+
+      // workers, each with its own copy of the solution objects; the guard
+      // stops them, and waits for them, however this loop is left
+      vector<std::thread> workers;
+      vector< vector<SolutionObject> > workerSolObjs;
+      if(nthreads > 1) workerSolObjs.assign(nthreads, C.SolObjs);
+      class WorkerGuard {
+      public:
+         WorkerGuard(vector<std::thread>& w, deque<EpochJob *>& q, std::mutex& m,
+                     std::condition_variable& cv)
+            : workers(w), queue(q), mtx(m), cvQueue(cv), stop(false) { }
+         ~WorkerGuard()
+         {
+            {
+               std::lock_guard<std::mutex> lock(mtx);
+               stop = true;
+               queue.clear();
+            }
+            cvQueue.notify_all();
+            for(size_t n=0; n<workers.size(); n++) workers[n].join();
          }
-         catch(std::exception& e) {
-            Exception ge(string("Std excep: ") + e.what());
-            GPSTK_THROW(ge);
+         vector<std::thread>& workers;
+         deque<EpochJob *>& queue;
+         std::mutex& mtx;
+         std::condition_variable& cvQueue;
+         bool stop;
+      } guard(workers, queue, mtx, cvQueue);
+
+      if(nthreads > 1) {
+         for(unsigned n=0; n<nthreads; n++) workers.push_back(std::thread(
+            [&, n]()
+            {
+               vector<SolutionObject>& SolObjs(workerSolObjs[n]);
+               for(;;) {
+                  EpochJob *pjob;
+                  {
+                     std::unique_lock<std::mutex> lock(mtx);
+                     cvQueue.wait(lock, [&]{ return guard.stop || !queue.empty(); });
+                     if(guard.stop) return;
+                     pjob = queue.front();
+                     queue.pop_front();
+                  }
+                  try {
+                     PrepareEpoch(*pjob, SolObjs, Rhead, mapDCBindex, false);
+                     pjob->SolData.resize(SolObjs.size());
+                     for(size_t m=0; m<SolObjs.size(); m++)
+                        SolObjs[m].SwapEpochData(pjob->SolData[m]);
+                  }
+                  catch(...) { pjob->error = std::current_exception(); }
+                  {
+                     std::lock_guard<std::mutex> lock(mtx);
+                     pjob->done = true;
+                  }
+                  cvDone.notify_all();
+               }
+            }));
+      }
+
+      string errmsg;
+      bool reading(true);
+      while(reading || !window.empty()) {
+         // read epochs until the window is full
+         while(reading && window.size() < maxJobs) {
+            k = ReadEpoch(istrm, Rdata, errmsg);
+            if(k != 1) {                  // no more data; iret is 0 or 3
+               reading = false;
+               iret = k;
+               break;
+            }
+
+            window.push_back(std::unique_ptr<EpochJob>(new EpochJob()));
+            window.back()->Rdata = Rdata;
+            if(nthreads > 1) {
+               {
+                  std::lock_guard<std::mutex> lock(mtx);
+                  queue.push_back(window.back().get());
+               }
+               cvQueue.notify_one();
+            }
          }
-         catch(...) {
-            Exception ue("Unknown exception while reading RINEX data.");
-            GPSTK_THROW(ue);
+         if(window.empty()) break;
+
+         // process the earliest epoch
+         EpochJob& job(*window.front());
+         if(nthreads == 1)
+            PrepareEpoch(job, C.SolObjs, Rhead, mapDCBindex, true);
+         else {
+            {
+               std::unique_lock<std::mutex> lock(mtx);
+               cvDone.wait(lock, [&]{ return job.done; });
+            }
+            if(job.error) std::rethrow_exception(job.error);
+            for(i=0; i<C.SolObjs.size(); ++i)
+               C.SolObjs[i].SwapEpochData(job.SolData[i]);
          }
 
-         // normal EOF
-         if(!istrm.good() || istrm.eof()) { iret = 0; break; }
+         ProcessEpoch(job, Rhead, ostrm, firstepoch);
 
-         // if aux header data, or no data, skip it
-         if(Rdata.epochFlag > 1 || Rdata.obs.empty()) {
-            LOG(DEBUG) << " RINEX Data is aux header or empty.";
-            continue;
-         }
+         firstepoch = false;
+         window.pop_front();
 
-         LOG(DEBUG) << "\n Read RINEX data: flag " << Rdata.epochFlag
-            << ", timetag " << printTime(Rdata.time,C.longfmt);
+      }  // end while loop over epochs
 
-         // stay within time limits
-         if(Rdata.time < C.beginTime) {
-            LOG(DEBUG) << " RINEX data timetag " << printTime(C.beginTime,C.longfmt)
-               << " is before begin time.";
-            continue;
-         }
-         if(Rdata.time > C.endTime) {
-            LOG(DEBUG) << " RINEX data timetag " << printTime(C.endTime,C.longfmt)
-               << " is after end time.";
-            break;
-         }
+      // failure to read data, after all the epochs before it
+      if(iret == 3) {
+         LOG(WARNING) << " Warning : Failed to read obs data (Exception "
+            << errmsg << "); dump follows.";
+         Rdata.dump(LOGstrm,Rhead);
+         istrm.close();
+      }
 
-         // decimate
-         if(C.decimate > 0.0) {
-            double dt(::fabs(Rdata.time - C.decTime));
-            dt -= C.decimate * long(0.5 + dt/C.decimate);
-            if(::fabs(dt) > 0.25) {
-               LOG(DEBUG) << " Decimation rejects RINEX data timetag "
-                  << printTime(Rdata.time,C.longfmt);
-               continue;
-            }
-         }
+      istrm.close();
 
-         // reset solution objects for this epoch
-         for(i=0; i<C.SolObjs.size(); ++i)
-            C.SolObjs[i].EpochReset();
+      // failure due to critical error
+      if(iret < 0) break;
 
-         // loop over satellites -----------------------------
-         RinexSatID sat;
-         Rinex3ObsData::DataMap::iterator it;
-         for(it=Rdata.obs.begin(); it!=Rdata.obs.end(); ++it) {
-            sat = it->first;
-            vector<RinexDatum>& vrdata(it->second);
-            string sys(asString(sat.systemChar()));
-
-            // is this system excluded?
-            if(find(C.allSystemChars.begin(),C.allSystemChars.end(),sys)
-                  == C.allSystemChars.end())
-            {
-               LOG(DEBUG) << " Sat " << sat << " : system " << sys
-                  << " is not needed.";
-               continue;
-            }
+      if(iret == 0) nfiles++;
 
-            // has user excluded this satellite?
-            if(find(C.exclSat.begin(),C.exclSat.end(),sat) != C.exclSat.end()) {
-               LOG(DEBUG) << " Sat " << sat << " is excluded.";
-               continue;
-            }
+   }  // end loop over files
 
-            // correct for DCB
-            if(DCBcorr && mapDCBindex.find(sys) != mapDCBindex.end()) {
-               i = mapDCBindex[sys];
-               if(C.P1C1bias.find(sat) != C.P1C1bias.end()) {
-                  LOG(DEBUG) << "Correct data " << asString(Rhead.mapObsTypes[sys][i])
-                     << " = " << fixed << setprecision(2) << vrdata[i].data
-                     << " for DCB with " << C.P1C1bias[sat];
-                  vrdata[i].data += C.P1C1bias[sat];
-               }
-            }
+   if(!C.OutputObsFile.empty()) ostrm.close();
 
-            // elevation mask, azimuth and ephemeris range corrected with trop
-            // - pass elev to CollectData for m-cov matrix and ORDs
-            double elev(0), ER(0), tcorr;
-            if((C.elevLimit > 0 || C.weight || C.ORDout)
-                              && PrevPos.getCoordinateSystem() != Position::Unknown) {
-               CorrectedEphemerisRange CER;
-               try {
-                  CER.ComputeAtReceiveTime(Rdata.time, PrevPos, sat, *C.pEph);
-                  elev = CER.elevation;
-                  // const double azim = CER.azimuth;
-                  if(C.ORDout) {
-                     tcorr = C.pTrop->correction(PrevPos,CER.svPosVel.x,Rdata.time);
-                     ER = CER.rawrange - CER.svclkbias - CER.relativity + tcorr;
-                  }
-                  if(elev < C.elevLimit) {         // TD add elev mask [azim]
-                     LOG(VERBOSE) << " Reject sat " << sat << " for elevation "
-                        << fixed << setprecision(2) << elev << " at time "
-                        << printTime(Rdata.time,C.longfmt);
-                     continue;
-                  }
-               }
-               catch(Exception& e) {
-                  LOG(WARNING) << "WARNING : Failed to get elevation for sat "
-                     << sat << " at time " << printTime(Rdata.time,C.longfmt);
-                  continue;
-               }
-            }
+   if(iret < 0) return iret;
 
-            // pick out data for each solution object
-            for(i=0; i<C.SolObjs.size(); ++i)
-               C.SolObjs[i].CollectData(sat,elev,ER,vrdata);
+   return nfiles;
+}
+catch(Exception& e) { GPSTK_RETHROW(e); }
+}  // end ProcessFiles()
 
-         }  // end loop over satellites
+//------------------------------------------------------------------------------------
+// Read the next epoch of data within the time limits and decimation.
+// Return 1 if Rdata holds the epoch, 0 at the end of the data, or 3 if the data
+// could not be read, with the exception text in errmsg.
+int ReadEpoch(Rinex3ObsStream& istrm, Rinex3ObsData& Rdata, string& errmsg)
+{
+try {
+   Configuration& C(Configuration::Instance());
 
-         // debug: dump the RINEX data object
-         if(C.debug > -1) Rdata.dump(LOGstrm,Rhead);
+   while(1) {
+      try { istrm >> Rdata; }
+      catch(Exception& e) {
+         errmsg = e.getText(0);
+         return 3;
+      }
+      catch(std::exception& e) {
+         Exception ge(string("Std excep: ") + e.what());
+         GPSTK_THROW(ge);
+      }
+      catch(...) {
+         Exception ue("Unknown exception while reading RINEX data.");
+         GPSTK_THROW(ue);
+      }
 
-         // update the trop model's weather ------------------
-         if(C.MetStore.size() > 0) C.setWeather(Rdata.time);
+      // normal EOF
+      if(!istrm.good() || istrm.eof()) return 0;
 
-         // put a blank line here for readability
-         LOG(INFO) << "";
+      // if aux header data, or no data, skip it
+      if(Rdata.epochFlag > 1 || Rdata.obs.empty()) {
+         LOG(DEBUG) << " RINEX Data is aux header or empty.";
+         continue;
+      }
 
-         // compute the solution(s) --------------------------
-         // tag for DAT - required for PRSplot
-         C.msg = printTime(Rdata.time,"DAT "+C.gpsfmt);
+      LOG(DEBUG) << "\n Read RINEX data: flag " << Rdata.epochFlag
+         << ", timetag " << printTime(Rdata.time,C.longfmt);
 
-         // compute and print the solution(s) ----------------
-         for(i=0; i<C.SolObjs.size(); ++i) {
-            // skip invalid descriptors
-            if(!C.SolObjs[i].isValid) continue;
+      // stay within time limits
+      if(Rdata.time < C.beginTime) {
+         LOG(DEBUG) << " RINEX data timetag " << printTime(C.beginTime,C.longfmt)
+            << " is before begin time.";
+         continue;
+      }
+      if(Rdata.time > C.endTime) {
+         LOG(DEBUG) << " RINEX data timetag " << printTime(C.endTime,C.longfmt)
+            << " is after end time.";
+         return 0;
+      }
+
+      // decimate
+      if(C.decimate > 0.0) {
+         double dt(::fabs(Rdata.time - C.decTime));
+         dt -= C.decimate * long(0.5 + dt/C.decimate);
+         if(::fabs(dt) > 0.25) {
+            LOG(DEBUG) << " Decimation rejects RINEX data timetag "
+               << printTime(Rdata.time,C.longfmt);
+            continue;
+         }
+      }
 
-            // dump the "DAT" record
-            if(firstepoch)
-               LOG(VERBOSE) << C.SolObjs[i].dump(-1, "RPF", "DAT");
-            LOG(INFO) << C.SolObjs[i].dump((C.debug > -1 ? 2:1), "RPF", C.msg);
+      return 1;
+   }
+}
+catch(Exception& e) { GPSTK_RETHROW(e); }
+}  // end ReadEpoch()
+
+//------------------------------------------------------------------------------------
+// Correct the data in job for DCB, and collect it into SolObjs, with elevations
+// and corrected ephemeris ranges. inOrder is true when called in time order, with
+// SolObjs = C.SolObjs; otherwise this is a worker thread, which must not use the
+// trop model, so the trop corrections for ORDs are left to ProcessEpoch(), and
+// which calls PrepareSolution() for each solution.
+void PrepareEpoch(EpochJob& job, vector<SolutionObject>& SolObjs,
+                  const Rinex3ObsHeader& Rhead, const map<string,int>& mapDCBindex,
+                  bool inOrder)
+{
+try {
+   Configuration& C(Configuration::Instance());
+   Rinex3ObsData& Rdata(job.Rdata);
+   size_t i;
+
+   // reset solution objects for this epoch
+   for(i=0; i<SolObjs.size(); ++i)
+      SolObjs[i].EpochReset();
+
+   // loop over satellites -----------------------------
+   RinexSatID sat;
+   Rinex3ObsData::DataMap::iterator it;
+   for(it=Rdata.obs.begin(); it!=Rdata.obs.end(); ++it) {
+      sat = it->first;
+      vector<RinexDatum>& vrdata(it->second);
+      string sys(asString(sat.systemChar()));
+
+      // is this system excluded?
+      if(find(C.allSystemChars.begin(),C.allSystemChars.end(),sys)
+            == C.allSystemChars.end())
+      {
+         JOBLOG(job,DEBUG) << " Sat " << sat << " : system " << sys
+            << " is not needed.";
+         continue;
+      }
 
-            // compute the solution
-            if(firstepoch) LOG(VERBOSE) << C.SolObjs[i].prs.outputString(
-                        string("RPF ")+C.SolObjs[i].Descriptor,-999);
-            if(firstepoch) LOG(VERBOSE) << C.SolObjs[i].prs.outputPOSString(
-                        string("RPR ")+C.SolObjs[i].Descriptor,-999);
-            if(firstepoch) LOG(VERBOSE) << C.SolObjs[i].prs.outputPOSString(
-                        string("RNE ")+C.SolObjs[i].Descriptor,-999);
-            j = C.SolObjs[i].ComputeSolution(Rdata.time);
+      // has user excluded this satellite?
+      if(find(C.exclSat.begin(),C.exclSat.end(),sat) != C.exclSat.end()) {
+         JOBLOG(job,DEBUG) << " Sat " << sat << " is excluded.";
+         continue;
+      }
 
-            // write ORDs, even if solution is not good
-            if(C.ORDout) C.SolObjs[i].WriteORDs(Rdata.time,j);
+      // correct for DCB
+      map<string,int>::const_iterator dit(mapDCBindex.find(sys));
+      if(dit != mapDCBindex.end()) {
+         i = dit->second;
+         map<RinexSatID,double>::const_iterator bit(C.P1C1bias.find(sat));
+         if(bit != C.P1C1bias.end()) {
+            JOBLOG(job,DEBUG) << "Correct data "
+               << asString(Rhead.mapObsTypes.find(sys)->second[i])
+               << " = " << fixed << setprecision(2) << vrdata[i].data
+               << " for DCB with " << bit->second;
+            vrdata[i].data += bit->second;
          }
+      }
 
-         // write to output RINEX ----------------------------
-         if(!C.OutputObsFile.empty()) {
-            Rinex3ObsData auxData;
-            auxData.time = Rdata.time;
-            auxData.clockOffset = Rdata.clockOffset;
-            auxData.epochFlag = 4;
-            ostringstream oss;
-            // loop over valid descriptors
-            for(k=0,i=0; i<C.SolObjs.size(); ++i) if(C.SolObjs[i].isValid) {
-               if(!C.SolObjs[i].prs.isValid())
-               {
-                  LOG(ERROR) << "Invalid soution!";
-                  break;
+      // elevation mask, azimuth and ephemeris range corrected with trop
+      // - pass elev to CollectData for m-cov matrix and ORDs
+      double elev(0), ER(0), tcorr;
+      if((C.elevLimit > 0 || C.weight || C.ORDout)
+                        && C.knownPos.getCoordinateSystem() != Position::Unknown) {
+         CorrectedEphemerisRange CER;
+         try {
+            CER.ComputeAtReceiveTime(Rdata.time, C.knownPos, sat, *C.pEph);
+            elev = CER.elevation;
+            // const double azim = CER.azimuth;
+            if(C.ORDout) {
+               if(inOrder) {
+                  tcorr = C.pTrop->correction(C.knownPos,CER.svPosVel.x,Rdata.time);
+                  ER = CER.rawrange - CER.svclkbias - CER.relativity + tcorr;
                }
-               oss.str("");
-               oss << "XYZ" << fixed << setprecision(3)
-                  << " " << setw(12) << C.SolObjs[i].prs.Solution(0)
-                  << " " << setw(12) << C.SolObjs[i].prs.Solution(1)
-                  << " " << setw(12) << C.SolObjs[i].prs.Solution(2);
-               oss << " " << C.SolObjs[i].Descriptor;     // may get truncated
-               auxData.auxHeader.commentList.push_back(oss.str());
-               k++;
-               oss.str("");
-               oss << "CLK" << fixed << setprecision(3);
-
-               for(j=0; j<C.SolObjs[i].prs.dataGNSS.size(); j++) {
-                  RinexSatID sat(1,C.SolObjs[i].prs.dataGNSS[j]);
-                  oss << " " << sat.systemString3()
-                     << " " << setw(11) << C.SolObjs[i].prs.Solution(3+j);
+               else {   // ProcessEpoch() will add tcorr
+                  EpochJob::TropSat ts;
+                  ts.sat = sat;
+                  ts.svPos = CER.svPosVel.x;
+                  ts.nmsg = job.Messages.size();
+                  ts.rejected = (elev < C.elevLimit);
+                  ts.logged = (ts.rejected
+                               && VERBOSE <= ConfigureLOG::ReportingLevel());
+                  job.TropSats.push_back(ts);
+                  ER = CER.rawrange - CER.svclkbias - CER.relativity;
                }
-               oss << " " << C.SolObjs[i].Descriptor;     // may get truncated
-               auxData.auxHeader.commentList.push_back(oss.str());
-               k++;
-               oss.str("");
-               oss << "DIA" << setw(2) << C.SolObjs[i].prs.Nsvs
-                  << fixed << setprecision(2)
-                  << " " << setw(4) << C.SolObjs[i].prs.PDOP
-                  << " " << setw(4) << C.SolObjs[i].prs.GDOP
-                  << " " << setw(8) << C.SolObjs[i].prs.RMSResidual
-                  << " " << C.SolObjs[i].Descriptor;     // may get truncated
-               auxData.auxHeader.commentList.push_back(oss.str());
-               k++;
             }
-            auxData.numSVs = k;            // number of lines to write
-            auxData.auxHeader.valid |= Rinex3ObsHeader::validComment;
-            ostrm << auxData;
+            if(elev < C.elevLimit) {         // TD add elev mask [azim]
+               JOBLOG(job,VERBOSE) << " Reject sat " << sat << " for elevation "
+                  << fixed << setprecision(2) << elev << " at time "
+                  << printTime(Rdata.time,C.longfmt);
+               continue;
+            }
+         }
+         catch(Exception& e) {
+            JOBLOG(job,WARNING) << "WARNING : Failed to get elevation for sat "
+               << sat << " at time " << printTime(Rdata.time,C.longfmt);
+            continue;
+         }
+      }
+
+      // pick out data for each solution object
+      for(i=0; i<SolObjs.size(); ++i)
+         SolObjs[i].CollectData(sat,elev,ER,vrdata);
+
+   }  // end loop over satellites
+
+   // get the ephemeris for the RAIM solutions
+   if(!inOrder) for(i=0; i<SolObjs.size(); ++i)
+      SolObjs[i].PrepareSolution(Rdata.time);
+}
+catch(Exception& e) { GPSTK_RETHROW(e); }
+}  // end PrepareEpoch()
 
-            ostrm << Rdata;
+//------------------------------------------------------------------------------------
+// Given the job for the next epoch, prepared by PrepareEpoch() with its data now
+// in C.SolObjs, compute the solutions and write the output.
+void ProcessEpoch(EpochJob& job, Rinex3ObsHeader& Rhead,
+                  Rinex3ObsStream& ostrm, bool firstepoch)
+{
+try {
+   Configuration& C(Configuration::Instance());
+   Rinex3ObsData& Rdata(job.Rdata);
+   int k;
+   size_t i,j,n;
+
+   // trop corrections left by a worker, in the order they would have been made;
+   // a sat whose correction fails is dropped, with the warning it would have had
+   for(n=0; n<job.TropSats.size(); n++) {
+      const EpochJob::TropSat& ts(job.TropSats[n]);
+      double tcorr;
+      try {
+         tcorr = C.pTrop->correction(C.knownPos,ts.svPos,Rdata.time);
+      }
+      catch(Exception& e) {
+         ostringstream oss;
+         oss << "WARNING : Failed to get elevation for sat "
+            << ts.sat << " at time " << printTime(Rdata.time,C.longfmt);
+         pair<LogLevel,string> msg(WARNING,oss.str());
+         if(ts.logged)              // replaces the elevation message
+            job.Messages[ts.nmsg] = msg;
+         else {
+            job.Messages.insert(job.Messages.begin()+ts.nmsg, msg);
+            for(j=n+1; j<job.TropSats.size(); j++)
+               job.TropSats[j].nmsg++;
+            if(!ts.rejected) for(i=0; i<C.SolObjs.size(); ++i)
+               C.SolObjs[i].RemoveSat(ts.sat);
          }
+         continue;
+      }
+      if(ts.rejected) continue;
+      for(i=0; i<C.SolObjs.size(); ++i)
+         for(j=0; j<C.SolObjs[i].Satellites.size(); j++)
+            if(C.SolObjs[i].Satellites[j] == ts.sat)
+               C.SolObjs[i].ERanges[j] += tcorr;
+   }
 
-         firstepoch = false;
+   // messages from PrepareEpoch()
+   job.WriteLog();
 
-      }  // end while loop over epochs
+   // debug: dump the RINEX data object
+   if(C.debug > -1) Rdata.dump(LOGstrm,Rhead);
 
-      istrm.close();
+   // update the trop model's weather ------------------
+   if(C.MetStore.size() > 0) C.setWeather(Rdata.time);
 
-      // failure due to critical error
-      if(iret < 0) break;
+   // put a blank line here for readability
+   LOG(INFO) << "";
 
-      if(iret == 0) nfiles++;
+   // compute the solution(s) --------------------------
+   // tag for DAT - required for PRSplot
+   C.msg = printTime(Rdata.time,"DAT "+C.gpsfmt);
 
-   }  // end loop over files
+   // compute and print the solution(s) ----------------
+   for(i=0; i<C.SolObjs.size(); ++i) {
+      // skip invalid descriptors
+      if(!C.SolObjs[i].isValid) continue;
 
-   if(!C.OutputObsFile.empty()) ostrm.close();
+      // dump the "DAT" record
+      if(firstepoch)
+         LOG(VERBOSE) << C.SolObjs[i].dump(-1, "RPF", "DAT");
+      LOG(INFO) << C.SolObjs[i].dump((C.debug > -1 ? 2:1), "RPF", C.msg);
 
-   if(iret < 0) return iret;
+      // compute the solution
+      if(firstepoch) LOG(VERBOSE) << C.SolObjs[i].prs.outputString(
+                  string("RPF ")+C.SolObjs[i].Descriptor,-999);
+      if(firstepoch) LOG(VERBOSE) << C.SolObjs[i].prs.outputPOSString(
+                  string("RPR ")+C.SolObjs[i].Descriptor,-999);
+      if(firstepoch) LOG(VERBOSE) << C.SolObjs[i].prs.outputPOSString(
+                  string("RNE ")+C.SolObjs[i].Descriptor,-999);
+      j = C.SolObjs[i].ComputeSolution(Rdata.time);
 
-   return nfiles;
+      // write ORDs, even if solution is not good
+      if(C.ORDout) C.SolObjs[i].WriteORDs(Rdata.time,j);
+   }
+
+   // write to output RINEX ----------------------------
+   if(!C.OutputObsFile.empty()) {
+      Rinex3ObsData auxData;
+      auxData.time = Rdata.time;
+      auxData.clockOffset = Rdata.clockOffset;
+      auxData.epochFlag = 4;
+      ostringstream oss;
+      // loop over valid descriptors
+      for(k=0,i=0; i<C.SolObjs.size(); ++i) if(C.SolObjs[i].isValid) {
+         if(!C.SolObjs[i].prs.isValid())
+         {
+            LOG(ERROR) << "Invalid soution!";
+            break;
+         }
+         oss.str("");
+         oss << "XYZ" << fixed << setprecision(3)
+            << " " << setw(12) << C.SolObjs[i].prs.Solution(0)
+            << " " << setw(12) << C.SolObjs[i].prs.Solution(1)
+            << " " << setw(12) << C.SolObjs[i].prs.Solution(2);
+         oss << " " << C.SolObjs[i].Descriptor;     // may get truncated
+         auxData.auxHeader.commentList.push_back(oss.str());
+         k++;
+         oss.str("");
+         oss << "CLK" << fixed << setprecision(3);
+
+         for(j=0; j<C.SolObjs[i].prs.dataGNSS.size(); j++) {
+            RinexSatID sat(1,C.SolObjs[i].prs.dataGNSS[j]);
+            oss << " " << sat.systemString3()
+               << " " << setw(11) << C.SolObjs[i].prs.Solution(3+j);
+         }
+         oss << " " << C.SolObjs[i].Descriptor;     // may get truncated
+         auxData.auxHeader.commentList.push_back(oss.str());
+         k++;
+         oss.str("");
+         oss << "DIA" << setw(2) << C.SolObjs[i].prs.Nsvs
+            << fixed << setprecision(2)
+            << " " << setw(4) << C.SolObjs[i].prs.PDOP
+            << " " << setw(4) << C.SolObjs[i].prs.GDOP
+            << " " << setw(8) << C.SolObjs[i].prs.RMSResidual
+            << " " << C.SolObjs[i].Descriptor;     // may get truncated
+         auxData.auxHeader.commentList.push_back(oss.str());
+         k++;
+      }
+      auxData.numSVs = k;            // number of lines to write
+      auxData.auxHeader.valid |= Rinex3ObsHeader::validComment;
+      ostrm << auxData;
+
+      ostrm << Rdata;
+   }
 }
 catch(Exception& e) { GPSTK_RETHROW(e); }
-}  // end ProcessFiles()
+}  // end ProcessEpoch()
 
 //------------------------------------------------------------------------------------
 //------------------------------------------------------------------------------------
@@ -1650,7 +1991,11 @@ void Configuration::SetDefaults(void) throw()
       maxReject = dummy.NSatsReject;
       nIter = dummy.MaxNIterations;
       convLimit = dummy.ConvergenceLimit;
+      RAIMThreads = dummy.RAIMThreads;
+      RAIMTimeLimit = dummy.RAIMTimeLimit;
+      RAIMDowndate = dummy.RAIMDowndate;
    }
+   nThreads = 1;
 
    userfmt = gpsfmt;
    help = verbose = false;
@@ -1926,6 +2271,14 @@ string Configuration::BuildCommandLine(void) throw()
             "Maximum iteration count in linearized LS");
    opts.Add(0, "conv", "lim", false, false, &convLimit, "",
             "Maximum convergence criterion in estimation in meters");
+   opts.Add(0, "RAIMthreads", "n", false, false, &RAIMThreads, "",
+            "Number of threads used in RAIM [0 for one per core]");
+   opts.Add(0, "RAIMtime", "sec", false, false, &RAIMTimeLimit, "",
+            "Limit on RAIM search time per epoch (sec) [0 for no limit]");
+   opts.Add(0, "RAIMdowndate", "", false, false, &RAIMDowndate, "",
+            "In RAIM, iterate only the combination best scored by downdating");
+   opts.Add(0, "threads", "n", false, false, &nThreads, "",
+            "Number of threads processing epochs [0 for one per core]");
    opts.Add(0, "Trop", "m,T,P,H", false, false, &TropStr, "",
             "Trop model <m> [one of Zero,Black,Saas,NewB,Neill,GG,GGHt,Global\n"
             "                      with optional weather T(C),P(mb),RH(%)]");
@@ -2113,6 +2466,9 @@ int Configuration::ExtraProcessing(string& errors, string& extras) throw()
    if(InputNavFiles.size() > 0 && InputSP3Files.size() > 0)
       oss << "Error : Both --nav and --eph appear: provide only one.\n";
 
+   if(RAIMThreads < 0)
+      oss << "Error : --RAIMthreads must not be negative\n";
+
    //
    if(LOGlevel != 2)
       ossx << "   LOG level is " << ConfigureLOG::ToString(LOGlevel) << "\n";
@@ -2362,6 +2718,41 @@ void SolutionObject::EpochReset(void) throw()
    R1.clear();
    R2.clear();
    UsedObsIDs.clear();
+   isPrepared = false;
+}
+
+//------------------------------------------------------------------------------------
+void SolutionObject::SwapEpochData(EpochData& ed) throw()
+{
+   Satellites.swap(ed.Satellites);
+   PRanges.swap(ed.PRanges);
+   Elevations.swap(ed.Elevations);
+   ERanges.swap(ed.ERanges);
+   RIono.swap(ed.RIono);
+   R1.swap(ed.R1);
+   R2.swap(ed.R2);
+   UsedObsIDs.swap(ed.UsedObsIDs);
+   std::swap(isPrepared,ed.isPrepared);
+   std::swap(NPrepare,ed.NPrepare);
+   PreparedSats.swap(ed.PreparedSats);
+   std::swap(SVP,ed.SVP);
+}
+
+//------------------------------------------------------------------------------------
+void SolutionObject::RemoveSat(const RinexSatID& sat) throw()
+{
+   for(size_t i=Satellites.size(); i>0; i--) {
+      if(Satellites[i-1] != sat) continue;
+      isPrepared = false;        // PreparedSats and SVP still include sat
+      Satellites.erase(Satellites.begin()+i-1);
+      PRanges.erase(PRanges.begin()+i-1);
+      Elevations.erase(Elevations.begin()+i-1);
+      ERanges.erase(ERanges.begin()+i-1);
+      RIono.erase(RIono.begin()+i-1);
+      R1.erase(R1.begin()+i-1);
+      R2.erase(R2.begin()+i-1);
+   }
+   UsedObsIDs.erase(sat);
 }
 
 //------------------------------------------------------------------------------------
@@ -2484,7 +2875,12 @@ int SolutionObject::ComputeSolution(const CommonTime& ttag)
       }  // end if SPSout
 
       // get the RAIM solution ------------------------------------------
-      iret = prs.RAIMCompute(ttag, Satellites, PRanges, invMCov, C.pEph, C.pTrop);
+      if(isPrepared) {
+         Satellites = PreparedSats;
+         iret = prs.RAIMCompute(ttag, Satellites, SVP, NPrepare, invMCov, C.pTrop);
+      }
+      else
+         iret = prs.RAIMCompute(ttag, Satellites, PRanges, invMCov, C.pEph, C.pTrop);
 
       if(iret < 0) {
          LOG(VERBOSE) << "RAIMCompute failed "
@@ -2502,13 +2898,14 @@ int SolutionObject::ComputeSolution(const CommonTime& ttag)
       // output XYZ solution
       LOG(INFO) << prs.outputString(string("RPF ")+Descriptor,iret);
 
-      if(prs.RMSFlag || prs.SlopeFlag || prs.TropFlag)
+      if(prs.RMSFlag || prs.SlopeFlag || prs.TropFlag || prs.TimeLimitFlag)
          LOG(WARNING) << "Warning for " << Descriptor
             << " - possible degraded RPF solution at "
             << printTime(ttag,C.longfmt) << " due to"
             << (prs.RMSFlag ? " large RMS":"")           // NB these strings are used
             << (prs.SlopeFlag ? " large slope":"")       // in PRSplot.pl
-            << (prs.TropFlag ? " missed trop. corr.":"");
+            << (prs.TropFlag ? " missed trop. corr.":"")
+            << (prs.TimeLimitFlag ? " RAIM time limit":"");
 
       // dump pre-fit residuals
       if(prs.hasMemory && ++nepochs > 1)
@@ -2564,6 +2961,22 @@ int SolutionObject::ComputeSolution(const CommonTime& ttag)
    catch(Exception& e) { GPSTK_RETHROW(e); }
 }
 
+//------------------------------------------------------------------------------------
+void SolutionObject::PrepareSolution(const CommonTime& ttag)
+{
+   try {
+      Configuration& C(Configuration::Instance());
+
+      isPrepared = false;
+      if(!isValid || Satellites.size() < 4 || C.SPSout) return;
+
+      PreparedSats = Satellites;
+      NPrepare = prs.PreparePRSolution(ttag, PreparedSats, PRanges, C.pEph, SVP);
+      isPrepared = true;
+   }
+   catch(Exception& e) { GPSTK_RETHROW(e); }
+}
+
 //------------------------------------------------------------------------------------
 int SolutionObject::WriteORDs(const CommonTime& time, const int iret)
 {
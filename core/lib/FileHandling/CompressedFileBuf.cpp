@@ -0,0 +1,391 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+
+/**
+ * @file CompressedFileBuf.cpp
+ * A read-only std::streambuf that decompresses gzip and Unix
+ * compress data on the fly.
+ */
+
+#include <cstring>
+#ifdef GPSTK_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "CompressedFileBuf.hpp"
+#include "FFStreamError.hpp"
+
+namespace gpstk
+{
+      /// Size of the compressed and decompressed data buffers.
+   static const std::size_t bufferSize = 262144;
+
+      /// The special LZW code that resets the string table.
+   static const unsigned lzwClear = 256;
+
+
+   struct CompressedFileBuf::ZState
+   {
+#ifdef GPSTK_HAVE_ZLIB
+      z_stream strm;
+         /// True between the start and end of a gzip member.
+      bool inMember;
+#endif
+   };
+
+
+   CompressedFileBuf::Format CompressedFileBuf ::
+   identify(std::streambuf* src)
+   {
+      pos_type start = src->pubseekoff(0, std::ios_base::cur,
+                                       std::ios_base::in);
+      if (start == pos_type(off_type(-1)))
+         return None;
+      unsigned char magic[2];
+      std::streamsize n = src->sgetn(reinterpret_cast<char*>(magic), 2);
+      if (src->pubseekpos(start, std::ios_base::in) != start)
+         return None;
+      if ((n < 2) || (magic[0] != 0x1f))
+         return None;
+      if (magic[1] == 0x8b)
+         return Gzip;
+      if (magic[1] == 0x9d)
+         return Compress;
+      return None;
+   }
+
+
+   bool CompressedFileBuf ::
+   canDecode(Format fmt)
+   {
+#ifdef GPSTK_HAVE_ZLIB
+      return (fmt != None);
+#else
+      return (fmt == Compress);
+#endif
+   }
+
+
+   CompressedFileBuf ::
+   CompressedFileBuf(std::streambuf* src, Format fmt)
+         : source(src), format(fmt), inBuf(bufferSize), inPos(0), inEnd(0),
+           outBuf(bufferSize), outOffset(0), finished(false), maxBits(0),
+           blockMode(false), nBits(0), maxCode(0), freeEnt(0), oldCode(-1),
+           finChar(0), codeCount(0), bitBuf(0), bitCount(0)
+   {
+#ifdef GPSTK_HAVE_ZLIB
+      if (format == Gzip)
+      {
+         zstate.reset(new ZState);
+         std::memset(&zstate->strm, 0, sizeof(zstate->strm));
+            // 15 bit window, with automatic gzip/zlib header detection
+         if (inflateInit2(&zstate->strm, 15+32) != Z_OK)
+         {
+            zstate.reset();
+         }
+         else
+         {
+            zstate->inMember = true;
+         }
+      }
+#endif
+   }
+
+
+   CompressedFileBuf ::
+   ~CompressedFileBuf()
+   {
+#ifdef GPSTK_HAVE_ZLIB
+      if (zstate)
+      {
+         inflateEnd(&zstate->strm);
+      }
+#endif
+   }
+
+
+   CompressedFileBuf::int_type CompressedFileBuf ::
+   underflow()
+   {
+      if (gptr() < egptr())
+         return traits_type::to_int_type(*gptr());
+      outOffset += egptr() - eback();
+      std::size_t n = 0;
+      while ((n == 0) && !finished)
+      {
+         if (format == Compress)
+         {
+            n = inflateCompress();
+         }
+         else if (zstate)
+         {
+            n = inflateGzip();
+         }
+         else
+         {
+            FFStreamError err("Unable to decompress gzip data, gpstk was"
+                              " built without zlib");
+            GPSTK_THROW(err);
+         }
+      }
+      char *base = &outBuf[0];
+      setg(base, base, base + n);
+      if (n == 0)
+         return traits_type::eof();
+      return traits_type::to_int_type(*base);
+   }
+
+
+   CompressedFileBuf::pos_type CompressedFileBuf ::
+   seekoff(off_type off, std::ios_base::seekdir way,
+           std::ios_base::openmode which)
+   {
+      if ((off != 0) || (way != std::ios_base::cur) ||
+          !(which & std::ios_base::in))
+      {
+         return pos_type(off_type(-1));
+      }
+      return pos_type(outOffset + (gptr() - eback()));
+   }
+
+
+   bool CompressedFileBuf ::
+   readInput()
+   {
+      if (inPos < inEnd)
+         return true;
+      std::streamsize n = source->sgetn(&inBuf[0], inBuf.size());
+      inPos = 0;
+      inEnd = (n > 0 ? n : 0);
+      return (inEnd > 0);
+   }
+
+
+   std::size_t CompressedFileBuf ::
+   inflateGzip()
+   {
+      std::size_t produced = 0;
+#ifdef GPSTK_HAVE_ZLIB
+      z_stream& strm(zstate->strm);
+      while ((produced == 0) && !finished)
+      {
+         if (!readInput())
+         {
+            if (zstate->inMember)
+            {
+               FFStreamError err("Compressed file is truncated");
+               GPSTK_THROW(err);
+            }
+            finished = true;
+            break;
+         }
+         if (!zstate->inMember)
+         {
+               // Concatenated gzip files are valid, but like gzip,
+               // ignore anything else after the end of the data.
+            if (static_cast<unsigned char>(inBuf[inPos]) != 0x1f)
+            {
+               finished = true;
+               break;
+            }
+            inflateReset(&strm);
+            zstate->inMember = true;
+         }
+         strm.next_in = reinterpret_cast<Bytef*>(&inBuf[inPos]);
+         strm.avail_in = inEnd - inPos;
+         strm.next_out = reinterpret_cast<Bytef*>(&outBuf[0]);
+         strm.avail_out = outBuf.size();
+         int rc = inflate(&strm, Z_NO_FLUSH);
+         inPos = inEnd - strm.avail_in;
+         produced = outBuf.size() - strm.avail_out;
+         if (rc == Z_STREAM_END)
+         {
+            zstate->inMember = false;
+         }
+         else if ((rc != Z_OK) && (rc != Z_BUF_ERROR))
+         {
+            FFStreamError err(std::string("Corrupt gzip data: ") +
+                              (strm.msg ? strm.msg : "unknown error"));
+            GPSTK_THROW(err);
+         }
+      }
+#endif
+      return produced;
+   }
+
+
+   bool CompressedFileBuf ::
+   getCode(unsigned& code)
+   {
+      while (bitCount < nBits)
+      {
+         if (!readInput())
+            return false;
+         bitBuf |= static_cast<unsigned long>(
+            static_cast<unsigned char>(inBuf[inPos++])) << bitCount;
+         bitCount += 8;
+      }
+      code = bitBuf & ((1UL << nBits) - 1);
+      bitBuf >>= nBits;
+      bitCount -= nBits;
+      codeCount++;
+      return true;
+   }
+
+
+   void CompressedFileBuf ::
+   skipCodeGroup()
+   {
+      unsigned code;
+      while (((codeCount % 8) != 0) && getCode(code))
+         ;
+      codeCount = 0;
+   }
+
+
+   std::size_t CompressedFileBuf ::
+   inflateCompress()
+   {
+      if (maxBits == 0)
+      {
+            // 2 magic bytes followed by the maximum code size and
+            // block mode flag
+         unsigned char header[3];
+         for (unsigned i = 0; i < 3; i++)
+         {
+            if (!readInput())
+            {
+               FFStreamError err("Compressed file is truncated");
+               GPSTK_THROW(err);
+            }
+            header[i] = inBuf[inPos++];
+         }
+         maxBits = header[2] & 0x1f;
+         blockMode = (header[2] & 0x80) != 0;
+         if ((header[0] != 0x1f) || (header[1] != 0x9d) ||
+             (maxBits < 9) || (maxBits > 16))
+         {
+            FFStreamError err("Invalid compressed file header");
+            GPSTK_THROW(err);
+         }
+         prefix.assign(1U << maxBits, 0);
+         suffix.assign(1U << maxBits, 0);
+         stack.resize((1U << maxBits) + 1);
+         for (unsigned i = 0; i < 256; i++)
+         {
+            suffix[i] = i;
+         }
+         nBits = 9;
+         maxCode = (1U << nBits) - 1;
+         freeEnt = (blockMode ? lzwClear + 1 : 256);
+      }
+
+      const unsigned maxMaxCode = 1U << maxBits;
+      std::size_t produced = 0;
+         // Stop while there's still room for the longest possible string.
+      while (produced + maxMaxCode <= outBuf.size())
+      {
+         if (freeEnt > maxCode)
+         {
+            skipCodeGroup();
+            nBits++;
+            maxCode = (nBits == maxBits ? maxMaxCode : (1U << nBits) - 1);
+         }
+         unsigned code;
+         if (!getCode(code))
+         {
+            finished = true;
+            break;
+         }
+         if (oldCode == -1)
+         {
+            if (code >= 256)
+            {
+               FFStreamError err("Corrupt compressed data");
+               GPSTK_THROW(err);
+            }
+            finChar = code;
+            oldCode = code;
+            outBuf[produced++] = finChar;
+            continue;
+         }
+         if ((code == lzwClear) && blockMode)
+         {
+            skipCodeGroup();
+            freeEnt = lzwClear;
+            nBits = 9;
+            maxCode = (1U << nBits) - 1;
+            continue;
+         }
+         unsigned inCode = code;
+         std::size_t sp = 0;
+         if (code >= freeEnt)
+         {
+               // The code being defined, which is the previous string
+               // plus its own first character.
+            if (code > freeEnt)
+            {
+               FFStreamError err("Corrupt compressed data");
+               GPSTK_THROW(err);
+            }
+            stack[sp++] = finChar;
+            code = oldCode;
+         }
+         while (code >= 256)
+         {
+            stack[sp++] = suffix[code];
+            code = prefix[code];
+         }
+         finChar = code;
+         stack[sp++] = finChar;
+         while (sp > 0)
+         {
+            outBuf[produced++] = stack[--sp];
+         }
+         if (freeEnt < maxMaxCode)
+         {
+            prefix[freeEnt] = oldCode;
+            suffix[freeEnt] = finChar;
+            freeEnt++;
+         }
+         oldCode = inCode;
+      }
+      return produced;
+   }
+
+}  // End of namespace gpstk
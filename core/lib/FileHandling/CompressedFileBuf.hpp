@@ -0,0 +1,195 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+
+/**
+ * @file CompressedFileBuf.hpp
+ * A read-only std::streambuf that decompresses gzip and Unix
+ * compress data on the fly.
+ */
+
+#ifndef GPSTK_COMPRESSEDFILEBUF_HPP
+#define GPSTK_COMPRESSEDFILEBUF_HPP
+
+#include <memory>
+#include <streambuf>
+#include <vector>
+
+namespace gpstk
+{
+      /// @ingroup FileHandling
+      //@{
+
+      /**
+       * A std::streambuf that reads compressed data from another
+       * streambuf (usually the std::filebuf of an open file) and
+       * makes the decompressed data available for reading.  Only as
+       * much of the file as is needed to satisfy reads is
+       * decompressed, so the expanded file never exists in memory or
+       * on disk as a whole.
+       *
+       * Files produced by Unix compress (.Z) are always supported.
+       * gzip files (.gz) are supported when the library is built
+       * with zlib.
+       *
+       * Seeking is not supported, however tellg() returns the
+       * offset in the decompressed data.  Corrupt input results in
+       * an FFStreamError being thrown by underflow(), which an
+       * istream will turn into badbit unless badbit exceptions are
+       * enabled.
+       */
+   class CompressedFileBuf : public std::streambuf
+   {
+   public:
+         /// Compression formats that can be identified.
+      enum Format
+      {
+         None,       ///< Not compressed, or an unknown format.
+         Gzip,       ///< gzip (RFC 1952).
+         Compress    ///< Unix compress (LZW).
+      };
+
+         /** Determine the compression format of the data in \a src
+          * from the first few bytes, leaving \a src positioned
+          * where it started.
+          * @param[in] src the buffer to check, which must support
+          *   seeking.
+          * @return the compression format, None if \a src is not
+          *   compressed or can't be rewound.
+          */
+      static Format identify(std::streambuf* src);
+
+         /// @return true if data in \a fmt can be decompressed.
+      static bool canDecode(Format fmt);
+
+         /** Prepare to decompress data read from \a src, which is
+          * not owned by this object.
+          * @param[in] src the buffer from which to read compressed data.
+          * @param[in] fmt the compression format of the data in \a src.
+          */
+      CompressedFileBuf(std::streambuf* src, Format fmt);
+
+      virtual ~CompressedFileBuf();
+
+   protected:
+         /** Decompress more data.
+          * @throw FFStreamError if the data is corrupt. */
+      virtual int_type underflow();
+
+         /// Only supports reporting the current position.
+      virtual pos_type seekoff(off_type off, std::ios_base::seekdir way,
+                               std::ios_base::openmode which =
+                               std::ios_base::in | std::ios_base::out);
+
+   private:
+         // The decompression state can't be copied.
+      CompressedFileBuf(const CompressedFileBuf&);
+      CompressedFileBuf& operator=(const CompressedFileBuf&);
+
+         /** Refill inBuf from the source if it is empty.
+          * @return false if there is no more input. */
+      bool readInput();
+
+         /** Decompress the next block of gzip data into outBuf.
+          * @return the number of bytes decompressed. */
+      std::size_t inflateGzip();
+
+         /** Decompress the next block of LZW data into outBuf.
+          * @return the number of bytes decompressed. */
+      std::size_t inflateCompress();
+
+         /** Get the next LZW code from the input.
+          * @return false if there isn't a complete code left. */
+      bool getCode(unsigned& code);
+
+         /** Skip to the end of the current group of eight codes,
+          * which compress does whenever the code size changes. */
+      void skipCodeGroup();
+
+         /// Where the compressed data comes from.
+      std::streambuf *source;
+         /// The compression format of source.
+      Format format;
+         /// Compressed data read from source.
+      std::vector<char> inBuf;
+         /// Index of the first unused byte in inBuf.
+      std::size_t inPos;
+         /// Number of valid bytes in inBuf.
+      std::size_t inEnd;
+         /// Decompressed data, which is the get area.
+      std::vector<char> outBuf;
+         /// Number of decompressed bytes before the get area.
+      std::streamoff outOffset;
+         /// Set once all the data has been decompressed.
+      bool finished;
+
+         /// zlib state, opaque so zlib.h isn't needed here.
+      struct ZState;
+      std::unique_ptr<ZState> zstate;
+
+         /// Largest LZW code size in bits.
+      unsigned maxBits;
+         /// True if the LZW table may be reset by a CLEAR code.
+      bool blockMode;
+         /// Current LZW code size in bits.
+      unsigned nBits;
+         /// Largest LZW code at the current code size.
+      unsigned maxCode;
+         /// Next LZW code to be defined.
+      unsigned freeEnt;
+         /// Previous LZW code, or -1 before the first code.
+      int oldCode;
+         /// First character of the previous LZW string.
+      unsigned char finChar;
+         /// Number of LZW codes read at the current code size.
+      unsigned codeCount;
+         /// Bits read from inBuf that haven't been used yet.
+      unsigned long bitBuf;
+         /// Number of valid bits in bitBuf.
+      unsigned bitCount;
+         /// The LZW string table, as prefix code and final character.
+      std::vector<unsigned short> prefix;
+      std::vector<unsigned char> suffix;
+         /// Scratch space for expanding an LZW string.
+      std::vector<unsigned char> stack;
+   }; // End of class 'CompressedFileBuf'
+
+      //@}
+
+}  // End of namespace gpstk
+
+#endif   // GPSTK_COMPRESSEDFILEBUF_HPP
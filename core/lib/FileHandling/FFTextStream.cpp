@@ -42,19 +42,24 @@
  */
 
 #include "FFTextStream.hpp"
+#include "CompressedFileBuf.hpp"
 
 namespace gpstk
 {
+   bool FFTextStream::defaultMemoryMap = false;
+
+
    FFTextStream ::
    FFTextStream()
    {
-      init();
+      init(std::ios::in);
    }
 
 
    FFTextStream ::
    ~FFTextStream()
    {
+      restoreFileBuf();
    }
 
 
@@ -63,7 +68,8 @@ namespace gpstk
                  std::ios::openmode mode )
          : FFStream(fn, mode)
    {
-      init();
+      init(mode);
+      initMap();
    }
 
 
@@ -72,7 +78,8 @@ namespace gpstk
                  std::ios::openmode mode )
          : FFStream( fn.c_str(), mode )
    {
-      init();
+      init(mode);
+      initMap();
    }
 
 
@@ -80,8 +87,12 @@ namespace gpstk
    open( const char* fn,
          std::ios::openmode mode )
    {
+         // FFStream::open closes the filebuf, make sure we're not
+         // still reading from an old mapping after it's reopened.
+      restoreFileBuf();
       FFStream::open(fn, mode);
-      init();
+      init(mode);
+      initMap();
    }
 
 
@@ -94,9 +105,143 @@ namespace gpstk
 
 
    void FFTextStream ::
-   init()
+   close()
+   {
+      restoreFileBuf();
+      std::fstream::close();
+   }
+
+
+   void FFTextStream ::
+   init(std::ios::openmode mode)
    {
       lineNumber = 0;
+      openMode = mode;
+   }
+
+
+   void FFTextStream ::
+   initMap()
+   {
+      if (defaultMemoryMap)
+      {
+         mapFile();
+      }
+   }
+
+
+   bool FFTextStream ::
+   mapFile()
+   {
+      if (isFiltered())
+         return false;
+      if (isMapped())
+         return true;
+      if (!is_open() || !good() || (openMode & std::ios::out) ||
+          !(openMode & std::ios::in))
+      {
+         return false;
+      }
+         // Start the mapped stream where the filebuf left off, in
+         // case anything has already been read.
+      std::streampos pos = std::fstream::rdbuf()->pubseekoff(
+         0, std::ios::cur, std::ios::in);
+      if ((pos == std::streampos(-1)) || !mapBuf.open(filename.c_str()))
+         return false;
+      if (mapBuf.pubseekpos(pos, std::ios::in) != pos)
+      {
+         mapBuf.close();
+         return false;
+      }
+      std::ios::rdbuf(&mapBuf);
+      return true;
+   }
+
+
+   void FFTextStream ::
+   mapMemory(const char* data, std::size_t size)
+   {
+      close();
+      clear();
+      init(std::ios::in);
+      mapBuf.attach(data, size);
+      std::ios::rdbuf(&mapBuf);
+   }
+
+
+   void FFTextStream ::
+   readMemory(const char* data, std::size_t size)
+   {
+      restoreFileBuf();
+      lineNumber = 0;
+      mapBuf.attach(data, size);
+      std::ios::rdbuf(&mapBuf);
+   }
+
+
+   void FFTextStream ::
+   restoreFileBuf()
+   {
+      if (mapBuf.is_open() || isFiltered())
+      {
+         std::ios::rdbuf(std::fstream::rdbuf());
+            // Filters may be reading from the mapping, so remove
+            // them first.
+         filters.clear();
+         mapBuf.close();
+      }
+   }
+
+
+   void FFTextStream ::
+   addInputFilter(std::streambuf* filter)
+   {
+      filters.push_back(std::unique_ptr<std::streambuf>(filter));
+      std::ios::rdbuf(filter);
+   }
+
+
+   bool FFTextStream ::
+   decompress()
+   {
+      if (!is_open() || !good() || (openMode & std::ios::out) ||
+          !(openMode & std::ios::in))
+      {
+         return false;
+      }
+      CompressedFileBuf::Format format =
+         CompressedFileBuf::identify(readBuffer());
+      if ((format == CompressedFileBuf::None) ||
+          !CompressedFileBuf::canDecode(format))
+      {
+         return false;
+      }
+      addInputFilter(new CompressedFileBuf(readBuffer(), format));
+      return true;
+   }
+
+
+   void FFTextStream ::
+   getMappedLine(const char*& line, std::size_t& length)
+   {
+         // Set the stream state the same way std::getline() does.
+      if (!good())
+      {
+         line = nullptr;
+         length = 0;
+         setstate(std::ios::failbit);
+         return;
+      }
+      std::size_t consumed = mapBuf.nextLine(line, length);
+      if (consumed == 0)
+      {
+         setstate(std::ios::eofbit | std::ios::failbit);
+      }
+      else if (consumed == length)
+      {
+            // last line of the file has no line terminator
+         setstate(std::ios::eofbit);
+      }
    }
 
 
@@ -140,25 +285,84 @@ namespace gpstk
    }
 
 
+   void FFTextStream ::
+   formattedGetLine( std::string& line,
+                     const bool expectEOF )
+   {
+      const char *ptr;
+      std::size_t length;
+      getLine(line, ptr, length, expectEOF);
+      if (readingMap())
+         line.assign(ptr, length);
+      else
+         line.resize(length);
+   }
+
+
+   void FFTextStream ::
+   formattedGetLine( const char*& line,
+                     std::size_t& length,
+                     const bool expectEOF )
+   {
+      getLine(lineBuffer, line, length, expectEOF);
+   }
+
+
       // the reason for checking ffs.eof() in the try AND catch block is
       // because if the user enabled exceptions on the stream with exceptions()
       // then eof could throw an exception, in which case we need to catch it
       // and rethrow an EOF or FFStream exception.  In any event, EndOfFile
       // gets thrown whenever there's an EOF and expectEOF is true
    void FFTextStream ::
-   formattedGetLine( std::string& line,
-                     const bool expectEOF )
+   getLine( std::string& buf,
+            const char*& line,
+            std::size_t& length,
+            const bool expectEOF )
    {
+      line = buf.data();
+      length = 0;
       try
       {
-         std::getline(*this, line);
+         if (readingMap())
+         {
+            getMappedLine(line, length);
+         }
+         else
+         {
+               // getline() leaves buf alone if the stream is not
+               // good, which would hide EOF when buf is reused.
+            buf.clear();
+            if (isFiltered())
+            {
+                  // A filter reports bad data by throwing, which
+                  // getline() only passes on if badbit exceptions
+                  // are enabled.
+               std::ios::iostate mask = exceptions();
+               exceptions(mask | std::ios::badbit);
+               try
+               {
+                  std::getline(*this, buf);
+               }
+               catch (...)
+               {
+                  exceptions(mask);
+                  throw;
+               }
+               exceptions(mask);
+            }
+            else
+            {
+               std::getline(*this, buf);
+            }
+            line = buf.data();
+            length = buf.length();
+         }
             // Remove CR characters left over in the buffer from windows files
-         size_t crpos = line.find_last_not_of('\r');
-         if ((crpos+1) < line.length())
-            line.erase(crpos+1);
-         for (int i=0; i<line.length(); i++)
+         while ((length > 0) && (line[length-1] == '\r'))
+            length--;
+         for (std::size_t i=0; i<length; i++)
          {
-            if (!isprint(line[i]))
+            if (!isprint(static_cast<unsigned char>(line[i])))
             {
                FFStreamError err("Non-text data in file.");
                GPSTK_THROW(err);
@@ -172,7 +376,7 @@ namespace gpstk
             GPSTK_THROW(err);
          }
             // catch EOF when stream exceptions are disabled
-         if ((line.size() == 0) && eof())
+         if ((length == 0) && eof())
          {
             if (expectEOF)
             {
@@ -189,7 +393,9 @@ namespace gpstk
       catch(std::exception &e)
       {
             // catch EOF when exceptions are enabled
-         if ( (line.size() == 0) && eof())
+         if (!readingMap())
+            length = buf.length();
+         if ( (length == 0) && eof())
          {
             if (expectEOF)
             {
@@ -209,6 +415,6 @@ namespace gpstk
             GPSTK_THROW(err);
          }
       }
-   }  // End of method 'FFTextStream::formattedGetLine()'
+   }  // End of method 'FFTextStream::getLine()'
    
 }  // End of namespace gpstk
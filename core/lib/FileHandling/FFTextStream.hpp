@@ -44,7 +44,10 @@
 #ifndef GPSTK_FFTEXTSTREAM_HPP
 #define GPSTK_FFTEXTSTREAM_HPP
 
+#include <memory>
+#include <vector>
 #include "FFStream.hpp"
+#include "MappedFileBuf.hpp"
 
 namespace gpstk
 {
@@ -59,6 +62,17 @@ namespace gpstk
        * update the line number - the derived class or programmer
        * needs to make sure that the reader or writer increments
        * lineNumber in these cases.
+       *
+       * Streams opened for input only may be memory mapped, either
+       * by setting defaultMemoryMap before the stream is opened or by
+       * calling mapFile() on an open stream.  A mapped stream reads
+       * directly from the mapping via the iostream API as usual, and
+       * the pointer/length form of formattedGetLine() returns lines
+       * without copying them at all.
+       *
+       * Derived classes may also have the stream read through one or
+       * more input filters, such as CompressedFileBuf, which decode
+       * the file as it is read.  See addInputFilter().
        */
    class FFTextStream : public FFStream
    {
@@ -93,6 +107,41 @@ namespace gpstk
       virtual void open( const std::string& fn,
                          std::ios::openmode mode );
 
+         /// Releases any memory mapping and closes the file.
+      void close();
+
+         /** Switch an open input-only stream to read from a memory
+          * mapping of the file, starting at the current read position.
+          * @return true if the stream is now memory mapped, false if
+          *   the stream is not open, was opened for output, or the
+          *   file could not be mapped, in which case the stream is
+          *   left reading through std::filebuf.
+          */
+      bool mapFile();
+
+         /** Read from a block of memory, e.g. part of a file that is
+          * already memory mapped, instead of from the file.  Any
+          * file the stream had open is closed.  The memory is not
+          * copied and must remain valid while the stream is in use.
+          * The line number is reset to 0.
+          * @param[in] data the first character of the text to read.
+          * @param[in] size the number of characters in the block.
+          */
+      void mapMemory(const char* data, std::size_t size);
+
+         /// @return true if the stream is reading from a memory mapping.
+      bool isMapped() const
+      { return mapBuf.is_open(); }
+
+         /// @return true if the stream is reading through input filters.
+      bool isFiltered() const
+      { return !filters.empty(); }
+
+         /** When true, FFTextStream objects subsequently opened for
+          * input only will attempt to memory map the file.
+          * Defaults to false. */
+      static bool defaultMemoryMap;
+
          /// The internal line count. When writing, make sure
          /// to increment this.
       unsigned int lineNumber;
@@ -118,6 +167,25 @@ namespace gpstk
       void formattedGetLine( std::string& line,
                              const bool expectEOF = false );
 
+         /**
+          * Identical to formattedGetLine(std::string&,const bool)
+          * except that the line is not copied into a string.  When the
+          * stream is memory mapped, \a line points directly into the
+          * mapping, otherwise it points to a buffer internal to the
+          * stream.  In either case, the line is NOT null-terminated
+          * and is only valid until the next read from the stream.
+          * @param[out] line set to the first character of the line.
+          * @param[out] length set to the number of characters in the
+          *   line, after any trailing '\r' characters are removed.
+          * @param[in] expectEOF set true if finding EOF on this read
+          *   is acceptable.
+          * @throw EndOfFile if \a expectEOF is true and an EOF is encountered.
+          * @throw FFStreamError if EOF is found and \a expectEOF is false
+          */
+      void formattedGetLine( const char*& line,
+                             std::size_t& length,
+                             const bool expectEOF = false );
+
 
    protected:
 
@@ -133,9 +201,75 @@ namespace gpstk
           */
       virtual void tryFFStreamPut(const FFData& rec);
 
+         /** Read the file through \a filter from now on.  The filter
+          * must read its input from readBuffer(), and should be added
+          * before anything is read.  Filters are removed when the
+          * stream is closed or reopened.  Errors thrown by a filter
+          * are passed on by formattedGetLine().
+          * @param[in] filter the buffer to read from, which the
+          *   stream takes ownership of.
+          */
+      void addInputFilter(std::streambuf* filter);
+
+         /** Read from a block of memory instead of the file, which
+          * is left open, until the stream is closed or reopened.  The
+          * memory is not copied and must remain valid while the
+          * stream is reading it.  The line number is reset to 0.
+          * @param[in] data the first character of the text to read.
+          * @param[in] size the number of characters in the block.
+          */
+      void readMemory(const char* data, std::size_t size);
+
+         /// @return the buffer the stream is currently reading from.
+      std::streambuf* readBuffer() const
+      { return std::ios::rdbuf(); }
+
+         /** If the stream is open for input only and the file is
+          * compressed in a format CompressedFileBuf can decode, add
+          * an input filter to decompress it.
+          * @return true if the file is being decompressed.
+          */
+      bool decompress();
+
    private:
          /// Initialize internal data structures
-      void init();
+      void init(std::ios::openmode mode);
+
+         /// Map the file if defaultMemoryMap is set.
+      void initMap();
+
+         /** Return to reading through std::filebuf and drop any input
+          * filters and mapping. */
+      void restoreFileBuf();
+
+         /// @return true if reading directly from the mapping.
+      bool readingMap() const
+      { return std::ios::rdbuf() == &mapBuf; }
+
+         /** Get one line from the mapping, setting the stream state
+          * the same way std::getline would. */
+      void getMappedLine(const char*& line, std::size_t& length);
+
+         /** Read a line either from the mapping or into \a buf,
+          * remove trailing CRs, make sure it's all text, and handle
+          * EOF/failure states.
+          * @throw EndOfFile
+          * @throw FFStreamError */
+      void getLine(std::string& buf, const char*& line, std::size_t& length,
+                   const bool expectEOF);
+
+         /// The mode the stream was most recently opened with.
+      std::ios::openmode openMode;
+
+         /// Read buffer used when the stream is memory mapped.
+      MappedFileBuf mapBuf;
+
+         /// Line buffer for the pointer form of formattedGetLine
+         /// when the stream is not memory mapped.
+      std::string lineBuffer;
+
+         /// Input filters, in the order they were added.
+      std::vector<std::unique_ptr<std::streambuf> > filters;
 
    }; // End of class 'FFTextStream'
 
@@ -0,0 +1,223 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+
+/**
+ * @file MappedFileBuf.cpp
+ * A read-only std::streambuf backed by a memory-mapped file.
+ */
+
+#include <cstring>
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "MappedFileBuf.hpp"
+
+namespace gpstk
+{
+   MappedFileBuf ::
+   MappedFileBuf()
+         : mapBase(nullptr), mapSize(0), isOpen(false), ownsMap(false)
+   {
+   }
+
+
+   MappedFileBuf ::
+   ~MappedFileBuf()
+   {
+      close();
+   }
+
+
+   bool MappedFileBuf ::
+   open(const char* fn)
+   {
+      close();
+#ifdef WIN32
+         // No mmap() here, the caller should use std::filebuf instead.
+      return false;
+#else
+      int fd = ::open(fn, O_RDONLY);
+      if (fd < 0)
+         return false;
+      struct stat sb;
+      if ((::fstat(fd, &sb) != 0) || !S_ISREG(sb.st_mode))
+      {
+         ::close(fd);
+         return false;
+      }
+      mapSize = sb.st_size;
+      if (mapSize > 0)
+      {
+         void *addr = ::mmap(nullptr, mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+         if (addr == MAP_FAILED)
+         {
+            ::close(fd);
+            mapSize = 0;
+            return false;
+         }
+         mapBase = static_cast<char*>(addr);
+         ownsMap = true;
+            // Text files are nearly always read front to back.
+         ::madvise(addr, mapSize, MADV_SEQUENTIAL);
+      }
+         // The mapping remains valid after the descriptor is closed.
+      ::close(fd);
+      setg(mapBase, mapBase, mapBase + mapSize);
+      isOpen = true;
+      return true;
+#endif
+   }
+
+
+   void MappedFileBuf ::
+   attach(const char* data, std::size_t size)
+   {
+      close();
+         // The get area is never written through, so casting away
+         // const is safe.
+      mapBase = const_cast<char*>(data);
+      mapSize = size;
+      setg(mapBase, mapBase, mapBase + mapSize);
+      isOpen = true;
+   }
+
+
+   void MappedFileBuf ::
+   close()
+   {
+#ifndef WIN32
+      if (ownsMap && (mapBase != nullptr))
+      {
+         ::munmap(mapBase, mapSize);
+      }
+#endif
+      mapBase = nullptr;
+      mapSize = 0;
+      isOpen = false;
+      ownsMap = false;
+      setg(nullptr, nullptr, nullptr);
+   }
+
+
+   std::size_t MappedFileBuf ::
+   nextLine(const char*& line, std::size_t& length)
+   {
+      char *start = gptr();
+      std::size_t avail = egptr() - start;
+      line = start;
+      if (avail == 0)
+      {
+         length = 0;
+         return 0;
+      }
+      const char *nl = static_cast<const char*>(std::memchr(start,'\n',avail));
+      std::size_t consumed;
+      if (nl == nullptr)
+      {
+         length = avail;
+         consumed = avail;
+      }
+      else
+      {
+         length = nl - start;
+         consumed = length + 1;
+      }
+         // gbump() takes an int, which may be too small for a huge
+         // file with no newlines, so reset the get area instead.
+      setg(eback(), start + consumed, egptr());
+      return consumed;
+   }
+
+
+   MappedFileBuf::int_type MappedFileBuf ::
+   underflow()
+   {
+      if (gptr() < egptr())
+         return traits_type::to_int_type(*gptr());
+      return traits_type::eof();
+   }
+
+
+   std::streamsize MappedFileBuf ::
+   showmanyc()
+   {
+      std::streamsize avail = egptr() - gptr();
+      return (avail > 0) ? avail : -1;
+   }
+
+
+   MappedFileBuf::pos_type MappedFileBuf ::
+   seekoff(off_type off, std::ios_base::seekdir way,
+           std::ios_base::openmode which)
+   {
+      if (!isOpen || !(which & std::ios_base::in))
+         return pos_type(off_type(-1));
+      off_type base;
+      switch (way)
+      {
+         case std::ios_base::beg:
+            base = 0;
+            break;
+         case std::ios_base::cur:
+            base = gptr() - eback();
+            break;
+         case std::ios_base::end:
+            base = mapSize;
+            break;
+         default:
+            return pos_type(off_type(-1));
+      }
+      off_type newPos = base + off;
+      if ((newPos < 0) || (newPos > off_type(mapSize)))
+         return pos_type(off_type(-1));
+      setg(eback(), eback() + newPos, egptr());
+      return pos_type(newPos);
+   }
+
+
+   MappedFileBuf::pos_type MappedFileBuf ::
+   seekpos(pos_type pos, std::ios_base::openmode which)
+   {
+      return seekoff(off_type(pos), std::ios_base::beg, which);
+   }
+
+}  // End of namespace gpstk
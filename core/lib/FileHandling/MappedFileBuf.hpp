@@ -0,0 +1,153 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+
+/**
+ * @file MappedFileBuf.hpp
+ * A read-only std::streambuf backed by a memory-mapped file.
+ */
+
+#ifndef GPSTK_MAPPEDFILEBUF_HPP
+#define GPSTK_MAPPEDFILEBUF_HPP
+
+#include <cstddef>
+#include <streambuf>
+
+namespace gpstk
+{
+      /// @ingroup FileHandling
+      //@{
+
+      /**
+       * A std::streambuf whose get area is the entire contents of a
+       * file mapped into memory.  Since the whole file is always in
+       * the get area, ordinary istream extraction, tellg() and
+       * seekg() work without any copying, and nextLine() can hand
+       * out non-owning pointers into the mapping.
+       *
+       * The buffer is read-only.  On platforms without mmap(), open()
+       * always fails so callers can fall back to std::filebuf.
+       */
+   class MappedFileBuf : public std::streambuf
+   {
+   public:
+         /// Create an empty, unmapped buffer.
+      MappedFileBuf();
+
+         /// Unmap the file, if any.
+      virtual ~MappedFileBuf();
+
+         /** Map the named file into memory, replacing any existing mapping.
+          * @param[in] fn the path of the file to map.
+          * @return true if the file was successfully mapped.
+          */
+      bool open(const char* fn);
+
+         /** Read from an existing block of memory instead of a file,
+          * e.g. part of another mapping.  The memory is not copied
+          * and must remain valid until the buffer is closed.
+          * @param[in] data the first byte of the block.
+          * @param[in] size the number of bytes in the block.
+          */
+      void attach(const char* data, std::size_t size);
+
+         /// Release the mapping.
+      void close();
+
+         /// @return the start of the mapped data.
+      const char* data() const
+      { return mapBase; }
+
+         /// @return true if a file is currently mapped.
+      bool is_open() const
+      { return isOpen; }
+
+         /// @return the size of the mapped file in bytes.
+      std::size_t size() const
+      { return mapSize; }
+
+         /** Get the next line in the mapping without copying it and
+          * advance the get pointer past the line terminator.
+          * @param[out] line points to the first character of the line,
+          *   which is NOT null-terminated.
+          * @param[out] length the number of characters in the line,
+          *   excluding the '\\n' terminator.
+          * @return the number of characters consumed, including the
+          *   terminator if there was one.  A return value of 0
+          *   indicates there was no data left, and a return value
+          *   equal to \a length indicates the line was terminated by
+          *   the end of the file rather than a '\\n'.
+          */
+      std::size_t nextLine(const char*& line, std::size_t& length);
+
+   protected:
+         /// All data is always in the get area, so this is always EOF.
+      virtual int_type underflow();
+
+         /// Report the number of unread characters in the mapping.
+      virtual std::streamsize showmanyc();
+
+         /// Reposition the get pointer, relative to \a way.
+      virtual pos_type seekoff(off_type off, std::ios_base::seekdir way,
+                               std::ios_base::openmode which =
+                               std::ios_base::in | std::ios_base::out);
+
+         /// Reposition the get pointer to an absolute position.
+      virtual pos_type seekpos(pos_type pos,
+                               std::ios_base::openmode which =
+                               std::ios_base::in | std::ios_base::out);
+
+   private:
+         // Copying would result in a double unmap.
+      MappedFileBuf(const MappedFileBuf&);
+      MappedFileBuf& operator=(const MappedFileBuf&);
+
+         /// Start of the mapped region, or nullptr if empty/unmapped.
+      char *mapBase;
+         /// Size of the mapped region in bytes.
+      std::size_t mapSize;
+         /// True if open() succeeded (an empty file is open but unmapped).
+      bool isOpen;
+         /// True if mapBase was mapped by open() and must be unmapped.
+      bool ownsMap;
+   }; // End of class 'MappedFileBuf'
+
+      //@}
+
+}  // End of namespace gpstk
+
+#endif   // GPSTK_MAPPEDFILEBUF_HPP
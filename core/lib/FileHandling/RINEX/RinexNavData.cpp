@@ -328,9 +328,9 @@ namespace gpstk
          time = CivilTime(yr,mo,day,hr,min,sec,gpstk::TimeSystem::GPS).convertToCommonTime();
          if(ds != 0) time += ds;
 
-         af0 = currentLine.substr(22,19);
-         af1 = currentLine.substr(41,19);
-         af2 = currentLine.substr(60,19);
+         af0.assign(currentLine, 22);
+         af1.assign(currentLine, 41);
+         af2.assign(currentLine, 60);
       }
       catch (std::exception &e)
       {
@@ -344,10 +344,10 @@ namespace gpstk
    {
       try
       {
-         IODE = currentLine.substr(3,19);
-         Crs = currentLine.substr(22,19);
-         dn = currentLine.substr(41,19);
-         M0 = currentLine.substr(60,19);
+         IODE.assign(currentLine, 3);
+         Crs.assign(currentLine, 22);
+         dn.assign(currentLine, 41);
+         M0.assign(currentLine, 60);
       }
       catch (std::exception &e)
       {
@@ -361,10 +361,10 @@ namespace gpstk
    {
       try
       {
-         Cuc = currentLine.substr(3,19);
-         ecc = currentLine.substr(22,19);
-         Cus = currentLine.substr(41,19);
-         Ahalf = currentLine.substr(60,19);
+         Cuc.assign(currentLine, 3);
+         ecc.assign(currentLine, 22);
+         Cus.assign(currentLine, 41);
+         Ahalf.assign(currentLine, 60);
       }
       catch (std::exception &e)
       {
@@ -378,10 +378,10 @@ namespace gpstk
    {
       try
       {
-         Toe = currentLine.substr(3,19);
-         Cic = currentLine.substr(22,19);
-         OMEGA0 = currentLine.substr(41,19);
-         Cis = currentLine.substr(60,19);
+         Toe.assign(currentLine, 3);
+         Cic.assign(currentLine, 22);
+         OMEGA0.assign(currentLine, 41);
+         Cis.assign(currentLine, 60);
       }
       catch (std::exception &e)
       {
@@ -395,10 +395,10 @@ namespace gpstk
    {
       try
       {
-         i0 = currentLine.substr(3,19);
-         Crc = currentLine.substr(22,19);
-         w = currentLine.substr(41,19);
-         OMEGAdot = currentLine.substr(60,19);
+         i0.assign(currentLine, 3);
+         Crc.assign(currentLine, 22);
+         w.assign(currentLine, 41);
+         OMEGAdot.assign(currentLine, 60);
       }
       catch (std::exception &e)
       {
@@ -414,10 +414,10 @@ namespace gpstk
       {
          RNDouble codeL2(0), L2P(0), toe_wn(0);
 
-         idot = currentLine.substr(3,19);
-         codeL2 = currentLine.substr(22,19);
-         toe_wn = currentLine.substr(41,19);
-         L2P = currentLine.substr(60,19);
+         idot.assign(currentLine, 3);
+         codeL2.assign(currentLine, 22);
+         toe_wn.assign(currentLine, 41);
+         L2P.assign(currentLine, 60);
 
          codeflgs = (short) codeL2;
          L2Pdata = (short) L2P;
@@ -437,10 +437,10 @@ namespace gpstk
       {
          RNDouble SV_health(0);
 
-         accuracy = currentLine.substr(3,19);
-         SV_health = currentLine.substr(22,19);
-         Tgd = currentLine.substr(41,19);
-         IODC = currentLine.substr(60,19);
+         accuracy.assign(currentLine, 3);
+         SV_health.assign(currentLine, 22);
+         Tgd.assign(currentLine, 41);
+         IODC.assign(currentLine, 60);
 
 
          health = (short) SV_health;
@@ -459,14 +459,14 @@ namespace gpstk
       {
          RNDouble HOW_sec(0);
 
-         HOW_sec = currentLine.substr(3,19);
+         HOW_sec.assign(currentLine, 3);
             // leave it alone so round-trips are possible
             // (even though we're storing a double as a long, which
             //could lead to failures in round-trip testing, though if
             //that happens your transmit time is messed).
             //setXmitTime(HOW_sec);
          sf1XmitTime = HOW_sec;
-         fitint = currentLine.substr(22,19);
+         fitint.assign(currentLine, 22);
       }
       catch (std::exception &e)
       {
@@ -321,9 +321,10 @@ namespace gpstk
 
                line.resize(80, ' ');
 
-               obs[sat][obs_type].data = asDouble(line.substr(line_ndx*16,   14));
-               obs[sat][obs_type].lli = asInt(    line.substr(line_ndx*16+14, 1));
-               obs[sat][obs_type].ssi = asInt(    line.substr(line_ndx*16+15, 1));
+               const char *field = line.data() + line_ndx*16;
+               obs[sat][obs_type].data = asDouble(field,    14);
+               obs[sat][obs_type].lli = asInt(    field+14, 1);
+               obs[sat][obs_type].ssi = asInt(    field+15, 1);
             }
          }
       }
@@ -42,6 +42,7 @@
  */
 
 #include "RinexObsStream.hpp"
+#include "HatanakaBuf.hpp"
 
 namespace gpstk
 {
@@ -58,6 +59,7 @@ namespace gpstk
          : FFTextStream(fn, mode)
    {
       init();
+      initFilters(mode);
    }
 
 
@@ -67,6 +69,7 @@ namespace gpstk
          : FFTextStream(fn.c_str(), mode)
    {
       init();
+      initFilters(mode);
    }
 
 
@@ -81,6 +84,7 @@ namespace gpstk
               std::ios::openmode mode )
    {
       FFTextStream::open(fn, mode);
+      initFilters(mode);
       init();
    }
 
@@ -116,4 +120,19 @@ namespace gpstk
       header = RinexObsHeader();
    }
 
+
+   void RinexObsStream ::
+   initFilters(std::ios::openmode mode)
+   {
+      if (!is_open() || (mode & std::ios::out))
+         return;
+         // A compressed file may also be Compact RINEX, which can't be
+         // checked for until it is being decompressed.  HatanakaBuf
+         // passes plain RINEX through unchanged.
+      if (decompress() || HatanakaBuf::isCRINEX(readBuffer()))
+      {
+         addInputFilter(new HatanakaBuf(readBuffer()));
+      }
+   }
+
 }  // End of namespace gpstk
@@ -61,6 +61,11 @@ namespace gpstk
       /**
        * This class reads RINEX files.
        *
+       * Files opened for input only may be compressed with gzip or
+       * Unix compress and/or Hatanaka compressed (Compact RINEX),
+       * in which case they are decompressed as they are read,
+       * without being expanded to disk.  Such streams can't seek.
+       *
        * @sa gpstk::RinexObsData and gpstk::RinexObsHeader.
        * @sa rinex_obs_test.cpp and rinex_obs_read_write.cpp for examples.
        */
@@ -116,6 +121,9 @@ namespace gpstk
 
    private:
       void init();
+
+         /// Add input filters for compressed or Compact RINEX files.
+      void initFilters(std::ios::openmode mode);
    }; // End of class 'RinexObsStream'
 
       //@}
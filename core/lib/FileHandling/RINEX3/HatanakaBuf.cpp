@@ -0,0 +1,536 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+
+/**
+ * @file HatanakaBuf.cpp
+ * A read-only std::streambuf that expands Compact RINEX (Hatanaka
+ * compressed) observation data on the fly.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "HatanakaBuf.hpp"
+#include "FFStreamError.hpp"
+#include "StringUtils.hpp"
+
+namespace gpstk
+{
+      /// Size of the buffer used to read from the source.
+   static const std::size_t readSize = 65536;
+
+      /// Restore at least this much data per underflow() if possible.
+   static const std::size_t minOutput = 65536;
+
+      /// @return true if \a line has the header label \a label.
+   static bool hasLabel(const std::string& line, const char* label)
+   {
+      std::size_t len = std::strlen(label);
+      return ((line.size() >= 60 + len) &&
+              (line.compare(60, len, label) == 0));
+   }
+
+
+   bool HatanakaBuf ::
+   isCRINEX(std::streambuf* src)
+   {
+      pos_type start = src->pubseekoff(0, std::ios_base::cur,
+                                       std::ios_base::in);
+      if (start == pos_type(off_type(-1)))
+         return false;
+      char buf[81];
+      std::streamsize n = src->sgetn(buf, 80);
+      if (src->pubseekpos(start, std::ios_base::in) != start)
+         return false;
+      std::string first(buf, n > 0 ? n : 0);
+      return hasLabel(first, "CRINEX VERS   / TYPE");
+   }
+
+
+   HatanakaBuf ::
+   HatanakaBuf(std::streambuf* src)
+         : source(src), inBuf(readSize), inPos(0), inEnd(0),
+           inputDone(false), outOffset(0), headerDone(false),
+           compact(false), crxVersion(0), numTypes(0), epochCount(0)
+   {
+      std::fill(sysNumTypes, sysNumTypes+128, 0);
+   }
+
+
+   HatanakaBuf::int_type HatanakaBuf ::
+   underflow()
+   {
+      if (gptr() < egptr())
+         return traits_type::to_int_type(*gptr());
+      outOffset += egptr() - eback();
+      outBuf.clear();
+      if (!headerDone)
+      {
+         readHeader();
+      }
+      else if (compact)
+      {
+         while ((outBuf.size() < minOutput) && readEpoch())
+            ;
+      }
+      else if (inPos < inEnd)
+      {
+         outBuf.assign(&inBuf[inPos], inEnd - inPos);
+         inPos = inEnd;
+      }
+      else if (!inputDone)
+      {
+         std::streamsize n = source->sgetn(&inBuf[0], inBuf.size());
+         if (n > 0)
+            outBuf.assign(&inBuf[0], n);
+         else
+            inputDone = true;
+      }
+      char *base = &outBuf[0];
+      setg(base, base, base + outBuf.size());
+      if (outBuf.empty())
+         return traits_type::eof();
+      return traits_type::to_int_type(*base);
+   }
+
+
+   HatanakaBuf::pos_type HatanakaBuf ::
+   seekoff(off_type off, std::ios_base::seekdir way,
+           std::ios_base::openmode which)
+   {
+      if ((off != 0) || (way != std::ios_base::cur) ||
+          !(which & std::ios_base::in))
+      {
+         return pos_type(off_type(-1));
+      }
+      return pos_type(outOffset + (gptr() - eback()));
+   }
+
+
+   bool HatanakaBuf ::
+   getLine(std::string& text)
+   {
+      text.clear();
+      bool gotData = false;
+      while (true)
+      {
+         if (inPos == inEnd)
+         {
+            if (inputDone)
+               break;
+            std::streamsize n = source->sgetn(&inBuf[0], inBuf.size());
+            inPos = 0;
+            inEnd = (n > 0 ? n : 0);
+            if (inEnd == 0)
+            {
+               inputDone = true;
+               break;
+            }
+         }
+         gotData = true;
+         const char *start = &inBuf[inPos];
+         const char *nl = static_cast<const char*>(
+            std::memchr(start, '\n', inEnd - inPos));
+         if (nl != nullptr)
+         {
+            text.append(start, nl - start);
+            inPos += nl - start + 1;
+            break;
+         }
+         text.append(start, inEnd - inPos);
+         inPos = inEnd;
+      }
+      while (!text.empty() && (text[text.size()-1] == '\r'))
+         text.resize(text.size()-1);
+      return gotData;
+   }
+
+
+   void HatanakaBuf ::
+   readHeader()
+   {
+      headerDone = true;
+      if (!getLine(line))
+         return;
+      compact = hasLabel(line, "CRINEX VERS   / TYPE");
+      if (!compact)
+      {
+         outBuf = line;
+         outBuf += '\n';
+         return;
+      }
+      crxVersion = static_cast<int>(StringUtils::asDouble(line.data(), 20));
+      if ((crxVersion != 1) && (crxVersion != 3))
+      {
+         FFStreamError err("Unsupported Compact RINEX version: " +
+                           StringUtils::strip(line.substr(0, 20)));
+         GPSTK_THROW(err);
+      }
+         // The CRINEX PROG / DATE record, which isn't part of the
+         // RINEX header.
+      if (!getLine(line))
+      {
+         FFStreamError err("Compact RINEX header is incomplete");
+         GPSTK_THROW(err);
+      }
+      while (true)
+      {
+         if (!getLine(line))
+         {
+            FFStreamError err("Compact RINEX header is incomplete");
+            GPSTK_THROW(err);
+         }
+         outBuf += line;
+         outBuf += '\n';
+         if (hasLabel(line, "# / TYPES OF OBSERV") &&
+             (line.compare(0, 6, "      ") != 0))
+         {
+            numTypes = StringUtils::asInt(line.data(), 6);
+         }
+         else if (hasLabel(line, "SYS / # / OBS TYPES") && (line[0] != ' '))
+         {
+            sysNumTypes[line[0] & 0x7f] = StringUtils::asInt(line.data()+3, 3);
+         }
+         else if (hasLabel(line, "END OF HEADER"))
+         {
+            break;
+         }
+      }
+   }
+
+
+   bool HatanakaBuf ::
+   readEpoch()
+   {
+      if (!getLine(line))
+         return false;
+         // Column positions in the Compact RINEX epoch line.
+      const char initChar = (crxVersion == 1 ? '&' : '>');
+      const std::size_t flagCol = (crxVersion == 1 ? 28 : 31);
+      const std::size_t satCol = (crxVersion == 1 ? 32 : 41);
+      const std::size_t timeLen = satCol - 6 * (crxVersion == 3);
+
+      std::string epoch;
+      if (!line.empty() && (line[0] == initChar))
+      {
+         epoch = line;
+         if (crxVersion == 1)
+            epoch[0] = ' ';
+      }
+      else
+      {
+         epoch = epochLine;
+         repair(epoch, line);
+      }
+      int flag = 0;
+      long numSVs = 0;
+      if (epoch.size() > flagCol)
+      {
+         if ((epoch[flagCol] >= '0') && (epoch[flagCol] <= '9'))
+            flag = epoch[flagCol] - '0';
+         std::size_t len = std::min<std::size_t>(3, epoch.size()-flagCol-1);
+         numSVs = StringUtils::asInt(epoch.data()+flagCol+1, len);
+      }
+      if (numSVs < 0)
+         numSVs = 0;
+
+      if (flag > 1)
+      {
+            // Events are stored as they are, and don't take part in
+            // the differencing of the data epochs.
+         outBuf += epoch;
+         endLine();
+         for (long i = 0; i < numSVs; i++)
+         {
+            if (!getLine(line))
+            {
+               FFStreamError err("Compact RINEX event is incomplete");
+               GPSTK_THROW(err);
+            }
+            outBuf += line;
+            endLine();
+         }
+         return true;
+      }
+      epochLine.swap(epoch);
+
+         // The receiver clock offset is on a line of its own.
+      if (!getLine(line))
+      {
+         FFStreamError err("Compact RINEX epoch is incomplete");
+         GPSTK_THROW(err);
+      }
+      bool haveClock = !line.empty();
+      long long clockOffset = 0;
+      if (haveClock)
+         clockOffset = restore(clock, line.data(), line.size());
+      else
+         clock.order = -1;
+      epochCount++;
+
+      std::string sats;
+      if (epochLine.size() > satCol)
+         sats = epochLine.substr(satCol);
+      sats.resize(3 * numSVs, ' ');
+
+      std::string head(epochLine, 0, timeLen);
+      head.resize(timeLen, ' ');
+      if (crxVersion == 3)
+      {
+         outBuf += head;
+         if (haveClock)
+         {
+            outBuf.append(6, ' ');
+            appendFixed(clockOffset, 12, 15);
+         }
+         endLine();
+      }
+      else
+      {
+            // RINEX 2 puts 12 satellites on each line, with the
+            // clock offset at the end of the first.
+         for (long i = 0; (i == 0) || (i < numSVs); i += 12)
+         {
+            if (i == 0)
+               outBuf += head;
+            else
+               outBuf.append(timeLen, ' ');
+            outBuf.append(sats, 3*i, 36);
+            if ((i == 0) && haveClock)
+            {
+               outBuf.append(3 * std::max<long>(0, 12 - numSVs), ' ');
+               appendFixed(clockOffset, 9, 12);
+            }
+            endLine();
+         }
+      }
+      readSatellites(sats);
+      return true;
+   }
+
+
+   void HatanakaBuf ::
+   readSatellites(const std::string& sats)
+   {
+      std::vector<long long> values;
+      std::vector<bool> have;
+      std::string diff;
+      for (std::size_t i = 0; i < sats.size(); i += 3)
+      {
+         std::string sat(sats, i, 3);
+         int ntypes = (crxVersion == 1 ? numTypes : sysNumTypes[sat[0] & 0x7f]);
+         if (ntypes <= 0)
+         {
+            FFStreamError err("No observation types for satellite " + sat);
+            GPSTK_THROW(err);
+         }
+         if (!getLine(line))
+         {
+            FFStreamError err("Compact RINEX epoch is incomplete");
+            GPSTK_THROW(err);
+         }
+            // Only satellites in the previous epoch continue their arcs.
+         SatState& state(satState[sat]);
+         if ((state.arcs.size() != std::size_t(ntypes)) ||
+             (state.lastEpoch + 1 != epochCount))
+         {
+            state.arcs.assign(ntypes, Arc());
+            state.flags.clear();
+         }
+         state.lastEpoch = epochCount;
+
+            // Fields are separated by a single blank and empty
+            // fields are missing data.  The flags follow the last field.
+         values.resize(ntypes);
+         have.assign(ntypes, false);
+         std::size_t pos = 0, len = line.size();
+         for (int k = 0; k < ntypes; k++)
+         {
+            std::size_t end = (pos < len ? line.find(' ', pos) : pos);
+            if (end == std::string::npos)
+               end = len;
+            if (end > pos)
+            {
+               values[k] = restore(state.arcs[k], line.data()+pos, end-pos);
+               have[k] = true;
+            }
+            else
+            {
+               state.arcs[k].order = -1;
+            }
+            pos = end + 1;
+         }
+         diff.clear();
+         if (pos < len)
+            diff.assign(line, pos, std::string::npos);
+         repair(state.flags, diff);
+         if (state.flags.size() < std::size_t(2 * ntypes))
+            state.flags.resize(2 * ntypes, ' ');
+
+         if (crxVersion == 3)
+            outBuf += sat;
+         for (int k = 0; k < ntypes; k++)
+         {
+               // RINEX 2 puts 5 observations on each line.
+            if ((crxVersion == 1) && (k > 0) && ((k % 5) == 0))
+               endLine();
+            if (have[k])
+               appendFixed(values[k], 3, 14);
+            else
+               outBuf.append(14, ' ');
+            outBuf.append(state.flags, 2*k, 2);
+         }
+         endLine();
+      }
+   }
+
+
+   void HatanakaBuf ::
+   repair(std::string& text, const std::string& diff)
+   {
+      if (text.size() < diff.size())
+         text.resize(diff.size(), ' ');
+      for (std::size_t i = 0; i < diff.size(); i++)
+      {
+         if (diff[i] == '&')
+            text[i] = ' ';
+         else if (diff[i] != ' ')
+            text[i] = diff[i];
+      }
+   }
+
+
+   long long HatanakaBuf ::
+   restore(Arc& arc, const char* field, std::size_t length)
+   {
+      bool init = ((length >= 2) && (field[1] == '&'));
+      if (init)
+      {
+         int order = field[0] - '0';
+         if ((order < 0) || (order > maxOrder))
+         {
+            FFStreamError err("Invalid Compact RINEX difference order: " +
+                              std::string(field, length));
+            GPSTK_THROW(err);
+         }
+         arc.order = order;
+         arc.count = 0;
+         field += 2;
+         length -= 2;
+      }
+      else if (arc.order < 0)
+      {
+         FFStreamError err("Compact RINEX data without initialization: " +
+                           std::string(field, length));
+         GPSTK_THROW(err);
+      }
+      else if (arc.count < arc.order)
+      {
+         arc.count++;
+      }
+
+      std::size_t i = 0;
+      bool negative = false;
+      if ((length > 0) && ((field[0] == '-') || (field[0] == '+')))
+      {
+         negative = (field[0] == '-');
+         i++;
+      }
+      if (i == length)
+      {
+         FFStreamError err("Invalid Compact RINEX data: " +
+                           std::string(field, length));
+         GPSTK_THROW(err);
+      }
+      long long value = 0;
+      for ( ; i < length; i++)
+      {
+         if ((field[i] < '0') || (field[i] > '9'))
+         {
+            FFStreamError err("Invalid Compact RINEX data: " +
+                              std::string(field, length));
+            GPSTK_THROW(err);
+         }
+         value = value * 10 + (field[i] - '0');
+      }
+      arc.diff[arc.count] = (negative ? -value : value);
+         // Integrate the differences back to the value.
+      for (int j = arc.count; j > 0; j--)
+      {
+         arc.diff[j-1] += arc.diff[j];
+      }
+      return arc.diff[0];
+   }
+
+
+   void HatanakaBuf ::
+   appendFixed(long long value, unsigned decimals, unsigned width)
+   {
+      char buf[32];
+      char *p = buf + sizeof(buf);
+      unsigned long long mag = (value < 0 ?
+                                0ULL - static_cast<unsigned long long>(value) :
+                                static_cast<unsigned long long>(value));
+      for (unsigned i = 0; i < decimals; i++)
+      {
+         *--p = '0' + (mag % 10);
+         mag /= 10;
+      }
+      *--p = '.';
+      do
+      {
+         *--p = '0' + (mag % 10);
+         mag /= 10;
+      } while (mag > 0);
+      if (value < 0)
+         *--p = '-';
+      std::size_t n = buf + sizeof(buf) - p;
+      if (n < width)
+         outBuf.append(width - n, ' ');
+      outBuf.append(p, n);
+   }
+
+
+   void HatanakaBuf ::
+   endLine()
+   {
+      std::size_t end = outBuf.find_last_not_of(' ');
+      outBuf.resize(end == std::string::npos ? 0 : end + 1);
+      outBuf += '\n';
+   }
+
+}  // End of namespace gpstk
@@ -0,0 +1,208 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+
+/**
+ * @file HatanakaBuf.hpp
+ * A read-only std::streambuf that expands Compact RINEX (Hatanaka
+ * compressed) observation data on the fly.
+ */
+
+#ifndef GPSTK_HATANAKABUF_HPP
+#define GPSTK_HATANAKABUF_HPP
+
+#include <map>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace gpstk
+{
+      /// @ingroup FileHandling
+      //@{
+
+      /**
+       * A std::streambuf that reads Compact RINEX observation data
+       * (as produced by RNX2CRX) from another streambuf and makes
+       * the equivalent RINEX observation data available for reading,
+       * one epoch at a time.  Compact RINEX version 1.0 (RINEX 2)
+       * and 3.0 (RINEX 3) are supported.
+       *
+       * If the first line of the source is not a Compact RINEX
+       * header, the data is passed through unchanged, so this
+       * buffer may be used on top of a decompressed stream whose
+       * contents are not yet known.
+       *
+       * As with CRX2RNX, trailing blanks are removed from the
+       * restored RINEX lines.  Seeking is not supported, however
+       * tellg() returns the offset in the restored data.  Invalid
+       * Compact RINEX data results in an FFStreamError being thrown
+       * by underflow().
+       */
+   class HatanakaBuf : public std::streambuf
+   {
+   public:
+         /** Determine whether \a src contains Compact RINEX data,
+          * leaving \a src positioned where it started.
+          * @param[in] src the buffer to check, which must support
+          *   seeking.
+          * @return true if the first line of \a src is a CRINEX
+          *   VERS / TYPE record.
+          */
+      static bool isCRINEX(std::streambuf* src);
+
+         /** Prepare to read Compact RINEX data from \a src, which is
+          * not owned by this object. */
+      HatanakaBuf(std::streambuf* src);
+
+   protected:
+         /** Restore the next epoch.
+          * @throw FFStreamError if the data is invalid. */
+      virtual int_type underflow();
+
+         /// Only supports reporting the current position.
+      virtual pos_type seekoff(off_type off, std::ios_base::seekdir way,
+                               std::ios_base::openmode which =
+                               std::ios_base::in | std::ios_base::out);
+
+   private:
+         /// Highest difference order supported for an arc.
+      static const int maxOrder = 9;
+
+         /// Differencing state for one data arc.
+      struct Arc
+      {
+         Arc() : order(-1), count(0) {}
+            /// Difference order, -1 if the arc hasn't started.
+         int order;
+            /// Number of differences accumulated so far (up to order).
+         int count;
+            /// The value and its differences.
+         long long diff[maxOrder+1];
+      };
+
+         /// Differencing state for one satellite.
+      struct SatState
+      {
+         SatState() : lastEpoch(0) {}
+            /// One arc per observation type.
+         std::vector<Arc> arcs;
+            /// LLI and SSI flags of the last epoch.
+         std::string flags;
+            /// Number of the last epoch this satellite was in.
+         unsigned long lastEpoch;
+      };
+
+         // Not copyable.
+      HatanakaBuf(const HatanakaBuf&);
+      HatanakaBuf& operator=(const HatanakaBuf&);
+
+         /** Get the next line from the source without any '\\r'.
+          * @return false at the end of the source. */
+      bool getLine(std::string& line);
+
+         /** Read the Compact RINEX and RINEX headers, putting the
+          * RINEX header in outBuf, or pass the first line through
+          * if the source is not Compact RINEX. */
+      void readHeader();
+
+         /** Restore one epoch (or event) into outBuf.
+          * @return false at the end of the source. */
+      bool readEpoch();
+
+         /** Restore the satellite records of an epoch.
+          * @param[in] sats the satellite list from the epoch line. */
+      void readSatellites(const std::string& sats);
+
+         /** Apply the text differences in \a diff to \a text, where
+          * a blank means no change and '&' means a blank. */
+      static void repair(std::string& text, const std::string& diff);
+
+         /** Update \a arc with a field of differenced data, either an
+          * initialization ("n&value") or the next difference.
+          * @return the restored value. */
+      static long long restore(Arc& arc, const char* field,
+                               std::size_t length);
+
+         /** Append \a value / 10^decimals to outBuf, in a field of
+          * \a width characters. */
+      void appendFixed(long long value, unsigned decimals, unsigned width);
+
+         /// Remove trailing blanks from the last line of outBuf and end it.
+      void endLine();
+
+         /// Where the Compact RINEX data comes from.
+      std::streambuf *source;
+         /// Data read from source.
+      std::vector<char> inBuf;
+         /// Index of the first unused byte in inBuf.
+      std::size_t inPos;
+         /// Number of valid bytes in inBuf.
+      std::size_t inEnd;
+         /// Set at the end of the source.
+      bool inputDone;
+         /// Restored data, which is the get area.
+      std::string outBuf;
+         /// Number of restored bytes before the get area.
+      std::streamoff outOffset;
+         /// Set once the header has been read.
+      bool headerDone;
+         /// True if the source is Compact RINEX, false to pass it through.
+      bool compact;
+         /// Compact RINEX major version, 1 or 3.
+      int crxVersion;
+         /// Number of observation types for RINEX 2.
+      int numTypes;
+         /// Number of observation types by system character for RINEX 3.
+      int sysNumTypes[128];
+         /// The most recent data epoch line, in Compact RINEX form.
+      std::string epochLine;
+         /// Receiver clock offset state.
+      Arc clock;
+         /// State for each satellite, keyed by satellite ID.
+      std::map<std::string, SatState> satState;
+         /// Number of data epochs restored so far.
+      unsigned long epochCount;
+         /// Scratch space for lines read from the source.
+      std::string line;
+   }; // End of class 'HatanakaBuf'
+
+      //@}
+
+}  // End of namespace gpstk
+
+#endif   // GPSTK_HATANAKABUF_HPP
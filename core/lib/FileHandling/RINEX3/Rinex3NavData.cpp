@@ -1308,15 +1308,15 @@ namespace gpstk
                // Rinex 2.*
             if (satSys == "G")
             {
-               af0 = line.substr(22,19);
-               af1 = line.substr(41,19);
-               af2 = line.substr(60,19);
+               af0.assign(line, 22);
+               af1.assign(line, 41);
+               af2.assign(line, 60);
             }
             else if (satSys == "R" || satSys == "S")
             {
-               TauN   =      line.substr(22,19);
-               GammaN =      line.substr(41,19);
-               MFtime =      RNDouble(line.substr(60,19));
+               TauN.assign(line, 22);
+               GammaN.assign(line, 41);
+               MFtime = RNDouble(line, 60);
                if (satSys == "R")
                {
                      // make MFtime consistent with R3.02
@@ -1327,15 +1327,15 @@ namespace gpstk
          else if (satSys == "G" || satSys == "E" || satSys == "C" ||
                   satSys == "J")
          {
-            af0 = line.substr(23,19);
-            af1 = line.substr(42,19);
-            af2 = line.substr(61,19);
+            af0.assign(line, 23);
+            af1.assign(line, 42);
+            af2.assign(line, 61);
          }
          else if (satSys == "R" || satSys == "S")
          {
-            TauN   =      line.substr(23,19);
-            GammaN =      line.substr(42,19);
-            MFtime =      RNDouble(line.substr(61,19));
+            TauN.assign(line, 23);
+            GammaN.assign(line, 42);
+            MFtime = RNDouble(line, 61);
          }
       }
       catch (std::exception &e)
@@ -1364,24 +1364,24 @@ namespace gpstk
          {
             if (satSys == "G" || satSys == "J" || satSys == "C")
             {
-               IODE = line.substr(n,19); n+=19;
-               Crs  = line.substr(n,19); n+=19;
-               dn   = line.substr(n,19); n+=19;
-               M0   = line.substr(n,19);
+               IODE.assign(line, n); n+=19;
+               Crs.assign(line, n); n+=19;
+               dn.assign(line, n); n+=19;
+               M0.assign(line, n);
             }
             else if (satSys == "E")
             {
-               IODnav = line.substr(n,19); n+=19;
-               Crs    = line.substr(n,19); n+=19;
-               dn     = line.substr(n,19); n+=19;
-               M0     = line.substr(n,19);
+               IODnav.assign(line, n); n+=19;
+               Crs.assign(line, n); n+=19;
+               dn.assign(line, n); n+=19;
+               M0.assign(line, n);
             }
             else if (satSys == "R" || satSys == "S")
             {
-               px     =        line.substr(n,19); n+=19;
-               vx     =        line.substr(n,19); n+=19;
-               ax     =        line.substr(n,19); n+=19;
-               health =        RNDouble(line.substr(n,19));
+               px.assign(line, n); n+=19;
+               vx.assign(line, n); n+=19;
+               ax.assign(line, n); n+=19;
+               health = RNDouble(line, n);
             }
          }
 
@@ -1390,23 +1390,23 @@ namespace gpstk
             if (satSys == "G" || satSys == "E" || satSys == "J" ||
                 satSys == "C")
             {
-               Cuc   = line.substr(n,19); n+=19;
-               ecc   = line.substr(n,19); n+=19;
-               Cus   = line.substr(n,19); n+=19;
-               Ahalf = line.substr(n,19);
+               Cuc.assign(line, n); n+=19;
+               ecc.assign(line, n); n+=19;
+               Cus.assign(line, n); n+=19;
+               Ahalf.assign(line, n);
             }
             else if (satSys == "R" || satSys == "S")
             {
-               py      =        line.substr(n,19); n+=19;
-               vy      =        line.substr(n,19); n+=19;
-               ay      =        line.substr(n,19); n+=19;
+               py.assign(line, n); n+=19;
+               vy.assign(line, n); n+=19;
+               ay.assign(line, n); n+=19;
                if (satSys == "R")
                {
-                  freqNum = RNDouble(line.substr(n,19));
+                  freqNum = RNDouble(line, n);
                }
                else                       // GEO
                {
-                  accCode = line.substr(n,19);
+                  accCode.assign(line, n);
                }
             }
          }
@@ -1416,49 +1416,49 @@ namespace gpstk
             if (satSys == "G" || satSys == "E" || satSys == "J" ||
                 satSys == "C")
             {
-               Toe    = line.substr(n,19); n+=19;
-               Cic    = line.substr(n,19); n+=19;
-               OMEGA0 = line.substr(n,19); n+=19;
-               Cis    = line.substr(n,19);
+               Toe.assign(line, n); n+=19;
+               Cic.assign(line, n); n+=19;
+               OMEGA0.assign(line, n); n+=19;
+               Cis.assign(line, n);
             }
             else if (satSys == "R" || satSys == "S")
             {
-               pz        = line.substr(n,19); n+=19;
-               vz        = line.substr(n,19); n+=19;
-               az        = line.substr(n,19); n+=19;
+               pz.assign(line, n); n+=19;
+               vz.assign(line, n); n+=19;
+               az.assign(line, n); n+=19;
                if (satSys == "R")
                {
-                  ageOfInfo = line.substr(n,19);
+                  ageOfInfo.assign(line, n);
                }
                else                       // GEO
                {
-                  IODN = line.substr(n,19);
+                  IODN.assign(line, n);
                }
             }
          }
 
          else if (nline == 4)
          {
-            i0       = line.substr(n,19); n+=19;
-            Crc      = line.substr(n,19); n+=19;
-            w        = line.substr(n,19); n+=19;
-            OMEGAdot = line.substr(n,19);
+            i0.assign(line, n); n+=19;
+            Crc.assign(line, n); n+=19;
+            w.assign(line, n); n+=19;
+            OMEGAdot.assign(line, n);
          }
 
          else if (nline == 5)
          {
             if (satSys == "G" || satSys == "J" || satSys == "C")
             {
-               idot     =        line.substr(n,19); n+=19;
-               codeflgs = RNDouble(line.substr(n,19)); n+=19;
-               weeknum  = RNDouble(line.substr(n,19)); n+=19;
-               L2Pdata  = RNDouble(line.substr(n,19));
+               idot.assign(line, n); n+=19;
+               codeflgs = RNDouble(line, n); n+=19;
+               weeknum  = RNDouble(line, n); n+=19;
+               L2Pdata  = RNDouble(line, n);
             }
             else if (satSys == "E")
             {
-               idot        =       line.substr(n,19); n+=19;
-               datasources =RNDouble(line.substr(n,19)); n+=19;
-               weeknum     =RNDouble(line.substr(n,19)); n+=19;
+               idot.assign(line, n); n+=19;
+               datasources =RNDouble(line, n); n+=19;
+               weeknum     =RNDouble(line, n); n+=19;
             }
          }
 
@@ -1467,37 +1467,37 @@ namespace gpstk
             Tgd2 = 0.0;
             if (satSys == "G" || satSys == "J")
             {
-               accuracy =       line.substr(n,19); n+=19;
-               health   = RNDouble(line.substr(n,19)); n+=19;
-               Tgd      =       line.substr(n,19); n+=19;
-               IODC     =       line.substr(n,19);
+               accuracy.assign(line, n); n+=19;
+               health   = RNDouble(line, n); n+=19;
+               Tgd.assign(line, n); n+=19;
+               IODC.assign(line, n);
             }
             else if (satSys == "E")
             {
-               accuracy =       line.substr(n,19); n+=19;
-               health   = RNDouble(line.substr(n,19)); n+=19;
-               Tgd      =       line.substr(n,19); n+=19;
-               Tgd2     =       line.substr(n,19);
+               accuracy.assign(line, n); n+=19;
+               health   = RNDouble(line, n); n+=19;
+               Tgd.assign(line, n); n+=19;
+               Tgd2.assign(line, n);
             }
             else if (satSys == "C")
             {
-               accuracy =       line.substr(n,19); n+=19;
-               health   = RNDouble(line.substr(n,19)); n+=19;
-               Tgd      =       line.substr(n,19); n+=19;
-               Tgd2     =       line.substr(n,19);
+               accuracy.assign(line, n); n+=19;
+               health   = RNDouble(line, n); n+=19;
+               Tgd.assign(line, n); n+=19;
+               Tgd2.assign(line, n);
             }
          }
 
          else if (nline == 7)
          {
-            xmitTime = RNDouble(line.substr(n,19)); n+=19;
+            xmitTime = RNDouble(line, n); n+=19;
             if (satSys == "C")
             {
-               IODC    =        line.substr(n,19); n+=19;
+               IODC.assign(line, n); n+=19;
             }
             else
             {
-               fitint  =        line.substr(n,19); n+=19;
+               fitint.assign(line, n); n+=19;
             }
    
             // Some RINEX files have xmitTime < 0.
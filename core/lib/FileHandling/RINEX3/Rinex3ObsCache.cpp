@@ -0,0 +1,525 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+
+/**
+ * @file Rinex3ObsCache.cpp
+ * Binary cache files holding the parsed contents of RINEX observation files.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#ifndef WIN32
+#include <sys/stat.h>
+#endif
+
+#include "Rinex3ObsCache.hpp"
+#include "Rinex3ObsData.hpp"
+#include "Rinex3ObsStream.hpp"
+#include "FFStreamError.hpp"
+#include "StringUtils.hpp"
+
+namespace gpstk
+{
+      // The cache file starts with a fixed size preamble:
+      //   magic "GPSTKR3C", format version, byte order mark,
+      //   source size, mtime and hash,
+      //   offset and size of the records,
+      //   offset and size of the text, and size of the header text.
+      // The records and the text follow, in that order.  Numbers
+      // are in the byte order of the machine that wrote the cache.
+   static const char cacheMagic[8] = { 'G','P','S','T','K','R','3','C' };
+   static const std::uint32_t byteOrderMark = 0x01020304;
+   static const std::size_t preambleSize = 80;
+
+      // Records are written to the file in blocks of about this size.
+   static const std::size_t flushSize = 1048576;
+
+      // Record types.
+   static const std::uint8_t obsRecord = 0;
+   static const std::uint8_t auxRecord = 1;
+
+      // Bits of the blank flags of a datum.
+   static const std::uint8_t dataBlankBit = 1;
+   static const std::uint8_t lliBlankBit = 2;
+   static const std::uint8_t ssiBlankBit = 4;
+
+   const char *Rinex3ObsCache::suffix = ".r3cache";
+   const std::uint32_t Rinex3ObsCache::formatVersion = 1;
+
+
+      /// Append the bytes of \a val to \a buf.
+   template <class T>
+   static void put(std::vector<char>& buf, T val)
+   {
+      std::size_t size = buf.size();
+      buf.resize(size + sizeof(T));
+      std::memcpy(&buf[size], &val, sizeof(T));
+   }
+
+      /// Get a T from \a p, which may be unaligned, and advance \a p.
+   template <class T>
+   static T get(const char*& p)
+   {
+      T val;
+      std::memcpy(&val, p, sizeof(T));
+      p += sizeof(T);
+      return val;
+   }
+
+      /// Throw unless there are \a n bytes left between \a p and \a end.
+   static void need(const char* p, std::size_t n, const char* end)
+   {
+      if (static_cast<std::size_t>(end - p) < n)
+      {
+         FFStreamError err("Corrupt RINEX observation cache");
+         GPSTK_THROW(err);
+      }
+   }
+
+      /** A 64-bit FNV-1a hash, taken a word at a time, which is
+       * several times faster than a byte at a time.  Any one
+       * changed byte still changes the hash. */
+   static std::uint64_t hashData(const char* data, std::size_t size)
+   {
+      const std::uint64_t prime = 1099511628211ULL;
+      std::uint64_t hash = 14695981039346656037ULL;
+      std::size_t i = 0;
+      for (; i + 8 <= size; i += 8)
+      {
+         std::uint64_t word;
+         std::memcpy(&word, data + i, 8);
+         hash = (hash ^ word) * prime;
+      }
+      for (; i < size; i++)
+      {
+         hash = (hash ^ static_cast<unsigned char>(data[i])) * prime;
+      }
+      return hash;
+   }
+
+
+   std::string Rinex3ObsCache ::
+   cacheName(const std::string& fn)
+   {
+      return fn + suffix;
+   }
+
+
+   bool Rinex3ObsCache ::
+   statFile(const std::string& fn, Source& src)
+   {
+#ifdef WIN32
+         // Caches depend on mmap(), see MappedFileBuf.
+      return false;
+#else
+      struct stat sb;
+      if ((::stat(fn.c_str(), &sb) != 0) || !S_ISREG(sb.st_mode))
+         return false;
+      src.size = sb.st_size;
+      src.mtime = sb.st_mtime;
+      src.hash = 0;
+      return true;
+#endif
+   }
+
+
+   bool Rinex3ObsCache ::
+   identify(const std::string& fn, Source& src)
+   {
+      if (!statFile(fn, src))
+         return false;
+      MappedFileBuf srcMap;
+      if (!srcMap.open(fn.c_str()) || (srcMap.size() != src.size))
+         return false;
+      src.hash = hashData(srcMap.data(), srcMap.size());
+      return true;
+   }
+
+
+   Rinex3ObsCache ::
+   Rinex3ObsCache()
+         : records(nullptr), next(nullptr), recordsEnd(nullptr),
+           text(nullptr), textLen(0), headerLen(0)
+   {
+   }
+
+
+   bool Rinex3ObsCache ::
+   open(const std::string& fn)
+   {
+      close();
+      Source src;
+      if (!statFile(fn, src) || !cacheMap.open(cacheName(fn).c_str()))
+         return false;
+
+      const char *p = cacheMap.data();
+      const std::size_t size = cacheMap.size();
+      if ((size < preambleSize) ||
+          (std::memcmp(p, cacheMagic, sizeof(cacheMagic)) != 0))
+      {
+         close();
+         return false;
+      }
+      p += sizeof(cacheMagic);
+      std::uint32_t version = get<std::uint32_t>(p);
+      std::uint32_t bom = get<std::uint32_t>(p);
+      Source cached;
+      cached.size = get<std::uint64_t>(p);
+      cached.mtime = get<std::int64_t>(p);
+      cached.hash = get<std::uint64_t>(p);
+      std::uint64_t recOffset = get<std::uint64_t>(p);
+      std::uint64_t recSize = get<std::uint64_t>(p);
+      std::uint64_t textOffset = get<std::uint64_t>(p);
+      std::uint64_t textSize = get<std::uint64_t>(p);
+      std::uint64_t hdrSize = get<std::uint64_t>(p);
+
+         // Check the cheap things before hashing the source.
+      if ((version != formatVersion) || (bom != byteOrderMark) ||
+          (cached.size != src.size) || (cached.mtime != src.mtime) ||
+          (recOffset > size) || (recSize > size - recOffset) ||
+          (textOffset > size) || (textSize > size - textOffset) ||
+          (hdrSize > textSize) ||
+          !identify(fn, src) || (cached.hash != src.hash))
+      {
+         close();
+         return false;
+      }
+
+      records = next = cacheMap.data() + recOffset;
+      recordsEnd = next + recSize;
+      text = cacheMap.data() + textOffset;
+      textLen = textSize;
+      headerLen = hdrSize;
+      return true;
+   }
+
+
+   void Rinex3ObsCache ::
+   close()
+   {
+      cacheMap.close();
+      records = next = recordsEnd = text = nullptr;
+      textLen = headerLen = 0;
+   }
+
+
+   bool Rinex3ObsCache ::
+   getRecord(Rinex3ObsData& rod)
+   {
+      if (!is_open() || (next == recordsEnd))
+         return false;
+
+      const char *p = next;
+      need(p, 27, recordsEnd);
+      std::uint8_t type = get<std::uint8_t>(p);
+      rod.epochFlag = get<std::int8_t>(p);
+      rod.numSVs = get<std::int16_t>(p);
+      long day = get<std::int32_t>(p);
+      long msod = get<std::int32_t>(p);
+      double fsod = get<double>(p);
+      TimeSystem ts = static_cast<TimeSystem>(get<std::int8_t>(p));
+      rod.time.setInternal(day, msod, fsod, ts);
+      rod.clockOffset = get<double>(p);
+      rod.auxHeader.clear();
+
+      if (type == auxRecord)
+      {
+            // The text is the epoch line followed by header records.
+         need(p, 16, recordsEnd);
+         std::uint64_t offset = get<std::uint64_t>(p);
+         std::uint64_t length = get<std::uint64_t>(p);
+         if ((offset > textLen) || (length > textLen - offset))
+         {
+            FFStreamError err("Corrupt RINEX observation cache");
+            GPSTK_THROW(err);
+         }
+         rod.obs.clear();
+         const char *line = text + offset;
+         const char *textEnd = line + length;
+         line = std::find(line, textEnd, '\n');
+         for (int i = 0; (i < rod.numSVs) && (line < textEnd); i++)
+         {
+            line++;
+            const char *eol = std::find(line, textEnd, '\n');
+            std::string hdrLine(line, eol);
+            StringUtils::stripTrailing(hdrLine, '\r');
+            StringUtils::stripTrailing(hdrLine);
+            rod.auxHeader.parseHeaderRecord(hdrLine);
+            line = eol;
+         }
+      }
+      else if (type == obsRecord)
+      {
+         need(p, 2, recordsEnd);
+         unsigned numSats = get<std::uint16_t>(p);
+            // Satellites are stored in map order, so walk the
+            // existing map alongside them, reusing its entries.
+         Rinex3ObsData::DataMap::iterator oi = rod.obs.begin();
+         for (unsigned isv = 0; isv < numSats; isv++)
+         {
+            need(p, 5, recordsEnd);
+            SatelliteSystem sys =
+               static_cast<SatelliteSystem>(get<std::int8_t>(p));
+            int id = get<std::int16_t>(p);
+            unsigned numObs = get<std::uint16_t>(p);
+            need(p, 10 * numObs, recordsEnd);
+            RinexSatID sat(id, sys);
+            while ((oi != rod.obs.end()) && (oi->first < sat))
+            {
+               rod.obs.erase(oi++);
+            }
+            if ((oi == rod.obs.end()) || (sat < oi->first))
+            {
+               oi = rod.obs.insert(oi, std::make_pair(
+                                      sat, std::vector<RinexDatum>()));
+            }
+            std::vector<RinexDatum>& data = oi->second;
+            data.resize(numObs);
+            for (unsigned i = 0; i < numObs; i++)
+            {
+               RinexDatum& rd = data[i];
+               rd.data = get<double>(p);
+               std::uint8_t flags = get<std::uint8_t>(p);
+               std::uint8_t blanks = get<std::uint8_t>(p);
+               rd.lli = flags & 0x0F;
+               rd.ssi = flags >> 4;
+               rd.dataBlank = (blanks & dataBlankBit) != 0;
+               rd.lliBlank = (blanks & lliBlankBit) != 0;
+               rd.ssiBlank = (blanks & ssiBlankBit) != 0;
+            }
+            ++oi;
+         }
+         rod.obs.erase(oi, rod.obs.end());
+      }
+      else
+      {
+         FFStreamError err("Corrupt RINEX observation cache");
+         GPSTK_THROW(err);
+      }
+
+      next = p;
+      return true;
+   }
+
+
+   bool Rinex3ObsCache ::
+   seek(std::size_t offset)
+   {
+      if (!is_open() || (offset > std::size_t(recordsEnd - records)))
+         return false;
+      next = records + offset;
+      return true;
+   }
+
+
+   Rinex3ObsCacheWriter ::
+   Rinex3ObsCacheWriter(const std::string& fn)
+         : sourceName(fn),
+           tmpName(Rinex3ObsCache::cacheName(fn) + ".tmp"),
+           recordsSize(0), textSize(0), done(false)
+   {
+      startSource.size = startSource.hash = 0;
+      startSource.mtime = 0;
+      if (!Rinex3ObsCache::statFile(fn, startSource))
+         return;
+      tmpFile.open(tmpName.c_str(), std::ios::out | std::ios::binary |
+                   std::ios::trunc);
+      buffer.reserve(flushSize + 65536);
+         // Leave room for the preamble, which is written last.
+      std::vector<char> preamble(preambleSize, 0);
+      tmpFile.write(preamble.data(), preamble.size());
+   }
+
+
+   Rinex3ObsCacheWriter ::
+   ~Rinex3ObsCacheWriter()
+   {
+      if (!done)
+      {
+         if (tmpFile.is_open())
+            tmpFile.close();
+         std::remove(tmpName.c_str());
+      }
+   }
+
+
+   void Rinex3ObsCacheWriter ::
+   addHeader(std::streamoff end)
+   {
+      if (!textRanges.empty())
+         return;
+      TextRange range = { 0, end };
+      textRanges.push_back(range);
+      textSize = end;
+   }
+
+
+   void Rinex3ObsCacheWriter ::
+   addRecord(const Rinex3ObsData& rod, std::streamoff start,
+             std::streamoff end)
+   {
+      long day, msod;
+      double fsod;
+      TimeSystem ts;
+      rod.time.getInternal(day, msod, fsod, ts);
+      bool isEvent = ((rod.epochFlag != 0) && (rod.epochFlag != 1) &&
+                      (rod.epochFlag != 6));
+
+      put<std::uint8_t>(buffer, isEvent ? auxRecord : obsRecord);
+      put<std::int8_t>(buffer, rod.epochFlag);
+      put<std::int16_t>(buffer, rod.numSVs);
+      put<std::int32_t>(buffer, day);
+      put<std::int32_t>(buffer, msod);
+      put<double>(buffer, fsod);
+      put<std::int8_t>(buffer, static_cast<std::int8_t>(ts));
+      put<double>(buffer, rod.clockOffset);
+
+      if (isEvent)
+      {
+            // Reading a record may read the header first.
+         if (!textRanges.empty() && (start < textRanges[0].end))
+            start = textRanges[0].end;
+         TextRange range = { start, end };
+         textRanges.push_back(range);
+         put<std::uint64_t>(buffer, textSize);
+         put<std::uint64_t>(buffer, end - start);
+         textSize += end - start;
+      }
+      else
+      {
+         put<std::uint16_t>(buffer, rod.obs.size());
+         Rinex3ObsData::DataMap::const_iterator oi;
+         for (oi = rod.obs.begin(); oi != rod.obs.end(); oi++)
+         {
+            put<std::int8_t>(buffer, static_cast<std::int8_t>(oi->first.system));
+            put<std::int16_t>(buffer, oi->first.id);
+            put<std::uint16_t>(buffer, oi->second.size());
+               // Each datum is the data, LLI and SSI packed into
+               // one byte, and the blank flags.
+            std::size_t pos = buffer.size();
+            buffer.resize(pos + 10 * oi->second.size());
+            char *p = &buffer[pos];
+            for (std::size_t i = 0; i < oi->second.size(); i++, p += 10)
+            {
+               const RinexDatum& rd = oi->second[i];
+               std::memcpy(p, &rd.data, 8);
+               p[8] = (rd.lli & 0x0F) | ((rd.ssi & 0x0F) << 4);
+               p[9] = ((rd.dataBlank ? dataBlankBit : 0) |
+                       (rd.lliBlank ? lliBlankBit : 0) |
+                       (rd.ssiBlank ? ssiBlankBit : 0));
+            }
+         }
+      }
+
+      if (buffer.size() >= flushSize)
+         flush();
+   }
+
+
+   void Rinex3ObsCacheWriter ::
+   flush()
+   {
+      tmpFile.write(buffer.data(), buffer.size());
+      recordsSize += buffer.size();
+      buffer.clear();
+   }
+
+
+   bool Rinex3ObsCacheWriter ::
+   finish()
+   {
+      flush();
+      if (!tmpFile.good() || textRanges.empty())
+         return false;
+
+         // Make sure the source didn't change while it was read.
+      Rinex3ObsCache::Source src;
+      if (!Rinex3ObsCache::identify(sourceName, src) ||
+          (src.size != startSource.size) || (src.mtime != startSource.mtime))
+      {
+         return false;
+      }
+
+         // Read the source again for the header and event text.
+      Rinex3ObsStream strm;
+      strm.useCache(false);
+      strm.open(sourceName.c_str(), std::ios::in);
+      if (!strm.is_open())
+         return false;
+      std::streamoff pos = 0;
+      std::vector<char> buf;
+      for (std::size_t i = 0; i < textRanges.size(); i++)
+      {
+         const TextRange& range = textRanges[i];
+         if (range.start > pos)
+            strm.ignore(range.start - pos);
+         buf.resize(range.end - range.start);
+         strm.read(buf.data(), buf.size());
+         if (!strm || (strm.gcount() != std::streamsize(buf.size())))
+            return false;
+         tmpFile.write(buf.data(), buf.size());
+         pos = range.end;
+      }
+
+         // Write the preamble.
+      std::vector<char> preamble(cacheMagic, cacheMagic + sizeof(cacheMagic));
+      put<std::uint32_t>(preamble, Rinex3ObsCache::formatVersion);
+      put<std::uint32_t>(preamble, byteOrderMark);
+      put<std::uint64_t>(preamble, src.size);
+      put<std::int64_t>(preamble, src.mtime);
+      put<std::uint64_t>(preamble, src.hash);
+      put<std::uint64_t>(preamble, preambleSize);
+      put<std::uint64_t>(preamble, recordsSize);
+      put<std::uint64_t>(preamble, preambleSize + recordsSize);
+      put<std::uint64_t>(preamble, textSize);
+      put<std::uint64_t>(preamble, textRanges[0].end);
+      tmpFile.seekp(0);
+      tmpFile.write(preamble.data(), preamble.size());
+      tmpFile.close();
+      if (tmpFile.fail())
+         return false;
+
+      std::string cacheName = Rinex3ObsCache::cacheName(sourceName);
+      if (std::rename(tmpName.c_str(), cacheName.c_str()) != 0)
+         return false;
+      done = true;
+      return true;
+   }
+
+}  // End of namespace gpstk
@@ -0,0 +1,252 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+
+/**
+ * @file Rinex3ObsCache.hpp
+ * Binary cache files holding the parsed contents of RINEX observation files.
+ */
+
+#ifndef GPSTK_RINEX3OBSCACHE_HPP
+#define GPSTK_RINEX3OBSCACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <ios>
+#include <string>
+#include <vector>
+#include "MappedFileBuf.hpp"
+
+namespace gpstk
+{
+      /// @ingroup FileHandling
+      //@{
+
+      // forward declaration
+   class Rinex3ObsData;
+
+      /**
+       * Read access to the binary cache file of a RINEX observation
+       * file, which holds the text of the header and the already
+       * parsed observation records.  The cache for "file" is named
+       * "file" + suffix, and is only used if its source file still
+       * has the size, modification time and hash it had when the
+       * cache was written.  The whole cache is mapped into memory
+       * by open() and records are decoded from the mapping directly.
+       *
+       * Caches are normally written and read by Rinex3ObsStream,
+       * see Rinex3ObsStream::useCache().  They are specific to the
+       * machine (byte order) and the version of the cache format,
+       * anything else is silently ignored.
+       *
+       * @sa Rinex3ObsCacheWriter
+       */
+   class Rinex3ObsCache
+   {
+   public:
+         /// The file name suffix for cache files.
+      static const char *suffix;
+
+         /// The version of the cache file format.
+      static const std::uint32_t formatVersion;
+
+         /// What identifies the contents of a source file.
+      struct Source
+      {
+         std::uint64_t size;       ///< file size in bytes
+         std::int64_t mtime;       ///< modification time, seconds
+         std::uint64_t hash;       ///< FNV-1a hash of the file contents
+      };
+
+         /// @return the name of the cache file for \a fn.
+      static std::string cacheName(const std::string& fn);
+
+         /** Get the size and modification time of a file.
+          * @param[in] fn the name of the file.
+          * @param[out] src the size and mtime of \a fn, hash is set to 0.
+          * @return false if \a fn is not a regular file. */
+      static bool statFile(const std::string& fn, Source& src);
+
+         /** Get the size, modification time and hash of a file.
+          * @param[in] fn the name of the file.
+          * @param[out] src the identity of \a fn.
+          * @return false if \a fn could not be read. */
+      static bool identify(const std::string& fn, Source& src);
+
+         /// Create an unopened cache.
+      Rinex3ObsCache();
+
+         /** Map the cache for a RINEX file, if there is a valid one.
+          * @param[in] fn the name of the RINEX file, not the cache.
+          * @return true if the cache is valid and open. */
+      bool open(const std::string& fn);
+
+         /// Release the mapping.
+      void close();
+
+         /// @return true if a cache is open.
+      bool is_open() const
+      { return cacheMap.is_open(); }
+
+         /// @return the text of the RINEX header, which is not null
+         ///   terminated.
+      const char* headerText() const
+      { return text; }
+
+         /// @return the number of characters in headerText().
+      std::size_t headerSize() const
+      { return headerLen; }
+
+         /** Decode the next record in the cache.
+          * @param[out] rod the record, with the header records of
+          *   events parsed into rod.auxHeader.
+          * @return false if there are no records left.
+          * @throw FFStreamError if the cache is corrupt. */
+      bool getRecord(Rinex3ObsData& rod);
+
+         /// @return the offset of the next record getRecord() decodes.
+      std::size_t tell() const
+      { return next - records; }
+
+         /** Set the record getRecord() decodes next.
+          * @param[in] offset a value previously returned by tell().
+          * @return false if \a offset is past the end of the records. */
+      bool seek(std::size_t offset);
+
+   private:
+         // The decoded data points into the mapping.
+      Rinex3ObsCache(const Rinex3ObsCache&);
+      Rinex3ObsCache& operator=(const Rinex3ObsCache&);
+
+         /// The mapped cache file.
+      MappedFileBuf cacheMap;
+         /// The first record.
+      const char *records;
+         /// The next record to decode.
+      const char *next;
+         /// The end of the records.
+      const char *recordsEnd;
+         /// The text section, starting with the header.
+      const char *text;
+         /// The size of the text section.
+      std::size_t textLen;
+         /// The size of the header in the text section.
+      std::size_t headerLen;
+   }; // End of class 'Rinex3ObsCache'
+
+
+      /**
+       * Write the cache for a RINEX observation file, given the
+       * records as they're read from it.  Records are written to a
+       * temporary file as they're added.  finish() adds the text of
+       * the header and of any event records, which it gets by
+       * reading the source again up to the last of them, and then
+       * renames the temporary file to the cache file.  Caches are
+       * a convenience, so failures simply result in no cache.
+       *
+       * @sa Rinex3ObsCache
+       */
+   class Rinex3ObsCacheWriter
+   {
+   public:
+         /** Start writing the cache for a RINEX file.
+          * @param[in] fn the name of the RINEX file, not the cache. */
+      Rinex3ObsCacheWriter(const std::string& fn);
+
+         /// Removes the temporary file unless finish() succeeded.
+      ~Rinex3ObsCacheWriter();
+
+         /// @return false if the cache can't be written.
+      bool good() const
+      { return tmpFile.good(); }
+
+         /** Record where the header ends.
+          * @param[in] end the position in the source text just
+          *   past the end of the header. */
+      void addHeader(std::streamoff end);
+
+         /** Add an observation record.
+          * @param[in] rod the record.
+          * @param[in] start the position in the source text where
+          *   the record begins.
+          * @param[in] end the position in the source text just past
+          *   the end of the record. */
+      void addRecord(const Rinex3ObsData& rod, std::streamoff start,
+                     std::streamoff end);
+
+         /** Complete the cache, once the whole source has been read.
+          * @return true if the cache was written. */
+      bool finish();
+
+   private:
+      Rinex3ObsCacheWriter(const Rinex3ObsCacheWriter&);
+      Rinex3ObsCacheWriter& operator=(const Rinex3ObsCacheWriter&);
+
+         /// Write the buffered records to the temporary file.
+      void flush();
+
+         /// A range of the source text to be copied into the cache.
+      struct TextRange
+      {
+         std::streamoff start, end;
+      };
+
+         /// The RINEX file.
+      std::string sourceName;
+         /// The size and mtime of the RINEX file when it was opened.
+      Rinex3ObsCache::Source startSource;
+         /// The temporary file being written.
+      std::string tmpName;
+      std::ofstream tmpFile;
+         /// Records not yet written to tmpFile.
+      std::vector<char> buffer;
+         /// Bytes of records written so far.
+      std::uint64_t recordsSize;
+         /// Text of the header and event records, in order.
+      std::vector<TextRange> textRanges;
+         /// Total size of textRanges.
+      std::uint64_t textSize;
+         /// True once the cache has been renamed into place.
+      bool done;
+   }; // End of class 'Rinex3ObsCacheWriter'
+
+      //@}
+
+}  // End of namespace gpstk
+
+#endif   // GPSTK_RINEX3OBSCACHE_HPP
@@ -53,6 +53,96 @@ using namespace std;
 
 namespace gpstk
 {
+      /** Append rightJustify(asString<short>(value), width, fill) to
+       * \a buf, which keeps only the rightmost \a width characters
+       * of a value that doesn't fit. */
+   static void appendShort(string& buf, short value, size_t width,
+                           char fill = ' ')
+   {
+      char digits[8];
+      char *end = digits + sizeof(digits), *p = end;
+      int v = (value < 0 ? -int(value) : int(value));
+      do
+      {
+         *--p = '0' + (v % 10);
+         v /= 10;
+      } while (v > 0);
+      if (value < 0)
+         *--p = '-';
+      size_t len = end - p;
+      if (len >= width)
+      {
+         buf.append(end - width, width);
+      }
+      else
+      {
+         buf.append(width - len, fill);
+         buf.append(p, len);
+      }
+   }
+
+
+      /** Append sat.toString() to \a buf.  The usual two digit
+       * satellite numbers are written directly, anything else is
+       * left to RinexSatID::toString(). */
+   static void appendSatID(string& buf, const RinexSatID& sat)
+   {
+      int rinexID = sat.id;
+         // the same kludging as toString() for PRNs > 99
+      if (sat.id != -1)
+      {
+         if (sat.system == SatelliteSystem::Geosync)
+            rinexID -= 100;
+         else if (sat.system == SatelliteSystem::QZSS)
+            rinexID -= (rinexID >= 193 ? 192 : 100);
+      }
+      if ((rinexID < 0) || (rinexID > 99))
+      {
+         buf += sat.toString();
+         return;
+      }
+      buf += sat.systemChar();
+      buf += (rinexID < 10 ? sat.getfill() : char('0' + rinexID / 10));
+      buf += char('0' + rinexID % 10);
+   }
+
+
+      /// Append the 16 character RINEX field for \a datum to \a buf.
+   static void appendDatum(string& buf, const RinexDatum& datum)
+   {
+      size_t pos = buf.size();
+      buf.resize(pos + 16);
+      datum.toChars(&buf[pos]);
+   }
+
+
+      /// Append Rinex3ObsData::writeTime(ct) to \a buf.
+   static void appendTime(string& buf, const CommonTime& ct)
+   {
+      if(ct == CommonTime::BEGINNING_OF_TIME)
+      {
+         buf.append(26, ' ');
+         return;
+      }
+
+      CivilTime civtime(ct);
+      buf += ' ';
+      appendShort(buf, civtime.year, 4);
+      buf += ' ';
+      appendShort(buf, civtime.month, 2, '0');
+      buf += ' ';
+      appendShort(buf, civtime.day, 2, '0');
+      buf += ' ';
+      appendShort(buf, civtime.hour, 2, '0');
+      buf += ' ';
+      appendShort(buf, civtime.minute, 2, '0');
+      appendFixed(buf, civtime.second, 7, 11);
+   }
+
+
+      // Each epoch is formatted into the stream's write buffer and
+      // written in one piece, which is considerably faster than
+      // writing it a line at a time.
    void reallyPutRecordVer2( Rinex3ObsStream& strm,
                              const Rinex3ObsData& rod )
    {
@@ -64,31 +154,35 @@ namespace gpstk
           && rod.epochFlag<=5
           && rod.auxHeader.numberHeaderRecordsToBeWritten()==0 ) return;
 
-         // first the epoch line to 'line'
-         //line  = writeTime(rod.time); // (ver 2 RinexObsData::writeTime)
-      string line;
+      string& buf(strm.writeBuffer);
+      buf.clear();
+      unsigned long lines = 0;
+         // start of the line being formatted
+      size_t lineStart = 0;
+
+         // first the epoch line
       if(rod.time == CommonTime::BEGINNING_OF_TIME)
-         line = string(26, ' ');
+         buf.append(26, ' ');
       else
       {
          CivilTime civTime(rod.time);
-         line  = string(1, ' ');
-         line += rightJustify(asString<short>(civTime.year),2);
-         line += string(1, ' ');
-         line += rightJustify(asString<short>(civTime.month),2);
-         line += string(1, ' ');
-         line += rightJustify(asString<short>(civTime.day),2);
-         line += string(1, ' ');
-         line += rightJustify(asString<short>(civTime.hour),2);
-         line += string(1, ' ');
-         line += rightJustify(asString<short>(civTime.minute),2);
-         line += rightJustify(asString(civTime.second, 7),11);
-         line += string(2, ' ');
-         line += rightJustify(asString<short>(rod.epochFlag), 1);
-         line += rightJustify(asString<short>(rod.numSVs), 3);
-      }
-
-         // write satellite ids to 'line'
+         buf += ' ';
+         appendShort(buf, civTime.year, 2);
+         buf += ' ';
+         appendShort(buf, civTime.month, 2);
+         buf += ' ';
+         appendShort(buf, civTime.day, 2);
+         buf += ' ';
+         appendShort(buf, civTime.hour, 2);
+         buf += ' ';
+         appendShort(buf, civTime.minute, 2);
+         appendFixed(buf, civTime.second, 7, 11);
+         buf.append(2, ' ');
+         appendShort(buf, rod.epochFlag, 1);
+         appendShort(buf, rod.numSVs, 3);
+      }
+
+         // write satellite ids
       const size_t maxPrnsPerLine = 12;
       size_t satsWritten = 0;
 
@@ -98,7 +192,7 @@ namespace gpstk
       {
          while( itr != rod.obs.end() && satsWritten < maxPrnsPerLine )
          {
-            line += itr->first.toString();
+            appendSatID(buf, itr->first);
             satsWritten++;
             itr++;
          }
@@ -106,8 +200,8 @@ namespace gpstk
             // add clock offset
          if( rod.clockOffset != 0.0 )
          {
-            line += string(68 - line.size(), ' ');
-            line += rightJustify( asString(rod.clockOffset, 9), 12 );
+            buf.append(68 - (buf.size() - lineStart), ' ');
+            appendFixed(buf, rod.clockOffset, 9, 12);
          }
 
             // continuation lines
@@ -115,100 +209,78 @@ namespace gpstk
          {
             if((satsWritten % maxPrnsPerLine) == 0)
             {
-               strm << line << endl;
-               strm.lineNumber++;
-               line  = string(32, ' ');
+               buf += '\n';
+               lines++;
+               lineStart = buf.size();
+               buf.append(32, ' ');
             }
-            line += itr->first.toString();
+            appendSatID(buf, itr->first);
             satsWritten++;
             itr++;
          }
 
       }  // End of 'if( rod.epochFlag==0 || rod.epochFlag==1 || ...'
 
-         // write the epoch line
-      strm << line << endl;
-      strm.lineNumber++;
-         // write the auxiliary header records, if any
-      if( rod.epochFlag >= 2 && rod.epochFlag <= 5 )
-      {
-         try
-         {
-            rod.auxHeader.writeHeaderRecords(strm);
-         }
-         catch(FFStreamError& e)
-         {
-            GPSTK_RETHROW(e);
-         }
-         catch(StringException& e)
-         {
-            GPSTK_RETHROW(e);
-         }
-      }  // write out data
-      else if( rod.epochFlag == 0 || rod.epochFlag == 1 || rod.epochFlag == 6 )
+      buf += '\n';
+      lines++;
+
+      if( rod.epochFlag == 0 || rod.epochFlag == 1 || rod.epochFlag == 6 )
       {
-         size_t i;
          const int maxObsPerLine(5);
+            // satellites whose system has no obs types get blanks
+         const vector<int> noIndexes(strm.header.R2ObsTypes.size(), -1);
+            // once per epoch, in case the header was edited
+         if (!strm.header.isObsTypeIndexCurrent())
+            strm.header.buildObsTypeIndex();
 
             // loop over satellites in R3 obs data
          for( itr = rod.obs.begin(); itr != rod.obs.end(); ++itr )
          {
-
-            RinexSatID sat(itr->first);               // current satellite
-            string sys(string(1,sat.systemChar()));   // system
-            int obsWritten(0);
-            line = string("");
-
-               // loop over R2 obstypes
-            for( i=0; i<strm.header.R2ObsTypes.size(); i++ )
+               // index of each R2 obstype in the R3 data
+            const Rinex3ObsHeader::SysObsTypes *sot =
+               strm.header.getSysObsTypes(itr->first.system);
+            const vector<int>& indexes(sot ? sot->r2Index : noIndexes);
+            for(size_t i=0; i<indexes.size(); i++)
             {
-
-                  // get the R3 obs ID from the map
-               RinexObsID obsid;
-               obsid =
-                  strm.header.mapSysR2toR3ObsID[sys][strm.header.R2ObsTypes[i]];
-
-                  // now find index of that data from R3 header
-               const vector<RinexObsID>& vecData(strm.header.mapObsTypes[sys]);
-
-               vector<RinexObsID>::const_iterator jt;
-               jt = find(vecData.begin(), vecData.end(), obsid);
-
-                  // index into vecData
-               int ind(-1);
-
-               if( jt != vecData.end() )
-                  ind = jt-vecData.begin();
-
                   // need a continuation line?
-               if( obsWritten != 0 && (obsWritten % maxObsPerLine) == 0 )
-               {
-                  strm << line << endl;
-                  strm.lineNumber++;
-                  line = string("");
-               }
-
-                  // write the line
-               if (ind == -1)
+               if( i != 0 && (i % maxObsPerLine) == 0 )
                {
-                  RinexDatum empty;
-                  line += empty.asString();
+                  buf += '\n';
+                  lines++;
                }
+               if (indexes[i] == -1)
+                  appendDatum(buf, RinexDatum());
                else
-               {
-                  line += itr->second[ind].asString();
-               }
-               obsWritten++;
-
-            }  // End of 'for( i=0; i<strm.header.R2ObsTypes.size(); i++ )'
+                  appendDatum(buf, itr->second[indexes[i]]);
+            }
 
-            strm << line << endl;
-            strm.lineNumber++;
+            buf += '\n';
+            lines++;
 
          }  // End of 'for( itr = rod.obs.begin(); itr != rod.obs.end();...'
+      }
 
-      }  // Ebf of 'else if( rod.epochFlag == 0 || rod.epochFlag == 1 || ...'
+         // flush once per epoch, as the line-by-line writer did per line
+      strm.write(buf.data(), buf.size());
+      strm.flush();
+      strm.lineNumber += lines;
 
+         // write the auxiliary header records, if any
+      if( rod.epochFlag >= 2 && rod.epochFlag <= 5 )
+      {
+         try
+         {
+            rod.auxHeader.writeHeaderRecords(strm);
+         }
+         catch(FFStreamError& e)
+         {
+            GPSTK_RETHROW(e);
+         }
+         catch(StringException& e)
+         {
+            GPSTK_RETHROW(e);
+         }
+      }
    }  // End of function 'reallyPutRecordVer2()'
 
 
@@ -257,8 +329,7 @@ namespace gpstk
                                     const RinexObsID& obsID,
                                     const Rinex3ObsHeader& hdr ) const
    {
-      string sys(1,svID.systemChar());
-      return getObs(svID, hdr.getObsIndex(sys, obsID));
+      return getObs(svID, hdr.getObsIndex(svID.system, obsID));
    }
 
    
@@ -267,7 +338,7 @@ namespace gpstk
                               const RinexObsID& obsID,
                               const Rinex3ObsHeader& hdr )
    {
-      size_t index = hdr.getObsIndex(string(1,svID.systemChar()), obsID);
+      size_t index = hdr.getObsIndex(svID.system, obsID);
       if (obs[svID].size() <= index)
          obs[svID].resize(index+1);
       if (obsID.type == ObservationType::Channel)
@@ -320,45 +391,45 @@ namespace gpstk
          return;
       }
 
-      string line;
+         // Format the epoch into the stream's buffer and write it
+         // in one piece.
+      string& buf(strm.writeBuffer);
+      buf.clear();
 
          // first the epoch line
-      line  = ">";
-      line += writeTime(time);
-      line += string(2, ' ');
-      line += rightJustify(asString<short>(epochFlag), 1);
-      line += rightJustify(asString<short>(numSVs   ), 3);
-      line += string(6, ' ');
+      buf += '>';
+      appendTime(buf, time);
+      buf.append(2, ' ');
+      appendShort(buf, epochFlag, 1);
+      appendShort(buf, numSVs, 3);
+      buf.append(6, ' ');
       if(clockOffset != 0.0) // optional data; need to test for its existence
-         line += rightJustify(asString(clockOffset, 12), 15);
-
-      strm << line << endl;
-      strm.lineNumber++;
-      line.erase();
+         appendFixed(buf, clockOffset, 12, 15);
+      buf += '\n';
+      unsigned long lines = 1;
 
       if(epochFlag == 0 || epochFlag == 1 || epochFlag == 6)
       {
-         DataMap::const_iterator itr = obs.begin();
-
-         while(itr != obs.end())
+         DataMap::const_iterator itr;
+         for(itr = obs.begin(); itr != obs.end(); itr++)
          {
-            line = itr->first.toString();
-
+            appendSatID(buf, itr->first);
             for(size_t i=0; i < itr->second.size(); i++)
             {
-               line += itr->second[i].asString();
+               appendDatum(buf, itr->second[i]);
             }
-               // write the data line out
-            strm << line << endl;
-            strm.lineNumber++;
-            line.erase();
-
-            itr++;
+            buf += '\n';
+            lines++;
          } // end loop over sats and data
       }
 
+         // flush once per epoch, as the line-by-line writer did per line
+      strm.write(buf.data(), buf.size());
+      strm.flush();
+      strm.lineNumber += lines;
+
          // write the auxiliary header records, if any
-      else if(epochFlag >= 2 && epochFlag <= 5)
+      if(epochFlag >= 2 && epochFlag <= 5)
       {
          try
          {
@@ -494,7 +565,6 @@ namespace gpstk
       {
             // first read the SatIDs off the epoch line
          int isv, ndx, line_ndx;
-         string satsys;
          RinexSatID sat;
          vector<RinexSatID> satIndex(rod.numSVs);
          for(isv=1, ndx=0; ndx<rod.numSVs; isv++, ndx++)
@@ -527,12 +597,16 @@ namespace gpstk
 
             // number of R2 OTs in header
          int numObs(strm.header.R2ObsTypes.size());
+         if (!strm.header.isObsTypeIndexCurrent())
+            strm.header.buildObsTypeIndex();
          rod.obs.clear();
             // loop over all sats, reading obs data
          for(isv=0; isv < rod.numSVs; isv++)
          {
             sat = satIndex[isv];                   // sat for this data
-            satsys = asString(sat.systemChar());   // system for this sat
+               // index of each R2 obstype in the R3 data for this system
+            const Rinex3ObsHeader::SysObsTypes *sot =
+               strm.header.getSysObsTypes(sat.system);
             vector<RinexDatum> data;
                // loop over data in the line
             for(ndx=0, line_ndx=0; ndx < numObs; ndx++, line_ndx++)
@@ -552,9 +626,7 @@ namespace gpstk
                }
 
                   // does this R2 OT map into a valid R3 ObsID?
-               string R2ot(strm.header.R2ObsTypes[ndx]);
-               string R3ot(strm.header.mapSysR2toR3ObsID[satsys][R2ot].asString());
-               if(R3ot != string("   "))
+               if((sot != nullptr) && (sot->r2Index[ndx] >= 0))
                {
                   RinexDatum tempData(line.substr(line_ndx*16, 16));
                   data.push_back(tempData);
@@ -590,6 +662,58 @@ namespace gpstk
    }  // end void reallyGetRecordVer2(Rinex3ObsStream& strm, Rinex3ObsData& rod)
 
 
+      /// Return the length of \a line with trailing blanks removed.
+   static size_t stripTrailingLength(const char* line, size_t length)
+   {
+      while ((length > 0) && (line[length-1] == ' '))
+         length--;
+      return length;
+   }
+
+
+      /** Parse the satellite ID in the first 3 columns of a RINEX 3
+       * observation line.  The usual "Xnn" form is decoded directly,
+       * anything else is left to RinexSatID::fromString(), which
+       * produces the same result but is considerably slower.
+       * @throw Exception for an invalid system character. */
+   static void parseSatID(const char* line, size_t length, RinexSatID& sat)
+   {
+      if ((length >= 3) && ((line[1] == ' ') || isdigit(line[1])) &&
+          isdigit(line[2]))
+      {
+         int prn = (line[1] == ' ' ? 0 : (line[1]-'0')*10) + (line[2]-'0');
+         bool known = true;
+         switch (line[0])
+         {
+            case 'G': sat.system = SatelliteSystem::GPS;     break;
+            case 'R': sat.system = SatelliteSystem::Glonass; break;
+            case 'E': sat.system = SatelliteSystem::Galileo; break;
+            case 'C': sat.system = SatelliteSystem::BeiDou;  break;
+            case 'I': sat.system = SatelliteSystem::IRNSS;   break;
+            case 'S':
+               sat.system = SatelliteSystem::Geosync;
+               if (prn > 0)
+                  prn += 100;
+               break;
+            case 'J':
+               sat.system = SatelliteSystem::QZSS;
+               if (prn > 0)
+                  prn += (prn < 83 ? 192 : 100);
+               break;
+            default:
+               known = false;
+               break;
+         }
+         if (known)
+         {
+            sat.id = (prn > 0 ? prn : -1);
+            return;
+         }
+      }
+      sat = RinexSatID(string(line, length < 3 ? length : 3));
+   }
+
+
    void Rinex3ObsData::reallyGetRecord(FFStream& ffs)
    {
       Rinex3ObsStream& strm = dynamic_cast<Rinex3ObsStream&>(ffs);
@@ -597,14 +721,14 @@ namespace gpstk
          // If the header hasn't been read, read it.
       if(!strm.headerRead) strm >> strm.header;
 
-      Rinex3ObsData rod;
-
-         // clear out this ObsData
-      *this = rod;
+         // The stream may have the record already parsed in its cache.
+      if(strm.getCachedRecord(*this)) return;
 
          // call the version for RINEX ver 2
       if(strm.header.version < 3)
       {
+            // clear out this ObsData
+         *this = Rinex3ObsData();
          try
          {
             reallyGetRecordVer2(strm, *this);
@@ -616,51 +740,76 @@ namespace gpstk
          return;
       }
 
-      string line;
+         // Lines are parsed in place, directly from the stream's
+         // buffer, and the map entries and vectors from the previous
+         // record are reused, so that no memory is allocated for an
+         // epoch with the same satellites as the last one.
+      const char *line;
+      size_t length;
 
          // read the first (epoch) line
-      strm.formattedGetLine(line, true);
-      StringUtils::stripTrailing(line, " ");
+      strm.formattedGetLine(line, length, true);
+      length = stripTrailingLength(line, length);
 
          // Check and parse the epoch line -----------------------------------
          // Check for epoch marker ('>') and following space.
-      if(line[0] != '>' || line[1] != ' ')
+      if(length < 2 || line[0] != '>' || line[1] != ' ')
       {
-         FFStreamError e("Bad epoch line: >" + line + "<");
+         FFStreamError e("Bad epoch line: >" + string(line, length) + "<");
+         GPSTK_THROW(e);
+      }
+      if(length < 32)
+      {
+         FFStreamError e("Epoch line too short: >" + string(line, length) +
+                         "<");
          GPSTK_THROW(e);
       }
 
-      epochFlag = asInt(line.substr(31,1));
+      epochFlag = asInt(line+31, 1);
       if(epochFlag < 0 || epochFlag > 6)
       {
          FFStreamError e("Invalid epoch flag: " + asString(epochFlag));
          GPSTK_THROW(e);
       }
 
-      time = parseTime(line, strm.header, strm.timesystem);
+      time = parseTime(line, length, strm.header, strm.timesystem);
 
-      numSVs = asInt(line.substr(32,3));
+      numSVs = asInt(line+32, std::min<size_t>(length-32, 3));
 
-      if(line.size() > 41)
-         clockOffset = asDouble(line.substr(41,15));
+      if(length > 41)
+         clockOffset = asDouble(line+41, std::min<size_t>(length-41, 15));
       else
          clockOffset = 0.0;
 
+      auxHeader.clear();
+
          // Read the observations: SV ID and data ----------------------------
       if(epochFlag == 0 || epochFlag == 1 || epochFlag == 6)
       {
-         vector<RinexSatID> satIndex(numSVs);
-         map<RinexSatID, vector<RinexDatum> > tempDataMap;
+         if (!strm.header.isObsTypeIndexCurrent())
+            strm.header.buildObsTypeIndex();
+
+            // Empty out the previous record's data without releasing
+            // it.  Anything still empty after this epoch is read is a
+            // satellite that's no longer being tracked.
+         DataMap::iterator oi;
+         for (oi = obs.begin(); oi != obs.end(); oi++)
+         {
+            oi->second.clear();
+         }
+            // satellites in this epoch whose system has no obs types
+         vector<RinexSatID> emptySats;
 
+         RinexSatID sat;
          for(int isv = 0; isv < numSVs; isv++)
          {
-            strm.formattedGetLine(line);
-            StringUtils::stripTrailing(line, " ");
+            strm.formattedGetLine(line, length);
+            length = stripTrailingLength(line, length);
 
                // get the SV ID
             try
             {
-               satIndex[isv] = RinexSatID(line.substr(0,3));
+               parseSatID(line, length, sat);
             }
             catch (Exception& e)
             {
@@ -670,42 +819,64 @@ namespace gpstk
 
                // get the # data items (# entries in ObsType map of
                // maps from header)
-            string gnss = asString(satIndex[isv].systemChar());
-            int size = strm.header.mapObsTypes[gnss].size();
+            const Rinex3ObsHeader::SysObsTypes *sot =
+               strm.header.getSysObsTypes(sat.system);
+            if (sot == nullptr)
+            {
+                  // Not in the header, this adds an empty entry to
+                  // mapObsTypes just as it always has.
+               strm.header.mapObsTypes[string(1,sat.systemChar())];
+               strm.header.buildObsTypeIndex();
+            }
+            int size = (sot ? sot->obsTypes.size() : 0);
+            if (size == 0)
+               emptySats.push_back(sat);
 
                // Some receivers leave blanks for missing Obs (which
                // is OK by RINEX 3).  If the last Obs are the ones
                // missing, it won't necessarily be padded with spaces,
-               // so the parser will break.  This adds the padding to
-               // let the parser do its job and interpret spaces as
-               // zeroes.
-            size_t minSize = 3 + 16*size;
-            if(line.size() < minSize)
-               line += string(minSize-line.size(), ' ');
-
-               // get the data (# entries in ObsType map of maps from header)
-            vector<RinexDatum> data;
+               // so RinexDatum treats anything past the end of the
+               // line as blank.
+            vector<RinexDatum>& data = obs[sat];
+            data.resize(size);
             for(int i = 0; i < size; i++)
             {
                size_t pos = 3 + 16*i;
-               RinexDatum tempData(line.substr(pos,16));
-               data.push_back(tempData);
+               if (pos < length)
+                  data[i].fromString(line+pos, length-pos);
+               else
+                  data[i].fromString(line, 0);
+            }
+         }
+
+            // remove satellites that were not in this epoch
+         for (oi = obs.begin(); oi != obs.end();)
+         {
+            if (oi->second.empty() &&
+                (std::find(emptySats.begin(), emptySats.end(), oi->first) ==
+                 emptySats.end()))
+            {
+               obs.erase(oi++);
+            }
+            else
+            {
+               oi++;
             }
-            obs[satIndex[isv]] = data;
          }
       }
 
          // ... or the auxiliary header information
-      else if(numSVs > 0)
+      else
       {
-         auxHeader.clear();
+         obs.clear();
+         string hdrLine;
          for(int i = 0; i < numSVs; i++)
          {
-            strm.formattedGetLine(line);
-            StringUtils::stripTrailing(line);
+            strm.formattedGetLine(hdrLine);
+            StringUtils::stripTrailing(hdrLine);
             try
             {
-               auxHeader.parseHeaderRecord(line);
+               auxHeader.parseHeaderRecord(hdrLine);
             }
             catch(FFStreamError& e)
             {
@@ -727,12 +898,19 @@ namespace gpstk
    } // end of reallyGetRecord()
 
 
-   CommonTime Rinex3ObsData::parseTime(const string& line,
+   CommonTime Rinex3ObsData::parseTime(const char* line,
+                                       size_t length,
                                        const Rinex3ObsHeader& hdr,
                                        const TimeSystem& ts) const
    {
       try
       {
+         if(length < 31)
+         {
+            FFStreamError e("Invalid time format");
+            GPSTK_THROW(e);
+         }
+
             // check if the spaces are in the right place - an easy
             // way to check if there's corruption in the file
          if( (line[ 1] != ' ') || (line[ 6] != ' ') || (line[ 9] != ' ') ||
@@ -744,18 +922,18 @@ namespace gpstk
          }
 
             // if there's no time, just return a bad time
-         if(line.substr(2,27) == string(27, ' '))
+         if(stripTrailingLength(line+2, 27) == 0)
             return CommonTime::BEGINNING_OF_TIME;
 
          int year, month, day, hour, min;
          double sec;
 
-         year  = asInt(   line.substr( 2,  4));
-         month = asInt(   line.substr( 7,  2));
-         day   = asInt(   line.substr(10,  2));
-         hour  = asInt(   line.substr(13,  2));
-         min   = asInt(   line.substr(16,  2));
-         sec   = asDouble(line.substr(19, 11));
+         year  = asInt(   line+ 2,  4);
+         month = asInt(   line+ 7,  2);
+         day   = asInt(   line+10,  2);
+         hour  = asInt(   line+13,  2);
+         min   = asInt(   line+16,  2);
+         sec   = asDouble(line+19, 11);
 
             // Real Rinex has epochs 'yy mm dd hr 59 60.0' surprisingly often.
          double ds = 0;
@@ -772,7 +950,6 @@ namespace gpstk
 
          return rv;
       }
-         // string exceptions for substr are caught here
       catch (std::exception &e)
       {
          FFStreamError err("std::exception: " + string(e.what()));
@@ -787,24 +964,8 @@ namespace gpstk
 
    string Rinex3ObsData::writeTime(const CommonTime& ct) const
    {
-      if(ct == CommonTime::BEGINNING_OF_TIME)
-         return string(26, ' ');
-
-      CivilTime civtime(ct);
       string line;
-
-      line  = string(1, ' ');
-      line += rightJustify(asString<short>(civtime.year    ), 4);
-      line += string(1, ' ');
-      line += rightJustify(asString<short>(civtime.month   ), 2, '0');
-      line += string(1, ' ');
-      line += rightJustify(asString<short>(civtime.day     ), 2, '0');
-      line += string(1, ' ');
-      line += rightJustify(asString<short>(civtime.hour    ), 2, '0');
-      line += string(1, ' ');
-      line += rightJustify(asString<short>(civtime.minute  ), 2, '0');
-      line += rightJustify(asString       (civtime.second,7),11);
-
+      appendTime(line, ct);
       return line;
    }  // end writeTime
 
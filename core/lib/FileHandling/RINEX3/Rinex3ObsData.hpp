@@ -223,11 +223,13 @@ namespace gpstk
           *  parameters.
           *
           * @param line The encoded time string found in the RINEX record.
+          * @param length The number of characters in \a line.
           * @param hdr  The RINEX Observation Header object for the current
           *             RINEX file.
           * @throw FFStreamError
           */
-      CommonTime parseTime( const std::string& line,
+      CommonTime parseTime( const char* line,
+                            std::size_t length,
                             const Rinex3ObsHeader& hdr,
                             const TimeSystem& ts) const;
 
@@ -224,6 +224,9 @@ namespace gpstk
       leapSeconds = 0;
       numSVs = 0;
       numObsForSat.clear();
+      sysObsTypes = SysObsTypesArray();
+      sysObsTypesValid = false;
+      sysObsTypesMapSize = 0;
       obsTypeList.clear();
       valid.clear();
       validEoH = false;
@@ -247,6 +250,7 @@ namespace gpstk
       Rinex3ObsStream& strm = dynamic_cast<Rinex3ObsStream&>(ffs);
 
       strm.header = *this;
+      strm.header.buildObsTypeIndex();
 
       Fields allValid = Fields::getRequired(version);
       if (allValid.empty())
@@ -1747,6 +1751,7 @@ namespace gpstk
       }
 
          // If we get here, we should have reached the end of header line.
+      buildObsTypeIndex();
       strm.header = *this;
       strm.headerRead = true;
 
@@ -2234,6 +2239,7 @@ namespace gpstk
             // save for this system
          mapSysR2toR3ObsID[mit->first] = mapR2toR3ObsID;
       }
+      buildObsTypeIndex();
    }  // end prepareVer2Write()
 
    void Rinex3ObsHeader::dump(ostream& s, double dumpVersion) const
@@ -2560,6 +2566,104 @@ namespace gpstk
    }
 
 
+   size_t Rinex3ObsHeader ::
+   getObsIndex(SatelliteSystem sys, const RinexObsID& obsID) const
+   {
+      string sysStr(1, RinexSatID(-1,sys).systemChar());
+      if (!sysObsTypesValid)
+         return getObsIndex(sysStr, obsID);
+      const SysObsTypes *sot = getSysObsTypes(sys);
+      if (sot == nullptr)
+      {
+         InvalidRequest ir("GNSS system " + sysStr + " not stored.");
+         GPSTK_THROW(ir);
+      }
+      for (size_t i = 0; i < sot->indexTypes.size(); i++)
+      {
+         if (sot->indexTypes[i].equalIndex(obsID))
+            return i;
+      }
+      InvalidRequest ir(obsID.asString(version) + " is not stored in system " +
+                        sysStr + ".");
+      GPSTK_THROW(ir);
+      return 0;
+   }
+
+
+   bool Rinex3ObsHeader ::
+   isObsTypeIndexCurrent() const
+   {
+      if (!sysObsTypesValid || (sysObsTypesMapSize != mapObsTypes.size()))
+         return false;
+      for (size_t i = 0; i < sysObsTypes.size(); i++)
+      {
+         const SysObsTypes& sot(sysObsTypes[i]);
+         if (!sot.present)
+            continue;
+         RinexObsMap::const_iterator moti = mapObsTypes.find(
+            string(1, RinexSatID(-1,static_cast<SatelliteSystem>(i))
+                   .systemChar()));
+         if ((moti == mapObsTypes.end()) ||
+             (sot.r2Index.size() != R2ObsTypes.size()) ||
+             (sot.obsTypes != moti->second))
+            return false;
+      }
+      return true;
+   }
+
+
+   void Rinex3ObsHeader ::
+   buildObsTypeIndex()
+   {
+      sysObsTypes = SysObsTypesArray();
+      sysObsTypesMapSize = mapObsTypes.size();
+      RinexObsMap remapped;
+      map<string,unsigned> obsCount;
+      remapObsTypes(remapped, obsCount);
+      for (const auto& moti : mapObsTypes)
+      {
+         if (moti.first.length() != 1)
+            continue;
+         RinexSatID sat;
+         try
+         {
+            sat.fromString(moti.first);
+         }
+         catch (Exception& e)
+         {
+               // not a RINEX system, only reachable through the map
+            continue;
+         }
+         size_t i = static_cast<size_t>(sat.system);
+         if (i >= sysObsTypes.size())
+            continue;
+         SysObsTypes& sot(sysObsTypes[i]);
+         sot.present = true;
+         sot.obsTypes = moti.second;
+         sot.indexTypes = remapped[moti.first];
+         VersionObsMap::const_iterator r2i = mapSysR2toR3ObsID.find(moti.first);
+         for (size_t j = 0; j < R2ObsTypes.size(); j++)
+         {
+            int index = -1;
+            if (r2i != mapSysR2toR3ObsID.end())
+            {
+               ObsIDMap::const_iterator oimi = r2i->second.find(R2ObsTypes[j]);
+               if (oimi != r2i->second.end())
+               {
+                  RinexObsVec::const_iterator jt =
+                     find(moti.second.begin(), moti.second.end(),
+                          oimi->second);
+                  if (jt != moti.second.end())
+                     index = jt - moti.second.begin();
+               }
+            }
+            sot.r2Index.push_back(index);
+         }
+      }
+      sysObsTypesValid = true;
+   }
+
+
    bool Rinex3ObsHeader::compare(const Rinex3ObsHeader& right,
                                  std::vector<std::string>& diffs,
                                  const std::vector<std::string>& inclExclList,
@@ -44,6 +44,7 @@
 #ifndef GPSTK_RINEX3OBSHEADER_HPP
 #define GPSTK_RINEX3OBSHEADER_HPP
 
+#include <array>
 #include <vector>
 #include <list>
 #include <map>
@@ -319,6 +320,30 @@ namespace gpstk
       typedef std::vector<Rinex3CorrInfo> CorrVec;
          /// Vector of wavelength factors
       typedef std::vector<ExtraWaveFact> FactorVector;
+
+         /** The observation types of one satellite system, copied
+          * from mapObsTypes and mapSysR2toR3ObsID by
+          * buildObsTypeIndex() so they can be found without building
+          * a string key and searching the maps. */
+      struct SysObsTypes
+      {
+         SysObsTypes() : present(false) {}
+            /// True if the system is in mapObsTypes.
+         bool present;
+            /// The system's entry in mapObsTypes.
+         RinexObsVec obsTypes;
+            /** obsTypes without the repeated ionospheric delay and
+             * channel pseudo-observables, numbered as getObsIndex()
+             * numbers them. */
+         RinexObsVec indexTypes;
+            /** For each of R2ObsTypes, the index in obsTypes of the
+             * RINEX 3 observation it maps to, or -1 if none. */
+         std::vector<int> r2Index;
+      };
+         /// SysObsTypes indexed by SatelliteSystem.
+      typedef std::array<SysObsTypes,
+                         static_cast<std::size_t>(SatelliteSystem::Last)>
+         SysObsTypesArray;
       typedef std::set<Field> FieldSet;
 
       class Fields
@@ -484,6 +509,19 @@ namespace gpstk
       short numSVs;                    ///< # OF SATELLITES
       PRNNumObsMap numObsForSat;       ///< PRN / # OF OBS
 
+         /** mapObsTypes indexed by SatelliteSystem.  This is built
+          * when the header is read from or written to a stream, and
+          * must be rebuilt with buildObsTypeIndex() after changing
+          * mapObsTypes, R2ObsTypes or mapSysR2toR3ObsID directly.
+          * The epoch readers and writers check it once per epoch
+          * with isObsTypeIndexCurrent().
+          * @see getSysObsTypes() */
+      SysObsTypesArray sysObsTypes;
+         /// True if sysObsTypes has been built.
+      bool sysObsTypesValid;
+         /// Size of mapObsTypes when sysObsTypes was built.
+      std::size_t sysObsTypesMapSize;
+
 
          /// number & types of observations R2 only
          ///@bug  this is being used but is not actually being filled
@@ -543,6 +581,45 @@ namespace gpstk
       virtual std::size_t getObsIndex(const std::string& sys,
                                       const RinexObsID& obsID ) const;
 
+         /** This method returns the numerical index of a given
+          * observation, using sysObsTypes if it has been built.
+          * @param[in] sys   GNSS system of the obs
+          * @param[in] obsID RinexObsID of the observation
+          * @throw InvalidRequest
+          */
+      std::size_t getObsIndex(SatelliteSystem sys,
+                              const RinexObsID& obsID) const;
+
+         /** Rebuild sysObsTypes from mapObsTypes, R2ObsTypes and
+          * mapSysR2toR3ObsID. */
+      void buildObsTypeIndex();
+
+         /** Check sysObsTypes against mapObsTypes and R2ObsTypes.
+          * This walks every system, so call it once per epoch or
+          * header, not once per satellite.
+          * @return true if sysObsTypes has been built and still
+          *   matches mapObsTypes and R2ObsTypes. */
+      bool isObsTypeIndexCurrent() const;
+
+         /** Get the observation types of a satellite system.
+          * @param[in] sys the system to look up.
+          * @return the system's entry in sysObsTypes, or nullptr if
+          *   the system is not in mapObsTypes.
+          * @throw InvalidRequest if sysObsTypes has not been built.
+          */
+      const SysObsTypes* getSysObsTypes(SatelliteSystem sys) const
+      {
+         if (!sysObsTypesValid)
+         {
+            InvalidRequest ir("Observation type index has not been built");
+            GPSTK_THROW(ir);
+         }
+         std::size_t i = static_cast<std::size_t>(sys);
+         if ((i >= sysObsTypes.size()) || !sysObsTypes[i].present)
+            return nullptr;
+         return &sysObsTypes[i];
+      }
+
          /** Parse a single header record, and modify valid
           * accordingly.  Used by reallyGetRecord for both
           * Rinex3ObsHeader and Rinex3ObsData. 
@@ -0,0 +1,283 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+/**
+ * @file Rinex3ObsIndex.cpp
+ * Index of the epochs in a RINEX observation file, by time.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "Rinex3ObsIndex.hpp"
+#include "Rinex3ObsCache.hpp"
+
+namespace gpstk
+{
+      // A saved index is a FileHeader followed by one FileEntry per
+      // record, written in native byte order.
+   namespace
+   {
+      const char indexMagic[8] = { 'G','P','S','T','K','R','3','I' };
+      const std::uint32_t indexVersion = 1;
+      const std::uint32_t byteOrderMark = 0x01020304;
+
+      struct FilePosition
+      {
+         std::int64_t offset;
+         std::uint64_t line;
+         std::uint64_t record;
+      };
+
+      struct FileHeader
+      {
+         char magic[8];
+         std::uint32_t version;
+         std::uint32_t bom;
+         std::uint64_t sourceSize;
+         std::int64_t sourceMtime;
+         std::uint64_t count;
+         std::uint64_t sorted;
+         FilePosition start;
+         FilePosition end;
+      };
+
+      struct FileEntry
+      {
+         FilePosition pos;
+         std::int64_t day;
+         std::int64_t msod;
+         double fsod;
+         std::int64_t timeSystem;
+      };
+
+      FilePosition toFile(const Rinex3ObsIndex::Position& pos)
+      {
+         FilePosition fp;
+         fp.offset = pos.offset;
+         fp.line = pos.line;
+         fp.record = pos.record;
+         return fp;
+      }
+
+      Rinex3ObsIndex::Position fromFile(const FilePosition& fp)
+      {
+         Rinex3ObsIndex::Position pos;
+         pos.offset = fp.offset;
+         pos.line = fp.line;
+         pos.record = fp.record;
+         return pos;
+      }
+   }
+
+
+   const char *Rinex3ObsIndex::suffix = ".r3idx";
+
+
+   std::string Rinex3ObsIndex ::
+   indexName(const std::string& fn)
+   {
+      return fn + suffix;
+   }
+
+
+   Rinex3ObsIndex ::
+   Rinex3ObsIndex()
+         : sorted(true)
+   {
+   }
+
+
+   void Rinex3ObsIndex ::
+   clear()
+   {
+      entries.clear();
+      startPos = endPos = Position();
+      sorted = true;
+   }
+
+
+   void Rinex3ObsIndex ::
+   add(const CommonTime& t, const Position& pos)
+   {
+      Entry entry;
+      entry.time = t;
+      entry.pos = pos;
+      if (!entries.empty())
+      {
+         const CommonTime& prev = entries.back().time;
+         if (t == CommonTime::BEGINNING_OF_TIME)
+            entry.time = prev;
+         else if (t < prev)
+            sorted = false;
+      }
+      entries.push_back(entry);
+   }
+
+
+   std::size_t Rinex3ObsIndex ::
+   find(const CommonTime& t) const
+   {
+      std::vector<Entry>::const_iterator i;
+      if (sorted)
+      {
+         i = std::lower_bound(entries.begin(), entries.end(), t,
+                              [](const Entry& e, const CommonTime& t)
+                              { return e.time < t; });
+      }
+      else
+      {
+         i = std::find_if(entries.begin(), entries.end(),
+                          [&t](const Entry& e)
+                          { return !(e.time < t); });
+      }
+      return i - entries.begin();
+   }
+
+
+   bool Rinex3ObsIndex ::
+   save(const std::string& fn) const
+   {
+      Rinex3ObsCache::Source src;
+      if (!Rinex3ObsCache::statFile(fn, src))
+         return false;
+
+      FileHeader fh;
+      std::memset(&fh, 0, sizeof(fh));
+      std::memcpy(fh.magic, indexMagic, sizeof(indexMagic));
+      fh.version = indexVersion;
+      fh.bom = byteOrderMark;
+      fh.sourceSize = src.size;
+      fh.sourceMtime = src.mtime;
+      fh.count = entries.size();
+      fh.sorted = sorted;
+      fh.start = toFile(startPos);
+      fh.end = toFile(endPos);
+
+      std::vector<FileEntry> fileEntries(entries.size());
+      for (std::size_t i = 0; i < entries.size(); i++)
+      {
+         FileEntry& fe = fileEntries[i];
+         long day, msod;
+         double fsod;
+         TimeSystem ts;
+         entries[i].time.getInternal(day, msod, fsod, ts);
+         fe.pos = toFile(entries[i].pos);
+         fe.day = day;
+         fe.msod = msod;
+         fe.fsod = fsod;
+         fe.timeSystem = static_cast<int>(ts);
+      }
+
+         // Write a temporary file and rename it, so a reader never
+         // sees a partial index.
+      std::string name = indexName(fn);
+      std::string tmpName = name + ".tmp";
+      {
+         std::ofstream out(tmpName.c_str(),
+                           std::ios::out | std::ios::binary | std::ios::trunc);
+         out.write(reinterpret_cast<const char*>(&fh), sizeof(fh));
+         if (!fileEntries.empty())
+         {
+            out.write(reinterpret_cast<const char*>(&fileEntries[0]),
+                      fileEntries.size() * sizeof(FileEntry));
+         }
+         out.close();
+         if (!out)
+         {
+            std::remove(tmpName.c_str());
+            return false;
+         }
+      }
+      if (std::rename(tmpName.c_str(), name.c_str()) != 0)
+      {
+         std::remove(tmpName.c_str());
+         return false;
+      }
+      return true;
+   }
+
+
+   bool Rinex3ObsIndex ::
+   load(const std::string& fn)
+   {
+      clear();
+      Rinex3ObsCache::Source src;
+      if (!Rinex3ObsCache::statFile(fn, src))
+         return false;
+      std::ifstream in(indexName(fn).c_str(),
+                       std::ios::in | std::ios::binary);
+      FileHeader fh;
+      if (!in.read(reinterpret_cast<char*>(&fh), sizeof(fh)) ||
+          (std::memcmp(fh.magic, indexMagic, sizeof(indexMagic)) != 0) ||
+          (fh.version != indexVersion) || (fh.bom != byteOrderMark) ||
+          (fh.sourceSize != src.size) || (fh.sourceMtime != src.mtime) ||
+          (fh.count > src.size))
+      {
+         return false;
+      }
+
+      std::vector<FileEntry> fileEntries(fh.count);
+      if (!fileEntries.empty() &&
+          !in.read(reinterpret_cast<char*>(&fileEntries[0]),
+                   fileEntries.size() * sizeof(FileEntry)))
+      {
+         return false;
+      }
+
+      entries.resize(fileEntries.size());
+      for (std::size_t i = 0; i < fileEntries.size(); i++)
+      {
+         const FileEntry& fe = fileEntries[i];
+         if ((fe.pos.offset < 0) || (fe.pos.offset > fh.end.offset))
+         {
+            clear();
+            return false;
+         }
+         entries[i].pos = fromFile(fe.pos);
+         entries[i].time.setInternal(fe.day, fe.msod, fe.fsod,
+                                     static_cast<TimeSystem>(fe.timeSystem));
+      }
+      startPos = fromFile(fh.start);
+      endPos = fromFile(fh.end);
+      sorted = (fh.sorted != 0);
+      return true;
+   }
+
+}  // End of namespace gpstk
@@ -0,0 +1,179 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+/**
+ * @file Rinex3ObsIndex.hpp
+ * Index of the epochs in a RINEX observation file, by time.
+ */
+
+#ifndef GPSTK_RINEX3OBSINDEX_HPP
+#define GPSTK_RINEX3OBSINDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CommonTime.hpp"
+
+namespace gpstk
+{
+      /// @ingroup FileHandling
+      //@{
+
+      /**
+       * The time and position in the stream of every record in a
+       * RINEX observation file, used by Rinex3ObsStream to seek to
+       * an epoch without reading the records before it.  Records
+       * without a time of their own (events with a blank epoch)
+       * are given the time of the record before them, so that the
+       * times in a normal file never decrease and can be searched
+       * in O(log n).
+       *
+       * An index can be saved next to the RINEX file, in a file
+       * named "file" + suffix, which is only loaded while the RINEX
+       * file has the size and modification time it had when the
+       * index was saved.
+       *
+       * @sa Rinex3ObsStream::buildIndex()
+       */
+   class Rinex3ObsIndex
+   {
+   public:
+         /// The file name suffix for saved indexes.
+      static const char *suffix;
+
+         /// A position in a Rinex3ObsStream.
+      struct Position
+      {
+         Position()
+               : offset(0), line(0), record(0)
+         {}
+         std::int64_t offset;      ///< offset in the stream
+         unsigned long line;       ///< lineNumber at offset
+         unsigned long record;     ///< recordNumber at offset
+      };
+
+         /// An indexed record.
+      struct Entry
+      {
+         CommonTime time;          ///< time of the record
+         Position pos;             ///< where the record starts
+      };
+
+         /// @return the name of the saved index for \a fn.
+      static std::string indexName(const std::string& fn);
+
+         /// Create an empty index.
+      Rinex3ObsIndex();
+
+         /// Remove all entries.
+      void clear();
+
+         /// @return true if there are no entries.
+      bool empty() const
+      { return entries.empty(); }
+
+         /// @return the number of records indexed.
+      std::size_t size() const
+      { return entries.size(); }
+
+         /// @return the \a i'th record in file order.
+      const Entry& operator[](std::size_t i) const
+      { return entries[i]; }
+
+         /// @return true if the record times never decrease.
+      bool isSorted() const
+      { return sorted; }
+
+         /// @return the position of the first record, after the header.
+      const Position& dataStart() const
+      { return startPos; }
+
+         /// @return the position after the last record.
+      const Position& dataEnd() const
+      { return endPos; }
+
+         /// Set the position of the first record.
+      void setDataStart(const Position& pos)
+      { startPos = pos; }
+
+         /// Set the position after the last record.
+      void setDataEnd(const Position& pos)
+      { endPos = pos; }
+
+         /** Add the next record in the file.
+          * @param[in] t the time of the record, BEGINNING_OF_TIME if
+          *   it has none.
+          * @param[in] pos where the record starts. */
+      void add(const CommonTime& t, const Position& pos);
+
+         /** Find the first record at or after a time.
+          * @param[in] t the time to look for.
+          * @return the index of the first record, in file order,
+          *   whose time is not before \a t, or size() if there is
+          *   none.
+          * @throw InvalidRequest if \a t is in a different time
+          *   system than the records. */
+      std::size_t find(const CommonTime& t) const;
+
+         /** Save the index for a RINEX file.
+          * @param[in] fn the name of the RINEX file, not the index.
+          * @return false if the index could not be written. */
+      bool save(const std::string& fn) const;
+
+         /** Load the saved index for a RINEX file, if it is valid.
+          * @param[in] fn the name of the RINEX file, not the index.
+          * @return true if the index was loaded, otherwise the
+          *   index is left empty. */
+      bool load(const std::string& fn);
+
+   private:
+         /// Indexed records, in file order.
+      std::vector<Entry> entries;
+         /// Position of the first record.
+      Position startPos;
+         /// Position after the last record.
+      Position endPos;
+         /// True while the times never decrease.
+      bool sorted;
+   }; // End of class 'Rinex3ObsIndex'
+
+      //@}
+
+}  // End of namespace gpstk
+
+#endif   // GPSTK_RINEX3OBSINDEX_HPP
@@ -0,0 +1,320 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+
+/**
+ * @file Rinex3ObsParallelReader.cpp
+ * Multi-threaded decoding of RINEX 3 observation files.
+ */
+
+#include <cstring>
+#include "Rinex3ObsParallelReader.hpp"
+
+namespace gpstk
+{
+      /** Transfer the contents of one record to another, reusing the
+       * storage of \a from rather than copying the observation map. */
+   static void moveRecord(Rinex3ObsData& from, Rinex3ObsData& to)
+   {
+      to.time = from.time;
+      to.epochFlag = from.epochFlag;
+      to.numSVs = from.numSVs;
+      to.clockOffset = from.clockOffset;
+      to.obs.swap(from.obs);
+      if ((from.epochFlag >= 2) && (from.epochFlag <= 5))
+         to.auxHeader = from.auxHeader;
+      else
+         to.auxHeader.clear();
+   }
+
+
+   const std::size_t Rinex3ObsParallelReader::defaultChunkSize;
+
+
+   Rinex3ObsParallelReader ::
+   Rinex3ObsParallelReader()
+         : maxAhead(0), nextChunk(0), readChunk(0), readIndex(0),
+           stopping(false)
+   {
+   }
+
+
+   Rinex3ObsParallelReader ::
+   Rinex3ObsParallelReader(const std::string& fn,
+                           unsigned numThreads,
+                           std::size_t chunkBytes)
+         : maxAhead(0), nextChunk(0), readChunk(0), readIndex(0),
+           stopping(false)
+   {
+      open(fn, numThreads, chunkBytes);
+   }
+
+
+   Rinex3ObsParallelReader ::
+   ~Rinex3ObsParallelReader()
+   {
+      close();
+   }
+
+
+   void Rinex3ObsParallelReader ::
+   open(const std::string& fn,
+        unsigned numThreads,
+        std::size_t chunkBytes)
+   {
+      close();
+      filename = fn;
+
+         // Read the header the usual way.
+      serialStrm.reset(new Rinex3ObsStream(fn.c_str(), std::ios::in));
+      if (!serialStrm->is_open())
+      {
+         FFStreamError err("Unable to open " + fn);
+         GPSTK_THROW(err);
+      }
+      serialStrm->exceptions(std::ios::failbit);
+      *serialStrm >> header;
+      timesystem = serialStrm->timesystem;
+
+         // RINEX 2 epochs can't be identified from the first
+         // character of the line, compressed files can't be split
+         // up, and there's nothing to parse in a cache, so just use
+         // the stream.
+      if ((header.version < 3) || serialStrm->isFiltered() ||
+          serialStrm->isCached() ||
+          !fileMap.open(fn.c_str()))
+      {
+         return;
+      }
+
+      std::streampos dataOffset = serialStrm->tellg();
+      if (dataOffset == std::streampos(-1))
+      {
+         fileMap.close();
+         return;
+      }
+      makeChunks(dataOffset, serialStrm->lineNumber,
+                 serialStrm->recordNumber, chunkBytes);
+      serialStrm.reset();
+
+      if (numThreads == 0)
+         numThreads = std::thread::hardware_concurrency();
+      if (numThreads == 0)
+         numThreads = 1;
+         // Keep the workers busy while the caller works through a chunk.
+      maxAhead = 2 * numThreads;
+      for (unsigned i = 0; i < numThreads; i++)
+      {
+         workers.push_back(std::thread(&Rinex3ObsParallelReader::work, this));
+      }
+   }
+
+
+   void Rinex3ObsParallelReader ::
+   close()
+   {
+      {
+         std::lock_guard<std::mutex> guard(lock);
+         stopping = true;
+      }
+      changed.notify_all();
+      for (unsigned i = 0; i < workers.size(); i++)
+      {
+         workers[i].join();
+      }
+      workers.clear();
+      chunks.clear();
+      serialStrm.reset();
+      fileMap.close();
+      maxAhead = nextChunk = readChunk = readIndex = 0;
+      stopping = false;
+   }
+
+
+   void Rinex3ObsParallelReader ::
+   makeChunks(std::size_t dataOffset, unsigned line, unsigned rec,
+              std::size_t chunkBytes)
+   {
+      const char *data = fileMap.data();
+      std::size_t size = fileMap.size();
+      std::size_t pos = dataOffset;
+
+      chunks.push_back(Chunk(pos, line, rec));
+      while (pos < size)
+      {
+         const char *lineStart = data + pos;
+         bool isEpoch = (*lineStart == '>');
+            // Only start a new chunk at an epoch line.
+         if (isEpoch && (pos - chunks.back().offset >= chunkBytes))
+         {
+            chunks.back().size = pos - chunks.back().offset;
+            chunks.push_back(Chunk(pos, line, rec));
+         }
+            // Find the end of the epoch line.
+         const char *nl = static_cast<const char*>(
+            std::memchr(lineStart, '\n', size - pos));
+         std::size_t lineLen = (nl == nullptr ? size - pos : nl - lineStart);
+         pos += (nl == nullptr ? lineLen : lineLen + 1);
+         line++;
+         rec++;
+         if (!isEpoch)
+         {
+               // Not an epoch line, which will be reported as an
+               // error when the chunk is decoded.
+            continue;
+         }
+            // Skip the satellite or auxiliary header records that
+            // follow, the count of which is in columns 33-35.
+         long count = 0;
+         if (lineLen > 32)
+         {
+            std::size_t fieldLen = lineLen - 32;
+            count = StringUtils::asInt(lineStart + 32,
+                                       fieldLen < 3 ? fieldLen : 3);
+         }
+         for (long i = 0; (i < count) && (pos < size); i++)
+         {
+            nl = static_cast<const char*>(
+               std::memchr(data + pos, '\n', size - pos));
+            pos = (nl == nullptr ? size : nl - data + 1);
+            line++;
+         }
+      }
+      chunks.back().size = pos - chunks.back().offset;
+   }
+
+
+   void Rinex3ObsParallelReader ::
+   work()
+   {
+      std::unique_lock<std::mutex> guard(lock);
+      while (true)
+      {
+         changed.wait(guard, [this]
+                      {
+                         return stopping || (nextChunk >= chunks.size()) ||
+                            (nextChunk < readChunk + maxAhead);
+                      });
+         if (stopping || (nextChunk >= chunks.size()))
+            return;
+         Chunk& chunk = chunks[nextChunk++];
+         guard.unlock();
+         decode(chunk);
+         guard.lock();
+         chunk.done = true;
+         changed.notify_all();
+      }
+   }
+
+
+   void Rinex3ObsParallelReader ::
+   decode(Chunk& chunk)
+   {
+         // Each worker gets its own stream over its part of the file,
+         // set up as though it had just read everything before the
+         // chunk, so errors are reported the same way.
+      Rinex3ObsStream strm;
+      strm.mapMemory(fileMap.data() + chunk.offset, chunk.size);
+      strm.filename = filename;
+      strm.header = header;
+      strm.headerRead = true;
+      strm.timesystem = timesystem;
+      strm.lineNumber = chunk.firstLine;
+      strm.recordNumber = chunk.firstRecord;
+      strm.exceptions(std::ios::failbit);
+      try
+      {
+         while (true)
+         {
+            chunk.records.push_back(Rinex3ObsData());
+            if (!(strm >> chunk.records.back()))
+            {
+               chunk.records.pop_back();
+               break;
+            }
+         }
+      }
+      catch (Exception& e)
+      {
+         chunk.records.pop_back();
+         chunk.failed = true;
+         chunk.error = FFStreamError(e);
+      }
+      catch (std::exception& e)
+      {
+         chunk.records.pop_back();
+         chunk.failed = true;
+         chunk.error = FFStreamError("std::exception thrown: " +
+                                     std::string(e.what()));
+      }
+   }
+
+
+   bool Rinex3ObsParallelReader ::
+   read(Rinex3ObsData& rod)
+   {
+      if (serialStrm)
+      {
+         return static_cast<bool>(*serialStrm >> rod);
+      }
+      std::unique_lock<std::mutex> guard(lock);
+      while (readChunk < chunks.size())
+      {
+         Chunk& chunk = chunks[readChunk];
+         changed.wait(guard, [&chunk] { return chunk.done; });
+         if (readIndex < chunk.records.size())
+         {
+            moveRecord(chunk.records[readIndex++], rod);
+            return true;
+         }
+            // Release the chunk's records and let the workers move on.
+         std::vector<Rinex3ObsData>().swap(chunk.records);
+         readChunk++;
+         readIndex = 0;
+         changed.notify_all();
+         if (chunk.failed)
+         {
+               // Nothing after an error is returned, just as with
+               // Rinex3ObsStream.
+            readChunk = chunks.size();
+            GPSTK_THROW(chunk.error);
+         }
+      }
+      return false;
+   }
+
+} // namespace gpstk
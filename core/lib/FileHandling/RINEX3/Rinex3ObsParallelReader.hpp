@@ -0,0 +1,220 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+
+/**
+ * @file Rinex3ObsParallelReader.hpp
+ * Multi-threaded decoding of RINEX 3 observation files.
+ */
+
+#ifndef GPSTK_RINEX3OBSPARALLELREADER_HPP
+#define GPSTK_RINEX3OBSPARALLELREADER_HPP
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MappedFileBuf.hpp"
+#include "Rinex3ObsStream.hpp"
+#include "Rinex3ObsData.hpp"
+
+namespace gpstk
+{
+      /// @ingroup FileHandling
+      //@{
+
+      /**
+       * Read a RINEX 3 observation file using multiple threads.
+       *
+       * After the header is read, the data section of the file is
+       * memory mapped and split into chunks at epoch lines.  The
+       * boundaries are found by counting the lines that follow each
+       * epoch line, so auxiliary header records (epoch flags 2-5) and
+       * satellite records always stay in the same chunk as their
+       * epoch line, even if they happen to start with '>'.  The
+       * chunks are then decoded by a pool of worker threads, each
+       * using Rinex3ObsData::reallyGetRecord() on its own stream, and
+       * read() returns the records in file order.  Only a limited
+       * number of chunks are decoded ahead of the reader, which
+       * limits the memory used.
+       *
+       * The records are identical to those read using
+       * Rinex3ObsStream.  If a record can't be decoded, all the
+       * records before it are returned, and then read() throws the
+       * same FFStreamError that Rinex3ObsStream would have, with the
+       * same line and record numbers.
+       *
+       * RINEX 2 files, which can't be split on epoch lines as easily,
+       * compressed files, files with a valid cache (when
+       * Rinex3ObsStream::defaultUseCache is set), and files that
+       * can't be memory mapped are read serially through a
+       * Rinex3ObsStream.
+       *
+       * @code
+       * Rinex3ObsParallelReader reader("file.rnx");
+       * Rinex3ObsData rod;
+       * while (reader.read(rod))
+       * {
+       *    ...
+       * }
+       * @endcode
+       */
+   class Rinex3ObsParallelReader
+   {
+   public:
+         /// Default size of a chunk, in bytes.
+      static const std::size_t defaultChunkSize = 1048576;
+
+         /// Create a reader with no file open.
+      Rinex3ObsParallelReader();
+
+         /** Open a file and start decoding it.
+          * @see open()
+          * @throw FFStreamError
+          */
+      Rinex3ObsParallelReader(const std::string& fn,
+                              unsigned numThreads = 0,
+                              std::size_t chunkBytes = defaultChunkSize);
+
+         /// Stop the worker threads.
+      ~Rinex3ObsParallelReader();
+
+         /** Read the header of a RINEX observation file, split the
+          * data into chunks and start decoding it.
+          * @param[in] fn the name of the file to read.
+          * @param[in] numThreads the number of worker threads to use,
+          *   0 to use one per core.
+          * @param[in] chunkBytes the approximate size in bytes of each
+          *   block of data given to a worker thread.
+          * @throw FFStreamError if the header can't be read.
+          */
+      void open(const std::string& fn,
+                unsigned numThreads = 0,
+                std::size_t chunkBytes = defaultChunkSize);
+
+         /// Stop decoding and close the file.
+      void close();
+
+         /** Get the next record in the file.
+          * @param[out] rod the record read.
+          * @return true if a record was read, false at the end of
+          *   the file.
+          * @throw FFStreamError if the next record could not be decoded.
+          */
+      bool read(Rinex3ObsData& rod);
+
+         /// @return the header of the open file.
+      const Rinex3ObsHeader& getHeader() const
+      { return header; }
+
+         /// @return the number of chunks the data was split into.
+      std::size_t getNumChunks() const
+      { return chunks.size(); }
+
+   private:
+         /// A contiguous block of epochs in the file.
+      struct Chunk
+      {
+         Chunk(std::size_t off, unsigned line, unsigned rec)
+               : offset(off), size(0), firstLine(line), firstRecord(rec),
+                 done(false), failed(false)
+         {}
+         std::size_t offset;    ///< Offset of the first epoch line.
+         std::size_t size;      ///< Number of bytes in the chunk.
+         unsigned firstLine;    ///< Line number before the chunk.
+         unsigned firstRecord;  ///< Record number of the first epoch.
+         std::vector<Rinex3ObsData> records; ///< Decoded records.
+         bool done;             ///< True once a worker has decoded it.
+         bool failed;           ///< True if decoding stopped on an error.
+         FFStreamError error;   ///< The error that stopped decoding.
+      };
+
+         // Not copyable, the workers refer to this object.
+      Rinex3ObsParallelReader(const Rinex3ObsParallelReader&);
+      Rinex3ObsParallelReader& operator=(const Rinex3ObsParallelReader&);
+
+         /** Split the data section into chunks.
+          * @param[in] dataOffset the offset of the first epoch line.
+          * @param[in] line the line number of the end of the header.
+          * @param[in] rec the record number of the first epoch. */
+      void makeChunks(std::size_t dataOffset, unsigned line, unsigned rec,
+                      std::size_t chunkBytes);
+
+         /// Worker thread main loop.
+      void work();
+
+         /// Decode all the records in \a chunk.
+      void decode(Chunk& chunk);
+
+         /// Name of the open file.
+      std::string filename;
+         /// Header of the open file.
+      Rinex3ObsHeader header;
+         /// Time system of the epochs in the file.
+      TimeSystem timesystem;
+         /// Mapping of the whole file.
+      MappedFileBuf fileMap;
+         /// Stream used to read files that can't be decoded in parallel.
+      std::unique_ptr<Rinex3ObsStream> serialStrm;
+         /// Blocks of data to be decoded, in file order.
+      std::vector<Chunk> chunks;
+         /// Worker threads.
+      std::vector<std::thread> workers;
+         /// Maximum number of chunks decoded ahead of readChunk.
+      std::size_t maxAhead;
+         /// Index of the next chunk to give to a worker.
+      std::size_t nextChunk;
+         /// Index of the chunk read() is returning records from.
+      std::size_t readChunk;
+         /// Index of the next record in chunks[readChunk].
+      std::size_t readIndex;
+         /// Set to make the workers exit.
+      bool stopping;
+         /// Protects everything shared with the workers.
+      std::mutex lock;
+         /// Signalled when a chunk is decoded or read.
+      std::condition_variable changed;
+   }; // class Rinex3ObsParallelReader
+
+      //@}
+
+} // namespace gpstk
+
+#endif // GPSTK_RINEX3OBSPARALLELREADER_HPP
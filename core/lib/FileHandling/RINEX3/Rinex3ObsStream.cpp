@@ -42,9 +42,14 @@
  */
 
 #include "Rinex3ObsStream.hpp"
+#include "HatanakaBuf.hpp"
+#include "Rinex3ObsData.hpp"
 
 namespace gpstk
 {
+   bool Rinex3ObsStream::defaultUseCache = false;
+
+
    Rinex3ObsStream ::
    Rinex3ObsStream()
    {
@@ -58,6 +63,8 @@ namespace gpstk
          : FFTextStream(fn, mode)
    {
       init();
+      if (!initCache(fn, mode))
+         initFilters(mode);
    }
 
 
@@ -67,6 +74,8 @@ namespace gpstk
          : FFTextStream(fn.c_str(), mode)
    {
       init();
+      if (!initCache(fn.c_str(), mode))
+         initFilters(mode);
    }
 
 
@@ -81,6 +90,10 @@ namespace gpstk
          std::ios::openmode mode )
    {
       FFTextStream::open(fn, mode);
+      index.clear();
+      indexed = false;
+      if (!initCache(fn, mode))
+         initFilters(mode);
    }
 
 
@@ -90,6 +103,8 @@ namespace gpstk
       headerRead = false;
       header = Rinex3ObsHeader();
       timesystem = TimeSystem::GPS;
+      cacheEnabled = defaultUseCache;
+      indexed = false;
    }
 
 
@@ -116,4 +131,278 @@ namespace gpstk
       return true;
    }
 
+
+   void Rinex3ObsStream ::
+   initFilters(std::ios::openmode mode)
+   {
+      if (!is_open() || (mode & std::ios::out))
+         return;
+         // A compressed file may also be Compact RINEX, which can't be
+         // checked for until it is being decompressed.  HatanakaBuf
+         // passes plain RINEX through unchanged.
+      if (decompress() || HatanakaBuf::isCRINEX(readBuffer()))
+      {
+         addInputFilter(new HatanakaBuf(readBuffer()));
+      }
+   }
+
+
+   bool Rinex3ObsStream ::
+   initCache(const char* fn, std::ios::openmode mode)
+   {
+      cache.close();
+      cacheWriter.reset();
+      if (!cacheEnabled || !is_open() || (mode & std::ios::out))
+         return false;
+      if (cache.open(fn))
+      {
+            // The header is parsed from the text in the cache as usual.
+         readMemory(cache.headerText(), cache.headerSize());
+         return true;
+      }
+      cacheWriter.reset(new Rinex3ObsCacheWriter(fn));
+      if (!cacheWriter->good())
+         cacheWriter.reset();
+      return false;
+   }
+
+
+   std::streamoff Rinex3ObsStream ::
+   textPosition()
+   {
+         // tellg() fails once eofbit is set, which it is when the
+         // last line has no terminator, so ask the buffer directly.
+      return std::streamoff(readBuffer()->pubseekoff(0, std::ios::cur,
+                                                     std::ios::in));
+   }
+
+
+   Rinex3ObsIndex::Position Rinex3ObsStream ::
+   position()
+   {
+      Rinex3ObsIndex::Position pos;
+      pos.offset = (isCached() ? cache.tell() : textPosition());
+      pos.line = lineNumber;
+      pos.record = recordNumber;
+      return pos;
+   }
+
+
+   void Rinex3ObsStream ::
+   seekPosition(const Rinex3ObsIndex::Position& pos)
+   {
+      clear();
+      if (isCached())
+      {
+         if (!cache.seek(pos.offset))
+         {
+            FFStreamError err("Invalid position in cache of " + filename);
+            GPSTK_THROW(err);
+         }
+      }
+      else
+      {
+         if (isFiltered())
+         {
+            FFStreamError err("Can't seek in compressed file " + filename);
+            GPSTK_THROW(err);
+         }
+         if (textPosition() != pos.offset)
+         {
+               // The cache is written from a sequential read.
+            cacheWriter.reset();
+            if (!seekg(pos.offset))
+            {
+               FFStreamError err("Unable to seek in " + filename);
+               GPSTK_THROW(err);
+            }
+         }
+      }
+      lineNumber = pos.line;
+      recordNumber = pos.record;
+   }
+
+
+   void Rinex3ObsStream ::
+   buildIndex(bool save)
+   {
+      if (indexed)
+         return;
+      if (!is_open() || (isFiltered() && !isCached()))
+      {
+         FFStreamError err("Can't index " + filename +
+                           ", it must be an uncompressed or cached input"
+                           " file");
+         GPSTK_THROW(err);
+      }
+      if (!headerRead)
+      {
+         Rinex3ObsHeader hdr;
+         if (!(*this >> hdr))
+         {
+            GPSTK_THROW(mostRecentException);
+         }
+      }
+
+      Rinex3ObsIndex::Position start = index.dataStart();
+         // A saved index must start where the header ends.
+      if (!isCached() && index.load(filename) &&
+          (index.dataStart().offset == start.offset) &&
+          (index.dataStart().line == start.line) &&
+          (index.dataStart().record == start.record))
+      {
+         indexed = true;
+         return;
+      }
+      index.clear();
+      index.setDataStart(start);
+
+         // Read all the records to get their times, making sure
+         // errors aren't hidden by the stream's exception mask.
+      Rinex3ObsIndex::Position here = position();
+      std::ios::iostate mask = exceptions();
+      try
+      {
+         exceptions(std::ios::failbit);
+         seekPosition(start);
+         Rinex3ObsData rod;
+         while (true)
+         {
+            Rinex3ObsIndex::Position pos = position();
+            if (!(*this >> rod))
+               break;
+            index.add(rod.time, pos);
+         }
+         index.setDataEnd(position());
+            // exceptions() throws if the state it's given is set.
+         clear();
+         exceptions(mask);
+         seekPosition(here);
+      }
+      catch (...)
+      {
+         index.clear();
+         index.setDataStart(start);
+         clear();
+         exceptions(mask);
+         seekPosition(here);
+         throw;
+      }
+      indexed = true;
+      if (save && !isCached())
+         index.save(filename);
+   }
+
+
+   bool Rinex3ObsStream ::
+   seekToTime(const CommonTime& t)
+   {
+      buildIndex();
+      std::size_t i = index.find(t);
+      if (i == index.size())
+      {
+         seekPosition(index.dataEnd());
+         return false;
+      }
+      seekPosition(index[i].pos);
+      return true;
+   }
+
+
+   void Rinex3ObsStream ::
+   readRange(const CommonTime& begin, const CommonTime& end,
+             std::vector<Rinex3ObsData>& records)
+   {
+      records.clear();
+      buildIndex();
+         // Records out of order are skipped over, consecutive
+         // records are read without seeking.
+      bool positioned = false;
+      for (std::size_t i = index.find(begin); i < index.size(); i++)
+      {
+         const Rinex3ObsIndex::Entry& entry = index[i];
+         if ((end < entry.time) || (entry.time < begin))
+         {
+            if (index.isSorted())
+               break;
+            positioned = false;
+            continue;
+         }
+         if (!positioned)
+         {
+            seekPosition(entry.pos);
+            positioned = true;
+         }
+         records.push_back(Rinex3ObsData());
+         if (!(*this >> records.back()))
+         {
+            records.pop_back();
+            GPSTK_THROW(mostRecentException);
+         }
+      }
+   }
+
+
+   void Rinex3ObsStream ::
+   tryFFStreamGet(FFData& rec)
+   {
+      if (!headerRead && (dynamic_cast<Rinex3ObsHeader*>(&rec) != nullptr))
+      {
+            // Note where the records start, for buildIndex().
+         tryCacheGet(rec);
+         if (headerRead)
+            index.setDataStart(position());
+      }
+      else
+      {
+         tryCacheGet(rec);
+      }
+   }
+
+
+   void Rinex3ObsStream ::
+   tryCacheGet(FFData& rec)
+   {
+      if (!cacheWriter)
+      {
+         FFTextStream::tryFFStreamGet(rec);
+         return;
+      }
+
+      std::streamoff start = textPosition();
+      unsigned long initialRecordNumber = recordNumber;
+      try
+      {
+         FFTextStream::tryFFStreamGet(rec);
+      }
+      catch (...)
+      {
+         cacheWriter.reset();
+         throw;
+      }
+         // Reading a record may read the header too, which was
+         // handled by a nested call.
+      if (!cacheWriter)
+         return;
+
+      if (recordNumber != initialRecordNumber)
+      {
+         Rinex3ObsHeader *hdr = dynamic_cast<Rinex3ObsHeader*>(&rec);
+         Rinex3ObsData *rod = dynamic_cast<Rinex3ObsData*>(&rec);
+         if (hdr != nullptr)
+            cacheWriter->addHeader(textPosition());
+         else if (rod != nullptr)
+            cacheWriter->addRecord(*rod, start, textPosition());
+         else
+            cacheWriter.reset();
+      }
+      else
+      {
+            // Only a complete file gets a cache.
+         if (eof())
+            cacheWriter->finish();
+         cacheWriter.reset();
+      }
+   }
+
 } // namespace gpstk
@@ -47,10 +47,13 @@
 #include <vector>
 #include <list>
 #include <map>
+#include <memory>
 #include <string>
 
 #include "FFTextStream.hpp"
 #include "Rinex3ObsHeader.hpp"
+#include "Rinex3ObsCache.hpp"
+#include "Rinex3ObsIndex.hpp"
 
 namespace gpstk
 {
@@ -60,6 +63,26 @@ namespace gpstk
       /**
        * This class reads RINEX 3 Obs files.
        *
+       * Files opened for input only may be compressed with gzip or
+       * Unix compress and/or Hatanaka compressed (Compact RINEX),
+       * in which case they are decompressed as they are read,
+       * without being expanded to disk.  Such streams can't seek.
+       *
+       * Input streams may also use a binary cache file next to the
+       * RINEX file, see useCache().  This is transparent to the
+       * caller, who still reads Rinex3ObsHeader and Rinex3ObsData.
+       *
+       * Uncompressed or cached input streams can jump to an epoch
+       * with seekToTime() or read a span of time with readRange(),
+       * using an index of the records built on demand, see
+       * buildIndex().
+       *
+       * @code
+       * Rinex3ObsStream strm("file.rnx");
+       * std::vector<Rinex3ObsData> window;
+       * strm.readRange(begin, end, window);
+       * @endcode
+       *
        * @sa Rinex3ObsData and Rinex3ObsHeader.
        */
    class Rinex3ObsStream : public FFTextStream
@@ -112,12 +135,138 @@ namespace gpstk
          /// Time system for epochs in this file
       TimeSystem timesystem;
 
+         /** Buffer Rinex3ObsData formats each epoch into before
+          * writing it in a single block.  It's kept with the stream
+          * so that its memory is reused from one epoch to the next. */
+      std::string writeBuffer;
+
          /// Check if the input stream is the kind of Rinex3ObsStream
       static bool isRinex3ObsStream(std::istream& i);
 
+         /** When true, Rinex3ObsStream objects subsequently created
+          * use caches as with useCache(true).  Defaults to false. */
+      static bool defaultUseCache;
+
+         /** Set whether files subsequently opened for input only by
+          * this stream use a cache, see Rinex3ObsCache.  If the file
+          * has a valid cache, the header and records are read from it
+          * instead of being parsed.  Otherwise the file is parsed, and
+          * if it's read to the end a cache is written for next time.
+          * Defaults to defaultUseCache.
+          * @param[in] b true to use caches. */
+      void useCache(bool b)
+      { cacheEnabled = b; }
+
+         /// @return true if the stream is reading from a cache.
+      bool isCached() const
+      { return cache.is_open(); }
+
+         /** Get the next record from the cache, if reading from one.
+          * Used by Rinex3ObsData.
+          * @param[out] rod the record.
+          * @return false if not reading from a cache, or there are no
+          *   more records in it.
+          * @throw FFStreamError if the cache is corrupt. */
+      bool getCachedRecord(Rinex3ObsData& rod)
+      { return cache.getRecord(rod); }
+
+         /** Index the time and position of every record in the file,
+          * reading the header first if necessary.  A valid index
+          * saved by an earlier buildIndex(true) is loaded instead of
+          * reading the records.  The stream is left where it was.
+          * This is done automatically by seekToTime() and
+          * readRange(), and only once per open().
+          * @param[in] save if true, save the index next to the file
+          *   for next time, see Rinex3ObsIndex.  Indexes of cached
+          *   streams are not saved, as the cache is already fast to
+          *   index.
+          * @throw FFStreamError if the stream can't be indexed,
+          *   which includes compressed streams that aren't cached,
+          *   or a record can't be read. */
+      void buildIndex(bool save = false);
+
+         /// @return the index made by buildIndex(), which is empty
+         ///   until then.
+      const Rinex3ObsIndex& getIndex() const
+      { return index; }
+
+         /** Position the stream so the next record read is the first
+          * one, in file order, whose time is not before \a t.
+          * @param[in] t the time to seek to.
+          * @return false if there is no such record, in which case
+          *   the stream is positioned at the end of the file.
+          * @throw FFStreamError if the stream can't be indexed.
+          * @throw InvalidRequest if \a t is in a different time
+          *   system than the file.
+          */
+      bool seekToTime(const CommonTime& t);
+
+         /** Read the records whose times are within a span of time.
+          * The stream is left after the last record read.
+          * @param[in] begin the earliest time to read.
+          * @param[in] end the latest time to read.
+          * @param[out] records the records from \a begin to \a end
+          *   inclusive, in file order.
+          * @throw FFStreamError if the stream can't be indexed or a
+          *   record can't be read.
+          * @throw InvalidRequest if \a begin or \a end is in a
+          *   different time system than the file.
+          */
+      void readRange(const CommonTime& begin, const CommonTime& end,
+                     std::vector<Rinex3ObsData>& records);
+
+   protected:
+         /** Calls FFTextStream::tryFFStreamGet, adds the record to
+          * the cache being written, if any, and notes where the
+          * header ends.
+          * @throw FFStreamError
+          * @throw StringUtils::StringException
+          */
+      virtual void tryFFStreamGet(FFData& rec);
+
    private:
          /// Initialize internal data structures.
       void init();
+
+         /// Add input filters for compressed or Compact RINEX files.
+      void initFilters(std::ios::openmode mode);
+
+         /** Read from the cache of \a fn if it has a valid one, else
+          * start writing one.
+          * @return true if reading from the cache. */
+      bool initCache(const char* fn, std::ios::openmode mode);
+
+         /** Read a record, adding it to the cache being written,
+          * if any.
+          * @throw FFStreamError
+          * @throw StringUtils::StringException
+          */
+      void tryCacheGet(FFData& rec);
+
+         /// @return the position in the text being read.
+      std::streamoff textPosition();
+
+         /// @return the position of the next record to be read.
+      Rinex3ObsIndex::Position position();
+
+         /** Set the next record to be read.
+          * @throw FFStreamError if the stream can't seek. */
+      void seekPosition(const Rinex3ObsIndex::Position& pos);
+
+         /// Use caches for files opened from now on.
+      bool cacheEnabled;
+
+         /// The cache being read.
+      Rinex3ObsCache cache;
+
+         /// The cache being written.
+      std::unique_ptr<Rinex3ObsCacheWriter> cacheWriter;
+
+         /// Index of the records, once buildIndex() has been called.
+      Rinex3ObsIndex index;
+
+         /// True once buildIndex() has succeeded.
+      bool indexed;
    }; // class 'Rinex3ObsStream'
 
       //@}
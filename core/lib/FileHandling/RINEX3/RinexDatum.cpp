@@ -40,6 +40,8 @@
  * Defines class methods for a single RINEX datum.
  */
 
+#include <cstdlib>
+#include <cstring>
 #include "RinexDatum.hpp"
 #include "Exception.hpp"
 #include "StringUtils.hpp"
@@ -65,39 +67,46 @@ namespace gpstk
    void RinexDatum ::
    fromString(const std::string& str)
    {
-      std::string tmpStr;
       GPSTK_ASSERT(str.length() == 16);
-      tmpStr = str.substr(0, 14);
-      if (tmpStr.find_last_not_of(" ") == std::string::npos)
+      fromString(str.data(), str.length());
+   }
+
+
+   void RinexDatum ::
+   fromString(const char* str, std::size_t length)
+   {
+      std::size_t dataLen = (length < 14 ? length : 14);
+      std::size_t i;
+      for (i = 0; (i < dataLen) && (str[i] == ' '); i++)
+         ;
+      if (i == dataLen)
       {
          data = 0.;
          dataBlank = true;
       }
       else
       {
-         data = StringUtils::asDouble(tmpStr);
+         data = StringUtils::asDouble(str, dataLen);
          dataBlank = false;
       }
-      tmpStr = str.substr(14, 1);
-      if (tmpStr == " ")
+      if ((length <= 14) || (str[14] == ' '))
       {
          lli = 0.;
          lliBlank = true;
       }
       else
       {
-         lli = StringUtils::asInt(tmpStr);
+         lli = StringUtils::asInt(str+14, 1);
          lliBlank = false;
       }
-      tmpStr = str.substr(15, 1);
-      if (tmpStr == " ")
+      if ((length <= 15) || (str[15] == ' '))
       {
          ssi = 0.;
          ssiBlank = true;
       }
       else
       {
-         ssi = StringUtils::asInt(tmpStr);
+         ssi = StringUtils::asInt(str+15, 1);
          ssiBlank = false;
       }
    }
@@ -106,35 +115,39 @@ namespace gpstk
    std::string RinexDatum ::
    asString() const
    {
-      std::string rv;
-      using gpstk::StringUtils::rightJustify;
+      char buf[16];
+      toChars(buf);
+      return std::string(buf, sizeof(buf));
+   } // asString() const
+
 
+   void RinexDatum ::
+   toChars(char* buf) const
+   {
       if (!dataBlank)
       {
-            // double 14.3
-         rv += rightJustify(gpstk::StringUtils::asString(data, 3), 14);
+            // double 14.3, keeping the rightmost characters of
+            // anything too big like rightJustify() does
+         if (gpstk::StringUtils::formatFixed(buf, 14, data, 3, 14) > 14)
+         {
+            std::string str;
+            gpstk::StringUtils::appendFixed(str, data, 3, 14);
+            std::memcpy(buf, str.data(), 14);
+         }
       }
       else
       {
-         rv += std::string(14, ' ');
+         std::memset(buf, ' ', 14);
       }
+         // Only the last digit of the indicators fits.
       if ((lli != 0) || !lliBlank)
-      {
-         rv += rightJustify(gpstk::StringUtils::asString<short>(lli),1);
-      }
+         buf[14] = '0' + std::abs(lli % 10);
       else
-      {
-         rv += " ";
-      }
+         buf[14] = ' ';
       if ((ssi != 0) || !ssiBlank)
-      {
-         rv += rightJustify(gpstk::StringUtils::asString<short>(ssi),1);
-      }
+         buf[15] = '0' + std::abs(ssi % 10);
       else
-      {
-         rv += " ";
-      }
-      return rv;
-   } // asString() const
+         buf[15] = ' ';
+   }
 
 } // namespace gpstk
@@ -44,6 +44,7 @@
 #ifndef RINEXDATUM_HPP
 #define RINEXDATUM_HPP
 
+#include <cstddef>
 #include <string>
 
 namespace gpstk
@@ -70,9 +71,25 @@ namespace gpstk
           * @throw AssertionFailure if str.length() != 16 */
       void fromString(const std::string& str);
 
+         /** Parse a RINEX OBS datum in place, without allocating
+          * memory.  Characters beyond \a length are treated as
+          * blanks, which allows parsing directly from a line that is
+          * shorter than the full record.
+          * @param[in] str the first character of the RINEX-formatted
+          *   datum, which need not be null-terminated.
+          * @param[in] length the number of characters available at
+          *   \a str, only the first 16 of which are used. */
+      void fromString(const char* str, std::size_t length);
+
          /// Turn this datum into a RINEX OBS formatted string
       std::string asString() const;
 
+         /** Write this datum as a RINEX OBS formatted field, the same
+          * as asString() but without allocating memory.
+          * @param[out] buf where to write the 16 characters of the
+          *   field, no null terminator is written. */
+      void toChars(char* buf) const;
+
       double data;    ///< The actual data point.
       bool dataBlank; ///< True if the data is blank in the file
       short lli;      ///< See the RINEX Spec. for an explanation.
@@ -199,13 +199,14 @@ namespace gpstk
                GPSTK_THROW(err);
             }
 
-            // parse the line
+            // parse the line, the fields are all within its length
+            const char *line = strm.lastLine.data();
             sat = static_cast<SatID>(SP3SatID(strm.lastLine.substr(1,3)));
 
-            x[0] = asDouble(strm.lastLine.substr(4,14));             // XYZ
-            x[1] = asDouble(strm.lastLine.substr(18,14));
-            x[2] = asDouble(strm.lastLine.substr(32,14));
-            clk = asDouble(strm.lastLine.substr(46,14));             // Clock
+            x[0] = asDouble(line+4,14);                              // XYZ
+            x[1] = asDouble(line+18,14);
+            x[2] = asDouble(line+32,14);
+            clk = asDouble(line+46,14);                              // Clock
 
             // handle NGA extension to SP3a - the event flag
             eventFlag = false;
@@ -219,10 +220,10 @@ namespace gpstk
 
             // the rest is version c only
             if(isVerC) {
-               sig[0] = asInt(strm.lastLine.substr(61,2));           // sigma XYZ
-               sig[1] = asInt(strm.lastLine.substr(64,2));
-               sig[2] = asInt(strm.lastLine.substr(67,2));
-               sig[3] = asInt(strm.lastLine.substr(70,3));           // sigma clock
+               sig[0] = asInt(line+61,2);                            // sigma XYZ
+               sig[1] = asInt(line+64,2);
+               sig[2] = asInt(line+67,2);
+               sig[3] = asInt(line+70,3);                            // sigma clock
 
                if(RecType == 'P') {                                  // P flags
                   clockEventFlag = clockPredFlag
@@ -256,17 +257,18 @@ namespace gpstk
                GPSTK_THROW(err);
             }
 
-            // parse the line
-            sdev[0] = abs(asInt(strm.lastLine.substr(4,4)));
-            sdev[1] = abs(asInt(strm.lastLine.substr(9,4)));
-            sdev[2] = abs(asInt(strm.lastLine.substr(14,4)));
-            sdev[3] = abs(asInt(strm.lastLine.substr(19,7)));
-            correlation[0] = asInt(strm.lastLine.substr(27,8));
-            correlation[1] = asInt(strm.lastLine.substr(36,8));
-            correlation[2] = asInt(strm.lastLine.substr(45,8));
-            correlation[3] = asInt(strm.lastLine.substr(54,8));
-            correlation[4] = asInt(strm.lastLine.substr(63,8));
-            correlation[5] = asInt(strm.lastLine.substr(72,8));
+            // parse the line, the fields are all within its length
+            const char *line = strm.lastLine.data();
+            sdev[0] = abs(asInt(line+4,4));
+            sdev[1] = abs(asInt(line+9,4));
+            sdev[2] = abs(asInt(line+14,4));
+            sdev[3] = abs(asInt(line+19,7));
+            correlation[0] = asInt(line+27,8);
+            correlation[1] = asInt(line+36,8);
+            correlation[2] = asInt(line+45,8);
+            correlation[3] = asInt(line+54,8);
+            correlation[4] = asInt(line+63,8);
+            correlation[5] = asInt(line+72,8);
 
             // tell the caller that correlation data is now present
             correlationFlag = true;
@@ -353,10 +355,10 @@ namespace gpstk
          else
             line += static_cast<SP3SatID>(sat).toString();  // sat ID
 
-         line += rightJustify(asString(x[0],6),14);         // XYZ
-         line += rightJustify(asString(x[1],6),14);
-         line += rightJustify(asString(x[2],6),14);
-         line += rightJustify(asString(clk,6),14);          // Clock
+         appendFixed(line,x[0],6,14);                       // XYZ
+         appendFixed(line,x[1],6,14);
+         appendFixed(line,x[2],6,14);
+         appendFixed(line,clk,6,14);                        // Clock
 
          // handle NGA extension to SP3a
          if(isVerA && strm.header.allowSP3aEvents
@@ -104,6 +104,10 @@ namespace gpstk
       virtual std::string name(void)
          { return std::string("GCAT"); }
 
+         /// Return a copy of this model; see TropModel::clone().
+      virtual TropModel* clone(void) const
+         { return new GCATTropModel(*this); }
+
          /** Compute and return the full tropospheric delay. The receiver
           *  height must has been provided before, whether using the
           *  appropriate constructor or with the setReceiverHeight() method
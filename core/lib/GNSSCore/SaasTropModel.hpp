@@ -115,6 +115,10 @@ namespace gpstk
       virtual std::string name(void)
       { return std::string("Saas"); }
 
+         /// Return a copy of this model; see TropModel::clone().
+      virtual TropModel* clone(void) const
+      { return new SaasTropModel(*this); }
+
          /** Compute and return the full tropospheric delay
           * @param elevation Elevation of satellite as seen at
           *   receiver, in degrees
@@ -72,6 +72,10 @@ namespace gpstk
       virtual std::string name(void)
       { return std::string("Simple"); }
 
+         /// Return a copy of this model; see TropModel::clone().
+      virtual TropModel* clone(void) const
+      { return new SimpleTropModel(*this); }
+
          /*** Compute and return the zenith delay for dry component of
           * the troposphere
           * @throw InvalidTropModel
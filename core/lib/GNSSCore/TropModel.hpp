@@ -117,6 +117,14 @@ namespace gpstk
       virtual std::string name(void)
       { return std::string("Undefined"); }
 
+         /** Return a copy of this model, which the caller must
+          * delete, or NULL if the model can't be copied.  correction()
+          * changes the receiver and time settings of most models, so
+          * threads that compute corrections at the same time need
+          * their own copies. */
+      virtual TropModel* clone(void) const
+      { return NULL; }
+
          /** Compute and return the full tropospheric delay
           * @param elevation Elevation of satellite as seen at
           *   receiver, in degrees
@@ -286,6 +294,10 @@ namespace gpstk
       virtual std::string name(void)
       { return std::string("Zero"); }
 
+         /// Return a copy of this model; see TropModel::clone().
+      virtual TropModel* clone(void) const
+      { return new ZeroTropModel(*this); }
+
          /** Compute and return the full tropospheric delay
           * @param elevation Elevation of satellite as seen at receiver, in degrees
           * @throw InvalidTropModel
@@ -0,0 +1,438 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+/// @file ArchiveTable.cpp
+/// Compact storage of a time-ordered table of fixed-size records.
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "ArchiveTable.hpp"
+
+using namespace std;
+
+namespace gpstk
+{
+      // How a field of a block is stored; the low 5 bits of the
+      // field's header byte hold the power of ten for fieldDecimal.
+   enum FieldForm
+   {
+      fieldZero = 0,       ///< all +0.0, nothing stored
+      fieldConstant = 1,   ///< one value, 8 bytes
+      fieldDecimal = 2,    ///< scaled integers, varint differences
+      fieldRaw = 3         ///< every value, 8 bytes each
+   };
+
+      // Exact powers of ten; 1e22 is the largest a double holds exactly.
+   static const double powersOfTen[] =
+   {
+      1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+   };
+   static const int maxPower = 22;
+
+      // Scaled values must be integers a double holds exactly.
+   static const double maxScaled = 9007199254740992.0;   // 2^53
+
+
+   static uint64_t doubleBits(double d)
+   {
+      uint64_t u;
+      memcpy(&u, &d, sizeof(u));
+      return u;
+   }
+
+
+   static void putDouble(vector<unsigned char>& bytes, double d)
+   {
+      unsigned char buf[sizeof(d)];
+      memcpy(buf, &d, sizeof(d));
+      bytes.insert(bytes.end(), buf, buf+sizeof(d));
+   }
+
+
+   static double getDouble(const unsigned char *& p)
+   {
+      double d;
+      memcpy(&d, p, sizeof(d));
+      p += sizeof(d);
+      return d;
+   }
+
+
+      // Store a signed integer, zigzag mapped, 7 bits per byte.
+   static void putVarint(vector<unsigned char>& bytes, int64_t i)
+   {
+      uint64_t u((static_cast<uint64_t>(i) << 1) ^
+                 static_cast<uint64_t>(i >> 63));
+      while(u >= 0x80)
+      {
+         bytes.push_back(static_cast<unsigned char>(u | 0x80));
+         u >>= 7;
+      }
+      bytes.push_back(static_cast<unsigned char>(u));
+   }
+
+
+   static int64_t getVarint(const unsigned char *& p)
+   {
+      uint64_t u(0);
+      for(int shift = 0; ; shift += 7)
+      {
+         unsigned char b(*p++);
+         u |= static_cast<uint64_t>(b & 0x7f) << shift;
+         if(!(b & 0x80))
+            break;
+      }
+      return static_cast<int64_t>(u >> 1) ^ -static_cast<int64_t>(u & 1);
+   }
+
+
+      // Find the least power of ten p for which every value (stride
+      // apart) is exactly k/10^p for an integer k; return -1 if none.
+   static int decimalPower(const double *v, unsigned n, unsigned stride)
+   {
+      for(unsigned i = 0; i < n; i++)
+      {
+         if(!std::isfinite(v[i*stride]))
+            return -1;
+      }
+      for(int p = 0; p <= maxPower; p++)
+      {
+         bool ok(true);
+         for(unsigned i = 0; ok && i < n; i++)
+         {
+            double x(v[i*stride] * powersOfTen[p]);
+            if(std::fabs(x) >= maxScaled)
+               return -1;
+            double k(std::floor(x + 0.5));
+            ok = (doubleBits(k / powersOfTen[p]) == doubleBits(v[i*stride]));
+         }
+         if(ok)
+            return p;
+      }
+      return -1;
+   }
+
+
+      // True if a and b are the same time to the bit, so that a
+      // time computed from the grid can stand in for a stored one.
+   static bool identicalTime(const CommonTime& a, const CommonTime& b)
+   {
+      long aday, amsod, bday, bmsod;
+      double afsod, bfsod;
+      TimeSystem ats, bts;
+      a.getInternal(aday, amsod, afsod, ats);
+      b.getInternal(bday, bmsod, bfsod, bts);
+      return (aday == bday && amsod == bmsod && afsod == bfsod && ats == bts);
+   }
+
+
+   const unsigned ArchiveTable::BlockSize;
+
+
+   ArchiveTable ::
+   ArchiveTable(unsigned nfields)
+         : nf(nfields), count(0), step(0.0), lastSlot(0)
+   {
+   }
+
+
+   CommonTime ArchiveTable ::
+   slotTime(int64_t slot) const
+   {
+      CommonTime t(first);
+      if(slot != 0)
+         t += static_cast<double>(slot) * step;
+      return t;
+   }
+
+
+   CommonTime ArchiveTable ::
+   getTime(std::size_t j) const
+   {
+      return slotTime(slots.empty() ? int64_t(j) : int64_t(slots[j]));
+   }
+
+
+   std::size_t ArchiveTable ::
+   lowerBound(const CommonTime& t) const
+   {
+      if(count == 0)
+         return 0;
+
+         // first guess from the grid
+      std::size_t k(0);
+      if(count > 1)
+      {
+         double x(std::ceil((t - first) / step));
+         if(x > 0.0)
+         {
+            double maxSlot(static_cast<double>(lastSlot) + 1.0);
+            int64_t slot(static_cast<int64_t>(x < maxSlot ? x : maxSlot));
+            if(slots.empty())
+               k = static_cast<std::size_t>(slot);
+            else
+               k = std::lower_bound(slots.begin(), slots.end(), slot)
+                  - slots.begin();
+         }
+      }
+
+         // then make sure of it using the times themselves
+      while(k > 0 && !(getTime(k-1) < t))
+         --k;
+      while(k < count && getTime(k) < t)
+         ++k;
+
+      return k;
+   }
+
+
+   bool ArchiveTable ::
+   append(const CommonTime& t, const double *fields)
+   {
+      if(count == 0)
+      {
+         first = t;
+         lastSlot = 0;
+      }
+      else if(count == 1)
+      {
+         double dt(t - first);
+         if(!(dt > 0.0))
+            return false;
+         step = dt;
+         if(!identicalTime(slotTime(1), t))
+         {
+            step = 0.0;
+            return false;
+         }
+         lastSlot = 1;
+      }
+      else
+      {
+         double x(std::floor((t - first) / step + 0.5));
+         if(!(x > static_cast<double>(lastSlot)) || x >= 4294967296.0)
+            return false;
+         int64_t slot(static_cast<int64_t>(x));
+         if(!identicalTime(slotTime(slot), t))
+            return false;
+         if(slot != lastSlot+1 && slots.empty())
+         {
+               // the first hole; number the records so far
+            slots.reserve(count+1);
+            for(std::size_t j = 0; j < count; j++)
+               slots.push_back(static_cast<uint32_t>(j));
+         }
+         if(!slots.empty())
+            slots.push_back(static_cast<uint32_t>(slot));
+         lastSlot = slot;
+      }
+
+         // reopen a partial last block, see shrink()
+      if(tail.empty() && count % BlockSize != 0)
+      {
+         std::size_t b(blockStart.size()-1);
+         tail.resize((count - b*BlockSize)*nf);
+         decodeBlock(b, &tail[0]);
+         bytes.resize(blockStart[b]);
+         blockStart.pop_back();
+      }
+
+      tail.insert(tail.end(), fields, fields+nf);
+      count++;
+      if(tail.size() == BlockSize*nf)
+         encodeBlock();
+      return true;
+   }
+
+
+   void ArchiveTable ::
+   encodeBlock()
+   {
+      const unsigned n(tail.size() / nf);
+      blockStart.push_back(static_cast<uint32_t>(bytes.size()));
+      for(unsigned f = 0; f < nf; f++)
+      {
+         const double *v(&tail[f]);
+         uint64_t bits0(doubleBits(v[0]));
+         bool constant(true);
+         for(unsigned i = 1; constant && i < n; i++)
+            constant = (doubleBits(v[i*nf]) == bits0);
+         if(constant)
+         {
+            if(bits0 == 0)
+               bytes.push_back(fieldZero << 5);
+            else
+            {
+               bytes.push_back(fieldConstant << 5);
+               putDouble(bytes, v[0]);
+            }
+            continue;
+         }
+
+         int p(decimalPower(v, n, nf));
+         if(p < 0)
+         {
+            bytes.push_back(fieldRaw << 5);
+            for(unsigned i = 0; i < n; i++)
+               putDouble(bytes, v[i*nf]);
+            continue;
+         }
+
+         bytes.push_back(static_cast<unsigned char>((fieldDecimal << 5) | p));
+         int64_t k0(0), k1(0);
+         for(unsigned i = 0; i < n; i++)
+         {
+            int64_t k(static_cast<int64_t>(
+                         std::floor(v[i*nf] * powersOfTen[p] + 0.5)));
+            if(i == 0)
+               putVarint(bytes, k);
+            else if(i == 1)
+               putVarint(bytes, k - k1);
+            else
+               putVarint(bytes, k - 2*k1 + k0);
+            k0 = k1;
+            k1 = k;
+         }
+      }
+      tail.clear();
+   }
+
+
+   void ArchiveTable ::
+   decodeBlock(std::size_t b, double *out) const
+   {
+      const unsigned n(std::min<std::size_t>(BlockSize, count - b*BlockSize));
+      const unsigned char *p(&bytes[blockStart[b]]);
+      for(unsigned f = 0; f < nf; f++)
+      {
+         unsigned char head(*p++);
+         switch(head >> 5)
+         {
+            case fieldZero:
+               for(unsigned i = 0; i < n; i++)
+                  out[i*nf+f] = 0.0;
+               break;
+            case fieldConstant:
+            {
+               double d(getDouble(p));
+               for(unsigned i = 0; i < n; i++)
+                  out[i*nf+f] = d;
+               break;
+            }
+            case fieldDecimal:
+            {
+               double scale(powersOfTen[head & 0x1f]);
+               int64_t k(0), d(0);
+               for(unsigned i = 0; i < n; i++)
+               {
+                  if(i == 0)
+                     k = getVarint(p);
+                  else if(i == 1)
+                  {
+                     d = getVarint(p);
+                     k += d;
+                  }
+                  else
+                  {
+                     d += getVarint(p);
+                     k += d;
+                  }
+                  out[i*nf+f] = static_cast<double>(k) / scale;
+               }
+               break;
+            }
+            default:
+               for(unsigned i = 0; i < n; i++)
+                  out[i*nf+f] = getDouble(p);
+               break;
+         }
+      }
+   }
+
+
+   void ArchiveTable ::
+   getRecords(std::size_t j1, std::size_t j2,
+              std::vector<double>& fields) const
+   {
+      fields.resize((j2-j1+1)*nf);
+      vector<double> block(BlockSize*nf);
+      const std::size_t nblocks(blockStart.size());
+      std::size_t j(j1);
+      while(j <= j2)
+      {
+         std::size_t b(j / BlockSize), first(b * BlockSize);
+         const double *src;
+         if(b < nblocks)
+         {
+            decodeBlock(b, &block[0]);
+            src = &block[0];
+         }
+         else
+            src = &tail[0];
+         std::size_t last(std::min(j2, first + BlockSize - 1));
+         std::copy(src + (j-first)*nf, src + (last-first+1)*nf,
+                   fields.begin() + (j-j1)*nf);
+         j = last + 1;
+      }
+   }
+
+
+   void ArchiveTable ::
+   shrink()
+   {
+      if(!tail.empty())
+         encodeBlock();
+      vector<unsigned char>(bytes).swap(bytes);
+      vector<uint32_t>(blockStart).swap(blockStart);
+      vector<uint32_t>(slots).swap(slots);
+      vector<double>(tail).swap(tail);
+   }
+
+
+   std::size_t ArchiveTable ::
+   memoryUsage() const throw()
+   {
+      return sizeof(*this) + bytes.capacity()
+         + blockStart.capacity() * sizeof(uint32_t)
+         + slots.capacity() * sizeof(uint32_t)
+         + tail.capacity() * sizeof(double);
+   }
+
+}  // namespace gpstk
@@ -0,0 +1,180 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+/// @file ArchiveTable.hpp
+/// Compact storage of a time-ordered table of fixed-size records.
+
+#ifndef GPSTK_ARCHIVETABLE_HPP
+#define GPSTK_ARCHIVETABLE_HPP
+
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+#include "CommonTime.hpp"
+
+namespace gpstk
+{
+      /// @ingroup GNSSEph
+      //@{
+
+      /** Time-ordered table of records, each made of the same number
+       * of double fields, stored far more compactly than a
+       * std::map<CommonTime, record>.  It is used by TabularSatStore
+       * to archive the table of one satellite.
+       *
+       * Record times are not stored: the table keeps the first time
+       * and the time step, and a record's time is the first time plus
+       * its slot number times the step.  Only a table with holes in
+       * it keeps the slot number of each record.  Records may only
+       * be appended, at a time on the grid after the last record.
+       *
+       * The records are encoded in blocks of BlockSize.  Each field
+       * of a block is stored in the cheapest form that reproduces it
+       * exactly: nothing if it is zero throughout, one value if it is
+       * constant, and otherwise, if all its values are decimal
+       * numbers of at most 22 places (as the values read from SP3 and
+       * RINEX clock files are), as integer multiples of a power of
+       * ten, of which the first value, first difference and then the
+       * second differences are stored as variable length integers.
+       * Any other field is stored as raw doubles.  Decoding returns
+       * every value with exactly the bits it was appended with.  The
+       * records after the last full block are kept unencoded until
+       * the block is full or shrink() is called. */
+   class ArchiveTable
+   {
+   public:
+         /// Number of records encoded together.
+      static const unsigned BlockSize = 32;
+
+         /** Make an empty table of records with the given number of
+          * fields. */
+      explicit ArchiveTable(unsigned nfields = 0);
+
+         /// Number of fields in each record.
+      unsigned numFields() const throw()
+      { return nf; }
+
+         /// Number of records in the table.
+      std::size_t size() const throw()
+      { return count; }
+
+         /// True if the table holds no records.
+      bool empty() const throw()
+      { return (count == 0); }
+
+         /// Time step in seconds, 0 if there are fewer than 2 records.
+      double getStep() const throw()
+      { return step; }
+
+         /// True if some slots between the first and last record are empty.
+      bool hasHoles() const throw()
+      { return !slots.empty(); }
+
+         /// Time of record j (< size()).
+      CommonTime getTime(std::size_t j) const;
+
+         /// Time of the first record; the table must not be empty.
+      CommonTime firstTime() const
+      { return first; }
+
+         /// Time of the last record; the table must not be empty.
+      CommonTime lastTime() const
+      { return getTime(count-1); }
+
+         /** Return the index of the first record with time >= t, or
+          * size() if there is none. */
+      std::size_t lowerBound(const CommonTime& t) const;
+
+         /** Append a record.
+          * @param[in] t time of the record; the first two records set
+          *   the start and step of the time grid, later ones must lie
+          *   on it, after the last record.
+          * @param[in] fields numFields() values.
+          * @return false, leaving the table unchanged, if t is not
+          *   after the last time or is not (exactly) on the grid. */
+      bool append(const CommonTime& t, const double *fields);
+
+         /** Decode the records j1 through j2 (j1 <= j2 < size()) into
+          * fields, numFields() values per record. */
+      void getRecords(std::size_t j1, std::size_t j2,
+                      std::vector<double>& fields) const;
+
+         /** Encode the records after the last full block, and
+          * release memory held for future appends.  Appending again
+          * decodes those records. */
+      void shrink();
+
+         /// Number of bytes used by the table, including itself.
+      std::size_t memoryUsage() const throw();
+
+   private:
+         /// Encode the records in tail as a block, and clear it.
+      void encodeBlock();
+
+         /** Decode block b into out, nf values for each of its
+          * records (BlockSize, except in a partial last block). */
+      void decodeBlock(std::size_t b, double *out) const;
+
+         /// Time of the given slot on the grid.
+      CommonTime slotTime(int64_t slot) const;
+
+         /// Number of fields in each record.
+      unsigned nf;
+         /// Number of records.
+      std::size_t count;
+         /// Time of the first record.
+      CommonTime first;
+         /// Time step in seconds.
+      double step;
+         /// Slot of the last record.
+      int64_t lastSlot;
+         /// Slot of each record, only if there are holes.
+      std::vector<uint32_t> slots;
+         /// Encoded blocks.
+      std::vector<unsigned char> bytes;
+         /// Start of each block in bytes.
+      std::vector<uint32_t> blockStart;
+         /// Fields of the records after the last block, in order.
+      std::vector<double> tail;
+   };
+
+      //@}
+
+}  // namespace gpstk
+
+#endif // GPSTK_ARCHIVETABLE_HPP
@@ -0,0 +1,924 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+
+/// @file ChebyshevEphemerisStore.cpp
+/// Store satellite orbits and clocks as piecewise Chebyshev polynomials
+/// fitted to another XvtStore.
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+
+#include "ChebyshevEphemerisStore.hpp"
+#include "BinUtils.hpp"
+#include "GNSSconstants.hpp"
+#include "StringUtils.hpp"
+#include "TimeString.hpp"
+
+using namespace std;
+
+namespace gpstk
+{
+      // Identifies the binary form, followed by its version.  Version
+      // 1 has no reference frames.
+   static const char chebMagic[8] = { 'G','P','S','T','K','C','H','B' };
+   static const uint16_t chebVersion = 2;
+
+
+      // Evaluate sum(c[k]*T_k(tau), k=0..n-1) and its derivative with
+      // respect to tau by Clenshaw's recurrence.
+   static void chebyshevSum(const double *c, unsigned n, double tau,
+                            double& f, double& df)
+   {
+      double b1 = 0.0, b2 = 0.0, d1 = 0.0, d2 = 0.0;
+      for (int k = int(n)-1; k >= 1; k--)
+      {
+         double b0 = c[k] + 2.0*tau*b1 - b2;
+         double d0 = 2.0*b1 + 2.0*tau*d1 - d2;
+         b2 = b1; b1 = b0;
+         d2 = d1; d1 = d0;
+      }
+      f = c[0] + tau*b1 - b2;
+      df = b1 + tau*d1 - d2;
+   }
+
+
+      // Return true if a source sample can be used in a fit.
+   static bool usableSample(const Xvt& xvt)
+   {
+      return (xvt.health != Xvt::HealthStatus::Unavailable &&
+              xvt.health != Xvt::HealthStatus::Uninitialized);
+   }
+
+
+      // Rank of a health value for worseHealth(); higher is worse.
+   static int healthRank(Xvt::HealthStatus health)
+   {
+      switch (health)
+      {
+         case Xvt::HealthStatus::Healthy:       return 0;
+         case Xvt::HealthStatus::Unused:        return 1;
+         case Xvt::HealthStatus::Unknown:       return 2;
+         case Xvt::HealthStatus::Degraded:      return 3;
+         case Xvt::HealthStatus::Uninitialized: return 4;
+         case Xvt::HealthStatus::Unavailable:   return 5;
+         default:                               return 6;
+      }
+   }
+
+
+   ChebyshevEphemerisStore ::
+   ChebyshevEphemerisStore()
+         : posTolerance(1.0e-3), clkTolerance(1.0e-12), numNodes(16),
+           minSpan(60.0), maxSpan(14400.0), maxPosError(0.0),
+           maxClkError(0.0)
+   {
+      onlyHealthy = false;
+   }
+
+
+   Xvt::HealthStatus ChebyshevEphemerisStore ::
+   worseHealth(Xvt::HealthStatus a, Xvt::HealthStatus b)
+   {
+      return (healthRank(b) > healthRank(a) ? b : a);
+   }
+
+
+   const ChebyshevEphemerisStore::Segment* ChebyshevEphemerisStore ::
+   findSegment(const Series& series, double dt)
+   {
+         // last segment that begins at or before dt
+      vector<Segment>::const_iterator it = upper_bound(
+         series.segments.begin(), series.segments.end(), dt,
+         [](double t, const Segment& seg) { return t < seg.begin; });
+      if (it == series.segments.begin())
+         return NULL;
+      --it;
+      if (dt > it->end)
+         return NULL;
+      return &(*it);
+   }
+
+
+   void ChebyshevEphemerisStore ::
+   evaluate(const Series& series, const Segment& seg, unsigned dims,
+            double dt, double *f, double *df)
+   {
+      double half = 0.5 * (seg.end - seg.begin);
+      double tau = (dt - 0.5*(seg.begin + seg.end)) / half;
+      const double *c = &series.coef[seg.offset];
+      for (unsigned i = 0; i < dims; i++)
+      {
+         chebyshevSum(c, seg.count[i], tau, f[i], df[i]);
+         df[i] /= half;
+         c += seg.count[i];
+      }
+   }
+
+
+   bool ChebyshevEphemerisStore ::
+   lookup(const SatID& sat, const CommonTime& t, Xvt& xvt) const
+   {
+      map<SatID, SatTable>::const_iterator it = tables.find(sat);
+      if (it == tables.end())
+         return false;
+      double dt = t - refEpoch;
+      const Segment *orb = findSegment(it->second.orbit, dt);
+      const Segment *clk = findSegment(it->second.clock, dt);
+      if (orb == NULL || clk == NULL)
+         return false;
+      double f[3], df[3];
+      evaluate(it->second.orbit, *orb, 3, dt, f, df);
+      for (int i = 0; i < 3; i++)
+      {
+         xvt.x[i] = f[i];
+         xvt.v[i] = df[i];
+      }
+      evaluate(it->second.clock, *clk, 1, dt, f, df);
+      xvt.clkbias = f[0];
+      xvt.clkdrift = df[0];
+      xvt.computeRelativityCorrection();
+      xvt.health = worseHealth(static_cast<Xvt::HealthStatus>(orb->health),
+                               static_cast<Xvt::HealthStatus>(clk->health));
+      xvt.frame = static_cast<ReferenceFrame>(orb->frame);
+      return true;
+   }
+
+
+   Xvt ChebyshevEphemerisStore ::
+   getXvt(const SatID& sat, const CommonTime& t) const
+   {
+      Xvt xvt;
+      if (!lookup(sat, t, xvt))
+      {
+         InvalidRequest e("No Chebyshev segment for " +
+                          StringUtils::asString(sat) + " at " +
+                          printTime(t, "%Y/%02m/%02d %2H:%02M:%02S"));
+         GPSTK_THROW(e);
+      }
+      if (onlyHealthy && xvt.health == Xvt::HealthStatus::Unhealthy)
+      {
+         InvalidRequest e("Not healthy");
+         GPSTK_THROW(e);
+      }
+      return xvt;
+   }
+
+
+   Xvt ChebyshevEphemerisStore ::
+   computeXvt(const SatID& sat, const CommonTime& t) const throw()
+   {
+      Xvt xvt;
+      try
+      {
+         if (lookup(sat, t, xvt))
+            return xvt;
+      }
+      catch (...)
+      {
+      }
+      xvt = Xvt();
+      xvt.health = Xvt::HealthStatus::Unavailable;
+      return xvt;
+   }
+
+
+   Xvt::HealthStatus ChebyshevEphemerisStore ::
+   getSVHealth(const SatID& sat, const CommonTime& t) const throw()
+   {
+      try
+      {
+         map<SatID, SatTable>::const_iterator it = tables.find(sat);
+         if (it != tables.end())
+         {
+            const Segment *orb = findSegment(it->second.orbit, t - refEpoch);
+            const Segment *clk = findSegment(it->second.clock, t - refEpoch);
+            if (orb != NULL && clk != NULL)
+               return worseHealth(
+                  static_cast<Xvt::HealthStatus>(orb->health),
+                  static_cast<Xvt::HealthStatus>(clk->health));
+         }
+      }
+      catch (...)
+      {
+      }
+      return Xvt::HealthStatus::Unavailable;
+   }
+
+
+   void ChebyshevEphemerisStore ::
+   dump(std::ostream& s, short detail) const
+   {
+      s << "Dump of ChebyshevEphemerisStore:" << endl
+        << " " << tables.size() << " satellites, " << numSegments()
+        << " segments, " << numCoefficients() << " coefficients" << endl
+        << " Tolerances " << posTolerance << " m, " << clkTolerance
+        << " s; worst fit " << maxPosError << " m, " << maxClkError
+        << " s" << endl
+        << " " << numNodes << " nodes, spans " << minSpan << " to "
+        << maxSpan << " s" << endl;
+      if (tables.empty() || detail < 1)
+         return;
+      s << " Time span "
+        << printTime(getInitialTime(), "%Y/%02m/%02d %2H:%02M:%02S")
+        << " to " << printTime(getFinalTime(), "%Y/%02m/%02d %2H:%02M:%02S")
+        << endl;
+      for (map<SatID, SatTable>::const_iterator it = tables.begin();
+           it != tables.end(); ++it)
+      {
+         s << " " << it->first << ": "
+           << it->second.orbit.segments.size() << " orbit segments, "
+           << it->second.clock.segments.size() << " clock segments, "
+           << (it->second.orbit.coef.size() + it->second.clock.coef.size())
+           << " coefficients" << endl;
+         if (detail < 2)
+            continue;
+         for (int part = 0; part < 2; part++)
+         {
+            const Series& series = (part ? it->second.clock
+                                    : it->second.orbit);
+            for (size_t i = 0; i < series.segments.size(); i++)
+            {
+               const Segment& seg = series.segments[i];
+               s << (part ? "   clock " : "   orbit ")
+                 << printTime(refEpoch + seg.begin,
+                              "%Y/%02m/%02d %2H:%02M:%06.3f")
+                 << " to " << printTime(refEpoch + seg.end,
+                                        "%Y/%02m/%02d %2H:%02M:%06.3f")
+                 << " coefficients";
+               for (int j = 0; j < (part ? 1 : 3); j++)
+                  s << " " << int(seg.count[j]);
+               s << " health "
+                 << static_cast<Xvt::HealthStatus>(seg.health);
+               if (!part)
+                  s << " frame " << static_cast<ReferenceFrame>(seg.frame);
+               s << endl;
+            }
+         }
+      }
+   }
+
+
+   void ChebyshevEphemerisStore ::
+   copySegment(const Series& from, const Segment& seg, unsigned dims,
+               Series& to)
+   {
+      unsigned n = 0;
+      for (unsigned i = 0; i < dims; i++)
+         n += seg.count[i];
+      Segment copy(seg);
+      copy.offset = to.coef.size();
+      to.segments.push_back(copy);
+      to.coef.insert(to.coef.end(), from.coef.begin() + seg.offset,
+                     from.coef.begin() + seg.offset + n);
+   }
+
+
+   void ChebyshevEphemerisStore ::
+   edit(const CommonTime& tmin, const CommonTime& tmax)
+   {
+      double dtmin = tmin - refEpoch, dtmax = tmax - refEpoch;
+      map<SatID, SatTable>::iterator it = tables.begin();
+      while (it != tables.end())
+      {
+         SatTable kept;
+         for (int part = 0; part < 2; part++)
+         {
+            Series& series = (part ? it->second.clock : it->second.orbit);
+            Series& keep = (part ? kept.clock : kept.orbit);
+            for (size_t i = 0; i < series.segments.size(); i++)
+            {
+               const Segment& seg = series.segments[i];
+               if (seg.end >= dtmin && seg.begin <= dtmax)
+                  copySegment(series, seg, (part ? 1 : 3), keep);
+            }
+         }
+         if (kept.orbit.segments.empty() || kept.clock.segments.empty())
+         {
+            tables.erase(it++);
+         }
+         else
+         {
+            std::swap(it->second, kept);
+            ++it;
+         }
+      }
+   }
+
+
+   void ChebyshevEphemerisStore ::
+   clear()
+   {
+      tables.clear();
+      maxPosError = 0.0;
+      maxClkError = 0.0;
+   }
+
+
+   CommonTime ChebyshevEphemerisStore ::
+   getInitialTime() const
+   {
+      if (tables.empty())
+      {
+         InvalidRequest e("ChebyshevEphemerisStore is empty");
+         GPSTK_THROW(e);
+      }
+      double dt = 0.0;
+      for (map<SatID, SatTable>::const_iterator it = tables.begin();
+           it != tables.end(); ++it)
+      {
+         double sat = std::max(it->second.orbit.segments.front().begin,
+                               it->second.clock.segments.front().begin);
+         if (it == tables.begin() || sat < dt)
+            dt = sat;
+      }
+      return refEpoch + dt;
+   }
+
+
+   CommonTime ChebyshevEphemerisStore ::
+   getFinalTime() const
+   {
+      if (tables.empty())
+      {
+         InvalidRequest e("ChebyshevEphemerisStore is empty");
+         GPSTK_THROW(e);
+      }
+      double dt = 0.0;
+      for (map<SatID, SatTable>::const_iterator it = tables.begin();
+           it != tables.end(); ++it)
+      {
+         double sat = std::min(it->second.orbit.segments.back().end,
+                               it->second.clock.segments.back().end);
+         if (it == tables.begin() || sat > dt)
+            dt = sat;
+      }
+      return refEpoch + dt;
+   }
+
+
+   std::set<SatID> ChebyshevEphemerisStore ::
+   getIndexSet() const
+   {
+      set<SatID> rv;
+      for (map<SatID, SatTable>::const_iterator it = tables.begin();
+           it != tables.end(); ++it)
+         rv.insert(it->first);
+      return rv;
+   }
+
+
+   unsigned long ChebyshevEphemerisStore ::
+   numSegments() const
+   {
+      unsigned long n = 0;
+      for (map<SatID, SatTable>::const_iterator it = tables.begin();
+           it != tables.end(); ++it)
+         n += it->second.orbit.segments.size() +
+            it->second.clock.segments.size();
+      return n;
+   }
+
+
+   unsigned long ChebyshevEphemerisStore ::
+   numCoefficients() const
+   {
+      unsigned long n = 0;
+      for (map<SatID, SatTable>::const_iterator it = tables.begin();
+           it != tables.end(); ++it)
+         n += it->second.orbit.coef.size() + it->second.clock.coef.size();
+      return n;
+   }
+
+
+   void ChebyshevEphemerisStore ::
+   setPositionTolerance(double tol)
+   {
+      if (!(tol > 0.0))
+      {
+         InvalidParameter e("Position tolerance must be positive");
+         GPSTK_THROW(e);
+      }
+      posTolerance = tol;
+   }
+
+
+   void ChebyshevEphemerisStore ::
+   setClockTolerance(double tol)
+   {
+      if (!(tol > 0.0))
+      {
+         InvalidParameter e("Clock tolerance must be positive");
+         GPSTK_THROW(e);
+      }
+      clkTolerance = tol;
+   }
+
+
+   void ChebyshevEphemerisStore ::
+   setNumNodes(unsigned n)
+   {
+      if (n < 2 || n > MaxCoefficients)
+      {
+         InvalidParameter e("Number of nodes must be from 2 to " +
+                            StringUtils::asString(MaxCoefficients));
+         GPSTK_THROW(e);
+      }
+      numNodes = n;
+   }
+
+
+   void ChebyshevEphemerisStore ::
+   setSpanLimits(double minSec, double maxSec)
+   {
+      if (!(minSec > 0.0) || !(maxSec >= minSec))
+      {
+         InvalidParameter e("Segment spans must satisfy 0 < min <= max");
+         GPSTK_THROW(e);
+      }
+      minSpan = minSec;
+      maxSpan = maxSec;
+   }
+
+
+   void ChebyshevEphemerisStore ::
+   fit(const XvtStore<SatID>& source,
+       const CommonTime& begin, const CommonTime& end)
+   {
+      set<SatID> sats = source.getIndexSet();
+      for (set<SatID>::const_iterator it = sats.begin();
+           it != sats.end(); ++it)
+         fit(source, *it, begin, end);
+   }
+
+
+   void ChebyshevEphemerisStore ::
+   fit(const XvtStore<SatID>& source, const SatID& sat,
+       const CommonTime& begin, const CommonTime& end)
+   {
+      if (tables.empty())
+         refEpoch = begin;
+      double b, e;
+      try
+      {
+         b = begin - refEpoch;
+         e = end - refEpoch;
+      }
+      catch (InvalidRequest& exc)
+      {
+         GPSTK_RETHROW(exc);
+      }
+      if (!(e > b))
+      {
+         InvalidRequest exc("Fit span end must be after its beginning");
+         GPSTK_THROW(exc);
+      }
+
+      SatTable old, table;
+      map<SatID, SatTable>::iterator it = tables.find(sat);
+      if (it != tables.end())
+         std::swap(old, it->second);
+
+      for (int part = 0; part < 2; part++)
+      {
+         const Series& prev = (part ? old.clock : old.orbit);
+         Series& series = (part ? table.clock : table.orbit);
+         unsigned dims = (part ? 1 : 3);
+            // keep the segments wholly outside [b,e] and refit the
+            // rest, including all of any segment that straddles b or e
+         double pb = b, pe = e;
+         size_t i = 0;
+         for (; i < prev.segments.size() && prev.segments[i].end <= b; i++)
+            copySegment(prev, prev.segments[i], dims, series);
+         size_t j = i;
+         for (; j < prev.segments.size() && prev.segments[j].begin < e; j++)
+         {
+            pb = std::min(pb, prev.segments[j].begin);
+            pe = std::max(pe, prev.segments[j].end);
+         }
+            // equal chunks no longer than maxSpan
+         unsigned chunks =
+            static_cast<unsigned>(std::ceil((pe - pb) / maxSpan));
+         if (chunks == 0)
+            chunks = 1;
+         for (unsigned k = 0; k < chunks; k++)
+         {
+            double cb = pb + (pe - pb) * k / chunks;
+            double ce = (k+1 == chunks ? pe : pb + (pe - pb) * (k+1) / chunks);
+            fitSpan(source, sat, part != 0, cb, ce, series);
+         }
+         for (; j < prev.segments.size(); j++)
+            copySegment(prev, prev.segments[j], dims, series);
+      }
+
+      if (table.orbit.segments.empty() || table.clock.segments.empty())
+         tables.erase(sat);
+      else
+         std::swap(tables[sat], table);
+   }
+
+
+   void ChebyshevEphemerisStore ::
+   fitSpan(const XvtStore<SatID>& source, const SatID& sat, bool clock,
+           double b, double e, Series& series)
+   {
+      const unsigned n = numNodes;
+      const unsigned dims = (clock ? 1 : 3);
+      const double tol = (clock ? clkTolerance : posTolerance);
+      const double mid = 0.5 * (b + e), half = 0.5 * (e - b);
+         // the halves must not be shorter than minSpan
+      const bool canSplit = (half >= minSpan);
+      double f[3][MaxCoefficients], c[3][MaxCoefficients];
+      int minHealth = int(Xvt::HealthStatus::MaxValue);
+      int maxHealth = int(Xvt::HealthStatus::MinValue);
+      Xvt::HealthStatus health = Xvt::HealthStatus::Healthy;
+         // the frame of the first sample, and whether any other differs
+      ReferenceFrame frame = ReferenceFrame::Unknown;
+      bool sameFrame = true;
+      bool usable = true;
+
+         // sample the source at the Chebyshev nodes
+      for (unsigned k = 0; k < n; k++)
+      {
+         Xvt xvt = source.computeXvt(sat, refEpoch +
+                                     (mid + half*std::cos(PI*(k+0.5)/n)));
+         if (!usableSample(xvt))
+         {
+            usable = false;
+            break;
+         }
+         if (clock)
+            f[0][k] = xvt.clkbias;
+         else
+            for (int i = 0; i < 3; i++)
+               f[i][k] = xvt.x[i];
+         if (k == 0)
+            frame = xvt.frame;
+         else if (xvt.frame != frame)
+            sameFrame = false;
+         minHealth = std::min(minHealth, int(xvt.health));
+         maxHealth = std::max(maxHealth, int(xvt.health));
+         health = worseHealth(health, xvt.health);
+      }
+
+      if (usable)
+      {
+         Segment seg;
+         seg.begin = b;
+         seg.end = e;
+         seg.offset = series.coef.size();
+         seg.count[0] = seg.count[1] = seg.count[2] = 0;
+            // coefficients by the discrete cosine transform, then drop
+            // the trailing ones whose sum is small against the tolerance
+         for (unsigned i = 0; i < dims; i++)
+         {
+            for (unsigned j = 0; j < n; j++)
+            {
+               double sum = 0.0;
+               for (unsigned k = 0; k < n; k++)
+                  sum += f[i][k] * std::cos(PI*j*(k+0.5)/n);
+               c[i][j] = (j == 0 ? 1.0 : 2.0) * sum / n;
+            }
+            double dropped = 0.0;
+            unsigned count = n;
+            while (count > 1 && dropped + std::abs(c[i][count-1]) <= 0.1*tol)
+               dropped += std::abs(c[i][--count]);
+            seg.count[i] = static_cast<uint8_t>(count);
+            series.coef.insert(series.coef.end(), c[i], c[i] + count);
+         }
+
+            // compare with the source between the nodes
+         double err = 0.0;
+         unsigned m = 2 * n;
+         for (unsigned k = 0; k <= m; k++)
+         {
+            double dt = b + (e - b) * k / m;
+            Xvt src = source.computeXvt(sat, refEpoch + dt);
+            if (!usableSample(src))
+            {
+               usable = false;
+               break;
+            }
+            double fit[3], dfit[3];
+            evaluate(series, seg, dims, dt, fit, dfit);
+            if (clock)
+            {
+               err = std::max(err, std::abs(fit[0] - src.clkbias));
+            }
+            else
+            {
+               double dx = fit[0] - src.x[0];
+               double dy = fit[1] - src.x[1];
+               double dz = fit[2] - src.x[2];
+               err = std::max(err, std::sqrt(dx*dx + dy*dy + dz*dz));
+            }
+            minHealth = std::min(minHealth, int(src.health));
+            maxHealth = std::max(maxHealth, int(src.health));
+            health = worseHealth(health, src.health);
+            if (src.frame != frame)
+               sameFrame = false;
+         }
+         if (usable &&
+             (!canSplit || (err <= tol && minHealth == maxHealth &&
+                            (clock || sameFrame))))
+         {
+            seg.health = static_cast<uint8_t>(health);
+            seg.frame = static_cast<uint8_t>(clock ? ReferenceFrame::Unknown
+                                             : frame);
+            series.segments.push_back(seg);
+            if (clock)
+               maxClkError = std::max(maxClkError, err);
+            else
+               maxPosError = std::max(maxPosError, err);
+            return;
+         }
+         series.coef.resize(seg.offset);
+      }
+
+         // either split, or leave a gap where the source has no data
+      if (canSplit)
+      {
+         fitSpan(source, sat, clock, b, mid, series);
+         fitSpan(source, sat, clock, mid, e, series);
+      }
+   }
+
+
+      // Append the binary form of series to buf.
+   template <class Series>
+   static void writeSeries(const Series& series, unsigned dims, string& buf)
+   {
+      using BinUtils::encodeVarLE;
+      buf += encodeVarLE<uint32_t>(series.segments.size());
+      for (size_t i = 0; i < series.segments.size(); i++)
+      {
+         buf += encodeVarLE<double>(series.segments[i].begin);
+         buf += encodeVarLE<double>(series.segments[i].end);
+         buf += static_cast<char>(series.segments[i].health);
+         buf += static_cast<char>(series.segments[i].frame);
+         unsigned n = 0;
+         for (unsigned j = 0; j < dims; j++)
+         {
+            buf += static_cast<char>(series.segments[i].count[j]);
+            n += series.segments[i].count[j];
+         }
+         for (unsigned j = 0; j < n; j++)
+            buf += encodeVarLE<double>(
+               series.coef[series.segments[i].offset + j]);
+      }
+   }
+
+
+   void ChebyshevEphemerisStore ::
+   write(std::ostream& s) const
+   {
+      using BinUtils::encodeVarLE;
+      long day, sod;
+      double fsod;
+      TimeSystem ts;
+      refEpoch.get(day, sod, fsod, ts);
+
+      string buf(chebMagic, sizeof(chebMagic));
+      buf += encodeVarLE<uint16_t>(chebVersion);
+      buf += encodeVarLE<int32_t>(static_cast<int32_t>(ts));
+      buf += encodeVarLE<int32_t>(day);
+      buf += encodeVarLE<int32_t>(sod);
+      buf += encodeVarLE<double>(fsod);
+      buf += encodeVarLE<double>(posTolerance);
+      buf += encodeVarLE<double>(clkTolerance);
+      buf += encodeVarLE<double>(maxPosError);
+      buf += encodeVarLE<double>(maxClkError);
+      buf += encodeVarLE<uint32_t>(tables.size());
+      for (map<SatID, SatTable>::const_iterator it = tables.begin();
+           it != tables.end(); ++it)
+      {
+         buf += encodeVarLE<int32_t>(static_cast<int32_t>(it->first.system));
+         buf += encodeVarLE<int32_t>(it->first.id);
+         writeSeries(it->second.orbit, 3, buf);
+         writeSeries(it->second.clock, 1, buf);
+      }
+      s.write(buf.data(), buf.size());
+      if (!s)
+      {
+         InvalidRequest e("Failed to write ChebyshevEphemerisStore");
+         GPSTK_THROW(e);
+      }
+   }
+
+
+      // Decode a value of type T from buf at pos and advance pos,
+      // throwing if buf is too short.
+   template <class T>
+   static T readVar(const string& buf, size_t& pos)
+   {
+      if (buf.size() - pos < sizeof(T))
+      {
+         InvalidRequest e("Truncated ChebyshevEphemerisStore data");
+         GPSTK_THROW(e);
+      }
+      T rv = BinUtils::decodeVarLE<T>(buf, pos);
+      pos += sizeof(T);
+      return rv;
+   }
+
+
+      // Decode the binary form of a series written by writeSeries().
+   template <class Series>
+   static void readSeries(const string& buf, size_t& pos, unsigned dims,
+                          unsigned maxCount, uint16_t version, Series& series)
+   {
+      uint32_t nseg = readVar<uint32_t>(buf, pos);
+      for (uint32_t i = 0; i < nseg; i++)
+      {
+         typename decltype(series.segments)::value_type seg;
+         seg.begin = readVar<double>(buf, pos);
+         seg.end = readVar<double>(buf, pos);
+         seg.health = readVar<uint8_t>(buf, pos);
+         seg.frame = static_cast<uint8_t>(ReferenceFrame::Unknown);
+         if (version > 1)
+            seg.frame = readVar<uint8_t>(buf, pos);
+         if (seg.frame >= static_cast<uint8_t>(ReferenceFrame::Last))
+         {
+            InvalidRequest e("Invalid reference frame in "
+                             "ChebyshevEphemerisStore");
+            GPSTK_THROW(e);
+         }
+         seg.count[0] = seg.count[1] = seg.count[2] = 0;
+         unsigned n = 0;
+         for (unsigned j = 0; j < dims; j++)
+         {
+            seg.count[j] = readVar<uint8_t>(buf, pos);
+            if (seg.count[j] < 1 || seg.count[j] > maxCount)
+            {
+               InvalidRequest e("Invalid coefficient count in "
+                                "ChebyshevEphemerisStore");
+               GPSTK_THROW(e);
+            }
+            n += seg.count[j];
+         }
+         if (!(seg.end > seg.begin) ||
+             (!series.segments.empty() &&
+              seg.begin < series.segments.back().end))
+         {
+            InvalidRequest e("Segments out of order in "
+                             "ChebyshevEphemerisStore");
+            GPSTK_THROW(e);
+         }
+         seg.offset = series.coef.size();
+         for (unsigned j = 0; j < n; j++)
+            series.coef.push_back(readVar<double>(buf, pos));
+         series.segments.push_back(seg);
+      }
+   }
+
+
+   void ChebyshevEphemerisStore ::
+   read(std::istream& s)
+   {
+      string buf((istreambuf_iterator<char>(s)), istreambuf_iterator<char>());
+      if (buf.compare(0, sizeof(chebMagic), chebMagic, sizeof(chebMagic)))
+      {
+         InvalidRequest e("Not ChebyshevEphemerisStore data");
+         GPSTK_THROW(e);
+      }
+      size_t pos = sizeof(chebMagic);
+      uint16_t version = readVar<uint16_t>(buf, pos);
+      if (version < 1 || version > chebVersion)
+      {
+         InvalidRequest e("Unsupported ChebyshevEphemerisStore version " +
+                          StringUtils::asString(version));
+         GPSTK_THROW(e);
+      }
+
+      int32_t ts = readVar<int32_t>(buf, pos);
+      int32_t day = readVar<int32_t>(buf, pos);
+      int32_t sod = readVar<int32_t>(buf, pos);
+      double fsod = readVar<double>(buf, pos);
+      if (ts < 0 || ts >= static_cast<int32_t>(TimeSystem::Last))
+      {
+         InvalidRequest e("Invalid time system in ChebyshevEphemerisStore");
+         GPSTK_THROW(e);
+      }
+      CommonTime epoch;
+      try
+      {
+         epoch.set(day, sod, fsod, static_cast<TimeSystem>(ts));
+      }
+      catch (InvalidParameter& ip)
+      {
+         InvalidRequest e(ip);
+         GPSTK_THROW(e);
+      }
+      double posTol = readVar<double>(buf, pos);
+      double clkTol = readVar<double>(buf, pos);
+      double posErr = readVar<double>(buf, pos);
+      double clkErr = readVar<double>(buf, pos);
+      uint32_t nsat = readVar<uint32_t>(buf, pos);
+
+      map<SatID, SatTable> newTables;
+      for (uint32_t k = 0; k < nsat; k++)
+      {
+         int32_t sys = readVar<int32_t>(buf, pos);
+         int32_t id = readVar<int32_t>(buf, pos);
+         if (sys < 0 || sys >= static_cast<int32_t>(SatelliteSystem::Last))
+         {
+            InvalidRequest e("Invalid satellite system in "
+                             "ChebyshevEphemerisStore");
+            GPSTK_THROW(e);
+         }
+         SatID sat(id, static_cast<SatelliteSystem>(sys));
+         SatTable& table = newTables[sat];
+         readSeries(buf, pos, 3, MaxCoefficients, version, table.orbit);
+         readSeries(buf, pos, 1, MaxCoefficients, version, table.clock);
+         if (table.orbit.segments.empty() || table.clock.segments.empty())
+            newTables.erase(sat);
+      }
+
+      refEpoch = epoch;
+      tables.swap(newTables);
+      posTolerance = posTol;
+      clkTolerance = clkTol;
+      maxPosError = posErr;
+      maxClkError = clkErr;
+   }
+
+
+   void ChebyshevEphemerisStore ::
+   writeFile(const std::string& filename) const
+   {
+      ofstream strm(filename.c_str(), ios::out | ios::binary);
+      if (!strm)
+      {
+         FileMissingException e("Could not open " + filename);
+         GPSTK_THROW(e);
+      }
+      try
+      {
+         write(strm);
+      }
+      catch (InvalidRequest& e)
+      {
+         e.addText("Writing " + filename);
+         GPSTK_RETHROW(e);
+      }
+   }
+
+
+   void ChebyshevEphemerisStore ::
+   loadFile(const std::string& filename)
+   {
+      ifstream strm(filename.c_str(), ios::in | ios::binary);
+      if (!strm)
+      {
+         FileMissingException e("Could not open " + filename);
+         GPSTK_THROW(e);
+      }
+      try
+      {
+         read(strm);
+      }
+      catch (InvalidRequest& e)
+      {
+         e.addText("Reading " + filename);
+         GPSTK_RETHROW(e);
+      }
+   }
+
+} // namespace gpstk
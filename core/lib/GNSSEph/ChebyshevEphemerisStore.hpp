@@ -0,0 +1,355 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+
+/// @file ChebyshevEphemerisStore.hpp
+/// Store satellite orbits and clocks as piecewise Chebyshev polynomials
+/// fitted to another XvtStore.
+
+#ifndef GPSTK_CHEBYSHEVEPHEMERISSTORE_HPP
+#define GPSTK_CHEBYSHEVEPHEMERISSTORE_HPP
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "XvtStore.hpp"
+#include "SatID.hpp"
+
+namespace gpstk
+{
+      /// @ingroup GNSSEph
+      //@{
+
+      /** Compact orbit and clock product made of per-satellite
+       * Chebyshev segments.
+       *
+       * fit() samples any XvtStore<SatID> (OrbitEphStore,
+       * SP3EphemerisStore, GloEphemerisStore, ...) over a time span
+       * and fits, for each satellite, contiguous segments of Chebyshev
+       * expansions of the position components, and separately of the
+       * clock bias, which is rarely as smooth as the orbit over the
+       * same span.  A segment is accepted when the fit agrees
+       * with the source to within the position and clock tolerances
+       * at points between the fit nodes, and is halved otherwise.
+       * Trailing coefficients that are too small to matter are
+       * dropped, so smooth stretches cost few numbers.  Velocity and
+       * clock drift are the derivatives of the fitted polynomials,
+       * and the relativity correction is computed from the fitted
+       * position and velocity.  Each orbit segment keeps the
+       * reference frame the source reported, and a segment is split
+       * where the source changes frame, as it is where the health
+       * changes.
+       *
+       * Where the source can not be evaluated, no segment is made, so
+       * gaps in the source remain gaps here (to a resolution of the
+       * minimum segment span).  A segment that still misses the
+       * tolerance at the minimum span, e.g. one containing the change
+       * from one broadcast ephemeris to the next, is kept anyway;
+       * getMaxPositionError() and getMaxClockError() report the worst
+       * misfit seen at the check points.
+       *
+       * The segments can be written to and read from a compact
+       * binary form with write()/writeFile() and read()/loadFile().
+       *
+       * Lookups are a binary search and a few polynomial evaluations
+       * with no cached state, so a loaded store may be queried from
+       * any number of threads at once (see XvtStore). */
+   class ChebyshevEphemerisStore : public XvtStore<SatID>
+   {
+   public:
+         /// Largest number of coefficients per component in a segment.
+      static const unsigned MaxCoefficients = 32;
+
+         /// Default constructor.
+      ChebyshevEphemerisStore();
+
+         /// Destructor
+      virtual ~ChebyshevEphemerisStore() {}
+
+         /** Returns the position, velocity, and clock offset of the
+          * indicated satellite in ECEF coordinates (meters) at the
+          * indicated time.
+          * @param[in] sat the satellite of interest
+          * @param[in] t the time to look up
+          * @return the Xvt of the satellite at the indicated time
+          * @throw InvalidRequest if no segment covers t, or the
+          *   segment is unhealthy and onlyHealthy is set. */
+      virtual Xvt getXvt(const SatID& sat, const CommonTime& t) const;
+
+         /** Compute the position, velocity and clock offset of the
+          * indicated satellite in ECEF coordinates (meters) at the
+          * indicated time, without throwing.  The health field is
+          * Unavailable if no segment covers t, otherwise it is the
+          * worseHealth() of the orbit and clock segments.
+          * @note This function ignores the onlyHealthy flag.
+          * @param[in] sat the satellite of interest
+          * @param[in] t the time to look up
+          * @return the Xvt of the satellite at the indicated time */
+      virtual Xvt computeXvt(const SatID& sat, const CommonTime& t)
+         const throw();
+
+         /** Get the satellite health at a specific time.
+          * @param[in] sat the satellite of interest
+          * @param[in] t the time to look up
+          * @return the worseHealth() of the orbit and clock segments
+          *   covering t, or Unavailable. */
+      virtual Xvt::HealthStatus getSVHealth(const SatID& sat,
+                                            const CommonTime& t)
+         const throw();
+
+         /** Combine two health values, such as those of the orbit
+          * and clock segments covering a time, into the one to
+          * report.  Unhealthy always wins, then Unavailable,
+          * Uninitialized, Degraded, Unknown, Unused and Healthy, so
+          * the combination is never better than either value.
+          * @param[in] a,b the health values to combine
+          * @return the worse of a and b */
+      static Xvt::HealthStatus worseHealth(Xvt::HealthStatus a,
+                                           Xvt::HealthStatus b);
+
+         /** Dump the store to a stream.
+          * @param[in] s the stream to receive the output
+          * @param[in] detail 0: summary, 1: per satellite,
+          *   2: every segment. */
+      virtual void dump(std::ostream& s = std::cout, short detail = 0) const;
+
+         /** Remove the segments that lie entirely outside [tmin, tmax].
+          * @param[in] tmin defines the beginning of the time interval
+          * @param[in] tmax defines the end of the time interval */
+      virtual void edit(const CommonTime& tmin,
+                        const CommonTime& tmax = CommonTime::END_OF_TIME);
+
+         /// Remove all segments and reset the fit statistics.
+      virtual void clear();
+
+         /// Return the time system of the store.
+      virtual TimeSystem getTimeSystem() const
+      { return refEpoch.getTimeSystem(); }
+
+         /** Return the start of the earliest segment.
+          * @throw InvalidRequest if the store is empty. */
+      virtual CommonTime getInitialTime() const;
+
+         /** Return the end of the latest segment.
+          * @throw InvalidRequest if the store is empty. */
+      virtual CommonTime getFinalTime() const;
+
+         /// Velocity is always available, as the derivative of the fit.
+      virtual bool hasVelocity() const
+      { return true; }
+
+         /// Return true if the store has segments for the satellite.
+      virtual bool isPresent(const SatID& sat) const
+      { return tables.find(sat) != tables.end(); }
+
+         /// Return the satellites that have segments in the store.
+      virtual std::set<SatID> getIndexSet() const;
+
+         /** Fit segments for every satellite in source.getIndexSet()
+          * over [begin, end], replacing any segments those satellites
+          * already have in that span.
+          * @param[in] source the orbits and clocks to compress
+          * @param[in] begin start of the span to fit
+          * @param[in] end end of the span to fit
+          * @throw InvalidRequest if end is not after begin or its time
+          *   system does not match the store's. */
+      void fit(const XvtStore<SatID>& source,
+               const CommonTime& begin, const CommonTime& end);
+
+         /** Fit segments for one satellite over [begin, end],
+          * replacing any segments it already has in that span.
+          * Existing segments that straddle begin or end are refitted
+          * whole.
+          * @param[in] source the orbits and clocks to compress
+          * @param[in] sat the satellite to fit
+          * @param[in] begin start of the span to fit
+          * @param[in] end end of the span to fit
+          * @throw InvalidRequest if end is not after begin or its time
+          *   system does not match the store's. */
+      void fit(const XvtStore<SatID>& source, const SatID& sat,
+               const CommonTime& begin, const CommonTime& end);
+
+         /** Set the largest position misfit (meters, 3D) accepted in
+          * a segment at the check points.
+          * @throw InvalidParameter if tol is not positive. */
+      void setPositionTolerance(double tol);
+      double getPositionTolerance() const
+      { return posTolerance; }
+
+         /** Set the largest clock bias misfit (seconds) accepted in a
+          * segment at the check points.
+          * @throw InvalidParameter if tol is not positive. */
+      void setClockTolerance(double tol);
+      double getClockTolerance() const
+      { return clkTolerance; }
+
+         /** Set the number of fit nodes, which is the largest number
+          * of coefficients kept per component.
+          * @throw InvalidParameter if n is less than 2 or more than
+          *   MaxCoefficients. */
+      void setNumNodes(unsigned n);
+      unsigned getNumNodes() const
+      { return numNodes; }
+
+         /** Set the longest and shortest segment spans in seconds.
+          * Fitting starts with segments of maxSpan and halves them
+          * down to no less than minSpan.
+          * @throw InvalidParameter unless 0 < minSpan <= maxSpan. */
+      void setSpanLimits(double minSpan, double maxSpan);
+      double getMinSpan() const
+      { return minSpan; }
+      double getMaxSpan() const
+      { return maxSpan; }
+
+         /// Largest 3D position misfit (meters) seen while fitting.
+      double getMaxPositionError() const
+      { return maxPosError; }
+
+         /// Largest clock bias misfit (seconds) seen while fitting.
+      double getMaxClockError() const
+      { return maxClkError; }
+
+         /// Total number of segments in the store.
+      unsigned long numSegments() const;
+
+         /// Total number of polynomial coefficients in the store.
+      unsigned long numCoefficients() const;
+
+         /** Write the store in its binary form.
+          * @param[in] s the stream to write to; it should be opened
+          *   in binary mode.
+          * @throw InvalidRequest if the stream fails. */
+      void write(std::ostream& s) const;
+
+         /** Replace the contents of the store with the binary form
+          * read from a stream, as written by write().
+          * @param[in] s the stream to read from; it should be opened
+          *   in binary mode.
+          * @throw InvalidRequest if the data is truncated or is not
+          *   a store written by write(). */
+      void read(std::istream& s);
+
+         /** Write the store in its binary form to a file.
+          * @throw FileMissingException if the file can not be opened.
+          * @throw InvalidRequest if writing fails. */
+      void writeFile(const std::string& filename) const;
+
+         /** Replace the contents of the store with those of a file
+          * written by writeFile().
+          * @throw FileMissingException if the file can not be opened.
+          * @throw InvalidRequest if the file is not a valid store. */
+      void loadFile(const std::string& filename);
+
+   private:
+         /// One fitted interval of one quantity for one satellite.
+      struct Segment
+      {
+            /// Start and end in seconds from refEpoch.
+         double begin, end;
+            /// Index of the first coefficient in Series::coef.
+         uint32_t offset;
+            /// Coefficient count for each dimension (x, y, z or bias).
+         uint8_t count[3];
+            /// Xvt::HealthStatus reported by the source.
+         uint8_t health;
+            /// ReferenceFrame of the source's positions; Unknown for
+            /// clock segments.
+         uint8_t frame;
+      };
+
+         /// The segments of one quantity, in time order, and their
+         /// coefficients, packed in segment order.
+      struct Series
+      {
+         std::vector<Segment> segments;
+         std::vector<double> coef;
+      };
+
+         /// The orbit (x, y, z) and clock (bias) of one satellite are
+         /// segmented separately, as they are smooth over very
+         /// different spans.
+      struct SatTable
+      {
+         Series orbit;
+         Series clock;
+      };
+
+         /// Return the segment of series covering dt, or NULL.
+      static const Segment* findSegment(const Series& series, double dt);
+
+         /** Evaluate the dims components of seg at dt into f, and
+          * their time derivatives into df. */
+      static void evaluate(const Series& series, const Segment& seg,
+                           unsigned dims, double dt, double *f, double *df);
+
+         /// Look up and evaluate; false if no segment covers t.
+      bool lookup(const SatID& sat, const CommonTime& t, Xvt& xvt) const;
+
+         /** Fit [b, e] (seconds from refEpoch) of the orbit or clock
+          * of sat, halving as needed, and append the accepted
+          * segments to series. */
+      void fitSpan(const XvtStore<SatID>& source, const SatID& sat,
+                   bool clock, double b, double e, Series& series);
+
+         /// Append a copy of seg and its coefficients from one series
+         /// to another.
+      static void copySegment(const Series& from, const Segment& seg,
+                              unsigned dims, Series& to);
+
+         /// Origin of all segment times.
+      CommonTime refEpoch;
+         /// Segments per satellite.
+      std::map<SatID, SatTable> tables;
+
+      double posTolerance;
+      double clkTolerance;
+      unsigned numNodes;
+      double minSpan;
+      double maxSpan;
+      double maxPosError;
+      double maxClkError;
+   }; // end class ChebyshevEphemerisStore
+
+      //@}
+
+} // namespace gpstk
+
+#endif // GPSTK_CHEBYSHEVEPHEMERISSTORE_HPP
@@ -85,6 +85,9 @@ namespace gpstk
             return rec;
          }
 
+         if(useInterpCache && interpType == 2)
+            return getCachedValue(sat, ttag, isExact, it1, it2);
+
          // pull data out of the data table
          size_t n,Nlow(Nhalf-1),Nhi(Nhalf),Nmatch(Nhalf);
          CommonTime ttag0(it1->first);
@@ -192,6 +195,75 @@ namespace gpstk
       catch(InvalidRequest& e) { GPSTK_RETHROW(e); }
    }
 
+   // Interpolate for getValue() using the interpolation cache; this follows
+   // the Lagrange branches of getValue(), but computes the Lagrange
+   // coefficients once for all the components, using weights kept with the
+   // cached interval.
+   ClockRecord ClockSatStore::getCachedValue(const SatID& sat,
+                                             const CommonTime& ttag,
+                                             bool isExact,
+                                             const DataTableIterator& it1,
+                                             const DataTableIterator& it2)
+      const
+   {
+      size_t n,N,Nlow(Nhalf-1),Nhi(Nhalf),Nmatch(Nhalf);
+      ClockRecord rec;
+      shared_ptr<const InterpWindow> win(getInterpWindow(sat, it1, it2));
+      const vector<ClockRecord>& recs(win->recs);
+      const vector<double>& times(win->times);
+      double dt(ttag - win->first);       // dt in seconds
+      N = recs.size();
+
+      // find index of matching time tag
+      if(isExact)
+         for(n=0; n<N; n++)
+            if(ABS(times[n] - dt) < 1.e-8)
+               Nmatch = n;
+      if(isExact && Nmatch == Nhalf-1) { Nlow++; Nhi++; }
+
+      // Lagrange coefficients for value (L) and derivative (Lp)
+      vector<double> L,Lp;
+      LagrangeCoefficients(times, win->weights, dt, L, Lp);
+
+      double bias(0.0),dbias(0.0),drift(0.0),ddrift(0.0),accel(0.0);
+      for(n=0; n<N; n++) {
+         bias += L[n]*recs[n].bias;
+         dbias += Lp[n]*recs[n].bias;
+         drift += L[n]*recs[n].drift;
+         ddrift += Lp[n]*recs[n].drift;
+         accel += L[n]*recs[n].accel;
+      }
+
+      rec.accel = rec.sig_accel = 0.0;              // defaults
+      rec.bias = bias;                                       // sec
+      if(isExact)
+         rec.sig_bias = recs[Nmatch].sig_bias;
+      else
+         rec.sig_bias = RSS(recs[Nhi].sig_bias,recs[Nlow].sig_bias);
+      if(haveClockDrift) {
+         rec.drift = drift;                                  // sec/sec
+         rec.sig_drift = RSS(recs[Nhi].sig_drift,recs[Nlow].sig_drift);
+      }
+      else {                              // must interpolate biases to get drift
+         rec.drift = dbias;                                  // sec/sec
+         rec.sig_drift = rec.sig_bias/(times[Nhi]-times[Nlow]);
+      }
+
+      if(haveClockAccel) {
+         rec.accel = accel;                                  // sec/sec^2
+         if(isExact)
+            rec.sig_accel = recs[Nmatch].sig_accel;
+         else
+            rec.sig_accel = RSS(recs[Nhi].sig_accel,recs[Nlow].sig_accel);
+      }
+      else if(haveClockDrift) {              // must interpolate drift to get accel
+         rec.accel = ddrift;                                 // sec/sec^2
+         rec.sig_accel = rec.sig_drift/(times[Nhi]-times[Nlow]);
+      }
+
+      return rec;
+   }
+
    // Return the clock bias for the given satellite at the given time
    // @param[in] sat the SatID of the satellite of interest
    // @param[in] ttag the time (CommonTime) of interest
@@ -319,10 +391,14 @@ namespace gpstk
    {
       try {
          checkTimeSystem(ttag.getTimeSystem());
+         clearInterpCache(sat);
 
          if(rec.drift != 0.0) haveClockDrift = true;
          if(rec.accel != 0.0) haveClockAccel = true;
 
+         if(archiveRecord(sat, ttag, rec))
+            return;
+
          if(tables.find(sat) != tables.end() &&
             tables[sat].find(ttag) != tables[sat].end()) {
                // record already exists in the table
@@ -338,8 +414,10 @@ namespace gpstk
                oldrec.sig_accel = rec.sig_accel;
             }
          }
-         else  // create a new entry in the table
+         else {   // create a new entry in the table
             tables[sat][ttag] = rec;
+            addToFlatTable(sat, ttag);
+         }
       }
       catch(InvalidRequest& ir) { GPSTK_RETHROW(ir); }
    }
@@ -350,6 +428,8 @@ namespace gpstk
    {
       try {
          checkTimeSystem(ttag.getTimeSystem());
+         clearInterpCache(sat);
+         expandArchive(sat);
 
          if(tables.find(sat) != tables.end() &&
             tables[sat].find(ttag) != tables[sat].end()) {
@@ -366,6 +446,7 @@ namespace gpstk
             rec.accel = rec.sig_accel = 0.0;
 
             tables[sat][ttag] = rec;
+            addToFlatTable(sat, ttag);
          }
       }
       catch(InvalidRequest& ir) { GPSTK_RETHROW(ir); }
@@ -377,6 +458,8 @@ namespace gpstk
    {
       try {
          checkTimeSystem(ttag.getTimeSystem());
+         clearInterpCache(sat);
+         expandArchive(sat);
 
          haveClockDrift = true;
 
@@ -395,6 +478,7 @@ namespace gpstk
             rec.accel = rec.sig_accel = 0.0;
 
             tables[sat][ttag] = rec;
+            addToFlatTable(sat, ttag);
          }
       }
       catch(InvalidRequest& ir) { GPSTK_RETHROW(ir); }
@@ -406,6 +490,8 @@ namespace gpstk
    {
       try {
          checkTimeSystem(ttag.getTimeSystem());
+         clearInterpCache(sat);
+         expandArchive(sat);
 
          haveClockAccel = true;
 
@@ -424,9 +510,34 @@ namespace gpstk
             rec.bias = rec.sig_bias = 0.0;
 
             tables[sat][ttag] = rec;
+            addToFlatTable(sat, ttag);
          }
       }
       catch(InvalidRequest& ir) { GPSTK_RETHROW(ir); }
    }
 
+   // Store a ClockRecord as the fields of an ArchiveTable.
+   void ClockSatStore::toArchiveFields(const ClockRecord& rec,
+                                       double *fields) const
+   {
+      fields[0] = rec.bias;
+      fields[1] = rec.sig_bias;
+      fields[2] = rec.drift;
+      fields[3] = rec.sig_drift;
+      fields[4] = rec.accel;
+      fields[5] = rec.sig_accel;
+   }
+
+   // Fill a ClockRecord from the fields of an ArchiveTable.
+   void ClockSatStore::fromArchiveFields(const double *fields,
+                                         ClockRecord& rec) const
+   {
+      rec.bias = fields[0];
+      rec.sig_bias = fields[1];
+      rec.drift = fields[2];
+      rec.sig_drift = fields[3];
+      rec.accel = fields[4];
+      rec.sig_accel = fields[5];
+   }
+
 }  // End of namespace gpstk
@@ -118,9 +118,33 @@ namespace gpstk
          /// Store half the interpolation order, for convenience
       unsigned int Nhalf;
 
+         /** Interpolate for getValue() using the interpolation cache
+          * (see enableInterpCache()), with Lagrange interpolation.
+          * @param[in] sat the SatID of the satellite of interest
+          * @param[in] ttag the time (CommonTime) of interest
+          * @param[in] isExact true if ttag is one of the table times
+          * @param[in] it1 first record of the interval found by
+          *   getTableInterval()
+          * @param[in] it2 last record of the interval
+          * @return object of type ClockRecord containing the data
+          *   value(s). */
+      ClockRecord getCachedValue(const SatID& sat, const CommonTime& ttag,
+                                 bool isExact,
+                                 const DataTableIterator& it1,
+                                 const DataTableIterator& it2) const;
+
          /// Flag to reject bad clock data; default true
       bool rejectBadClockFlag;
 
+         /** A ClockRecord is archived (see
+          * TabularSatStore::enableArchive()) as its 6 values, in
+          * the order they are declared. */
+      virtual unsigned archiveFields(void) const { return 6; }
+      virtual void toArchiveFields(const ClockRecord& rec,
+                                   double *fields) const;
+      virtual void fromArchiveFields(const double *fields,
+                                     ClockRecord& rec) const;
+
          // member functions
    public:
 
@@ -152,6 +152,156 @@ namespace gpstk
    }  // end CorrectedEphemerisRange::ComputeAtTransmitTime
 
 
+      // Compute the corrected range at TRANSMIT time for all the satellites
+      // of one epoch. Each step follows ComputeAtTransmitTime(tr_nom,pr,...),
+      // rotateEarth() and updateCER(), and the Position::elevation() etc. that
+      // updateCER() calls, operation for operation, so that the results are
+      // the same; only the receiver-side quantities are computed just once.
+   int CorrectedEphemerisRange::ComputeAtTransmitTime(
+      const CommonTime& tr_nom,
+      const vector<SatID>& sats,
+      const vector<double>& prs,
+      const Position& Rx,
+      const XvtStore<SatID>& Eph,
+      vector<CorrectedEphemerisRange>& cers,
+      vector<double>& ranges,
+      vector<bool>& valid)
+   {
+      try {
+         if(sats.size() != prs.size()) {
+            InvalidParameter e("sats and prs differ in size");
+            GPSTK_THROW(e);
+         }
+
+         const size_t N(sats.size());
+         size_t i,k;
+         cers.resize(N);
+         ranges.assign(N,0.0);
+         valid.assign(N,false);
+
+         // the receiver: Cartesian, and the geodetic local frame
+         Position R(Rx);
+         R.transformTo(Position::Cartesian);
+         const double latGeodetic(Rx.getGeodeticLatitude()*DEG_TO_RAD);
+         const double longGeodetic(Rx.getLongitude()*DEG_TO_RAD);
+         const double kVector[3] = { ::cos(latGeodetic)*::cos(longGeodetic),
+                                     ::cos(latGeodetic)*::sin(longGeodetic),
+                                     ::sin(latGeodetic) };
+         const double iVector[3] = { -::sin(latGeodetic)*::cos(longGeodetic),
+                                     -::sin(latGeodetic)*::sin(longGeodetic),
+                                     ::cos(latGeodetic) };
+         const double jVector[3] = { -::sin(longGeodetic),
+                                     ::cos(longGeodetic), 0 };
+
+         // and the spherical frame of Triple::elvAngle() and azAngle()
+         const double RR(R[0]*R[0] + R[1]*R[1] + R[2]*R[2]);
+         double xy(R[0]*R[0] + R[1]*R[1]);
+         double xyz(xy + R[2]*R[2]);
+         xy = ::sqrt(xy);
+         xyz = ::sqrt(xyz);
+         const bool azOK(xy > 1e-14 && xyz > 1e-14);
+         const double cosl(R[0]/xy), sinl(R[1]/xy), sint(R[2]/xyz);
+         const double xn1(-sint*cosl), xn2(-sint*sinl), xn3(xy/xyz);
+         const double xe1(-sinl), xe2(cosl);
+
+         // 0-th order estimate of transmit time = receiver - pseudorange/c
+         vector<CommonTime> tt(N);
+         for(i=0; i<N; i++) {
+            cers[i].transmit = tr_nom;
+            cers[i].transmit -= prs[i]/C_MPS;
+            tt[i] = cers[i].transmit;
+         }
+
+         // correct for SV clock, querying the store for all sats together
+         vector<SatID> qsats(sats);
+         vector<size_t> index(N);
+         for(i=0; i<N; i++) index[i] = i;
+         for(int n=0; n<2; n++) {
+            vector<Xvt> xvts;
+            vector<bool> found;
+            Eph.getXvts(qsats, tt, xvts, found);
+            for(k=0,i=0; i<qsats.size(); i++) {
+               if(!found[i]) continue;
+               CorrectedEphemerisRange& cer(cers[index[i]]);
+               cer.svPosVel = xvts[i];
+               tt[k] = cer.transmit;
+               // remove clock bias and relativity correction
+               tt[k] -= (cer.svPosVel.clkbias + cer.svPosVel.relcorr);
+               qsats[k] = qsats[i];
+               index[k] = index[i];
+               k++;
+            }
+            qsats.resize(k);
+            tt.resize(k);
+            index.resize(k);
+         }
+
+         int nvalid(0);
+         for(k=0; k<index.size(); k++) {
+            i = index[k];
+            CorrectedEphemerisRange& cer(cers[i]);
+            Xvt& sv(cer.svPosVel);
+
+            cer.rotateEarth(R);
+            // raw range
+            cer.rawrange = RSS(sv.x[0]-R[0], sv.x[1]-R[1], sv.x[2]-R[2]);
+
+            // as updateCER()
+            cer.relativity = sv.computeRelativityCorrection() * C_MPS;
+            cer.svclkbias = sv.clkbias * C_MPS;
+            cer.svclkdrift = sv.clkdrift * C_MPS;
+
+            cer.cosines[0] = (R[0]-sv.x[0])/cer.rawrange;
+            cer.cosines[1] = (R[1]-sv.x[1])/cer.rawrange;
+            cer.cosines[2] = (R[2]-sv.x[2])/cer.rawrange;
+
+            // slant vector, receiver to SV
+            const double z[3] = { sv.x[0]-R[0], sv.x[1]-R[1], sv.x[2]-R[2] };
+            const double zz(z[0]*z[0] + z[1]*z[1] + z[2]*z[2]);
+
+            // Position::elevation() and azimuth(), i.e. Triple::elvAngle()
+            // and azAngle(), which would throw where these tests fail
+            if(zz <= 1e-14 || RR <= 1e-14 || !azOK) continue;
+            double c((z[0]*R[0] + z[1]*R[1] + z[2]*R[2]) / ::sqrt(zz * RR));
+            if(fabs(c) > 1.0e0) c = fabs(c) / c;
+            cer.elevation = 90.0 - ::acos(c) * RAD_TO_DEG;
+
+            double p1((xn1 * z[0]) + (xn2 * z[1]) + (xn3 * z[2]));
+            double p2((xe1 * z[0]) + (xe2 * z[1]));
+            if(fabs(p1) + fabs(p2) < 1.0e-14) continue;
+            double alpha(90 - ::atan2(p1, p2) * RAD_TO_DEG);
+            cer.azimuth = (alpha < 0 ? alpha + 360 : alpha);
+
+            // Position::elevationGeodetic() and azimuthGeodetic()
+            const double zmag(::sqrt(zz));
+            if(zmag <= 1e-4) continue;
+            double localUp(z[0]*kVector[0] + z[1]*kVector[1] + z[2]*kVector[2]);
+            cer.elevationGeodetic = 90.0 - ((::acos(localUp/zmag))*RAD_TO_DEG);
+
+            double localN((z[0]*iVector[0] + z[1]*iVector[1] + z[2]*iVector[2])
+                           / zmag);
+            double localE((z[0]*jVector[0] + z[1]*jVector[1] + z[2]*jVector[2])
+                           / zmag);
+            if(fabs(localN) + fabs(localE) < 1.0e-16)
+               cer.azimuthGeodetic = 0.0;
+            else {
+               alpha = ((::atan2(localE, localN)) * RAD_TO_DEG);
+               cer.azimuthGeodetic = (alpha < 0.0 ? alpha + 360.0 : alpha);
+            }
+
+            ranges[i] = cer.rawrange - cer.svclkbias - cer.relativity;
+            valid[i] = true;
+            nvalid++;
+         }
+
+         return nvalid;
+      }
+      catch(gpstk::Exception& e) {
+         GPSTK_RETHROW(e);
+      }
+   }  // end CorrectedEphemerisRange::ComputeAtTransmitTime
+
+
    double CorrectedEphemerisRange::ComputeAtTransmitTime(
       const CommonTime& tr_nom,
       const Position& Rx,
@@ -44,6 +44,8 @@
 #ifndef NEW_EPHEMERIS_RANGE_HPP
 #define NEW_EPHEMERIS_RANGE_HPP
 
+#include <vector>
+
 #include "CommonTime.hpp"
 #include "SatID.hpp"
 #include "Position.hpp"
@@ -87,6 +89,37 @@ namespace gpstk
          const SatID sat,
          const XvtStore<SatID>& Eph);
 
+         /// Compute the corrected range at TRANSMIT time, as the
+         /// function above does, for all the satellites of one epoch.
+         /// The receiver-side work (its Cartesian and geodetic
+         /// coordinates and local frame) is done once, and the
+         /// ephemeris is queried for all the satellites together, with
+         /// XvtStore::getXvts(), at each step of the iteration. The
+         /// results agree with calling the function above for each to
+         /// well under a mm; the batch orbit evaluation of
+         /// OrbitEph::svXvt(ephs,times) is not bit-identical.
+         /// @param[in] tr_nom nominal receive time
+         /// @param[in] sats the satellites
+         /// @param[in] prs the measured pseudorange of each of sats
+         /// @param[in] Rx receiver position
+         /// @param[in] Eph the ephemeris store
+         /// @param[out] cers all the CER quantities (elevation, azimuth,
+         ///   etc.) of each of sats
+         /// @param[out] ranges the corrected range of each of sats,
+         ///   0 if not valid
+         /// @param[out] valid false where the function above would throw
+         /// @return the number of valid satellites
+         /// @throw InvalidParameter if sats and prs differ in size
+      static int ComputeAtTransmitTime(
+         const CommonTime& tr_nom,
+         const std::vector<SatID>& sats,
+         const std::vector<double>& prs,
+         const Position& Rx,
+         const XvtStore<SatID>& Eph,
+         std::vector<CorrectedEphemerisRange>& cers,
+         std::vector<double>& ranges,
+         std::vector<bool>& valid);
+
          /// Compute the corrected range at TRANSMIT time, from
          /// receiver at position Rx, to the GPS satellite given by
          /// SatID sat, as well as all the CER quantities, given the
@@ -61,10 +61,18 @@ namespace gpstk
    // ordering has been determined.
    void GPSEphemerisStore::rationalize(void)
    {
+      ReadWriteLock::WriteGuard guard(windowLock, useWindow);
+
+      // validity times and keys change below
+      clearEphCache();
+
       // loop over satellites
       SatTableMap::iterator it;
       for (it = satTables.begin(); it != satTables.end(); it++) {
          TimeOrbitEphTable& table = it->second;
+         // edit() and the sliding window may empty a table
+         if (table.empty())
+            continue;
          TimeOrbitEphTable::iterator ei;
          TimeOrbitEphTable::iterator eiPrev;
          bool begin = true;
@@ -231,6 +239,10 @@ namespace gpstk
         finalTime   = rCei->second->endValid;
 
       } // end outer for-loop
+
+      // the keys changed, so the window's queue of them is out of date
+      if (useWindow)
+         rebuildWindow();
    }
 
    //-----------------------------------------------------------------------------
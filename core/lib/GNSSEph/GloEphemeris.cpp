@@ -97,16 +97,197 @@ namespace gpstk
 
       }
 
+         // Interpolate the trajectory table, if there is one covering
+         // the epoch
+      double dt( epoch - ephTime );
+      if ( trajectory )
+      {
+         const Trajectory& tr( *trajectory );
+         int nodes( tr.nodes.size()/9 );
+         if ( dt >= tr.first*tr.interval &&
+              dt <= (tr.first+nodes-1)*tr.interval )
+         {
+            return trajectoryXvt( dt, epoch );
+         }
+      }
+
+         // Get the reference state, rotated from PZ-90 to an absolute
+         // coordinate system
+      double s0, numSeconds;
+      Vector<double> initialState( inertialState(s0, numSeconds) );
+
+         // We will need some PZ-90 ellipsoid parameters
+      PZ90Ellipsoid pz90;
+      double we( pz90.angVelocity() );
+      double s( s0 + we*numSeconds );
+
+         // Integrate satellite state to desired epoch using the given step
+      double rkStep( step );
+
+      if ( dt < 0.0 ) rkStep = step*(-1.0);
+      CommonTime workEpoch( ephTime );
+
+      double tolerance( 1e-9 );
+      bool done( false );
+      while (!done)
+      {
+
+            // If we are about to overstep, change the stepsize appropriately
+            // to hit our target final time.
+         if( rkStep > 0.0 )
+         {
+            if( (workEpoch + rkStep) > epoch )
+               rkStep = (epoch - workEpoch);
+         }
+         else
+         {
+            if ( (workEpoch + rkStep) < epoch )
+               rkStep = (epoch - workEpoch);
+         }
+
+         numSeconds += rkStep;
+         s = s0 + we*( numSeconds );
+
+         rungeKuttaStep( initialState, s, rkStep );
+
+            // If we are within tolerance of the target time, we are done.
+         workEpoch += rkStep;
+         if ( std::fabs(epoch - workEpoch ) < tolerance )
+            done = true;
+
+      }  // End of 'while (!done)...'
+
+      return inertialToXvt( initialState, s, epoch );
+
+   }  // End of method 'GloEphemeris::svXvt(const CommonTime& t)'
+
+
+      // Integrate the orbit across the fit interval into a table.
+   GloEphemeris& GloEphemeris::makeTrajectory( double interval )
+   {
+
+         // First, let's check if there is valid data
+      if(!valid)
+      {
+         InvalidRequest exc("makeTrajectory(): No valid data stored.");
+         GPSTK_THROW(exc);
+      }
+      if( !(interval > 0.0) )
+      {
+         InvalidRequest exc("makeTrajectory(): interval must be positive.");
+         GPSTK_THROW(exc);
+      }
+
+      PZ90Ellipsoid pz90;
+      double we( pz90.angVelocity() );
+
+      std::shared_ptr<Trajectory> tr( new Trajectory );
+      tr->interval = interval;
+      int n( static_cast<int>(std::ceil(900.0/interval)) );
+      tr->first = -n;
+      tr->nodes.resize(9*(2*n+1));
+      Vector<double> start( inertialState(tr->s0, tr->sod) );
+
+         // Integrate from the epoch to the nodes on each side in turn,
+         // with the same steps svXvt() would take
+      for( int dir = -1; dir <= 1; dir += 2 )
+      {
+         Vector<double> state( start );
+         double t( 0.0 );
+         for( int k = 0; k <= n; ++k )
+         {
+            double target( dir*k*interval );
+            while( std::fabs(target - t) >= 1e-9 )
+            {
+               double h( dir*step );
+               if( (dir > 0 && t + h > target) ||
+                   (dir < 0 && t + h < target) )
+                  h = target - t;
+               t += h;
+               rungeKuttaStep( state, tr->s0 + we*(tr->sod + t), h );
+            }
+
+            double s( tr->s0 + we*(tr->sod + target) );
+            Vector<double> dxt( derivative(state, inertialAccel(s)) );
+            double *node( &tr->nodes[9*(n + dir*k)] );
+            for( int j = 0; j < 6; ++j )
+               node[j] = state(j);
+            node[6] = dxt(1);
+            node[7] = dxt(3);
+            node[8] = dxt(5);
+         }
+      }
+
+      trajectory = tr;
+      return (*this);
+
+   }  // End of method 'GloEphemeris::makeTrajectory()'
+
+
+      // Interpolate the trajectory table at dt seconds from the epoch.
+   Xvt GloEphemeris::trajectoryXvt( double dt,
+                                    const CommonTime& epoch ) const
+   {
+
+      const Trajectory& tr( *trajectory );
+      int last( tr.nodes.size()/9 - 2 );
+
+         // Find the interval [t0, t0+h] holding dt, and the normalized
+         // time u in it
+      double h( tr.interval );
+      double tt( dt/h - tr.first );
+      int k( static_cast<int>(std::floor(tt)) );
+      if( k < 0 ) k = 0;
+      if( k > last ) k = last;
+      double u( tt - k );
+      const double *n0( &tr.nodes[9*k] );
+      const double *n1( n0 + 9 );
+
+         // Quintic Hermite basis functions, for position and for
+         // acceleration at each end, and their derivatives
+      double u2( u*u ), u3( u2*u ), u4( u3*u ), u5( u4*u );
+      double hp0( 1.0 - 10.0*u3 + 15.0*u4 - 6.0*u5 );
+      double hv0( (u - 6.0*u3 + 8.0*u4 - 3.0*u5)*h );
+      double ha0( 0.5*(u2 - 3.0*u3 + 3.0*u4 - u5)*h*h );
+      double ha1( 0.5*(u3 - 2.0*u4 + u5)*h*h );
+      double hv1( (-4.0*u3 + 7.0*u4 - 3.0*u5)*h );
+      double hp1( 1.0 - hp0 );
+      double dp0( (-30.0*u2 + 60.0*u3 - 30.0*u4)/h );
+      double dv0( 1.0 - 18.0*u2 + 32.0*u3 - 15.0*u4 );
+      double da0( 0.5*(2.0*u - 9.0*u2 + 12.0*u3 - 5.0*u4)*h );
+      double da1( 0.5*(3.0*u2 - 8.0*u3 + 5.0*u4)*h );
+      double dv1( -12.0*u2 + 28.0*u3 - 15.0*u4 );
+      double dp1( -dp0 );
+
+      Vector<double> state(6);
+      for( int j = 0; j < 3; ++j )
+      {
+         state(2*j)   = hp0*n0[2*j] + hv0*n0[2*j+1] + ha0*n0[6+j]
+                      + hp1*n1[2*j] + hv1*n1[2*j+1] + ha1*n1[6+j];
+         state(2*j+1) = dp0*n0[2*j] + dv0*n0[2*j+1] + da0*n0[6+j]
+                      + dp1*n1[2*j] + dv1*n1[2*j+1] + da1*n1[6+j];
+      }
+
+      PZ90Ellipsoid pz90;
+      double s( tr.s0 + pz90.angVelocity()*(tr.sod + dt) );
+
+      return inertialToXvt( state, s, epoch );
+
+   }  // End of method 'GloEphemeris::trajectoryXvt()'
+
+
+      // Get the initial state in the inertial frame.
+   Vector<double> GloEphemeris::inertialState( double& s0,
+                                               double& sod ) const
+   {
+
          // Get the data out of the GloRecord structure
       double px( x[0] );   // X coordinate (km)
       double vx( v[0] );   // X velocity   (km/s)
-      double ax( a[0] );   // X acceleration (km/s^2)
       double py( x[1] );   // Y coordinate
       double vy( v[1] );   // Y velocity
-      double ay( a[1] );   // Y acceleration
       double pz( x[2] );   // Z coordinate
       double vz( v[2] );   // Z velocity
-      double az( a[2] );   // Z acceleration
 
          // We will need some PZ-90 ellipsoid parameters
       PZ90Ellipsoid pz90;
@@ -114,16 +295,15 @@ namespace gpstk
 
          // Get sidereal time at Greenwich at 0 hours UT
       double gst( getSidTime( ephTime ) );
-      double s0( gst*PI/12.0 );
+      s0 = gst*PI/12.0;
       YDSTime ytime( ephTime );
-      double numSeconds( ytime.sod );
-      double s( s0 + we*numSeconds );
+      sod = ytime.sod;
+      double s( s0 + we*sod );
       double cs( std::cos(s) );
       double ss( std::sin(s) );
 
          // Initial state matrix
-      Vector<double> initialState(6), accel(3), dxt1(6), dxt2(6), dxt3(6),
-                     dxt4(6), tempRes(6);
+      Vector<double> initialState(6);
 
          // Get the reference state out of GloEphemeris object data. Values
          // must be rotated from PZ-90 to an absolute coordinate system
@@ -141,74 +321,77 @@ namespace gpstk
          // Initial z velocity
       initialState(5)  = vz;
 
+      return initialState;
 
-         // Integrate satellite state to desired epoch using the given step
-      double rkStep( step );
+   }  // End of method 'GloEphemeris::inertialState()'
 
-      if ( (epoch - ephTime) < 0.0 ) rkStep = step*(-1.0);
-      CommonTime workEpoch( ephTime );
 
-      double tolerance( 1e-9 );
-      bool done( false );
-      while (!done)
-      {
+      // Get the luni-solar acceleration in the inertial frame.
+   Vector<double> GloEphemeris::inertialAccel( double s ) const
+   {
 
-            // If we are about to overstep, change the stepsize appropriately
-            // to hit our target final time.
-         if( rkStep > 0.0 )
-         {
-            if( (workEpoch + rkStep) > epoch )
-               rkStep = (epoch - workEpoch);
-         }
-         else
-         {
-            if ( (workEpoch + rkStep) < epoch )
-               rkStep = (epoch - workEpoch);
-         }
+      double cs( std::cos(s) );
+      double ss( std::sin(s) );
 
-         numSeconds += rkStep;
-         s = s0 + we*( numSeconds );
-         cs = std::cos(s);
-         ss = std::sin(s);
+      Vector<double> accel(3);
+      accel(0) = a[0]*cs - a[1]*ss;
+      accel(1) = a[0]*ss + a[1]*cs;
+      accel(2) = a[2];
 
-            // Accelerations are computed once per iteration
-         accel(0) = ax*cs - ay*ss;
-         accel(1) = ax*ss + ay*cs;
-         accel(2) = az;
+      return accel;
 
-         dxt1 = derivative( initialState, accel );
-         for( int j = 0; j < 6; ++j )
-            tempRes(j) = initialState(j) + rkStep*dxt1(j)/2.0;
+   }  // End of method 'GloEphemeris::inertialAccel()'
 
-         dxt2 = derivative( tempRes, accel );
-         for( int j = 0; j < 6; ++j )
-            tempRes(j) = initialState(j) + rkStep*dxt2(j)/2.0;
 
-         dxt3 = derivative( tempRes, accel );
-         for( int j = 0; j < 6; ++j )
-            tempRes(j) = initialState(j) + rkStep*dxt3(j);
+      // Advance an inertial state by one Runge-Kutta step.
+   void GloEphemeris::rungeKuttaStep( Vector<double>& state,
+                                      double s,
+                                      double h ) const
+   {
 
-         dxt4 = derivative( tempRes, accel );
-         for( int j = 0; j < 6; ++j )
-            initialState(j) = initialState(j) + rkStep * ( dxt1(j)
-                            + 2.0 * ( dxt2(j) + dxt3(j) ) + dxt4(j) ) / 6.0;
+         // Accelerations are computed once per step
+      Vector<double> accel( inertialAccel(s) ), dxt1(6), dxt2(6), dxt3(6),
+                     dxt4(6), tempRes(6);
 
+      dxt1 = derivative( state, accel );
+      for( int j = 0; j < 6; ++j )
+         tempRes(j) = state(j) + h*dxt1(j)/2.0;
 
-            // If we are within tolerance of the target time, we are done.
-         workEpoch += rkStep;
-         if ( std::fabs(epoch - workEpoch ) < tolerance )
-            done = true;
+      dxt2 = derivative( tempRes, accel );
+      for( int j = 0; j < 6; ++j )
+         tempRes(j) = state(j) + h*dxt2(j)/2.0;
 
-      }  // End of 'while (!done)...'
+      dxt3 = derivative( tempRes, accel );
+      for( int j = 0; j < 6; ++j )
+         tempRes(j) = state(j) + h*dxt3(j);
+
+      dxt4 = derivative( tempRes, accel );
+      for( int j = 0; j < 6; ++j )
+         state(j) = state(j) + h * ( dxt1(j)
+                  + 2.0 * ( dxt2(j) + dxt3(j) ) + dxt4(j) ) / 6.0;
+
+   }  // End of method 'GloEphemeris::rungeKuttaStep()'
+
+
+      // Convert an inertial state to an Xvt at the given epoch.
+   Xvt GloEphemeris::inertialToXvt( const Vector<double>& state,
+                                    double s,
+                                    const CommonTime& epoch ) const
+   {
 
+      PZ90Ellipsoid pz90;
+      double we( pz90.angVelocity() );
+      double cs( std::cos(s) );
+      double ss( std::sin(s) );
 
-      px = initialState(0);
-      py = initialState(2);
-      pz = initialState(4);
-      vx = initialState(1);
-      vy = initialState(3);
-      vz = initialState(5);
+      double px( state(0) );
+      double py( state(2) );
+      double pz( state(4) );
+      double vx( state(1) );
+      double vy( state(3) );
+      double vz( state(5) );
 
+      Xvt sv;
       sv.x[0] = 1000.0*( px*cs + py*ss );         // X coordinate
       sv.x[1] = 1000.0*(-px*ss + py*cs);          // Y coordinate
       sv.x[2] = 1000.0*pz;                        // Z coordinate
@@ -223,11 +406,9 @@ namespace gpstk
       sv.clkdrift = clkdrift;
       sv.frame = ReferenceFrame::PZ90;
 
-         // We are done, let's return
       return sv;
 
-
-   }  // End of method 'GloEphemeris::svXvt(const CommonTime& t)'
+   }  // End of method 'GloEphemeris::inertialToXvt()'
 
 
       // Get the epoch time for this ephemeris
@@ -392,6 +573,7 @@ namespace gpstk
       ageOfInfo = age;
 
       step = rkStep;
+      trajectory.reset();
 
          // Set this object as valid
       valid = true;
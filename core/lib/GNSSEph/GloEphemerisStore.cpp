@@ -62,6 +62,9 @@ namespace gpstk
          CommonTime t( data.time);
          t.setTimeSystem(TimeSystem::GLO);   // must be GLONASS time
 
+         if (trajectoryInterval > 0.0)
+            gloEphem.makeTrajectory(trajectoryInterval);
+
          SatID sat( data.sat );
          pe[sat][t] = gloEphem; // find or add entry
 
@@ -79,6 +82,49 @@ namespace gpstk
    }  // End of method 'GloEphemerisStore::addEphemeris()'
 
 
+      // Integrate each ephemeris across its fit interval into a table.
+   GloEphemerisStore& GloEphemerisStore::enableTrajectories(double interval)
+   {
+      if ( !(interval > 0.0) )
+      {
+         InvalidParameter e("Trajectory interval must be positive");
+         GPSTK_THROW(e);
+      }
+      trajectoryInterval = interval;
+
+      for (GloEphMap::iterator it = pe.begin(); it != pe.end(); ++it)
+      {
+         for (TimeGloMap::iterator jt = it->second.begin();
+              jt != it->second.end(); ++jt)
+         {
+            jt->second.makeTrajectory(trajectoryInterval);
+         }
+      }
+
+      return (*this);
+
+   }  // End of method 'GloEphemerisStore::enableTrajectories()'
+
+
+      // Stop using trajectory tables.
+   GloEphemerisStore& GloEphemerisStore::disableTrajectories()
+   {
+      trajectoryInterval = 0.0;
+
+      for (GloEphMap::iterator it = pe.begin(); it != pe.end(); ++it)
+      {
+         for (TimeGloMap::iterator jt = it->second.begin();
+              jt != it->second.end(); ++jt)
+         {
+            jt->second.clearTrajectory();
+         }
+      }
+
+      return (*this);
+
+   }  // End of method 'GloEphemerisStore::disableTrajectories()'
+
+
       /* Returns the position, velocity and clock offset of the indicated
        * satellite in ECEF coordinates (meters) at the indicated time,
        * in the PZ-90 ellipsoid.
@@ -157,7 +203,7 @@ namespace gpstk
       }
 
          // We now have the proper reference data record. Let's use it
-      GloEphemeris data( i->second );
+      const GloEphemeris& data( i->second );
 
          // Compute the satellite position, velocity and clock offset
       sv = data.svXvt( epoch );
@@ -231,7 +277,7 @@ namespace gpstk
          }
 
             // We now have the proper reference data record. Let's use it
-         GloEphemeris data(i->second);
+         const GloEphemeris& data(i->second);
 
             // Compute the satellite position, velocity and clock offset
          rv = data.svXvt(epoch);
@@ -75,7 +75,7 @@ namespace gpstk
       GloEphemerisStore()
             : initialTime(CommonTime::END_OF_TIME),
               finalTime(CommonTime::BEGINNING_OF_TIME),
-              step(1.0)
+              step(1.0), trajectoryInterval(0.0)
       {
             setCheckHealthFlag(false);
       }
@@ -89,7 +89,7 @@ namespace gpstk
                          bool checkHealth )
             : initialTime(CommonTime::END_OF_TIME),
               finalTime(CommonTime::BEGINNING_OF_TIME),
-              step(rkStep)
+              step(rkStep), trajectoryInterval(0.0)
       {
             setCheckHealthFlag(false);
       }
@@ -164,6 +164,23 @@ namespace gpstk
       GloEphemerisStore& setCheckHealthFlag( bool checkHealth )
       { onlyHealthy = checkHealth; return (*this); };
 
+         /** Integrate each ephemeris once across its fit interval,
+          *  now and as ephemerides are added, and answer getXvt() by
+          *  interpolating the resulting tables.  This is much faster
+          *  when each ephemeris is used more than a few times; see
+          *  GloEphemeris::makeTrajectory() for the accuracy.
+          *
+          * @param interval   Spacing of the tables in seconds.
+          */
+      GloEphemerisStore& enableTrajectories( double interval = 60.0 );
+
+         /// Stop using trajectory tables, and free them.
+      GloEphemerisStore& disableTrajectories();
+
+         /// Return true if trajectory tables are in use.
+      bool isTrajectories() const
+      { return (trajectoryInterval > 0.0); };
+
          /** A debugging function that outputs in human readable form,
           *  all data stored in this object.
           * 
@@ -297,6 +314,9 @@ namespace gpstk
          /// Integration step for Runge-Kutta algorithm (1 second by default)
       double step;
 
+         /// Spacing of the trajectory tables, or 0 if they are not used
+      double trajectoryInterval;
+
    };  // End of class 'GloEphemerisStore'
 
       //@}
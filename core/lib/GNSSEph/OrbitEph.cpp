@@ -46,6 +46,9 @@
 /// flags. It serves as the base class for broadcast ephemerides for GPS, QZSS,
 /// Galileo, and BeiDou, with RINEX Navigation input, among others.
 
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
 #include "OrbitEph.hpp"
 #include "MathBase.hpp"
 #include "GNSSconstants.hpp"
@@ -62,6 +65,79 @@ using namespace std;
 
 namespace gpstk
 {
+      // sin and cos of x, with the reduction and polynomial kernels of
+      // fdlibm, to about an ulp for |x| < 1e5.  There are no branches or
+      // libm calls, so loops that use it can be vectorized.
+   static inline void batchSinCos(double x, double& s, double& c)
+   {
+      const double invpio2 = 6.36619772367581382433e-01;
+      const double pio2_1 = 1.57079632673412561417e+00;  // first 33 bits
+      const double pio2_2 = 6.07710050630396597660e-11;  // next 33 bits
+      const double pio2_3 = 2.02226624871116645580e-21;  // pi/2 - the rest
+      const double shift = 6755399441055744.0;           // 1.5 * 2^52
+      const double S1 = -1.66666666666666324348e-01, S2 = 8.33333333332248946124e-03,
+                   S3 = -1.98412698298579493134e-04, S4 = 2.75573137070700676789e-06,
+                   S5 = -2.50507602534068634195e-08, S6 = 1.58969099521155010221e-10;
+      const double C1 = 4.16666666666666019037e-02, C2 = -1.38888888888741095749e-03,
+                   C3 = 2.48015872894767294178e-05, C4 = -2.75573143513906633035e-07,
+                   C5 = 2.08757232129817482790e-09, C6 = -1.13596475577881948265e-11;
+
+      // x = n*pi/2 + r, |r| <= pi/4; the low bits of t are n
+      double t = x * invpio2 + shift;
+      double n = t - shift;
+      double r = ((x - n * pio2_1) - n * pio2_2) - n * pio2_3;
+      uint64_t quad;
+      memcpy(&quad, &t, sizeof(quad));
+
+      double z = r * r;
+      double sk = r + r*z*(S1 + z*(S2 + z*(S3 + z*(S4 + z*(S5 + z*S6)))));
+      double ck = 1.0 - 0.5*z + z*z*(C1 + z*(C2 + z*(C3 + z*(C4 + z*(C5 + z*C6)))));
+
+      // select and negate by quadrant, on the bits
+      uint64_t sbits, cbits;
+      memcpy(&sbits, &sk, sizeof(sbits));
+      memcpy(&cbits, &ck, sizeof(cbits));
+      uint64_t swap = uint64_t(0) - (quad & 1);
+      uint64_t sres = ((sbits & ~swap) | (cbits & swap)) ^ ((quad & 2) << 62);
+      uint64_t cres = ((cbits & ~swap) | (sbits & swap)) ^ (((quad + 1) & 2) << 62);
+      memcpy(&s, &sres, sizeof(s));
+      memcpy(&c, &cres, sizeof(c));
+   }
+
+      // Number of elements the batch svXvt() works on at a time, in
+      // local arrays that the compiler knows do not overlap.
+   static const size_t batchBlockSize = 64;
+
+      // Solve Kepler's equation M = E - e sin(E) for n elements, with
+      // Newton's method from E = M + e sin(M).  Every element takes the
+      // same steps; one that has converged, as svXvt(t) decides it, is
+      // masked out of the update.  After keplerMinIter steps, which is
+      // enough for e < 0.3, iteration stops once all have converged.
+   static void solveKepler(const double *meana, const double *ecc,
+                           double *ea, size_t n)
+   {
+      const int keplerMinIter(5), keplerMaxIter(20);
+      size_t i;
+      double s,c;
+      double active[batchBlockSize];
+      for(i=0; i<n; i++) {
+         batchSinCos(meana[i], s, c);
+         ea[i] = meana[i] + ecc[i] * s;
+         active[i] = 1.0;
+      }
+      for(int loop_cnt=1; loop_cnt <= keplerMaxIter; loop_cnt++) {
+         for(i=0; i<n; i++) {
+            batchSinCos(ea[i], s, c);
+            double delea = active[i] * (meana[i] - (ea[i] - ecc[i] * s)) /
+                           (1.0 - ecc[i] * c);
+            ea[i] += delea;
+            active[i] = (fabs(delea) > 1.0e-11 ? active[i] : 0.0);
+         }
+         if(loop_cnt >= keplerMinIter &&
+            find(active, active+n, 1.0) == active+n)
+            break;
+      }
+   }
 
    OrbitEph :: OrbitEph()
          : dataLoadedFlag(false),
@@ -255,6 +331,192 @@ namespace gpstk
       return sv;
    }
 
+   // Compute satellite position, velocity and clock at each of the times.
+   // throw Invalid Request if the required data has not been stored.
+   void OrbitEph::svXvt(const vector<CommonTime>& times, vector<Xvt>& sv) const
+   {
+      vector<const OrbitEph*> ephs(times.size(), this);
+      svXvt(ephs, times, sv);
+   }
+
+   // Compute satellite position, velocity and clock for each ephemeris at
+   // its own time, as svXvt(t) does but a stage at a time over arrays.  For
+   // each block of elements the orbit parameters are copied once into one
+   // local array per field, and every loop after that runs over those
+   // arrays without branches or calls into libm, using batchSinCos() in
+   // place of sin() and cos(), so that it can be vectorized.  The results
+   // agree with svXvt(t) to well under a mm.
+   // throw Invalid Request if the sizes differ or data has not been stored.
+   void OrbitEph::svXvt(const vector<const OrbitEph*>& ephs,
+                        const vector<CommonTime>& times,
+                        vector<Xvt>& sv)
+   {
+      if(ephs.size() != times.size())
+         GPSTK_THROW(InvalidRequest("Numbers of ephemerides and times differ"));
+
+      const size_t N(ephs.size());
+      const size_t B(batchBlockSize);
+      GPSEllipsoid ell;
+      CGCS2000Ellipsoid bell;
+      const double sqrtgm(SQRT(ell.gm()));
+      const double sqrtgmBDS(SQRT(bell.gm()));
+      const double we(ell.angVelocity());
+
+      // per-element copies of the orbit parameters, and intermediate values
+      double lecc[B], q[B], Ak[B], sqrtAk[B], Adot[B], amm[B];
+      double meana[B], ea[B], elapte[B], elaptc[B], cosw[B], sinw[B];
+      double Cuc[B], Cus[B], Crc[B], Crs[B], Cic[B], Cis[B];
+      double i0[B], idot[B], OMEGA0[B], domk[B];
+      double x[B], y[B], z[B], vx[B], vy[B], vz[B], relcorr[B];
+
+      // elements for which svRelativity() differs from the orbit's own
+      // Kepler solution: it ignores dndot and uses CGCS2000 for BeiDou
+      size_t relIndex[B];
+      double relMeana[B], relEcc[B], relEa[B];
+
+      const OrbitEph *prev(NULL);
+      double Ahalf(0.0), ToeSOW(0.0), TocOff(0.0), qe(0.0), cw(0.0), sw(0.0);
+      sv.resize(N);
+
+      for(size_t b0=0; b0<N; b0+=B) {
+         const size_t n(N-b0 < B ? N-b0 : B);
+         size_t i,k,nrel(0);
+
+         // copy the parameters; quantities that depend on the ephemeris
+         // only are found once for each run of the same ephemeris
+         for(i=0; i<n; i++) {
+            const OrbitEph& eph(*ephs[b0+i]);
+            if(!eph.dataLoadedFlag)
+               GPSTK_THROW(InvalidRequest("Data not loaded"));
+            if(&eph != prev) {
+               Ahalf = SQRT(eph.A);
+               ToeSOW = GPSWeekSecond(eph.ctToe).sow;
+               TocOff = eph.ctToe - eph.ctToc;
+               qe = SQRT(1.0e0 - eph.ecc*eph.ecc);
+               cw = ::cos(eph.w);
+               sw = ::sin(eph.w);
+               prev = &eph;
+            }
+            lecc[i] = eph.ecc;
+            q[i] = qe;
+            cosw[i] = cw;
+            sinw[i] = sw;
+            elapte[i] = times[b0+i] - eph.ctToe;
+            elaptc[i] = elapte[i] + TocOff;
+            Adot[i] = eph.Adot;
+            Ak[i] = eph.A + eph.Adot * elapte[i];
+            sqrtAk[i] = SQRT(Ak[i]);
+            double dnA = eph.dn + 0.5*eph.dndot*elapte[i];
+            amm[i] = (sqrtgm / (eph.A*Ahalf)) + dnA;
+            // batchSinCos() reduces the angle itself, so no fmod()
+            meana[i] = eph.M0 + elapte[i] * amm[i];
+            Cuc[i] = eph.Cuc; Cus[i] = eph.Cus;
+            Crc[i] = eph.Crc; Crs[i] = eph.Crs;
+            Cic[i] = eph.Cic; Cis[i] = eph.Cis;
+            i0[i] = eph.i0;
+            idot[i] = eph.idot;
+            domk[i] = eph.OMEGAdot - we;
+            // longitude of the node at Toe, less the earth's rotation since
+            OMEGA0[i] = eph.OMEGA0 - we * ToeSOW;
+
+            bool isBDS(eph.satID.system == SatelliteSystem::BeiDou);
+            if(eph.dndot != 0.0 || isBDS) {
+               double ammRel = ((isBDS ? sqrtgmBDS : sqrtgm) / (eph.A*Ahalf))
+                               + eph.dn;
+               relIndex[nrel] = i;
+               relMeana[nrel] = eph.M0 + elapte[i] * ammRel;
+               relEcc[nrel] = eph.ecc;
+               nrel++;
+            }
+         }
+
+         // Kepler's equation, for all elements together
+         solveKepler(meana, lecc, ea, n);
+
+         // the orbit, in one branch-free pass
+         for(i=0; i<n; i++) {
+            double sinea,cosea,G,sintrue,costrue,sinal,cosal,s2al,c2al;
+            double du,dr,di,sindu,cosdu,cosu,sinu,R,xip,yip;
+            double can,san,cinc,sinc,dek,dlk,div,duv,drv,dxp,dyp;
+
+            batchSinCos(ea[i], sinea, cosea);
+            G = 1.0e0 - lecc[i] * cosea;
+
+            // true anomaly, and the argument of latitude alat = true + w
+            sintrue = q[i] * sinea / G;
+            costrue = (cosea - lecc[i]) / G;
+            sinal = sintrue * cosw[i] + costrue * sinw[i];
+            cosal = costrue * cosw[i] - sintrue * sinw[i];
+            s2al = 2.0e0 * sinal * cosal;
+            c2al = cosal * cosal - sinal * sinal;
+
+            // correction terms (2nd harmonic)
+            du = c2al * Cuc[i] + s2al * Cus[i];
+            dr = c2al * Crc[i] + s2al * Crs[i];
+            di = c2al * Cic[i] + s2al * Cis[i];
+
+            // in plane location, at U = alat + du
+            batchSinCos(du, sindu, cosdu);
+            cosu = cosal * cosdu - sinal * sindu;
+            sinu = sinal * cosdu + cosal * sindu;
+            R = Ak[i] * G + dr;
+            xip = R * cosu;
+            yip = R * sinu;
+
+            // angles for rotation to earth fixed
+            batchSinCos(OMEGA0[i] + domk[i] * elapte[i], san, can);
+            batchSinCos(i0[i] + idot[i] * elapte[i] + di, sinc, cinc);
+
+            // earth fixed coordinates in meters
+            x[i] = xip*can - yip*cinc*san;
+            y[i] = xip*san + yip*cinc*can;
+            z[i] = yip*sinc;
+
+            // velocity of rotation coordinates
+            dek = amm[i] / G;
+            dlk = amm[i] * q[i] / (G*G);
+            div = idot[i] - 2.0e0 * dlk * (Cic[i] * s2al - Cis[i] * c2al);
+            duv = dlk * (1.e0 + 2.e0 * (Cus[i]*c2al - Cuc[i]*s2al));
+            drv = Ak[i] * lecc[i] * dek * sinea -
+                  2.e0 * dlk * (Crc[i] * s2al - Crs[i] * c2al) + Adot[i] * G;
+            dxp = drv*cosu - R*sinu*duv;
+            dyp = drv*sinu + R*cosu*duv;
+
+            // velocities
+            vx[i] = dxp*can - xip*san*domk[i] - dyp*cinc*san
+                  + yip*(sinc*san*div - cinc*can*domk[i]);
+            vy[i] = dxp*san + xip*can*domk[i] + dyp*cinc*can
+                  - yip*(sinc*can*div + cinc*san*domk[i]);
+            vz[i] = dyp*sinc + yip*cinc*div;
+
+            relcorr[i] = REL_CONST * lecc[i] * sqrtAk[i] * sinea;
+         }
+
+         // relativity for the elements whose svRelativity() differs
+         if(nrel > 0) {
+            solveKepler(relMeana, relEcc, relEa, nrel);
+            for(k=0; k<nrel; k++) {
+               i = relIndex[k];
+               relcorr[i] = REL_CONST * relEcc[k] * sqrtAk[i] * ::sin(relEa[k]);
+            }
+         }
+
+         for(i=0; i<n; i++) {
+            const OrbitEph& eph(*ephs[b0+i]);
+            Xvt& xvt(sv[b0+i]);
+            xvt.x[0] = x[i]; xvt.x[1] = y[i]; xvt.x[2] = z[i];
+            xvt.v[0] = vx[i]; xvt.v[1] = vy[i]; xvt.v[2] = vz[i];
+            xvt.relcorr = relcorr[i];
+
+            // clock corrections, as svClockBias() and svClockDrift()
+            xvt.clkbias = eph.af0 + elaptc[i] * (eph.af1 + elaptc[i] * eph.af2);
+            xvt.clkdrift = eph.af1 + elaptc[i] * eph.af2;
+            xvt.frame = ReferenceFrame::WGS84;
+            xvt.health = Xvt::Uninitialized;
+         }
+      }
+   }
+
    // Compute satellite relativity correction (sec) at the given time
    // throw Invalid Request if the required data has not been stored.
    double OrbitEph::svRelativity(const CommonTime& t) const
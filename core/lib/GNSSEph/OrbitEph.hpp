@@ -51,6 +51,7 @@
 #define GPSTK_ORBITEPH_HPP
 
 #include <string>
+#include <vector>
 #include "Exception.hpp"
 #include "CommonTime.hpp"
 #include "ObsID.hpp"
@@ -128,6 +129,33 @@ namespace gpstk
           * @throw Invalid Request if the required data has not been stored. */
       Xvt svXvt(const CommonTime& t) const;
 
+         /** Compute satellite position, velocity and clock at each of
+          * the given times, agreeing with svXvt(t) to well under a mm.
+          * This is much faster than calling svXvt(t) for each time.
+          * @param[in] times the times of interest
+          * @param[out] sv the Xvt at each of times
+          * @throw Invalid Request if the required data has not been stored. */
+      void svXvt(const std::vector<CommonTime>& times,
+                 std::vector<Xvt>& sv) const;
+
+         /** Compute satellite position, velocity and clock for each
+          * of a set of ephemerides, each at its own time, agreeing
+          * with ephs[i]->OrbitEph::svXvt(times[i]) to well under a
+          * mm.  The orbit parameters are copied into per-field
+          * arrays, a block of elements at a time, and the Kepler
+          * equation and orbit are computed over the arrays in
+          * branch-free loops that the compiler can vectorize.  The
+          * relativity correction reuses the Kepler solution, except
+          * for BeiDou and non-zero dndot, where svRelativity() differs.
+          * @param[in] ephs the ephemerides to evaluate
+          * @param[in] times the time at which to evaluate each of ephs
+          * @param[out] sv the Xvt for each of ephs
+          * @throw Invalid Request if the sizes of ephs and times
+          *   differ, or the data has not been stored in one of ephs. */
+      static void svXvt(const std::vector<const OrbitEph*>& ephs,
+                        const std::vector<CommonTime>& times,
+                        std::vector<Xvt>& sv);
+
          /** Compute satellite relativity correction (sec) at the given time
           * @throw Invalid Request if the required data has not been stored. */
       double svRelativity(const CommonTime& t) const;
@@ -47,6 +47,7 @@
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <algorithm>
 
 #include "StringUtils.hpp"
 #include "MathBase.hpp"
@@ -63,6 +64,7 @@ namespace gpstk
 {
    Xvt OrbitEphStore::getXvt(const SatID& sat, const CommonTime& t) const
    {
+      ReadWriteLock::ReadGuard guard(windowLock, useWindow);
       try
       {
             // get the appropriate OrbitEph
@@ -95,6 +97,7 @@ namespace gpstk
    Xvt OrbitEphStore::computeXvt(const SatID& sat, const CommonTime& t) const
       throw()
    {
+      ReadWriteLock::ReadGuard guard(windowLock, useWindow);
       Xvt rv;
       rv.health = Xvt::HealthStatus::Unavailable;
       try
@@ -116,9 +119,141 @@ namespace gpstk
    }
 
 
+   vector<Xvt> OrbitEphStore::getXvt(const vector<SatID>& sats,
+                                     const CommonTime& t) const
+   {
+      ReadWriteLock::ReadGuard guard(windowLock, useWindow);
+      try
+      {
+            // get the appropriate OrbitEphs, as getXvt(sat,t) does
+         vector<const OrbitEph*> ephs(sats.size());
+         for (size_t i = 0; i < sats.size(); i++)
+         {
+            ephs[i] = findOrbitEph(sats[i],t);
+            if (!ephs[i])
+            {
+               InvalidRequest exc("No OrbitEph for satellite " +
+                                  asString(sats[i]));
+               GPSTK_THROW(exc);
+            }
+            if (onlyHealthy && !ephs[i]->isHealthy())
+               GPSTK_THROW(InvalidRequest("Not healthy"));
+         }
+
+            // compute the positions, velocities and times
+         vector<Xvt> sv;
+         OrbitEph::svXvt(ephs, vector<CommonTime>(sats.size(), t), sv);
+         for (size_t i = 0; i < sats.size(); i++)
+         {
+            sv[i].health = (ephs[i]->isHealthy() ? Xvt::HealthStatus::Healthy
+                            : Xvt::HealthStatus::Unhealthy);
+         }
+         return sv;
+      }
+      catch(InvalidRequest& ir)
+      {
+         GPSTK_RETHROW(ir);
+      }
+   }
+
+
+   vector<Xvt> OrbitEphStore::computeXvt(const vector<SatID>& sats,
+                                         const CommonTime& t) const
+      throw()
+   {
+      ReadWriteLock::ReadGuard guard(windowLock, useWindow);
+      vector<Xvt> rv(sats.size());
+      try
+      {
+            // get the appropriate OrbitEphs, skipping missing ones
+         vector<const OrbitEph*> ephs;
+         vector<size_t> index;
+         for (size_t i = 0; i < sats.size(); i++)
+         {
+            rv[i].health = Xvt::HealthStatus::Unavailable;
+            const OrbitEph *eph = findOrbitEph(sats[i],t);
+            if (eph != nullptr)
+            {
+               ephs.push_back(eph);
+               index.push_back(i);
+            }
+         }
+
+            // compute the positions, velocities and times
+         vector<Xvt> sv;
+         OrbitEph::svXvt(ephs, vector<CommonTime>(ephs.size(), t), sv);
+         for (size_t k = 0; k < ephs.size(); k++)
+         {
+            rv[index[k]] = sv[k];
+            rv[index[k]].health = (ephs[k]->isHealthy()
+                                   ? Xvt::HealthStatus::Healthy
+                                   : Xvt::HealthStatus::Unhealthy);
+         }
+      }
+      catch (...)
+      {
+      }
+      return rv;
+   }
+
+
+   int OrbitEphStore::getXvts(const vector<SatID>& sats,
+                              const vector<CommonTime>& times,
+                              vector<Xvt>& xvts,
+                              vector<bool>& found) const
+   {
+      if (sats.size() != times.size())
+      {
+         InvalidParameter e("ids and times differ in size");
+         GPSTK_THROW(e);
+      }
+      ReadWriteLock::ReadGuard guard(windowLock, useWindow);
+
+      xvts.resize(sats.size());
+      found.assign(sats.size(), false);
+
+         // get the appropriate OrbitEphs, skipping those for which
+         // getXvt(sat,t) would throw
+      vector<const OrbitEph*> ephs;
+      vector<CommonTime> ephTimes;
+      vector<size_t> index;
+      for (size_t i = 0; i < sats.size(); i++)
+      {
+         const OrbitEph *eph;
+         try
+         {
+            eph = findOrbitEph(sats[i],times[i]);
+         }
+         catch (InvalidRequest&)
+         {
+            continue;
+         }
+         if (!eph || !eph->dataLoaded() || (onlyHealthy && !eph->isHealthy()))
+            continue;
+         ephs.push_back(eph);
+         ephTimes.push_back(times[i]);
+         index.push_back(i);
+      }
+
+         // compute the positions, velocities and times
+      vector<Xvt> sv;
+      OrbitEph::svXvt(ephs, ephTimes, sv);
+      for (size_t k = 0; k < ephs.size(); k++)
+      {
+         xvts[index[k]] = sv[k];
+         xvts[index[k]].health = (ephs[k]->isHealthy()
+                                  ? Xvt::HealthStatus::Healthy
+                                  : Xvt::HealthStatus::Unhealthy);
+         found[index[k]] = true;
+      }
+      return ephs.size();
+   }
+
+
    Xvt::HealthStatus OrbitEphStore ::
    getSVHealth(const SatID& sat, const CommonTime& t) const throw()
    {
+      ReadWriteLock::ReadGuard guard(windowLock, useWindow);
       Xvt::HealthStatus rv = Xvt::HealthStatus::Unavailable;
       try
       {
@@ -139,6 +274,7 @@ namespace gpstk
 
    void OrbitEphStore::dump(ostream& os, short detail) const
    {
+      ReadWriteLock::ReadGuard guard(windowLock, useWindow);
       SatTableMap::const_iterator it;
 
       os << "Dump of " << getName() << " (detail level=" << detail << "):\n";
@@ -243,13 +379,58 @@ namespace gpstk
 
    } // end OrbitEphStore::dump
 
+   //---------------------------------------------------------------------------------
+   OrbitEph* OrbitEphStore::addEphemeris(const OrbitEph* eph)
+   {
+      try {
+         ReadWriteLock::WriteGuard guard(windowLock, useWindow);
+         if(!useWindow)
+            return insertEphemeris(eph);
+
+         // insertEphemeris() may also replace an ephemeris with the same Toe
+         SatTableMap::const_iterator sit = satTables.find(eph->satID);
+         const size_t before(sit == satTables.end() ? 0 : sit->second.size());
+         OrbitEph *ret = insertEphemeris(eph);
+         windowCount += satTables[eph->satID].size() - before;
+
+         // any ephemeris received, even a copy, moves the window along
+         if(eph->beginValid > windowLatest)
+            windowLatest = eph->beginValid;
+
+         if(ret != NULL) {
+            const SatID sat(ret->satID);
+            TimeOrbitEphTable& toet = satTables[sat];
+            TimeOrbitEphTable::iterator it =
+               toet.find(strictMethod ? ret->beginValid : ret->ctToe);
+            if(windowNeeds(toet, it))
+               windowOrder.push_back(std::make_pair(sat, it->first));
+            else {
+               // it arrived too late for the window
+               delete it->second;
+               toet.erase(it);
+               clearEphCache(sat);
+               windowCount--;
+               windowEvictions++;
+               message = string("outside window");
+               ret = NULL;
+            }
+         }
+
+         evictWindow();
+         return ret;
+      }
+      catch(Exception& e) { GPSTK_RETHROW(e) }
+   }
+
    //---------------------------------------------------------------------------------
    // Keeps only one OrbitEph for a given satellite and Toe.
    // If keys are repeated, keep the one with the earliest transmit time.
-   OrbitEph* OrbitEphStore::addEphemeris(const OrbitEph* eph)
+   OrbitEph* OrbitEphStore::insertEphemeris(const OrbitEph* eph)
    {
       OrbitEph *ret(0);
       try {
+         clearEphCache(eph->satID);
+
          // is the satellite found in the table? If not, create one
          if(satTables.find(eph->satID) == satTables.end()) {
             TimeOrbitEphTable newtable;
@@ -306,6 +487,7 @@ namespace gpstk
          if(it==toet.begin()) {
             // candidate is before beginning of map
             if(it->second->ctToe == eph->ctToe) {
+               delete it->second;
                toet.erase(it);
             }
             ret = eph->clone();
@@ -331,6 +513,7 @@ namespace gpstk
          // Check if iterator points to late transmission of
          // same OrbitEph as candidate
          if(it->second->ctToe == eph->ctToe) {
+            delete it->second;
             toet.erase(it);
             ret = eph->clone();
             toet[keyVal] = ret;
@@ -354,15 +537,20 @@ namespace gpstk
       }
       catch(Exception& e) { GPSTK_RETHROW(e) }
 
-   }  // end OrbitEph* OrbitEphStore::addEphemeris(const OrbitEph* eph)
+   }  // end OrbitEph* OrbitEphStore::insertEphemeris(const OrbitEph* eph)
 
    //---------------------------------------------------------------------------------
    void OrbitEphStore::edit(const CommonTime& tmin, const CommonTime& tmax)
    {
+      ReadWriteLock::WriteGuard guard(windowLock, useWindow);
+      clearEphCache();
+
       for(SatTableMap::iterator i = satTables.begin(); i != satTables.end(); i++)
       {
          TimeOrbitEphTable& eMap = i->second;
 
+         const size_t before(eMap.size());
+
          TimeOrbitEphTable::iterator lower = eMap.lower_bound(tmin);
          if(lower != eMap.begin())
          {
@@ -378,6 +566,9 @@ namespace gpstk
                delete emi->second;
             eMap.erase(upper, eMap.end());
          }
+
+         if(useWindow)
+            windowCount -= before - eMap.size();
       }
 
       initialTime = tmin;
@@ -387,6 +578,7 @@ namespace gpstk
    //---------------------------------------------------------------------------------
    void OrbitEphStore::clear(void)
    {
+      ReadWriteLock::WriteGuard guard(windowLock, useWindow);
       for(SatTableMap::iterator ui=satTables.begin(); ui!=satTables.end(); ui++) {
          TimeOrbitEphTable& toet = ui->second;
          for(TimeOrbitEphTable::iterator toeti = toet.begin(); toeti != toet.end(); toeti++) {
@@ -396,6 +588,10 @@ namespace gpstk
       }
 
       satTables.clear();
+      ephCache.clear();
+      windowOrder.clear();
+      windowCount = 0;
+      windowLatest = CommonTime::BEGINNING_OF_TIME;
 
       initialTime = CommonTime::END_OF_TIME;
       initialTime.setTimeSystem(timeSystem);
@@ -403,9 +599,115 @@ namespace gpstk
       finalTime.setTimeSystem(timeSystem);
    }
 
+   //---------------------------------------------------------------------------------
+   void OrbitEphStore::enableWindow(double length, unsigned maxEph)
+   {
+      if(!(length > 0.0) || maxEph == 0) {
+         InvalidParameter ip("Window length and size must be positive");
+         GPSTK_THROW(ip);
+      }
+
+      useWindow = true;
+      windowLength = length;
+      windowMaxEph = maxEph;
+      windowEvictions = 0;
+      rebuildWindow();
+   }
+
+   //---------------------------------------------------------------------------------
+   void OrbitEphStore::rebuildWindow(void)
+   {
+      // queue what is already in the store, earliest first
+      vector<pair<CommonTime, pair<SatID, CommonTime> > > all;
+      windowLatest = CommonTime::BEGINNING_OF_TIME;
+      for(SatTableMap::const_iterator it = satTables.begin();
+          it != satTables.end(); it++) {
+         TimeOrbitEphTable::const_iterator ei;
+         for(ei = it->second.begin(); ei != it->second.end(); ei++) {
+            all.push_back(make_pair(ei->second->beginValid,
+                                    make_pair(it->first, ei->first)));
+            if(ei->second->beginValid > windowLatest)
+               windowLatest = ei->second->beginValid;
+         }
+      }
+      std::stable_sort(all.begin(), all.end(),
+                       [](const pair<CommonTime, pair<SatID, CommonTime> >& l,
+                          const pair<CommonTime, pair<SatID, CommonTime> >& r)
+                       { return l.first < r.first; });
+      windowOrder.clear();
+      for(size_t i = 0; i < all.size(); i++)
+         windowOrder.push_back(all[i].second);
+      windowCount = all.size();
+
+      evictWindow();
+   }
+
+   //---------------------------------------------------------------------------------
+   CommonTime OrbitEphStore::getWindowStart(void) const
+   {
+      ReadWriteLock::ReadGuard guard(windowLock, useWindow);
+      if(!useWindow || windowLatest == CommonTime::BEGINNING_OF_TIME)
+         return CommonTime::BEGINNING_OF_TIME;
+      return windowLatest - windowLength;
+   }
+
+   //---------------------------------------------------------------------------------
+   bool OrbitEphStore::windowNeeds(const TimeOrbitEphTable& toet,
+                                   TimeOrbitEphTable::const_iterator it) const
+   {
+      const CommonTime start(windowLatest - windowLength);
+      if(it->second->endValid < start)
+         return false;                                      // expired
+      TimeOrbitEphTable::const_iterator next = it;
+      ++next;
+      return (next == toet.end() || next->first > start);   // not superseded
+   }
+
+   //---------------------------------------------------------------------------------
+   // Ephemerides arrive roughly in time order, so those added earliest
+   // are the first to fall out of the window.  Stop at the first one still
+   // needed; any behind it that are not wait until it goes.
+   void OrbitEphStore::evictWindow(void)
+   {
+      if(windowLatest == CommonTime::BEGINNING_OF_TIME)
+         return;
+
+      while(!windowOrder.empty()) {
+         const SatID sat(windowOrder.front().first);
+         SatTableMap::iterator sit = satTables.find(sat);
+         if(sit == satTables.end()) {
+            windowOrder.pop_front();
+            continue;
+         }
+         TimeOrbitEphTable& toet = sit->second;
+         TimeOrbitEphTable::iterator it = toet.find(windowOrder.front().second);
+         if(it == toet.end()) {
+            // replaced, or removed by edit()
+            windowOrder.pop_front();
+            continue;
+         }
+
+         if(windowCount <= windowMaxEph && windowNeeds(toet, it))
+            break;
+
+         delete it->second;
+         toet.erase(it);
+         clearEphCache(sat);
+         windowOrder.pop_front();
+         windowCount--;
+         windowEvictions++;
+      }
+
+      CommonTime ct(windowLatest - windowLength);
+      ct.setTimeSystem(timeSystem);
+      if(initialTime < ct)
+         initialTime = ct;
+   }
+
    //---------------------------------------------------------------------------------
    unsigned OrbitEphStore::size(void) const
    {
+      ReadWriteLock::ReadGuard guard(windowLock, useWindow);
       unsigned counter = 0;
       SatTableMap::const_iterator it;
       for(it = satTables.begin(); it != satTables.end(); it++)
@@ -416,6 +718,7 @@ namespace gpstk
    //---------------------------------------------------------------------------------
    unsigned OrbitEphStore::size(const SatID& sat) const
    {
+      ReadWriteLock::ReadGuard guard(windowLock, useWindow);
       unsigned n(0);
       SatTableMap::const_iterator it;
       if(sat.id == -1) {
@@ -440,95 +743,94 @@ namespace gpstk
    // @return a pointer to the desired OrbitEph, or NULL if no OrbitEph found.
    const OrbitEph* OrbitEphStore::findUserOrbitEph(const SatID& sat,
                                                    const CommonTime& t) const
+   {
+      ReadWriteLock::ReadGuard guard(windowLock, useWindow);
+      UserEphInterval ival;
+      UserEphInterval *cached = (useEphCache ? findEphCache(sat) : NULL);
+
+      // Consecutive calls for a satellite nearly always fall between
+      // the same two keys of its table, so try the last interval found.
+      if(cached != NULL) {
+         std::lock_guard<std::mutex> guard(ephCacheLock(sat));
+         if(cached->contains(t))
+            ival = *cached;
+      }
+
+      if(ival.found)
+         ephCacheHits++;
+      else {
+         if(!findUserEphInterval(sat, t, ival))
+            return NULL;
+         if(cached != NULL) {
+            std::lock_guard<std::mutex> guard(ephCacheLock(sat));
+            *cached = ival;
+            ephCacheMisses++;
+         }
+      }
+
+      // The key of next is the EARLIEST time it should be used, and
+      // it takes ~30 seconds from beginning of transmission to complete
+      // reception, so prefer next but fall back to the PRIOR set.
+      // There may be gaps in the middle of the map and cases where
+      // periods of effectivity do not overlap, so either may be invalid.
+      return ival.select(t);
+
+   }  // end OrbitEph* OrbitEphStore::findUserOrbitEph
+
+
+   //---------------------------------------------------------------------------------
+   bool OrbitEphStore::findUserEphInterval(const SatID& sat,
+                                           const CommonTime& t,
+                                           UserEphInterval& ival) const
    {
       // Is this satellite found in the table?
-      if(satTables.find(sat) == satTables.end())
-         return NULL;
+      SatTableMap::const_iterator sit = satTables.find(sat);
+      if(sit == satTables.end())
+         return false;
       // Define reference to the relevant map of orbital elements
-      const TimeOrbitEphTable& table = getTimeOrbitEphMap(sat);
+      const TimeOrbitEphTable& table = sit->second;
+
+      if (table.empty())
+         return false;
 
       // The map is ordered by beginning times of validity, which
       // is another way of saying "earliest transmit time".  A call
       // to table.lower_bound(t) will return the element of the map
-      // with a key "just beyond t" assuming the t is NOT a direct match for any key.
-
-      if (table.empty())
-         return NULL;
-
-      TimeOrbitEphTable::const_iterator it = table.find(t);
-      if(it == table.end()) {                   // not a direct match
-         it = table.lower_bound(t);
-
-         // Tricky case here.  If the key is beyond the last key in the table,
-         // lower_bound() will return table.end(). However, this doesn't entirely
-         // settle the matter. It is theoretically possible that the final
-         // item in the table may have an effectivity that "stretches" far enough
-         // to cover time t. Therefore, if it==table.end() we need to check
-         // the period of validity of the final element in the table against time t.
-         if(it == table.end()) {
-            TimeOrbitEphTable::const_reverse_iterator rit = table.rbegin();
-            if(rit->second->isValid(t))         // Last element in map works
-            {
-               return rit->second;
-            }
-
-            // have nothing
-            //string mess = "Time is beyond table for satellite " + asString(sat)
-            //   + " for time " + printTime(t,fmt);
-            //InvalidRequest e(mess);
-            //GPSTK_THROW(e);
-            return NULL;
-         }
-      }  // end if not a direct match
-
-      // Found a direct match. should probably use the PRIOR set
-      // since it takes ~30 seconds from beginning of transmission to complete
-      // reception.
-      // If lower_bound( ) was called, it points to the element after the time t,
-      // So either way, it points ONE BEYOND the element we want.
-      // The exception is if it is pointing to table.begin( ),
-      // then all of the elements in the map are too late.
-      if(it == table.begin()) {
-         if (it->second->isValid(t))
-         {
-            return it->second;
-         }
-         //string mess = "Time is before table for satellite " + asString(sat)
-         //      + " for time " + printTime(t,fmt);
-         //InvalidRequest e(mess);
-         //GPSTK_THROW(e);
-         return NULL;
+      // with key t, or the one "just beyond t" if there is none.
+      // Either way, it points ONE BEYOND the element we want.
+      TimeOrbitEphTable::const_iterator it = table.lower_bound(t);
+
+      ival = UserEphInterval();
+      ival.found = true;
+
+      // Tricky case here.  If the key is beyond the last key in the table,
+      // lower_bound() will return table.end(). However, this doesn't entirely
+      // settle the matter. It is theoretically possible that the final
+      // item in the table may have an effectivity that "stretches" far enough
+      // to cover time t, so it remains the prior candidate.
+      if(it != table.end()) {
+         ival.hasUpper = true;
+         ival.upper = it->first;
+         ival.next = it->second;
       }
 
-      // The iterator should be a valid iterator and set one beyond
-      // the item of interest. However, there may be gaps in the
-      // middle of the map and cases where periods of effectivity do
-      // not overlap. That's OK, the key represents the EARLIEST
-      // time the elements should be used.  Therefore, we can
-      // decrement the counter and test to see if the element is valid.
-      if (it->second->isValid(t))
-      {
-         return it->second;
-      }
-      it--;
-      if(!(it->second->isValid(t))) {
-         //// there is a "hole" in the middle of a map.
-         //string mess = "No orbital elements found for satellite " + asString(sat)
-         //   + " at time " + printTime(t,fmt);
-         //InvalidRequest e(mess);
-         //GPSTK_THROW(e);
-         return NULL;
+      // If it is pointing to table.begin( ), then all of the elements
+      // in the map are too late, and there is no prior candidate.
+      if(it != table.begin()) {
+         --it;
+         ival.hasLower = true;
+         ival.lower = it->first;
+         ival.prior = it->second;
       }
 
-      return it->second;
-
-   }  // end OrbitEph* OrbitEphStore::findUserOrbitEph
-
+      return true;
+   }
 
    //---------------------------------------------------------------------------------
    const OrbitEph* OrbitEphStore::findNearOrbitEph(const SatID& sat,
                                                    const CommonTime& t) const
    {
+      ReadWriteLock::ReadGuard guard(windowLock, useWindow);
         // Check for any OrbitEph for this SV
       if(satTables.find(sat) == satTables.end())
          return NULL;
@@ -621,6 +923,7 @@ namespace gpstk
    // @return the number of ephemerides added.
    int OrbitEphStore::addToList(list<OrbitEph*>& v, SatID sat) const
    {
+      ReadWriteLock::ReadGuard guard(windowLock, useWindow);
       int n = 0;
       SatTableMap::const_iterator it;
       for (it = satTables.begin(); it != satTables.end(); it++)
@@ -644,6 +947,7 @@ namespace gpstk
    const OrbitEphStore::TimeOrbitEphTable&
       OrbitEphStore::getTimeOrbitEphMap(const SatID& sat) const
    {
+      ReadWriteLock::ReadGuard guard(windowLock, useWindow);
       SatTableMap::const_iterator it = satTables.find(sat);
       if(it == satTables.end()) {
          InvalidRequest e("No OrbitEph for satellite " + asString(sat));
@@ -658,6 +962,7 @@ namespace gpstk
    //---------------------------------------------------------------------------------
    set<SatID> OrbitEphStore::getIndexSet() const
    {
+      ReadWriteLock::ReadGuard guard(windowLock, useWindow);
       set<SatID> retSet;
       SatTableMap::const_iterator cit;
       for (cit=satTables.begin();cit!=satTables.end();cit++)
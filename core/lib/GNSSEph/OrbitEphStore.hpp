@@ -49,14 +49,19 @@
 #define GPSTK_ORBITEPHSTORE_HPP
 
 #include <iostream>
+#include <atomic>
+#include <deque>
 #include <list>
+#include <mutex>
 #include <set>
+#include <vector>
 
 #include "OrbitEph.hpp"
 #include "Exception.hpp"
 #include "SatID.hpp"
 #include "CommonTime.hpp"
 #include "XvtStore.hpp"
+#include "ReadWriteLock.hpp"
 //#include "Rinex3NavData.hpp"
 
 namespace gpstk
@@ -80,7 +85,11 @@ namespace gpstk
       OrbitEphStore()
             : initialTime(CommonTime::END_OF_TIME),
               finalTime(CommonTime::BEGINNING_OF_TIME),
-              strictMethod(true)
+              strictMethod(true), useEphCache(true),
+              ephCacheHits(0), ephCacheMisses(0),
+              useWindow(false), windowLength(0), windowMaxEph(0),
+              windowLatest(CommonTime::BEGINNING_OF_TIME),
+              windowCount(0), windowEvictions(0)
       {
          timeSystem = TimeSystem::Any;
          initialTime.setTimeSystem(timeSystem);
@@ -88,6 +97,47 @@ namespace gpstk
          setOnlyHealthyFlag(false);
       }
 
+         /** Copy constructor.  Like the default copy, this copies the
+          * OrbitEph pointers, not the objects.  The lookup cache
+          * starts empty. */
+      OrbitEphStore(const OrbitEphStore& right)
+            : XvtStore<SatID>(right), message(right.message),
+              satTables(right.satTables), initialTime(right.initialTime),
+              finalTime(right.finalTime), timeSystem(right.timeSystem),
+              strictMethod(right.strictMethod),
+              useEphCache(right.useEphCache),
+              ephCacheHits(0), ephCacheMisses(0),
+              useWindow(right.useWindow), windowLength(right.windowLength),
+              windowMaxEph(right.windowMaxEph),
+              windowLatest(right.windowLatest),
+              windowOrder(right.windowOrder),
+              windowCount(right.windowCount), windowEvictions(0)
+      { clearEphCache(); }
+
+         /// Assignment operator; see the copy constructor.
+      OrbitEphStore& operator=(const OrbitEphStore& right)
+      {
+         if(this == &right)
+            return *this;
+         XvtStore<SatID>::operator=(right);
+         message = right.message;
+         satTables = right.satTables;
+         initialTime = right.initialTime;
+         finalTime = right.finalTime;
+         timeSystem = right.timeSystem;
+         strictMethod = right.strictMethod;
+         useEphCache = right.useEphCache;
+         useWindow = right.useWindow;
+         windowLength = right.windowLength;
+         windowMaxEph = right.windowMaxEph;
+         windowLatest = right.windowLatest;
+         windowOrder = right.windowOrder;
+         windowCount = right.windowCount;
+         windowEvictions = 0;
+         clearEphCache();
+         return *this;
+      }
+
          /// Destructor
       virtual ~OrbitEphStore() { clear(); }
 
@@ -122,6 +172,46 @@ namespace gpstk
       virtual Xvt computeXvt(const SatID& id, const CommonTime& t) const
          throw();
 
+         /** Returns the position, velocity, and clock offset of each
+          * of the indicated satellites at the indicated time, agreeing
+          * with getXvt(id,t) for each to well under a mm, but computed
+          * together using OrbitEph::svXvt(ephs,times).
+          * @param[in] ids the satellites of interest
+          * @param[in] t the time to look up
+          * @return the Xvt of each satellite in ids at time t
+          * @throw InvalidRequest if any of the satellites is not
+          *   stored or has no orbit elements at time t, or if
+          *   onlyHealthy is set and one is unhealthy. */
+      std::vector<Xvt> getXvt(const std::vector<SatID>& ids,
+                              const CommonTime& t) const;
+
+         /** Compute the position, velocity and clock offset of each of
+          * the indicated satellites at the indicated time, like
+          * computeXvt(id,t) for each, but computed together using
+          * OrbitEph::svXvt(ephs,times).  Satellites with no orbit
+          * elements at time t have health Unavailable.
+          * @param[in] ids the satellites of interest
+          * @param[in] t the time to look up
+          * @return the Xvt of each satellite in ids at time t */
+      std::vector<Xvt> computeXvt(const std::vector<SatID>& ids,
+                                  const CommonTime& t) const throw();
+
+         /** Get the position, velocity, and clock offset of each of
+          * the indicated satellites, each at its own time, agreeing
+          * with getXvt(ids[i],times[i]) to well under a mm, but
+          * computed together using OrbitEph::svXvt(ephs,times).  Satellites
+          * for which getXvt() would throw have found[i] false.
+          * @param[in] ids the satellites of interest
+          * @param[in] times the time to look up for each of ids
+          * @param[out] xvts the Xvt of each of ids
+          * @param[out] found true where xvts is defined
+          * @return the number of satellites found
+          * @throw InvalidParameter if ids and times differ in size */
+      virtual int getXvts(const std::vector<SatID>& ids,
+                          const std::vector<CommonTime>& times,
+                          std::vector<Xvt>& xvts,
+                          std::vector<bool>& found) const;
+
          /** Get the satellite health at a specific time.
           * @param[in] id the object's identifier
           * @param[in] t the time to look up
@@ -159,12 +249,18 @@ namespace gpstk
          /** Return the earliest time in the store.
           * @return The store initial time */
       virtual CommonTime getInitialTime() const
-      { return initialTime; }
+      {
+         ReadWriteLock::ReadGuard guard(windowLock, useWindow);
+         return initialTime;
+      }
 
          /** Return the latest time in the store.
           * @return The store final time */
       virtual CommonTime getFinalTime() const
-      { return finalTime; }
+      {
+         ReadWriteLock::ReadGuard guard(windowLock, useWindow);
+         return finalTime;
+      }
 
          /** Return the earliest time in the store for the given satellite.
           * @todo make work for sat = -1, system
@@ -172,6 +268,7 @@ namespace gpstk
           * @return The store initial time */
       virtual CommonTime getInitialTime(const SatID& sat) const
       {
+         ReadWriteLock::ReadGuard guard(windowLock, useWindow);
          if(satTables.find(sat) == satTables.end())
             return CommonTime::END_OF_TIME;
 
@@ -191,6 +288,7 @@ namespace gpstk
           * @return The store final time */
       virtual CommonTime getFinalTime(const SatID& sat) const
       {
+         ReadWriteLock::ReadGuard guard(windowLock, useWindow);
          if(satTables.find(sat) == satTables.end())
             return CommonTime::END_OF_TIME;
 
@@ -216,6 +314,7 @@ namespace gpstk
          /// Return true if the given SatID is present in the store
       virtual bool isPresent(const SatID& sat) const
       {
+         ReadWriteLock::ReadGuard guard(windowLock, useWindow);
          if(satTables.find(sat) != satTables.end()) return true;
          return false;
       }
@@ -245,7 +344,9 @@ namespace gpstk
           *   given satellite. */
       unsigned size(const SatID& sat) const;
 
-         /** Add an OrbitEph object to this collection.
+         /** Add an OrbitEph object to this collection.  If the
+          * sliding window is enabled, delete any ephemerides that the
+          * window no longer needs; see enableWindow().
           * @param eph pointer to the OrbitEph to add
           * @return pointer to new OrbitEph if it successful, NULL otherwise */
       virtual OrbitEph* addEphemeris(const OrbitEph* eph);
@@ -261,6 +362,7 @@ namespace gpstk
           * already exists in table. */
       bool isPresent(const SatID& sat, const CommonTime& t) const
       {
+         ReadWriteLock::ReadGuard guard(windowLock, useWindow);
          if(satTables.find(sat) == satTables.end())
             return false;
          const TimeOrbitEphTable& table = getTimeOrbitEphMap(sat);
@@ -294,6 +396,111 @@ namespace gpstk
                                                const CommonTime& t)
          const;
 
+         /** Return true if findUserOrbitEph() remembers, for each
+          * satellite, the last pair of candidate ephemerides it
+          * searched the table for (the default). */
+      bool isEphCache(void) const
+      { return useEphCache; }
+
+         /** Have findUserOrbitEph() remember the candidates it found
+          * for each satellite, so that later calls for times between
+          * the same two table entries skip the search.  It returns
+          * the same ephemeris with or without the cache.  The cache
+          * is on by default. */
+      void enableEphCache(void)
+      {
+         useEphCache = true;
+         clearEphCache();
+         resetEphCacheStats();
+      }
+
+         /// Stop using the lookup cache, and free it.
+      void disableEphCache(void)
+      {
+         useEphCache = false;
+         clearEphCache();
+      }
+
+         /** Get the number of findUserOrbitEph() calls answered from
+          * the lookup cache since its counts were last reset. */
+      unsigned long getEphCacheHits(void) const
+      { return ephCacheHits; }
+
+         /** Get the number of findUserOrbitEph() calls that had to
+          * search the table. */
+      unsigned long getEphCacheMisses(void) const
+      { return ephCacheMisses; }
+
+         /// Zero the lookup cache hit and miss counts.
+      void resetEphCacheStats(void)
+      {
+         ephCacheHits = 0;
+         ephCacheMisses = 0;
+      }
+
+         /** Return true if the store keeps only a sliding window of
+          * ephemerides; see enableWindow(). */
+      bool isWindow(void) const
+      { return useWindow; }
+
+         /** Keep only the ephemerides needed for times in a window
+          * that slides forward as ephemerides are added, for
+          * unattended real-time use where ephemerides arrive
+          * continuously, e.g. from LNavEphMaker.
+          *
+          * The window ends at the latest beginValid of any ephemeris
+          * passed to addEphemeris(), including copies it doesn't
+          * keep, and starts length seconds before that.  After each
+          * addEphemeris(), the store deletes the ephemerides that are
+          * superseded, meaning the next ephemeris for the satellite
+          * begins before the window starts, or expired, meaning
+          * their endValid is before the window starts.  With the
+          * user search method, findUserOrbitEph() then returns the
+          * same ephemeris at any time in the window as it would with
+          * nothing deleted.  If the store still holds more than
+          * maxEph ephemerides, it deletes the ones added earliest
+          * until it doesn't, regardless of the window.  An
+          * ephemeris that is already expired or superseded when it
+          * is added is not kept, and addEphemeris() returns NULL.
+          *
+          * Ephemerides are checked for deletion in the order they
+          * were added, so each addEphemeris() does a constant
+          * amount of work on average.
+          *
+          * While the window is enabled, one thread may add
+          * ephemerides while any number of others call the const
+          * methods: each call waits for, or holds off, any
+          * addEphemeris(), edit() or clear() in progress.  Pointers
+          * and references returned by findOrbitEph() and the like
+          * may be deleted by the next addEphemeris(), so readers in
+          * other threads should use getXvt(), computeXvt() and
+          * getSVHealth(), which are done before the lock is
+          * released.  Other configuration, such as enabling or
+          * disabling the window, must not overlap any other call.
+          * @param[in] length seconds from the start of the window to
+          *   the latest beginValid.
+          * @param[in] maxEph the most ephemerides to keep.
+          * @throw InvalidParameter if length or maxEph isn't positive. */
+      void enableWindow(double length, unsigned maxEph);
+
+         /// Stop deleting ephemerides; keep all those added from now on.
+      void disableWindow(void)
+      {
+         useWindow = false;
+         windowOrder.clear();
+         windowCount = 0;
+      }
+
+         /** Return the start of the sliding window, before which
+          * ephemerides may have been deleted, or BEGINNING_OF_TIME
+          * if there is no window or nothing has been added to it. */
+      CommonTime getWindowStart(void) const;
+
+         /** Get the number of ephemerides that the sliding window has
+          * deleted since it was enabled. */
+      unsigned long getWindowEvictions(void) const
+      { return windowEvictions; }
+
          /** Find an OrbitEph for the indicated satellite at time
           * t. The OrbitEph chosen is the one with HOW time closest to
           * the time t, (i.e. with smallest fabs(t-HOW), but still
@@ -388,6 +595,151 @@ namespace gpstk
          /// flag indicating search method (find...Eph) to use.
       bool strictMethod;
 
+         /** The times, for one satellite, between two adjacent keys
+          * of its TimeOrbitEphTable.  For any time t in (lower, upper],
+          * findUserOrbitEph() returns next if it is valid at t, else
+          * prior if it is valid at t, else NULL.  Before the first key
+          * there is no lower bound or prior; after the last key there
+          * is no upper bound or next. */
+      struct UserEphInterval
+      {
+         UserEphInterval()
+               : found(false), hasLower(false), hasUpper(false),
+                 prior(NULL), next(NULL)
+         {}
+
+            /// Return true if t is in the interval.
+         bool contains(const CommonTime& t) const
+         {
+            return (found && (!hasLower || lower < t) &&
+                    (!hasUpper || t <= upper));
+         }
+
+            /// Choose the ephemeris for time t in the interval.
+         const OrbitEph* select(const CommonTime& t) const
+         {
+            if(next != NULL && next->isValid(t))
+               return next;
+            if(prior != NULL && prior->isValid(t))
+               return prior;
+            return NULL;
+         }
+
+         bool found;                ///< false until the interval is set
+         bool hasLower, hasUpper;   ///< false where the interval is open
+         CommonTime lower, upper;   ///< keys bounding the interval
+         const OrbitEph *prior;     ///< OrbitEph with key lower
+         const OrbitEph *next;      ///< OrbitEph with key upper
+      };
+
+         /** Find the interval of sat's table containing t.
+          * @return false if there are no OrbitEph for sat. */
+      bool findUserEphInterval(const SatID& sat, const CommonTime& t,
+                               UserEphInterval& ival) const;
+
+         /** Return the cache entry for sat, or NULL if it has none.
+          * There is an entry for every satellite in satTables, made
+          * when the satellite is added, so that const callers never
+          * resize ephCache. */
+      UserEphInterval* findEphCache(const SatID& sat) const
+      {
+         unsigned sys(static_cast<unsigned>(sat.system));
+         if(sys >= ephCache.size() || sat.id < 0 ||
+            sat.id >= int(ephCache[sys].size()))
+            return NULL;
+         return &ephCache[sys][sat.id];
+      }
+
+         /// Return the lock guarding the cache entry for sat.
+      std::mutex& ephCacheLock(const SatID& sat) const
+      {
+         unsigned key(static_cast<unsigned>(sat.system) * 61 +
+                      static_cast<unsigned>(sat.id));
+         return ephCacheLocks[key % ephCacheLockCount];
+      }
+
+         /** Forget the cached interval for one satellite, making its
+          * entry if needed.  Call whenever its TimeOrbitEphTable
+          * changes. */
+      void clearEphCache(const SatID& sat)
+      {
+         if(sat.id < 0)
+            return;
+         unsigned sys(static_cast<unsigned>(sat.system));
+         if(sys >= ephCache.size())
+            ephCache.resize(sys+1);
+         if(sat.id >= int(ephCache[sys].size()))
+            ephCache[sys].resize(sat.id+1);
+         ephCache[sys][sat.id] = UserEphInterval();
+      }
+
+         /** Forget all cached intervals, leaving an entry for each
+          * satellite in satTables.  Call whenever more than one
+          * TimeOrbitEphTable changes, or any keys change. */
+      void clearEphCache(void)
+      {
+         ephCache.clear();
+         SatTableMap::const_iterator it;
+         for(it = satTables.begin(); it != satTables.end(); it++)
+            clearEphCache(it->first);
+      }
+
+         /// If true, findUserOrbitEph() uses ephCache.
+      bool useEphCache;
+         /** The last interval found by findUserOrbitEph() for each
+          * satellite, indexed by system then id, so that a lookup
+          * doesn't search satTables. */
+      mutable std::vector<std::vector<UserEphInterval> > ephCache;
+         /// Cache statistics, for tuning and testing.
+      mutable std::atomic<unsigned long> ephCacheHits, ephCacheMisses;
+         /// number of locks guarding the entries of ephCache
+      static const unsigned ephCacheLockCount = 16;
+         /** Guards for the entries of ephCache; satellites share them
+          * as chosen by ephCacheLock(). */
+      mutable std::mutex ephCacheLocks[ephCacheLockCount];
+
+         /** Add eph to satTables, without the locking or deletions
+          * done by addEphemeris(), which returns what this does. */
+      OrbitEph* insertEphemeris(const OrbitEph* eph);
+
+         /** Return true if the ephemeris at it in toet may still be
+          * chosen for a time in the sliding window, i.e. it is
+          * neither expired nor superseded; see enableWindow(). */
+      bool windowNeeds(const TimeOrbitEphTable& toet,
+                       TimeOrbitEphTable::const_iterator it) const;
+
+         /** Delete the ephemerides, in the order added, that are no
+          * longer needed for the sliding window. */
+      void evictWindow(void);
+
+         /** Queue every ephemeris in satTables for the sliding window,
+          * in order of beginValid, then call evictWindow().  Call
+          * after changing keys. */
+      void rebuildWindow(void);
+
+         /// If true, addEphemeris() keeps only a sliding window.
+      bool useWindow;
+         /// Seconds from the start of the window to windowLatest.
+      double windowLength;
+         /// Most ephemerides kept with the sliding window.
+      unsigned windowMaxEph;
+         /// Latest beginValid of the ephemerides added to the window.
+      CommonTime windowLatest;
+         /** Satellite and table key of each ephemeris added with the
+          * window enabled, in the order added.  Entries whose
+          * ephemeris was since replaced or removed by other means
+          * are dropped when they reach the front. */
+      std::deque<std::pair<SatID, CommonTime> > windowOrder;
+         /** Number of ephemerides in satTables while the window is
+          * enabled, which windowOrder overcounts by its stale
+          * entries. */
+      unsigned windowCount;
+         /// Number of ephemerides deleted by evictWindow().
+      std::atomic<unsigned long> windowEvictions;
+         /** Held to write by methods that change satTables while the
+          * window is enabled, and to read by const methods. */
+      mutable ReadWriteLock windowLock;
+
          /// Convenience routines
       void updateTimeLimits(const OrbitEph* eph)
       {
@@ -107,6 +107,9 @@ namespace gpstk
             return rec;
          }
 
+         if(useInterpCache)
+            return getCachedValue(sat, ttag, isExact, it1, it2);
+
          // pull data out of the data table
          size_t n,Nlow(Nhalf-1),Nhi(Nhalf),Nmatch(Nhalf);
          CommonTime ttag0(it1->first);
@@ -187,6 +190,79 @@ namespace gpstk
       catch(InvalidRequest& e) { GPSTK_RETHROW(e); }
    }
 
+   // Interpolate for getValue() using the interpolation cache; this follows
+   // getValue(), but computes the Lagrange coefficients once for all the
+   // components, using weights kept with the cached interval.
+   PositionRecord PositionSatStore::getCachedValue(const SatID& sat,
+                                                   const CommonTime& ttag,
+                                                   bool isExact,
+                                                   const DataTableIterator& it1,
+                                                   const DataTableIterator& it2)
+      const
+   {
+      int i;
+      size_t n,N,Nlow(Nhalf-1),Nhi(Nhalf),Nmatch(Nhalf);
+      PositionRecord rec;
+      shared_ptr<const InterpWindow> win(getInterpWindow(sat, it1, it2));
+      const vector<PositionRecord>& recs(win->recs);
+      double dt(ttag - win->first);       // dt in seconds
+      N = recs.size();
+
+      // find index matching ttag
+      if(isExact)
+         for(n=0; n<N; n++)
+            if(ABS(win->times[n] - dt) < 1.e-8)
+               Nmatch = n;
+      if(isExact && Nmatch == Nhalf-1) { Nlow++; Nhi++; }
+
+      // Lagrange coefficients for value (L) and derivative (Lp)
+      vector<double> L,Lp;
+      LagrangeCoefficients(win->times, win->weights, dt, L, Lp);
+
+      rec.sigAcc = rec.Acc = Triple(0,0,0);        // default
+      for(i=0; i<3; i++) {
+         double P(0.0),V(0.0),dV(0.0),A(0.0),dP(0.0);
+         for(n=0; n<N; n++) {
+            P += L[n]*recs[n].Pos[i];
+            if(haveVelocity) {
+               V += L[n]*recs[n].Vel[i];
+               if(haveAcceleration)
+                  A += L[n]*recs[n].Acc[i];
+               else
+                  dV += Lp[n]*recs[n].Vel[i];
+            }
+            else
+               dP += Lp[n]*recs[n].Pos[i];
+         }
+
+         rec.Pos[i] = P;
+         if(haveVelocity) {
+            rec.Vel[i] = V;
+            rec.Acc[i] = (haveAcceleration ? A : dV*0.1);  // dm/s/s -> m/s/s
+            if(isExact) {
+               rec.sigPos[i] = recs[Nmatch].sigPos[i];
+               rec.sigVel[i] = recs[Nmatch].sigVel[i];
+               if(haveAcceleration) rec.sigAcc[i] = recs[Nmatch].sigAcc[i];
+            }
+            else {
+               rec.sigPos[i] = RSS(recs[Nhi].sigPos[i],recs[Nlow].sigPos[i]);
+               rec.sigVel[i] = RSS(recs[Nhi].sigVel[i],recs[Nlow].sigVel[i]);
+               if(haveAcceleration)
+                  rec.sigAcc[i] = RSS(recs[Nhi].sigAcc[i],recs[Nlow].sigAcc[i]);
+            }
+         }
+         else {
+            rec.Vel[i] = dP*10000.;                     // km/sec -> dm/sec
+            if(isExact)
+               rec.sigPos[i] = recs[Nmatch].sigPos[i];
+            else
+               rec.sigPos[i] = RSS(recs[Nhi].sigPos[i],recs[Nlow].sigPos[i]);
+            rec.sigVel[i] = 0.0;
+         }
+      }
+      return rec;
+   }
+
    // Return the position for the given satellite at the given time
    // @param[in] sat the SatID of the satellite of interest
    // @param[in] ttag the time (CommonTime) of interest
@@ -350,6 +426,7 @@ namespace gpstk
    {
       try {
          checkTimeSystem(ttag.getTimeSystem());
+         clearInterpCache(sat);
 
          int i;
          if(!haveVelocity)
@@ -359,6 +436,9 @@ namespace gpstk
             for(i=0; i<3; i++)
                if(rec.Acc[i] != 0.0) { haveAcceleration = true; break; }
 
+         if(archiveRecord(sat, ttag, rec))
+            return;
+
          if(tables.find(sat) != tables.end() &&
             tables[sat].find(ttag) != tables[sat].end()) {
                   // record already exists in table
@@ -370,6 +450,7 @@ namespace gpstk
          }
          else {   // create a new entry in the table
             tables[sat][ttag] = rec;
+            addToFlatTable(sat, ttag);
          }
       }
       catch(InvalidRequest& ir) { GPSTK_RETHROW(ir); }
@@ -381,6 +462,8 @@ namespace gpstk
    {
       try {
          checkTimeSystem(ttag.getTimeSystem());
+         clearInterpCache(sat);
+         expandArchive(sat);
 
          if(tables.find(sat) != tables.end() &&
             tables[sat].find(ttag) != tables[sat].end()) {
@@ -396,6 +479,7 @@ namespace gpstk
             rec.Vel = rec.sigVel = rec.Acc = rec.sigAcc = Triple(0,0,0);
 
             tables[sat][ttag] = rec;
+            addToFlatTable(sat, ttag);
          }
       }
       catch(InvalidRequest& ir) { GPSTK_RETHROW(ir); }
@@ -407,6 +491,8 @@ namespace gpstk
    {
       try {
          checkTimeSystem(ttag.getTimeSystem());
+         clearInterpCache(sat);
+         expandArchive(sat);
 
          haveVelocity = true;
 
@@ -424,6 +510,7 @@ namespace gpstk
             rec.Pos = rec.sigPos = rec.Acc = rec.sigAcc = Triple(0,0,0);
 
             tables[sat][ttag] = rec;
+            addToFlatTable(sat, ttag);
          }
       }
       catch(InvalidRequest& ir) { GPSTK_RETHROW(ir); }
@@ -435,6 +522,8 @@ namespace gpstk
    {
       try {
          checkTimeSystem(ttag.getTimeSystem());
+         clearInterpCache(sat);
+         expandArchive(sat);
 
          haveAcceleration = true;
 
@@ -452,11 +541,40 @@ namespace gpstk
             rec.Vel = rec.sigVel = rec.Pos = rec.sigPos = Triple(0,0,0);
 
             tables[sat][ttag] = rec;
+            addToFlatTable(sat, ttag);
          }
       }
       catch(InvalidRequest& ir) { GPSTK_RETHROW(ir); }
    }
 
+   // Store a PositionRecord as the fields of an ArchiveTable.
+   void PositionSatStore::toArchiveFields(const PositionRecord& rec,
+                                          double *fields) const
+   {
+      for(int i=0; i<3; i++) {
+         fields[i] = rec.Pos[i];
+         fields[3+i] = rec.sigPos[i];
+         fields[6+i] = rec.Vel[i];
+         fields[9+i] = rec.sigVel[i];
+         fields[12+i] = rec.Acc[i];
+         fields[15+i] = rec.sigAcc[i];
+      }
+   }
+
+   // Fill a PositionRecord from the fields of an ArchiveTable.
+   void PositionSatStore::fromArchiveFields(const double *fields,
+                                            PositionRecord& rec) const
+   {
+      for(int i=0; i<3; i++) {
+         rec.Pos[i] = fields[i];
+         rec.sigPos[i] = fields[3+i];
+         rec.Vel[i] = fields[6+i];
+         rec.sigVel[i] = fields[9+i];
+         rec.Acc[i] = fields[12+i];
+         rec.sigAcc[i] = fields[15+i];
+      }
+   }
+
    //@}
 
 }  // End of namespace gpstk
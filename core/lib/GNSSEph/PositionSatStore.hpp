@@ -119,6 +119,30 @@ namespace gpstk
          /// Store half the interpolation order, for convenience
       unsigned int Nhalf;
 
+         /** Interpolate for getValue() using the interpolation cache
+          * (see enableInterpCache()).
+          * @param[in] sat the SatID of the satellite of interest
+          * @param[in] ttag the time (CommonTime) of interest
+          * @param[in] isExact true if ttag is one of the table times
+          * @param[in] it1 first record of the interval found by
+          *   getTableInterval()
+          * @param[in] it2 last record of the interval
+          * @return object of type PositionRecord containing the data
+          *   value(s). */
+      PositionRecord getCachedValue(const SatID& sat, const CommonTime& ttag,
+                                    bool isExact,
+                                    const DataTableIterator& it1,
+                                    const DataTableIterator& it2) const;
+
+         /** A PositionRecord is archived (see
+          * TabularSatStore::enableArchive()) as its 18 values,
+          * Pos, sigPos, Vel, sigVel, Acc and sigAcc in that order. */
+      virtual unsigned archiveFields(void) const { return 18; }
+      virtual void toArchiveFields(const PositionRecord& rec,
+                                   double *fields) const;
+      virtual void fromArchiveFields(const double *fields,
+                                     PositionRecord& rec) const;
+
          // member functions
    public:
 
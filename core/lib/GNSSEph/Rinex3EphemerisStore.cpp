@@ -42,6 +42,9 @@
 
 #include "Rinex3EphemerisStore.hpp"
 
+#include <atomic>
+#include <thread>
+
 #include "Rinex3NavStream.hpp"
 #include "Rinex3NavData.hpp"
 #include "GPSEphemeris.hpp"
@@ -116,74 +119,154 @@ namespace gpstk
    int Rinex3EphemerisStore::loadFile(const string& filename, bool dump, ostream& s)
    {
       try {
-         int nread(0);
-         Rinex3NavStream strm;
-         what = string();
-         
-         strm.open(filename.c_str(), ios::in);
-         if(!strm.is_open()) {
-            what = string("File ") + filename + string(" could not be opened.");
-            return -1;
-         }
-         strm.exceptions(ios::failbit);
+         NavFileContents contents;
+         readFile(filename, contents);
+         return addFileContents(filename, contents, dump, s);
+      }
+      catch(Exception& e) {
+         GPSTK_RETHROW(e);
+      }
+
+   } // end Rinex3EphemerisStore::loadFile
+
+   // load the given Rinex navigation files, reading them in parallel
+   int Rinex3EphemerisStore::loadFiles(const vector<string>& filenames,
+                                       unsigned numThreads)
+   {
+      vector<NavFileContents> contents(filenames.size());
+
+      if(numThreads == 0)
+         numThreads = std::thread::hardware_concurrency();
+      if(numThreads == 0)
+         numThreads = 1;
+      if(numThreads > filenames.size())
+         numThreads = filenames.size();
+
+      // each thread reads whichever file is next in the list into its
+      // own slot in contents
+      std::atomic<size_t> nextFile(0);
+      auto work = [&filenames, &contents, &nextFile]()
+      {
+         size_t i;
+         while((i = nextFile++) < filenames.size())
+            readFile(filenames[i], contents[i]);
+      };
+      vector<std::thread> workers;
+      for(unsigned i=1; i<numThreads; i++)
+         workers.push_back(std::thread(work));
+      work();
+      for(size_t i=0; i<workers.size(); i++)
+         workers[i].join();
+
+      // add them to the store in the order given
+      int nread(0);
+      for(size_t i=0; i<filenames.size(); i++) {
+         int n = addFileContents(filenames[i], contents[i], false, cout);
+         if(n < 0) return n;
+         nread += n;
+         // release the parsed records as soon as they're stored
+         vector<Rinex3NavData>().swap(contents[i].records);
+      }
+
+      return nread;
+   } // end Rinex3EphemerisStore::loadFiles
+
+   // read a Rinex navigation file into contents without changing the store
+   void Rinex3EphemerisStore::readFile(const string& filename,
+                                       NavFileContents& contents)
+   {
+      Rinex3NavStream strm;
+      Rinex3NavData rec;
+
+      strm.open(filename.c_str(), ios::in);
+      if(!strm.is_open()) {
+         contents.what = string("File ") + filename
+            + string(" could not be opened.");
+         contents.status = -1;
+         return;
+      }
+      strm.exceptions(ios::failbit);
+
+      try { strm >> contents.header; }
+      catch(Exception& e) {
+         contents.what = string("Failed to read header of file ") + filename
+            + string(" : ") + e.getText();
+         contents.status = -2;
+         return;
+      }
+      catch(...) {
+         contents.what = string("Failed to read header of file ") + filename;
+         contents.status = -2;
+         return;
+      }
 
-         try { strm >> Rhead; }
+      while(1) {
+         // read the record
+         try { strm >> rec; }
          catch(Exception& e) {
-            what = string("Failed to read header of file ") + filename
+            contents.what = string("Failed to read data in file ") + filename
                + string(" : ") + e.getText();
-            return -2;
+            contents.status = -3;
+            return;
          }
-         if(dump) Rhead.dump(s);
-
-         // add to FileStore
-         NavFiles.addFile(filename, Rhead);
-
-         // add to mapTimeCorr
-         if(Rhead.mapTimeCorr.size() > 0) {
-            map<string, TimeSystemCorrection>::const_iterator it;
-            for(it=Rhead.mapTimeCorr.begin(); it!=Rhead.mapTimeCorr.end(); ++it)
-               addTimeCorr(it->second);
+         catch(std::exception& e) {
+            contents.what = string("std excep: ") + e.what();
+            contents.status = -3;
+            return;
+         }
+         catch(...) {
+            contents.what = string("Unknown exception while reading data of file ")
+               + filename;
+            contents.status = -3;
+            return;
          }
 
-         while(1) {
-            // read the record
-            try { strm >> Rdata; }
-            catch(Exception& e) {
-               what = string("Failed to read data in file ") + filename
-                  + string(" : ") + e.getText();
-               return -3;
-            }
-            catch(std::exception& e) {
-               what = string("std excep: ") + e.what();
-               return -3;
-            }
-            catch(...) {
-               what = string("Unknown exception while reading data of file ")
-                  + filename;
-               return -3;
-            }
+         if(!strm.good() || strm.eof()) break;
 
-            if(!strm.good() || strm.eof()) break;
+         contents.records.push_back(rec);
+      }
+   } // end Rinex3EphemerisStore::readFile
 
-            nread++;
-            if(dump) Rdata.dump(s);
+   // add the contents of a file read by readFile() to the store
+   int Rinex3EphemerisStore::addFileContents(const string& filename,
+                                             const NavFileContents& contents,
+                                             bool dump, ostream& s)
+   {
+      what = contents.what;
+      if(contents.status == -1 || contents.status == -2)
+         return contents.status;
 
-            try {
-               addEphemeris(Rdata);
-            }
-            catch(Exception& e) {
-               cout << "addEphemeris caught excp " << e.what();
-               GPSTK_RETHROW(e);
-            }
-         }
+      Rhead = contents.header;
+      if(dump) Rhead.dump(s);
 
-         return nread;
+      // add to FileStore
+      NavFiles.addFile(filename, Rhead);
+
+      // add to mapTimeCorr
+      if(Rhead.mapTimeCorr.size() > 0) {
+         map<string, TimeSystemCorrection>::const_iterator it;
+         for(it=Rhead.mapTimeCorr.begin(); it!=Rhead.mapTimeCorr.end(); ++it)
+            addTimeCorr(it->second);
       }
-      catch(Exception& e) {
-         GPSTK_RETHROW(e);
+
+      for(size_t i=0; i<contents.records.size(); i++) {
+         if(dump) contents.records[i].dump(s);
+
+         try {
+            addEphemeris(contents.records[i]);
+         }
+         catch(Exception& e) {
+            cout << "addEphemeris caught excp " << e.what();
+            GPSTK_RETHROW(e);
+         }
       }
+      if(!contents.records.empty())
+         Rdata = contents.records.back();
 
-   } // end Rinex3EphemerisStore::loadFile
+      if(contents.status < 0)
+         return contents.status;
+      return contents.records.size();
+   } // end Rinex3EphemerisStore::addFileContents
 
    // Find the appropriate time system correction object in the collection for the
    // given time systems, and dump it to a string and return that string.
@@ -344,6 +427,69 @@ namespace gpstk
    }
 
 
+   int Rinex3EphemerisStore::getXvts(const vector<SatID>& sats,
+                                     const vector<CommonTime>& inttags,
+                                     vector<Xvt>& xvts,
+                                     vector<bool>& found) const
+   {
+      if(sats.size() != inttags.size()) {
+         InvalidParameter e("ids and times differ in size");
+         GPSTK_THROW(e);
+      }
+
+      int n(0);
+      size_t i;
+      vector<SatID> orbSats;
+      vector<CommonTime> orbTimes;
+      vector<size_t> index;
+      xvts.resize(sats.size());
+      found.assign(sats.size(), false);
+
+      for(i=0; i<sats.size(); i++) {
+         TimeSystem ts;
+         switch(sats[i].system) {
+            case SatelliteSystem::GPS:
+            case SatelliteSystem::Galileo:
+            case SatelliteSystem::BeiDou:
+            case SatelliteSystem::QZSS:
+               if(sats[i].system == SatelliteSystem::GPS    ) ts = TimeSystem::GPS;
+               if(sats[i].system == SatelliteSystem::Galileo) ts = TimeSystem::GAL;
+               if(sats[i].system == SatelliteSystem::BeiDou ) ts = TimeSystem::BDT;
+               if(sats[i].system == SatelliteSystem::QZSS   ) ts = TimeSystem::QZS;
+               orbSats.push_back(sats[i]);
+               orbTimes.push_back(correctTimeSystem(inttags[i], ts));
+               index.push_back(i);
+               break;
+            case SatelliteSystem::Glonass:
+               try {
+                  xvts[i] = GLOstore.getXvt(sats[i],
+                                 correctTimeSystem(inttags[i], TimeSystem::GLO));
+                  found[i] = true;
+                  n++;
+               }
+               catch(InvalidRequest&) { }
+               break;
+            default:       // getXvt() throws: unsupported satellite system
+               break;
+         }
+      }
+
+      // the orbit-based systems, together
+      if(orbSats.size() > 0) {
+         vector<Xvt> orbXvts;
+         vector<bool> orbFound;
+         n += ORBstore.getXvts(orbSats, orbTimes, orbXvts, orbFound);
+         for(i=0; i<orbSats.size(); i++) {
+            if(!orbFound[i]) continue;
+            xvts[index[i]] = orbXvts[i];
+            found[index[i]] = true;
+         }
+      }
+
+      return n;
+   }
+
+
    Xvt::HealthStatus Rinex3EphemerisStore ::
    getSVHealth(const SatID& sat, const CommonTime& inttag) const throw()
    {
@@ -48,6 +48,7 @@
 #include <list>
 #include <map>
 #include <set>
+#include <vector>
 #include <algorithm>
 
 #include "Exception.hpp"
@@ -149,6 +150,22 @@ namespace gpstk
       virtual Xvt computeXvt(const SatID& id, const CommonTime& t) const
          throw();
 
+         /** Get the position, velocity, and clock offset of each of
+          * the indicated satellites, each at its own time, with the
+          * same results as getXvt(ids[i],times[i]); the orbit-based
+          * systems are computed together by OrbitEphStore::getXvts().
+          * Satellites for which getXvt() would throw have found[i] false.
+          * @param[in] ids the satellites of interest
+          * @param[in] times the time to look up for each of ids
+          * @param[out] xvts the Xvt of each of ids
+          * @param[out] found true where xvts is defined
+          * @return the number of satellites found
+          * @throw InvalidParameter if ids and times differ in size */
+      virtual int getXvts(const std::vector<SatID>& ids,
+                          const std::vector<CommonTime>& times,
+                          std::vector<Xvt>& xvts,
+                          std::vector<bool>& found) const;
+
          /** Get the satellite health at a specific time.
           * @param[in] id the object's identifier
           * @param[in] t the time to look up
@@ -270,6 +287,26 @@ namespace gpstk
       int loadFile(const std::string& filename, bool dump=false,
                    std::ostream& s=std::cout);
 
+         /** Load a list of RINEX navigation files, reading them in
+          * parallel.  The files are read and parsed concurrently, and
+          * the results are then added to the store one file at a
+          * time in the order given, so the store ends up exactly as
+          * it would after calling loadFile() for each file in turn,
+          * including which of any duplicate ephemerides are kept.
+          * Loading stops at the first file that can't be read,
+          * after adding what loadFile() would have added from it.
+          * @param[in] filenames names of the RINEX navigation files
+          *   to read.
+          * @param[in] numThreads the number of threads used to read
+          *   the files, 0 to use one per core.
+          * @return the number of nav records read from all the files,
+          *   or the value loadFile() would have returned for the
+          *   first file that failed (-1, -2 or -3), in which case
+          *   what describes the failure.
+          * @throw some other problem */
+      int loadFiles(const std::vector<std::string>& filenames,
+                    unsigned numThreads = 0);
+
          /** use to access the data records in the store in bulk Add
           * all Rinex3NavData in this store to the given list. If sat
           * is defined, (its default is (-1,mixed)), then add only
@@ -486,6 +523,35 @@ namespace gpstk
          return retSet;
       }
 
+   private:
+         /// The contents of one navigation file, as read by readFile().
+      struct NavFileContents
+      {
+         NavFileContents() : status(0) {}
+            /// -1, -2 or -3 if reading failed, as for loadFile().
+         int status;
+            /// Description of the failure.
+         std::string what;
+            /// The file's header.
+         Rinex3NavHeader header;
+            /// The records read, up to any failure.
+         std::vector<Rinex3NavData> records;
+      };
+
+         /** Read and parse a navigation file without changing the
+          * store.  This doesn't touch any member data, so it may be
+          * called from several threads at once.
+          * @param[in] filename the file to read.
+          * @param[out] contents the header and records read. */
+      static void readFile(const std::string& filename,
+                           NavFileContents& contents);
+
+         /** Add the contents of a file read by readFile() to the store.
+          * @return the value loadFile() returns. */
+      int addFileContents(const std::string& filename,
+                          const NavFileContents& contents,
+                          bool dump, std::ostream& s);
+
    }; // end class Rinex3EphemerisStore
 
       //@}
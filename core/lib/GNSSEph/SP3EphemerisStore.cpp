@@ -591,6 +591,10 @@ namespace gpstk
             // close
          strm.close();
 
+            // archive any tables the data could not be appended to
+         posStore.compactArchive();
+         clkStore.compactArchive();
+
       }
       catch (Exception& e)
       {
@@ -773,6 +777,9 @@ namespace gpstk
 
          strm.close();
 
+            // archive any tables the data could not be appended to
+         clkStore.compactArchive();
+
       }
       catch(Exception& e)
       {
@@ -491,6 +491,79 @@ namespace gpstk
       void setClockLinearInterp(void) throw()
       { clkStore.setLinearInterp(); }
 
+         /** Use flat tables to look up data in both the position and
+          * clock stores, see TabularSatStore::enableFlatTable(). */
+      void enableFlatTables(void)
+      {
+         posStore.enableFlatTable();
+         clkStore.enableFlatTable();
+      }
+
+         /// Stop using flat tables in the position and clock stores.
+      void disableFlatTables(void) throw()
+      {
+         posStore.disableFlatTable();
+         clkStore.disableFlatTable();
+      }
+
+         /** Cache the interpolation intervals in both the position
+          * and clock stores, see TabularSatStore::enableInterpCache(). */
+      void enableInterpCache(void)
+      {
+         posStore.enableInterpCache();
+         clkStore.enableInterpCache();
+      }
+
+         /// Stop caching interpolation intervals.
+      void disableInterpCache(void)
+      {
+         posStore.disableInterpCache();
+         clkStore.disableInterpCache();
+      }
+
+         /** Keep the position and clock tables in compact archived
+          * form, for storing long spans of data; see
+          * TabularSatStore::enableArchive().  Data loaded afterwards
+          * are archived as they are read. */
+      void enableArchive(void)
+      {
+         posStore.enableArchive();
+         clkStore.enableArchive();
+      }
+
+         /// Stop archiving, putting all the data back in maps.
+      void disableArchive(void)
+      {
+         posStore.disableArchive();
+         clkStore.disableArchive();
+      }
+
+         /// Are the tables archived?
+      bool isArchive(void) const throw()
+      { return posStore.isArchive(); }
+
+         /// Get the number of bytes used by the archived tables.
+      std::size_t archiveMemoryUsage(void) const throw()
+      {
+         return (posStore.archiveMemoryUsage() +
+                 clkStore.archiveMemoryUsage());
+      }
+
+         /** Get the number of position and clock interpolations that
+          * reused a cached interval. */
+      unsigned long getInterpCacheHits(void) const
+      {
+         return posStore.getInterpCacheHits() + clkStore.getInterpCacheHits();
+      }
+
+         /** Get the number of position and clock interpolations that
+          * extracted a new interval from the tables. */
+      unsigned long getInterpCacheMisses(void) const
+      {
+         return (posStore.getInterpCacheMisses() +
+                 clkStore.getInterpCacheMisses());
+      }
+
 
          /** Get a list (std::vector) of SatIDs present in both clock
           * and position stores */
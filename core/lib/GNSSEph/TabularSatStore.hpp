@@ -45,6 +45,11 @@
 #define GPSTK_TABULAR_SAT_STORE_INCLUDE
 
 #include <map>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
 #include <iostream>
 #include <cmath>
 
@@ -54,6 +59,8 @@
 #include "TimeString.hpp"
 #include "Xvt.hpp"
 #include "CivilTime.hpp"
+#include "MiscMath.hpp"
+#include "ArchiveTable.hpp"
 //#include "logstream.hpp"      // TEMP
 
 namespace gpstk
@@ -130,6 +137,100 @@ namespace gpstk
 
       typedef typename DataTable::const_iterator DataTableIterator;
 
+         /** Flat (array) form of the DataTable for one satellite,
+          * used by getTableInterval() when the flat table backend is
+          * enabled.  The records themselves stay in tables; this
+          * holds, in time order, an iterator to each one and its time
+          * in seconds since the first, so that the table can be
+          * searched without walking the map.  If the times are evenly
+          * spaced, the position of any time is computed directly. */
+      struct FlatTable
+      {
+         FlatTable() : uniform(false), step(0.0) {}
+            /// true if secs[k] == k*step for all k
+         bool uniform;
+            /// time step (seconds) between the first two records
+         double step;
+            /// time of each record, in seconds since the first one
+         std::vector<double> secs;
+            /// iterator to each record in the DataTable, in time order
+         std::vector<DataTableIterator> recs;
+      };
+
+         /// true if getTableInterval() should use flatTables
+      bool useFlatTable;
+
+         /// flat tables, one for each satellite present in tables
+      std::vector<FlatTable> flatTables;
+
+         /** Index of each satellite in flatTables, by satellite
+          * system and then satellite id; -1 if not present. */
+      std::vector< std::vector<int> > flatIndex;
+
+         /** Copy of the records in one interpolation interval of a
+          * DataTable, with the Lagrange weights for their times, kept
+          * by getInterpWindow() so that it can be reused by later
+          * calls which interpolate within the same interval. */
+      struct InterpWindow
+      {
+            /// times of the first and last records in the interval
+         CommonTime first, last;
+            /// time of each record, in seconds since first
+         std::vector<double> times;
+            /// Lagrange weights for times, see LagrangeWeights()
+         std::vector<double> weights;
+            /// the records in the interval
+         std::vector<DataRecord> recs;
+      };
+
+         /// true if getInterpWindow() should keep its windows
+      bool useInterpCache;
+
+         /** The last interpolation window used for each satellite.
+          * There is an entry for each satellite in tables, made when
+          * the satellite is added, so that const callers never change
+          * the map itself, only the windows it holds. */
+      mutable std::map<SatID, std::shared_ptr<const InterpWindow> >
+         interpCache;
+
+         /// number of calls to getInterpWindow() that reused a window
+      mutable std::atomic<unsigned long> interpCacheHits;
+
+         /// number of calls to getInterpWindow() that made a window
+      mutable std::atomic<unsigned long> interpCacheMisses;
+
+         /// number of locks guarding the windows in interpCache
+      static const unsigned interpCacheLockCount = 16;
+
+         /** Guards for the windows in interpCache; satellites share
+          * them as chosen by interpCacheLock(). */
+      mutable std::mutex interpCacheLocks[interpCacheLockCount];
+
+         /// true if new satellite tables should be archived
+      bool useArchive;
+
+         /** Archived tables, see enableArchive().  The records of a
+          * satellite are either here or in tables, never in both. */
+      std::map<SatID, ArchiveTable> archiveTables;
+
+         /** Records j1 through j2 of an archived table, decoded by
+          * getArchiveWindow() and kept for the later calls that
+          * search within them. */
+      struct ArchiveWindow
+      {
+            /// indexes in the archived table of the first and last records
+         std::size_t j1, j2;
+            /// the decoded records
+         DataTable recs;
+      };
+
+         /** The last decoded window of each archived table.  As for
+          * interpCache, there is an entry for each satellite, made
+          * when the satellite is added, and the windows are guarded
+          * by interpCacheLocks. */
+      mutable std::map<SatID, std::shared_ptr<const ArchiveWindow> >
+         archiveCache;
+
          // member functions
    public:
          /// Default constructor
@@ -137,8 +238,54 @@ namespace gpstk
       : storeTimeSystem(TimeSystem::Any),
          havePosition(false), haveVelocity(false),
          haveClockBias(false), haveClockDrift(false),
-         checkDataGap(false), checkInterval(false)
+         checkDataGap(false), checkInterval(false),
+         useFlatTable(false), useInterpCache(false),
+         interpCacheHits(0), interpCacheMisses(0), useArchive(false)
       {}
+
+         /** Copy constructor.  The flat tables refer to the records
+          * in tables, so they are rebuilt rather than copied, and the
+          * interpolation cache starts empty. */
+      TabularSatStore(const TabularSatStore& right)
+      : tables(right.tables), storeTimeSystem(right.storeTimeSystem),
+         havePosition(right.havePosition), haveVelocity(right.haveVelocity),
+         haveClockBias(right.haveClockBias),
+         haveClockDrift(right.haveClockDrift),
+         checkDataGap(right.checkDataGap), gapInterval(right.gapInterval),
+         checkInterval(right.checkInterval), maxInterval(right.maxInterval),
+         useFlatTable(right.useFlatTable),
+         useInterpCache(right.useInterpCache),
+         interpCacheHits(0), interpCacheMisses(0),
+         useArchive(right.useArchive), archiveTables(right.archiveTables)
+      {
+         rebuildFlatTables();
+         clearInterpCache();
+      }
+
+         /// Assignment operator; see the copy constructor.
+      TabularSatStore& operator=(const TabularSatStore& right)
+      {
+         if(this == &right)
+            return *this;
+         tables = right.tables;
+         storeTimeSystem = right.storeTimeSystem;
+         havePosition = right.havePosition;
+         haveVelocity = right.haveVelocity;
+         haveClockBias = right.haveClockBias;
+         haveClockDrift = right.haveClockDrift;
+         checkDataGap = right.checkDataGap;
+         gapInterval = right.gapInterval;
+         checkInterval = right.checkInterval;
+         maxInterval = right.maxInterval;
+         useFlatTable = right.useFlatTable;
+         rebuildFlatTables();
+         useArchive = right.useArchive;
+         archiveTables = right.archiveTables;
+         useInterpCache = right.useInterpCache;
+         clearInterpCache();
+         return *this;
+      }
+
          /// Destructor
       virtual ~TabularSatStore() {}
 
@@ -208,6 +355,14 @@ namespace gpstk
           *   data gap larger than the max
           * @throw InvalidRequest if MaxInterval is set and the
           *   interval is too wide
+          * @note If the table of sat is archived (see
+          *   enableArchive()), it1 and it2 point into a window of
+          *   decoded records that the store keeps for sat, not into
+          *   the store's tables.  They remain valid until the next
+          *   call of getTableInterval() or
+          *   getNonCenteredTableInterval() in the same thread, and
+          *   after it as long as the store is not changed and its
+          *   later searches for sat stay within the window.
           */
       virtual bool getTableInterval(const SatID& sat,
                                     const CommonTime& ttag,
@@ -222,6 +377,31 @@ namespace gpstk
             static const char *fmt=
                " at time %F/%.3g %4Y/%02m/%02d %2H:%02M:%.3f %P";
 
+               // an archived table is searched in a window of its
+               // records around ttag, wide enough that the search
+               // goes exactly as it would in the whole table
+            const ArchiveTable *at(findArchiveTable(sat));
+            if(at)
+            {
+               std::size_t n(at->size()), k(at->lowerBound(ttag)),
+                  reach(nhalf > 0 ? nhalf : 0);
+               return searchTableInterval(sat,
+                                          getArchiveWindow(sat, *at,
+                                             (k > reach+2 ? k-reach-2 : 0),
+                                             std::min(n-1, k+reach+1)),
+                                          n, ttag, nhalf, it1, it2,
+                                          exactReturn, fmt);
+            }
+
+               // search the flat table instead, if there is one
+            if(useFlatTable)
+            {
+               const FlatTable *ft(findFlatTable(sat));
+               if(ft)
+                  return getFlatTableInterval(sat, *ft, ttag, nhalf, it1, it2,
+                                              exactReturn, fmt);
+            }
+
                // find the DataTable for this sat
             typename std::map<SatID, DataTable>::const_iterator satit;
             satit = tables.find(sat);
@@ -233,139 +413,9 @@ namespace gpstk
                GPSTK_THROW(e);
             }
 
-               // this is the data table for the sat
-            const DataTable& dtable(satit->second);
-
-               // cannot interpolate with one point
-            if(dtable.size() < 2)
-            {
-               InvalidRequest e("Inadequate data (size < 2) for satellite " +
-                                gpstk::StringUtils::asString(sat) +
-                                printTime(ttag,fmt));
-               GPSTK_THROW(e);
-            }
-
-               // find the timetag in this table
-
-               /** @note throw here if time systems do not match and
-                * are not "Any" */
-            it1 = dtable.find(ttag);
-               // is it an exact match?
-            bool exactMatch(it1 != dtable.end());
-
-               // user must decide whether to return with exact value;
-               // e.g. without velocity data, user needs the interval
-               // to compute v from x data
-            if(exactMatch && exactReturn)
-               return true;
-
-               // lower_bound points to the first element with key >= ttag
-            it1 = it2 = dtable.lower_bound(ttag);
-            if (it1 == dtable.end())
-            {
-               InvalidRequest e("No data in time range for satellite " +
-                                gpstk::StringUtils::asString(sat) +
-                                printTime(ttag,fmt));
-               GPSTK_THROW(e);
-            }
-
-               // ttag is <= first time in table
-            if(it1 == dtable.begin())
-            {
-                  // at table begin but its an exact match && an
-                  // interval of only 2
-               if(exactMatch && nhalf==1)
-               {
-                  ++(it2 = it1);
-                  return exactMatch;
-               }
-               InvalidRequest e("Inadequate data before(1) requested time for"
-                                " satellite " +
-                                gpstk::StringUtils::asString(sat) +
-                                printTime(ttag,fmt));
-               GPSTK_THROW(e);
-            }
-
-               // move it1 down by one
-            if(--it1 == dtable.begin())
-            {
-                  // if an interval of only 2
-               if(nhalf==1)
-               {
-                  ++(it2 = it1);
-                  return exactMatch;
-               }
-               InvalidRequest e("Inadequate data before(2) requested time for"
-                                " satellite " +
-                                gpstk::StringUtils::asString(sat) +
-                                printTime(ttag,fmt));
-               GPSTK_THROW(e);
-            }
-
-               //LOG(INFO) << "OK, have interval " << printTime(it1->first,"%F/%g") <<
-               //" <= " <<printTime(ttag,"%F/%g")<< " < " <<printTime(it2->first,"%F/%g");
-
-               // now have it1->first <= ttag < it2->first and it2 ==
-               // it1+1 check for gap between these two table entries
-               // surrounding ttag
-            if(checkDataGap && (it2->first-it1->first) > gapInterval)
-            {
-               InvalidRequest e("Gap at interpolation time for satellite " +
-                                gpstk::StringUtils::asString(sat) +
-                                printTime(ttag,fmt));
-               GPSTK_THROW(e);
-            }
-
-               // now expand the interval to include 2*nhalf timesteps
-            for(int k=0; k<nhalf-1; k++)
-            {
-               bool last(k==nhalf-2); // true only on the last iteration
-                  // move left by one; if require full interval && out
-                  // of room on left, fail
-               if(--it1 == dtable.begin() && !last)
-               {
-                  InvalidRequest
-                     e("Inadequate data before(3) requested time for"
-                       " satellite " + gpstk::StringUtils::asString(sat) +
-                       printTime(ttag,fmt));
-                  GPSTK_THROW(e);
-               }
-                  //LOG(INFO) << k << " expand left " << printTime(it1->first,"%F/%g");
-
-               if(++it2 == dtable.end())
-               {
-                  if(exactMatch && last && it1 != dtable.begin())
-                  {
-                        // exact match && at end of interval && with
-                        // room to move down
-
-                        // move interval down by one
-                     it2--;
-                     it1--;
-                  }
-                  else
-                  {
-                     InvalidRequest
-                        e("Inadequate data after(2) requested time for"
-                          " satellite " + gpstk::StringUtils::asString(sat) +
-                          printTime(ttag,fmt));
-                     GPSTK_THROW(e);
-                  }
-               }
-                  //LOG(INFO) << k << " expand right " << printTime(it2->first,"%F/%g");
-            }
-
-               // check that the interval is not too large
-            if(checkInterval && (it2->first - it1->first) > maxInterval)
-            {
-               InvalidRequest e("Interpolation interval too large for"
-                                " satellite " +
-                                gpstk::StringUtils::asString(sat) +
-                                printTime(ttag,fmt));
-               GPSTK_THROW(e);
-            }
-
-            return exactMatch;
+            return searchTableInterval(sat, satit->second,
+                                       satit->second.size(), ttag, nhalf,
+                                       it1, it2, exactReturn, fmt);
          }
          catch(InvalidRequest& ir)
          {
@@ -414,7 +464,10 @@ namespace gpstk
           * @throw InvalidRequest if GapInterval is set and there is a
           *   data gap larger than the max
           * @throw InvalidRequest if MaxInterval is set and the
-          *   interval is too wide */
+          *   interval is too wide
+          * @note For an archived table, it1 and it2 point into a
+          *   window of decoded records with the lifetime given in
+          *   getTableInterval(). */
       virtual bool getNonCenteredTableInterval(const SatID& sat,
                                                const CommonTime& ttag,
                                                const int& nhalf,
@@ -425,6 +478,24 @@ namespace gpstk
       {
          try
          {
+            static const char *fmt=" at time %4Y/%02m/%02d %2H:%02M:%02S";
+
+               // as in getTableInterval(), but this search reaches
+               // up to 2*nhalf records from ttag
+            const ArchiveTable *at(findArchiveTable(sat));
+            if(at)
+            {
+               std::size_t n(at->size()), k(at->lowerBound(ttag)),
+                  reach(nhalf > 0 ? 2*nhalf : 0);
+               return searchNonCenteredInterval(sat,
+                                                getArchiveWindow(sat, *at,
+                                                   (k > reach+2 ?
+                                                    k-reach-2 : 0),
+                                                   std::min(n-1, k+reach+1)),
+                                                n, ttag, nhalf, it1, it2,
+                                                exactReturn, fmt);
+            }
+
                // find the DataTable for this sat
             typename std::map<SatID, DataTable>::const_iterator satit;
             satit = tables.find(sat);
@@ -436,126 +507,10 @@ namespace gpstk
                GPSTK_THROW(ir);
             }
 
-               // this is the data table for the sat
-            const DataTable& dtable(satit->second);
-            static const char *fmt=" at time %4Y/%02m/%02d %2H:%02M:%02S";
-
-               // find the timetag in this table
-               /** @note throw here if time systems do not match and
-                * are not "Any" */
-            it1 = dtable.find(ttag);
-               // is it an exact match?
-            bool exactMatch(it1 != dtable.end());
-
-               // user must decide whether to return with exact value;
-               // e.g. without velocity data, user needs the interval
-               // to compute v from x data
-            if(exactMatch && exactReturn)
-               return true;
-
-               // lower_bound points to the first element with key >= ttag
-            it1 = it2 = dtable.lower_bound(ttag);
-
-               // Should we allow to predict data?
-            if(it1 == dtable.end())
-            {
-               InvalidRequest ir("No data for the requested time of satellite "
-                                 + gpstk::StringUtils::asString(sat)
-                                 + printTime(ttag,fmt));
-               GPSTK_THROW(ir);
-            }
-
-            if(int(dtable.size()) < 2*nhalf)
-            {
-               InvalidRequest ir("Inadequate data for satellite " +
-                                 gpstk::StringUtils::asString(sat) +
-                                 printTime(ttag,fmt));
-               GPSTK_THROW(ir);
-            }
-
-               // check for gap only when exactMatch==false
-            if(!exactMatch && checkDataGap)
-            {
-               typename DataTable::const_iterator lit,rit;
-               lit = rit = it2;
-
-               if(rit!=dtable.begin())
-               {
-                  lit--;
-                  if((rit->first-lit->first) > gapInterval)
-                  {
-                     InvalidRequest ir(
-                        "Gap at interpolation time for satellite " +
-                        gpstk::StringUtils::asString(sat) +
-                        printTime(ttag,fmt));
-                     GPSTK_THROW(ir);
-                  }
-               }
-               else
-               {
-                  if((rit->first - ttag) > gapInterval)
-                  {
-                     InvalidRequest ir(
-                        "Gap may produce bad interpolation precision for"
-                        " satellite " + gpstk::StringUtils::asString(sat) +
-                        printTime(ttag,fmt));
-                     GPSTK_THROW(ir);
-                  }
-               }
-            }
-
-               // try to get the beginning of the window
-            int i, ileft(nhalf);
-            for(i = 0; i < nhalf; i++)
-            {
-               if(it1 == dtable.begin())
-                  break;
-               it1--;
-               ileft--;
-            }
-
-               // try to get the ending of the window
-            int iright = nhalf - 1 + ileft;
-            for(i = 0; i < (nhalf-1+ileft); i++)
-            {
-               it2++;
-               if(it2 == dtable.end())
-               {
-                  it2--;
-                  break;
-               }
-               iright--;
-            }
-
-               // adjust the beginning of the window again
-            int ileft2 = iright;
-            for(i = 0; i < iright; i++)
-            {
-               if(it1 == dtable.begin())
-                  break;
-               it1--;
-               ileft2--;
-            }
-
-               // We have checked that there are enough data, so ileft2 should
-               // always be zero.
-            if(ileft2 > 0)
-            {
-               InvalidRequest ir("This should never happen");
-               GPSTK_THROW(ir);
-            }
-
-               // check that the interval is not too large
-            if(checkInterval && (it2->first - it1->first) > maxInterval)
-            {
-               InvalidRequest ir("Interpolation interval too large for"
-                                 " satellite " +
-                                 gpstk::StringUtils::asString(sat) +
-                                 printTime(ttag,fmt));
-               GPSTK_THROW(ir);
-            }
-
-            return exactMatch;
+            return searchNonCenteredInterval(sat, satit->second,
+                                             satit->second.size(), ttag,
+                                             nhalf, it1, it2, exactReturn,
+                                             fmt);
          }
          catch(InvalidRequest& ir)
          {
@@ -614,13 +569,22 @@ namespace gpstk
                   << std::fixed << std::setprecision(2) << maxInterval;
             os << std::endl;
 
+            if(useArchive || !archiveTables.empty())
+               os << "  Archived tables for " << archiveTables.size()
+                  << " satellites use " << archiveMemoryUsage() << " bytes."
+                  << std::endl;
+
             if(detail > 0)
             {
-               typename SatTable::const_iterator it;
-               for(it=tables.begin(); it!=tables.end(); it++)
+               std::vector<SatID> sats(allSats());
+               for(std::size_t i=0; i<sats.size(); i++)
                {
-                  os << "   Sat " << it->first << " : "
-                     << it->second.size() << " records.";
+                  const SatID& sat(sats[i]);
+                  typename SatTable::const_iterator it(tables.find(sat));
+                  const ArchiveTable *at(findArchiveTable(sat));
+                  os << "   Sat " << sat << " : "
+                     << (at ? at->size() : it->second.size()) << " records"
+                     << (at ? " (archived)." : ".");
 
                   if(detail == 1)
                   {
@@ -631,11 +595,15 @@ namespace gpstk
                      /** @note cannot access DataRecord without
                       * operator<<(DataRecord) */
                   os << "   Data:" << std::endl;
+                  DataTable decoded;
+                  if(at)
+                     decodeArchive(*at, 0, at->size()-1, decoded);
+                  const DataTable& dtab(at ? decoded : it->second);
                   typename DataTable::const_iterator jt;
-                  for(jt=it->second.begin(); jt!=it->second.end(); jt++)
+                  for(jt=dtab.begin(); jt!=dtab.end(); jt++)
                   {
                      os << " " << printTime(jt->first,fmt)
-                        << " " << gpstk::StringUtils::asString(it->first)
+                        << " " << gpstk::StringUtils::asString(sat)
                         << " " << jt->second /// @note requires operator<<(DataRecord)
                         << std::endl;
                   }
@@ -656,23 +624,27 @@ namespace gpstk
             // loop over satellites
          typename SatTable::iterator it;
          for(it=tables.begin(); it!=tables.end(); it++)
-         {
-               //sat = it->first;
-            DataTable& dtab(it->second);
-            typename DataTable::iterator jt;
-
-               // delete everything above tmax
-               // jt points to the earliest time > tmax
-            jt = dtab.upper_bound(tmax);
-            if(jt != dtab.end())
-               dtab.erase(jt,dtab.end());
+            editTable(it->second, tmin, tmax);
 
-               // delete everything before tmin
-               // jt points to the earliest time >= tmin
-            jt = dtab.lower_bound(tmin);
-            if(jt != dtab.begin() && --jt != dtab.begin())
-               dtab.erase(dtab.begin(),jt);
+            // archived tables that lose records are edited as maps
+            // and archived again
+         std::vector<SatID> edited;
+         typename std::map<SatID, ArchiveTable>::const_iterator ait;
+         for(ait=archiveTables.begin(); ait!=archiveTables.end(); ++ait)
+         {
+            if(tmax < ait->second.lastTime() ||
+               ait->second.lowerBound(tmin) > 1)
+               edited.push_back(ait->first);
+         }
+         for(std::size_t i=0; i<edited.size(); i++)
+         {
+            expandArchive(edited[i]);
+            editTable(tables[edited[i]], tmin, tmax);
+            archiveTable(edited[i]);
          }
+
+         rebuildFlatTables();
+         clearInterpCache();
       }
 
          // remaining functions are not virtual
@@ -684,11 +656,18 @@ namespace gpstk
          for(satit=tables.begin(); satit!=tables.end(); ++satit)
             satit->second.clear();
          tables.clear();
+         archiveTables.clear();
+         flatTables.clear();
+         flatIndex.clear();
+         clearInterpCache();
       }
 
          /// Return true if the given SatID is present in the store
       virtual bool isPresent(const SatID& sat) const throw()
-      { return (tables.find(sat) != tables.end()); }
+      {
+         return (tables.find(sat) != tables.end() ||
+                 archiveTables.find(sat) != archiveTables.end());
+      }
 
          /** Determine if the input TimeSystem conflicts with the
           * stored TimeSystem.
@@ -712,6 +691,12 @@ namespace gpstk
       CommonTime getInitialTime() const throw()
       {
          CommonTime initialTime(CommonTime::END_OF_TIME);
+         typename std::map<SatID, ArchiveTable>::const_iterator ait;
+         for(ait=archiveTables.begin(); ait!=archiveTables.end(); ++ait)
+         {
+            CommonTime t(ait->second.firstTime());
+            if(t < initialTime) initialTime = t;
+         }
          if(tables.size() == 0) return initialTime;
 
             // loop over satellites
@@ -736,6 +721,12 @@ namespace gpstk
       CommonTime getFinalTime() const throw()
       {
          CommonTime finalTime(CommonTime::BEGINNING_OF_TIME);
+         typename std::map<SatID, ArchiveTable>::const_iterator ait;
+         for(ait=archiveTables.begin(); ait!=archiveTables.end(); ++ait)
+         {
+            CommonTime t(ait->second.lastTime());
+            if(t > finalTime) finalTime = t;
+         }
          if(tables.size() == 0)
             return finalTime;
 
@@ -766,6 +757,9 @@ namespace gpstk
       CommonTime getInitialTime(const SatID& sat) const throw()
       {
          CommonTime initialTime(CommonTime::END_OF_TIME);
+         const ArchiveTable *at(findArchiveTable(sat));
+         if(at)
+            return at->firstTime();
          if(tables.size() == 0)
             return initialTime;
 
@@ -781,6 +775,9 @@ namespace gpstk
       CommonTime getFinalTime(const SatID& sat) const throw()
       {
          CommonTime finalTime(CommonTime::BEGINNING_OF_TIME);
+         const ArchiveTable *at(findArchiveTable(sat));
+         if(at)
+            return at->lastTime();
          if(tables.size() == 0)
             return finalTime;
 
@@ -817,7 +814,8 @@ namespace gpstk
       bool hasClockDrift() const throw() { return haveClockDrift; }
 
          /// Get number of satellites available
-      inline int nsats(void) const throw() { return tables.size(); }
+      inline int nsats(void) const throw()
+      { return tables.size() + archiveTables.size(); }
 
          /// Is the given satellite present?
       bool hasSatellite(const SatID& sat) const throw()
@@ -826,12 +824,11 @@ namespace gpstk
          /// Get a list (std::vector) of SatIDs present in the store
       std::vector<SatID> getSatList(void) const throw()
       {
-         std::vector<SatID> satlist;
-         typename SatTable::const_iterator it;
-         for(it=tables.begin(); it != tables.end(); ++it)
+         std::vector<SatID> satlist, sats(allSats());
+         for(std::size_t i=0; i<sats.size(); i++)
          {
-            if(it->second.size() > 0)
-               satlist.push_back(it->first);
+            if(ndata(sats[i]) > 0)
+               satlist.push_back(sats[i]);
          }
          return satlist;
       }
@@ -845,12 +842,18 @@ namespace gpstk
          {
             n += sit->second.size();
          }
+         typename std::map<SatID, ArchiveTable>::const_iterator ait;
+         for(ait=archiveTables.begin(); ait!=archiveTables.end(); ++ait)
+            n += ait->second.size();
          return n;
       }
 
          /// Get the number of data records for the given sat
       inline int ndata(const SatID& sat) const throw()
       {
+         const ArchiveTable *at(findArchiveTable(sat));
+         if(at)
+            return at->size();
          typename SatTable::const_iterator it(tables.find(sat));
          if(it == tables.end())
          {
@@ -872,6 +875,12 @@ namespace gpstk
             if(sit->first.system == sys)
                n += sit->second.size();
          }
+         typename std::map<SatID, ArchiveTable>::const_iterator ait;
+         for(ait=archiveTables.begin(); ait!=archiveTables.end(); ++ait)
+         {
+            if(ait->first.system == sys)
+               n += ait->second.size();
+         }
          return n;
       }
 
@@ -886,9 +895,10 @@ namespace gpstk
       {
             // get the table for this sat
          typename SatTable::const_iterator it(tables.find(sat));
+         const ArchiveTable *at(findArchiveTable(sat));
 
             // not found or empty
-         if(it == tables.end() || it->second.size() == 0)
+         if(!at && (it == tables.end() || it->second.size() == 0))
             return 0.0;
 
             // save the most frequent N step sizes
@@ -897,12 +907,21 @@ namespace gpstk
          double dt[N],del;
 
             // loop over the table
-         typename DataTable::const_iterator jt(it->second.begin());
-         CommonTime prevT(jt->first);
-         ++jt;
-         while(jt != it->second.end())
+         typename DataTable::const_iterator jt;
+         std::size_t j(1);
+         CommonTime prevT, t;
+         if(at)
+            prevT = at->firstTime();
+         else
          {
-            del = jt->first - prevT;
+            jt = it->second.begin();
+            prevT = jt->first;
+            ++jt;
+         }
+         while(at ? j < at->size() : jt != it->second.end())
+         {
+            t = (at ? at->getTime(j++) : (jt++)->first);
+            del = t - prevT;
             if(del > 1.0e-8)
             {
                for(i=0; i<N; i++)
@@ -920,8 +939,7 @@ namespace gpstk
                   }
                }
             }
-            prevT = jt->first;
-            ++jt;
+            prevT = t;
          }
 
             // find the most frequent interval
@@ -974,6 +992,967 @@ namespace gpstk
       void setTimeSystem(const TimeSystem& ts) throw()
       { storeTimeSystem = ts; }
 
+         /// Is the flat table backend in use?
+      bool isFlatTable(void) const throw() { return useFlatTable; }
+
+         /** Use flat tables in getTableInterval().  A time-sorted
+          * array is kept for each satellite alongside the maps, which
+          * is searched in constant time when the data are evenly
+          * spaced (as SP3 and clock data nearly always are), and by
+          * bisection otherwise, instead of searching two maps.  The
+          * results are identical, but the arrays use extra memory
+          * and make adding data out of time order slower. */
+      void enableFlatTable(void)
+      {
+         useFlatTable = true;
+         rebuildFlatTables();
+      }
+
+         /// Stop using flat tables, and free them.
+      void disableFlatTable(void) throw()
+      {
+         useFlatTable = false;
+         rebuildFlatTables();
+      }
+
+         /// Is the interpolation cache in use?
+      bool isInterpCache(void) const throw() { return useInterpCache; }
+
+         /** Keep the last interpolation interval used for each
+          * satellite, with precomputed Lagrange weights, and reuse it
+          * while later calls interpolate within the same interval.
+          * This is much faster when a satellite is evaluated many
+          * times per table interval, as in processing observations
+          * at high rate.  Interpolated values differ from those
+          * computed without the cache only by rounding error,
+          * which for SP3 data is at the micrometer level. */
+      void enableInterpCache(void)
+      {
+         useInterpCache = true;
+         clearInterpCache();
+         resetInterpCacheStats();
+      }
+
+         /// Stop using the interpolation cache, and free it.
+      void disableInterpCache(void)
+      {
+         useInterpCache = false;
+         clearInterpCache();
+      }
+
+         /** Get the number of interpolations that reused a cached
+          * interval since the cache was enabled or its counts were
+          * reset. */
+      unsigned long getInterpCacheHits(void) const
+      { return interpCacheHits; }
+
+         /** Get the number of interpolations that had to extract a
+          * new interval from the table. */
+      unsigned long getInterpCacheMisses(void) const
+      { return interpCacheMisses; }
+
+         /// Reset the interpolation cache hit and miss counts.
+      void resetInterpCacheStats(void)
+      {
+         interpCacheHits = 0;
+         interpCacheMisses = 0;
+      }
+
+         /// Is the archive mode on?
+      bool isArchive(void) const throw() { return useArchive; }
+
+         /** Keep the table of each satellite as an ArchiveTable
+          * instead of a map, for long spans of data: the times are
+          * implied by the time step, and the values are stored as
+          * scaled integer differences where that is exact, and not at
+          * all where they are zero.  This uses a fraction of the
+          * memory of the maps, and the results of all the get..()
+          * functions are identical, but each interpolation must
+          * decode the records it uses, which makes it slower.
+          * Records added in time order on a satellite's time grid are
+          * appended to its archived table; any other addition puts
+          * the satellite's table back into a map until
+          * compactArchive() is called.  With archived tables, the
+          * iterators returned by getTableInterval() point into a
+          * window of decoded records around the requested time that
+          * the store keeps for each satellite; see the note there on
+          * how long they remain valid.
+          * @throw InvalidRequest if the records of this store can not
+          *   be archived. */
+      void enableArchive(void)
+      {
+         if(archiveFields() == 0)
+         {
+            InvalidRequest ir("This store does not support archive mode");
+            GPSTK_THROW(ir);
+         }
+         useArchive = true;
+         compactArchive();
+      }
+
+         /// Stop using archived tables, putting all the data in maps.
+      void disableArchive(void)
+      {
+         useArchive = false;
+         while(!archiveTables.empty())
+            expandArchive(archiveTables.begin()->first);
+      }
+
+         /** In archive mode, archive the tables of all satellites
+          * that are held in maps; a table is left in its map if its
+          * times are not evenly spaced (apart from gaps). */
+      void compactArchive(void)
+      {
+         if(!useArchive)
+            return;
+         std::vector<SatID> sats;
+         typename SatTable::const_iterator it;
+         for(it=tables.begin(); it!=tables.end(); ++it)
+            sats.push_back(it->first);
+         typename std::map<SatID, ArchiveTable>::iterator ait;
+         for(ait=archiveTables.begin(); ait!=archiveTables.end(); ++ait)
+            ait->second.shrink();
+         for(std::size_t i=0; i<sats.size(); i++)
+            archiveTable(sats[i]);
+         rebuildFlatTables();
+      }
+
+         /// Get the number of satellites whose tables are archived.
+      int narchived(void) const throw() { return archiveTables.size(); }
+
+         /// Get the number of bytes used by the archived tables.
+      std::size_t archiveMemoryUsage(void) const throw()
+      {
+         std::size_t n(0);
+         typename std::map<SatID, ArchiveTable>::const_iterator ait;
+         for(ait=archiveTables.begin(); ait!=archiveTables.end(); ++ait)
+            n += ait->second.memoryUsage();
+         return n;
+      }
+
+   protected:
+         /** Number of fields of a DataRecord in an ArchiveTable;
+          * stores that support archive mode override this, and
+          * toArchiveFields() and fromArchiveFields(), to return a
+          * nonzero number. */
+      virtual unsigned archiveFields(void) const { return 0; }
+
+         /// Store rec in fields, archiveFields() values.
+      virtual void toArchiveFields(const DataRecord& rec, double *fields)
+         const
+      {}
+
+         /// Fill rec from fields, archiveFields() values.
+      virtual void fromArchiveFields(const double *fields, DataRecord& rec)
+         const
+      {}
+
+         /** Return the archived table of the given satellite, or
+          * NULL if it has none. */
+      const ArchiveTable* findArchiveTable(const SatID& sat) const throw()
+      {
+         if(archiveTables.empty())
+            return NULL;
+         typename std::map<SatID, ArchiveTable>::const_iterator
+            ait(archiveTables.find(sat));
+         return (ait == archiveTables.end() ? NULL : &ait->second);
+      }
+
+         /// Decode records j1 through j2 of an archived table into dtab.
+      void decodeArchive(const ArchiveTable& at, std::size_t j1,
+                         std::size_t j2, DataTable& dtab) const
+      {
+         std::vector<double> fields;
+         at.getRecords(j1, j2, fields);
+         const unsigned nf(at.numFields());
+         DataRecord rec;
+         dtab.clear();
+         for(std::size_t j=j1; j<=j2; j++)
+         {
+            fromArchiveFields(&fields[(j-j1)*nf], rec);
+            dtab.insert(dtab.end(), std::make_pair(at.getTime(j), rec));
+         }
+      }
+
+         /** Return a table holding at least records j1 through j2 of
+          * at, the archived table of sat.  The satellite's last
+          * window in archiveCache is reused if it holds them;
+          * otherwise the whole ArchiveTable blocks from j1 through
+          * the block after j2 are decoded and replace it.  The window
+          * is not changed once made, and this thread's last one is
+          * kept until its next call, so the table stays valid even
+          * if other threads replace the satellite's window. */
+      const DataTable& getArchiveWindow(const SatID& sat,
+                                        const ArchiveTable& at,
+                                        std::size_t j1,
+                                        std::size_t j2) const
+      {
+         static thread_local std::shared_ptr<const ArchiveWindow> held;
+         typename std::map<SatID, std::shared_ptr<const ArchiveWindow> >::
+            iterator cit(archiveCache.find(sat));
+         if(cit != archiveCache.end())
+         {
+            std::shared_ptr<const ArchiveWindow> win;
+            {
+               std::lock_guard<std::mutex> guard(interpCacheLock(sat));
+               win = cit->second;
+            }
+            if(win && win->j1 <= j1 && j2 <= win->j2)
+            {
+               held = win;
+               return win->recs;
+            }
+         }
+
+            // decode the window without holding the lock
+         const std::size_t nb(ArchiveTable::BlockSize);
+         std::shared_ptr<ArchiveWindow> win(new ArchiveWindow());
+         win->j1 = j1 - j1 % nb;
+         win->j2 = std::min(at.size()-1, j2 - j2 % nb + 2*nb - 1);
+         decodeArchive(at, win->j1, win->j2, win->recs);
+
+         if(cit != archiveCache.end())
+         {
+            std::lock_guard<std::mutex> guard(interpCacheLock(sat));
+            cit->second = win;
+         }
+         held = win;
+         return win->recs;
+      }
+
+         /** If in archive mode, add a record at time ttag to the
+          * archived table of sat, making it if the satellite is new.
+          * If the record can not be appended to it, the archived
+          * table is put back in a map.
+          * @return true if the record was added, false if it must be
+          *   added to the map in tables. */
+      bool archiveRecord(const SatID& sat, const CommonTime& ttag,
+                         const DataRecord& rec)
+      {
+         if(!useArchive || tables.find(sat) != tables.end())
+            return false;
+         std::vector<double> fields(archiveFields());
+         toArchiveFields(rec, &fields[0]);
+         typename std::map<SatID, ArchiveTable>::iterator
+            ait(archiveTables.find(sat));
+         if(ait == archiveTables.end())
+            ait = archiveTables.insert(
+               std::make_pair(sat, ArchiveTable(fields.size()))).first;
+         if(ait->second.append(ttag, &fields[0]))
+            return true;
+         expandArchive(sat);
+         return false;
+      }
+
+         /** Put the archived table of sat, if it has one, back into
+          * a map in tables. */
+      void expandArchive(const SatID& sat)
+      {
+         typename std::map<SatID, ArchiveTable>::iterator
+            ait(archiveTables.find(sat));
+         if(ait == archiveTables.end())
+            return;
+         if(!ait->second.empty())
+            decodeArchive(ait->second, 0, ait->second.size()-1, tables[sat]);
+         archiveTables.erase(ait);
+         archiveCache[sat].reset();
+         rebuildFlatTable(sat);
+      }
+
+         /** Move the table of sat from tables to an archived table,
+          * unless it is empty or its times are not on a grid.  The
+          * caller must rebuild the flat tables.
+          * @return true if the table was archived. */
+      bool archiveTable(const SatID& sat)
+      {
+         typename SatTable::iterator it(tables.find(sat));
+         if(it == tables.end() || it->second.empty())
+            return false;
+         ArchiveTable at(archiveFields());
+         std::vector<double> fields(archiveFields());
+         typename DataTable::const_iterator jt;
+         for(jt=it->second.begin(); jt!=it->second.end(); ++jt)
+         {
+            toArchiveFields(jt->second, &fields[0]);
+            if(!at.append(jt->first, &fields[0]))
+               return false;
+         }
+         at.shrink();
+         archiveTables[sat] = at;
+         tables.erase(it);
+         archiveCache[sat].reset();
+         return true;
+      }
+
+         /// Return all the satellites in tables and archiveTables, in order.
+      std::vector<SatID> allSats(void) const
+      {
+         std::vector<SatID> sats;
+         typename SatTable::const_iterator it;
+         for(it=tables.begin(); it!=tables.end(); ++it)
+            sats.push_back(it->first);
+         typename std::map<SatID, ArchiveTable>::const_iterator ait;
+         for(ait=archiveTables.begin(); ait!=archiveTables.end(); ++ait)
+            sats.push_back(ait->first);
+         std::inplace_merge(sats.begin(), sats.begin()+tables.size(),
+                            sats.end());
+         return sats;
+      }
+
+         /** Remove the data outside the time interval from one table;
+          * see edit(). */
+      static void editTable(DataTable& dtab, const CommonTime& tmin,
+                            const CommonTime& tmax)
+      {
+         typename DataTable::iterator jt;
+
+            // delete everything above tmax
+            // jt points to the earliest time > tmax
+         jt = dtab.upper_bound(tmax);
+         if(jt != dtab.end())
+            dtab.erase(jt,dtab.end());
+
+            // delete everything before tmin
+            // jt points to the earliest time >= tmin
+         jt = dtab.lower_bound(tmin);
+         if(jt != dtab.begin() && --jt != dtab.begin())
+            dtab.erase(dtab.begin(),jt);
+      }
+
+         /// Return the lock guarding the cached window for sat.
+      std::mutex& interpCacheLock(const SatID& sat) const
+      {
+         unsigned key(static_cast<unsigned>(sat.system) * 61 +
+                      static_cast<unsigned>(sat.id));
+         return interpCacheLocks[key % interpCacheLockCount];
+      }
+
+         /** Return the interpolation window holding the records from
+          * it1 through it2 of the table for sat, as found by
+          * getTableInterval(), reusing the satellite's last window
+          * if it covers the same interval.  The window is not changed
+          * once made, so it may be used after other threads have
+          * replaced it in the cache. */
+      std::shared_ptr<const InterpWindow>
+      getInterpWindow(const SatID& sat,
+                      const DataTableIterator& it1,
+                      const DataTableIterator& it2) const
+      {
+         typename std::map<SatID, std::shared_ptr<const InterpWindow> >::
+            iterator cit(interpCache.find(sat));
+         if(cit != interpCache.end())
+         {
+            std::shared_ptr<const InterpWindow> win;
+            {
+               std::lock_guard<std::mutex> guard(interpCacheLock(sat));
+               win = cit->second;
+            }
+            if(win && win->first == it1->first && win->last == it2->first)
+            {
+               interpCacheHits++;
+               return win;
+            }
+         }
+         interpCacheMisses++;
+
+            // make the window without holding the lock
+         std::shared_ptr<InterpWindow> win(new InterpWindow());
+         win->first = it1->first;
+         win->last = it2->first;
+         DataTableIterator kt(it1);
+         while(1)
+         {
+            win->times.push_back(kt->first - win->first);
+            win->recs.push_back(kt->second);
+            if(kt == it2) break;
+            ++kt;
+         }
+         LagrangeWeights(win->times, win->weights);
+
+         if(cit != interpCache.end())
+         {
+            std::lock_guard<std::mutex> guard(interpCacheLock(sat));
+            cit->second = win;
+         }
+         return win;
+      }
+
+         /** Forget the cached interpolation and archive windows for
+          * the given satellite, making their entries if needed.  Call
+          * whenever the satellite's table changes. */
+      void clearInterpCache(const SatID& sat)
+      {
+         interpCache[sat].reset();
+         archiveCache[sat].reset();
+      }
+
+         /** Forget all the cached interpolation and archive windows,
+          * leaving an entry for each satellite. */
+      void clearInterpCache(void)
+      {
+         interpCache.clear();
+         archiveCache.clear();
+         typename std::map<SatID, DataTable>::const_iterator satit;
+         for(satit = tables.begin(); satit != tables.end(); ++satit)
+         {
+            interpCache[satit->first];
+            archiveCache[satit->first];
+         }
+         typename std::map<SatID, ArchiveTable>::const_iterator ait;
+         for(ait = archiveTables.begin(); ait != archiveTables.end(); ++ait)
+         {
+            interpCache[ait->first];
+            archiveCache[ait->first];
+         }
+      }
+
+         /** Return the index in flatTables of the given satellite,
+          * or -1 if it has no flat table. */
+      int flatTableIndex(const SatID& sat) const throw()
+      {
+         unsigned sys(static_cast<unsigned>(sat.system));
+         if(sys >= flatIndex.size() || sat.id < 0 ||
+            sat.id >= int(flatIndex[sys].size()))
+            return -1;
+         return flatIndex[sys][sat.id];
+      }
+
+         /** Return the flat table for the given satellite, or NULL
+          * if it has none. */
+      const FlatTable* findFlatTable(const SatID& sat) const throw()
+      {
+         int i(flatTableIndex(sat));
+         return (i < 0 ? NULL : &flatTables[i]);
+      }
+
+         /** Rebuild the flat table for the given satellite from its
+          * DataTable.  Call whenever records are added to or removed
+          * from the table for sat, unless addToFlatTable() applies. */
+      void rebuildFlatTable(const SatID& sat)
+      {
+         if(!useFlatTable || sat.id < 0)
+            return;
+         typename SatTable::const_iterator satit(tables.find(sat));
+         if(satit == tables.end())
+            return;
+
+         unsigned sys(static_cast<unsigned>(sat.system));
+         if(sys >= flatIndex.size())
+            flatIndex.resize(sys+1);
+         if(sat.id >= int(flatIndex[sys].size()))
+            flatIndex[sys].resize(sat.id+1, -1);
+         if(flatIndex[sys][sat.id] < 0)
+         {
+            flatIndex[sys][sat.id] = flatTables.size();
+            flatTables.push_back(FlatTable());
+         }
+
+         FlatTable& ft(flatTables[flatIndex[sys][sat.id]]);
+         ft = FlatTable();
+         ft.secs.reserve(satit->second.size());
+         ft.recs.reserve(satit->second.size());
+         DataTableIterator jt;
+         for(jt=satit->second.begin(); jt!=satit->second.end(); ++jt)
+            appendFlatRecord(ft, jt);
+      }
+
+         /// Rebuild all the flat tables, or free them if not in use.
+      void rebuildFlatTables(void)
+      {
+         flatTables.clear();
+         flatIndex.clear();
+         if(!useFlatTable)
+            return;
+         typename SatTable::const_iterator it;
+         for(it=tables.begin(); it!=tables.end(); ++it)
+            rebuildFlatTable(it->first);
+      }
+
+         /** Update the flat table for the given satellite after a
+          * record has been added to its DataTable at time ttag.
+          * Adding after the last record, the usual case, takes
+          * constant time; otherwise the flat table is rebuilt. */
+      void addToFlatTable(const SatID& sat, const CommonTime& ttag)
+      {
+         if(!useFlatTable)
+            return;
+         int i(flatTableIndex(sat));
+         if(i >= 0 && !flatTables[i].recs.empty() &&
+            flatTables[i].recs.back()->first < ttag)
+         {
+            typename SatTable::const_iterator satit(tables.find(sat));
+            DataTableIterator jt(satit->second.end());
+            appendFlatRecord(flatTables[i], --jt);
+         }
+         else
+            rebuildFlatTable(sat);
+      }
+
+         /// Add a record at the end of a flat table.
+      static void appendFlatRecord(FlatTable& ft, const DataTableIterator& jt)
+      {
+            // tolerance (seconds) on the time step for a uniform table
+         static const double tol(1.e-6);
+
+         if(ft.recs.empty())
+         {
+            ft.secs.push_back(0.0);
+            ft.recs.push_back(jt);
+            return;
+         }
+
+         double sec(jt->first - ft.recs[0]->first);
+         if(ft.recs.size() == 1)
+         {
+            ft.step = sec;
+            ft.uniform = (sec > 0.0);
+         }
+         else if(ft.uniform && std::fabs(sec - ft.step*ft.secs.size()) > tol)
+            ft.uniform = false;
+
+         ft.secs.push_back(sec);
+         ft.recs.push_back(jt);
+      }
+
+         /** Find the position in a flat table of the first record
+          * with time >= ttag, as DataTable::lower_bound() would. */
+      static std::size_t flatLowerBound(const FlatTable& ft,
+                                        const CommonTime& ttag)
+      {
+         const std::size_t n(ft.recs.size());
+         double sec(ttag - ft.recs[0]->first);
+         std::size_t k;
+
+            // first guess, computed directly for evenly spaced data
+         if(ft.uniform)
+         {
+            double x(std::ceil(sec/ft.step));
+            k = (x <= 0.0 ? 0 : (x >= double(n) ? n : std::size_t(x)));
+         }
+         else
+            k = std::lower_bound(ft.secs.begin(), ft.secs.end(), sec)
+               - ft.secs.begin();
+
+            // then make sure of it using the times themselves
+         while(k > 0 && !(ft.recs[k-1]->first < ttag))
+            --k;
+         while(k < n && ft.recs[k]->first < ttag)
+            ++k;
+
+         return k;
+      }
+
+         /** getTableInterval() for a satellite with a flat table.
+          * This follows the map version step for step, using
+          * positions in the flat table instead of map iterators, and
+          * returns the same interval or throws the same errors. */
+      bool getFlatTableInterval(const SatID& sat,
+                                const FlatTable& ft,
+                                const CommonTime& ttag,
+                                const int& nhalf,
+                                DataTableIterator& it1,
+                                DataTableIterator& it2,
+                                bool exactReturn,
+                                const char *fmt)
+         const
+      {
+         const std::size_t n(ft.recs.size());
+
+            // cannot interpolate with one point
+         if(n < 2)
+         {
+            InvalidRequest e("Inadequate data (size < 2) for satellite " +
+                             gpstk::StringUtils::asString(sat) +
+                             printTime(ttag,fmt));
+            GPSTK_THROW(e);
+         }
+
+            // i2 is the first record with time >= ttag
+         std::size_t i1, i2(flatLowerBound(ft, ttag));
+         bool exactMatch(i2 < n && !(ttag < ft.recs[i2]->first));
+
+         if(exactMatch && exactReturn)
+         {
+            it1 = ft.recs[i2];
+            return true;
+         }
+
+         if(i2 == n)
+         {
+            InvalidRequest e("No data in time range for satellite " +
+                             gpstk::StringUtils::asString(sat) +
+                             printTime(ttag,fmt));
+            GPSTK_THROW(e);
+         }
+
+            // ttag is <= first time in table
+         if(i2 == 0)
+         {
+            if(exactMatch && nhalf==1)
+            {
+               it1 = ft.recs[0];
+               it2 = ft.recs[1];
+               return exactMatch;
+            }
+            InvalidRequest e("Inadequate data before(1) requested time for"
+                             " satellite " +
+                             gpstk::StringUtils::asString(sat) +
+                             printTime(ttag,fmt));
+            GPSTK_THROW(e);
+         }
+
+         i1 = i2 - 1;
+         if(i1 == 0)
+         {
+            if(nhalf==1)
+            {
+               it1 = ft.recs[0];
+               it2 = ft.recs[1];
+               return exactMatch;
+            }
+            InvalidRequest e("Inadequate data before(2) requested time for"
+                             " satellite " +
+                             gpstk::StringUtils::asString(sat) +
+                             printTime(ttag,fmt));
+            GPSTK_THROW(e);
+         }
+
+         if(checkDataGap &&
+            (ft.recs[i2]->first - ft.recs[i1]->first) > gapInterval)
+         {
+            InvalidRequest e("Gap at interpolation time for satellite " +
+                             gpstk::StringUtils::asString(sat) +
+                             printTime(ttag,fmt));
+            GPSTK_THROW(e);
+         }
+
+            // expand the interval to include 2*nhalf timesteps
+         for(int k=0; k<nhalf-1; k++)
+         {
+            bool last(k==nhalf-2);
+            if(--i1 == 0 && !last)
+            {
+               InvalidRequest
+                  e("Inadequate data before(3) requested time for"
+                    " satellite " + gpstk::StringUtils::asString(sat) +
+                    printTime(ttag,fmt));
+               GPSTK_THROW(e);
+            }
+            if(++i2 == n)
+            {
+               if(exactMatch && last && i1 != 0)
+               {
+                  i2--;
+                  i1--;
+               }
+               else
+               {
+                  InvalidRequest
+                     e("Inadequate data after(2) requested time for"
+                       " satellite " + gpstk::StringUtils::asString(sat) +
+                       printTime(ttag,fmt));
+                  GPSTK_THROW(e);
+               }
+            }
+         }
+
+         if(checkInterval &&
+            (ft.recs[i2]->first - ft.recs[i1]->first) > maxInterval)
+         {
+            InvalidRequest e("Interpolation interval too large for"
+                             " satellite " +
+                             gpstk::StringUtils::asString(sat) +
+                             printTime(ttag,fmt));
+            GPSTK_THROW(e);
+         }
+
+         it1 = ft.recs[i1];
+         it2 = ft.recs[i2];
+         return exactMatch;
+      }
+
+         /** The search of getTableInterval() in a DataTable.
+          * @param[in] sat satellite of interest, for messages
+          * @param[in] dtable the table, or for an archived table a
+          *   window of it from getArchiveWindow()
+          * @param[in] n number of records in the whole table
+          * @param[in] fmt format for the time in messages
+          * For the other parameters and the return value, see
+          * getTableInterval(). */
+      bool searchTableInterval(const SatID& sat,
+                               const DataTable& dtable,
+                               std::size_t n,
+                               const CommonTime& ttag,
+                               const int& nhalf,
+                               DataTableIterator& it1,
+                               DataTableIterator& it2,
+                               bool exactReturn,
+                               const char *fmt)
+         const
+      {
+            // cannot interpolate with one point
+         if(n < 2)
+         {
+            InvalidRequest e("Inadequate data (size < 2) for satellite " +
+                             gpstk::StringUtils::asString(sat) +
+                             printTime(ttag,fmt));
+            GPSTK_THROW(e);
+         }
+
+            // find the timetag in this table
+
+            /** @note throw here if time systems do not match and
+             * are not "Any" */
+         it1 = dtable.find(ttag);
+            // is it an exact match?
+         bool exactMatch(it1 != dtable.end());
+
+            // user must decide whether to return with exact value;
+            // e.g. without velocity data, user needs the interval
+            // to compute v from x data
+         if(exactMatch && exactReturn)
+            return true;
+
+            // lower_bound points to the first element with key >= ttag
+         it1 = it2 = dtable.lower_bound(ttag);
+         if (it1 == dtable.end())
+         {
+            InvalidRequest e("No data in time range for satellite " +
+                             gpstk::StringUtils::asString(sat) +
+                             printTime(ttag,fmt));
+            GPSTK_THROW(e);
+         }
+
+            // ttag is <= first time in table
+         if(it1 == dtable.begin())
+         {
+               // at table begin but its an exact match && an
+               // interval of only 2
+            if(exactMatch && nhalf==1)
+            {
+               ++(it2 = it1);
+               return exactMatch;
+            }
+            InvalidRequest e("Inadequate data before(1) requested time for"
+                             " satellite " +
+                             gpstk::StringUtils::asString(sat) +
+                             printTime(ttag,fmt));
+            GPSTK_THROW(e);
+         }
+
+            // move it1 down by one
+         if(--it1 == dtable.begin())
+         {
+               // if an interval of only 2
+            if(nhalf==1)
+            {
+               ++(it2 = it1);
+               return exactMatch;
+            }
+            InvalidRequest e("Inadequate data before(2) requested time for"
+                             " satellite " +
+                             gpstk::StringUtils::asString(sat) +
+                             printTime(ttag,fmt));
+            GPSTK_THROW(e);
+         }
+
+            //LOG(INFO) << "OK, have interval " << printTime(it1->first,"%F/%g") <<
+            //" <= " <<printTime(ttag,"%F/%g")<< " < " <<printTime(it2->first,"%F/%g");
+
+            // now have it1->first <= ttag < it2->first and it2 ==
+            // it1+1 check for gap between these two table entries
+            // surrounding ttag
+         if(checkDataGap && (it2->first-it1->first) > gapInterval)
+         {
+            InvalidRequest e("Gap at interpolation time for satellite " +
+                             gpstk::StringUtils::asString(sat) +
+                             printTime(ttag,fmt));
+            GPSTK_THROW(e);
+         }
+
+            // now expand the interval to include 2*nhalf timesteps
+         for(int k=0; k<nhalf-1; k++)
+         {
+            bool last(k==nhalf-2); // true only on the last iteration
+               // move left by one; if require full interval && out
+               // of room on left, fail
+            if(--it1 == dtable.begin() && !last)
+            {
+               InvalidRequest
+                  e("Inadequate data before(3) requested time for"
+                    " satellite " + gpstk::StringUtils::asString(sat) +
+                    printTime(ttag,fmt));
+               GPSTK_THROW(e);
+            }
+               //LOG(INFO) << k << " expand left " << printTime(it1->first,"%F/%g");
+
+            if(++it2 == dtable.end())
+            {
+               if(exactMatch && last && it1 != dtable.begin())
+               {
+                     // exact match && at end of interval && with
+                     // room to move down
+
+                     // move interval down by one
+                  it2--;
+                  it1--;
+               }
+               else
+               {
+                  InvalidRequest
+                     e("Inadequate data after(2) requested time for"
+                       " satellite " + gpstk::StringUtils::asString(sat) +
+                       printTime(ttag,fmt));
+                  GPSTK_THROW(e);
+               }
+            }
+               //LOG(INFO) << k << " expand right " << printTime(it2->first,"%F/%g");
+         }
+
+            // check that the interval is not too large
+         if(checkInterval && (it2->first - it1->first) > maxInterval)
+         {
+            InvalidRequest e("Interpolation interval too large for"
+                             " satellite " +
+                             gpstk::StringUtils::asString(sat) +
+                             printTime(ttag,fmt));
+            GPSTK_THROW(e);
+         }
+
+         return exactMatch;
+      }
+
+
+         /** The search of getNonCenteredTableInterval() in a
+          * DataTable; see searchTableInterval(). */
+      bool searchNonCenteredInterval(const SatID& sat,
+                                     const DataTable& dtable,
+                                     std::size_t n,
+                                     const CommonTime& ttag,
+                                     const int& nhalf,
+                                     DataTableIterator& it1,
+                                     DataTableIterator& it2,
+                                     bool exactReturn,
+                                     const char *fmt)
+         const
+      {
+            // find the timetag in this table
+            /** @note throw here if time systems do not match and
+             * are not "Any" */
+         it1 = dtable.find(ttag);
+            // is it an exact match?
+         bool exactMatch(it1 != dtable.end());
+
+            // user must decide whether to return with exact value;
+            // e.g. without velocity data, user needs the interval
+            // to compute v from x data
+         if(exactMatch && exactReturn)
+            return true;
+
+            // lower_bound points to the first element with key >= ttag
+         it1 = it2 = dtable.lower_bound(ttag);
+
+            // Should we allow to predict data?
+         if(it1 == dtable.end())
+         {
+            InvalidRequest ir("No data for the requested time of satellite "
+                              + gpstk::StringUtils::asString(sat)
+                              + printTime(ttag,fmt));
+            GPSTK_THROW(ir);
+         }
+
+         if(int(n) < 2*nhalf)
+         {
+            InvalidRequest ir("Inadequate data for satellite " +
+                              gpstk::StringUtils::asString(sat) +
+                              printTime(ttag,fmt));
+            GPSTK_THROW(ir);
+         }
+
+            // check for gap only when exactMatch==false
+         if(!exactMatch && checkDataGap)
+         {
+            typename DataTable::const_iterator lit,rit;
+            lit = rit = it2;
+
+            if(rit!=dtable.begin())
+            {
+               lit--;
+               if((rit->first-lit->first) > gapInterval)
+               {
+                  InvalidRequest ir(
+                     "Gap at interpolation time for satellite " +
+                     gpstk::StringUtils::asString(sat) +
+                     printTime(ttag,fmt));
+                  GPSTK_THROW(ir);
+               }
+            }
+            else
+            {
+               if((rit->first - ttag) > gapInterval)
+               {
+                  InvalidRequest ir(
+                     "Gap may produce bad interpolation precision for"
+                     " satellite " + gpstk::StringUtils::asString(sat) +
+                     printTime(ttag,fmt));
+                  GPSTK_THROW(ir);
+               }
+            }
+         }
+
+            // try to get the beginning of the window
+         int i, ileft(nhalf);
+         for(i = 0; i < nhalf; i++)
+         {
+            if(it1 == dtable.begin())
+               break;
+            it1--;
+            ileft--;
+         }
+
+            // try to get the ending of the window
+         int iright = nhalf - 1 + ileft;
+         for(i = 0; i < (nhalf-1+ileft); i++)
+         {
+            it2++;
+            if(it2 == dtable.end())
+            {
+               it2--;
+               break;
+            }
+            iright--;
+         }
+
+            // adjust the beginning of the window again
+         int ileft2 = iright;
+         for(i = 0; i < iright; i++)
+         {
+            if(it1 == dtable.begin())
+               break;
+            it1--;
+            ileft2--;
+         }
+
+            // We have checked that there are enough data, so ileft2 should
+            // always be zero.
+         if(ileft2 > 0)
+         {
+            InvalidRequest ir("This should never happen");
+            GPSTK_THROW(ir);
+         }
+
+            // check that the interval is not too large
+         if(checkInterval && (it2->first - it1->first) > maxInterval)
+         {
+            InvalidRequest ir("Interpolation interval too large for"
+                              " satellite " +
+                              gpstk::StringUtils::asString(sat) +
+                              printTime(ttag,fmt));
+            GPSTK_THROW(ir);
+         }
+
+         return exactMatch;
+      }
    };
 
       //@}
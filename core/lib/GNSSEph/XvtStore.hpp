@@ -47,6 +47,7 @@
 
 #include <iostream>
 #include <set>
+#include <vector>
 
 #include "Exception.hpp"
 #include "CommonTime.hpp"
@@ -60,6 +61,17 @@ namespace gpstk
       /// Abstract base class for storing and accessing an object's position, 
       /// velocity, and clock data. Also defines a simple interface to remove
       /// data that had been added.
+      ///
+      /// Thread safety: once loaded, a store may be shared by any number
+      /// of threads calling its const methods (getXvt(), computeXvt(),
+      /// getSVHealth() and the like) at the same time, and each call
+      /// returns what it would have returned in a single thread.  Any
+      /// state that an implementation changes in a const method, such as
+      /// a lookup or interpolation cache, must be guarded so that this
+      /// holds, preferably per object so that queries for different
+      /// objects don't wait on each other.  Non-const methods (loading,
+      /// edit(), clear(), configuration) must not run at the same time
+      /// as any other call on the same store.
    template <class IndexType>
    class XvtStore
    {
@@ -94,6 +106,47 @@ namespace gpstk
       virtual Xvt computeXvt(const IndexType& id, const CommonTime& t)
          const throw() = 0;
 
+         /** Get the position, velocity, and clock offset of each of
+          * the indicated objects, each at its own time, with the same
+          * results as getXvt(ids[i],times[i]).  Where getXvt() would
+          * throw InvalidRequest, found[i] is false instead, so that
+          * one missing object does not fail the others.  Stores that
+          * can look up or evaluate many objects together override
+          * this; the default calls getXvt() for each.
+          * @param[in] ids the objects' identifiers
+          * @param[in] times the time to look up for each of ids
+          * @param[out] xvts the Xvt of each of ids
+          * @param[out] found true where xvts is defined
+          * @return the number of objects found
+          * @throw InvalidParameter if ids and times differ in size */
+      virtual int getXvts(const std::vector<IndexType>& ids,
+                          const std::vector<CommonTime>& times,
+                          std::vector<Xvt>& xvts,
+                          std::vector<bool>& found) const
+      {
+         if (ids.size() != times.size())
+         {
+            InvalidParameter e("ids and times differ in size");
+            GPSTK_THROW(e);
+         }
+         int n(0);
+         xvts.resize(ids.size());
+         found.assign(ids.size(), false);
+         for (size_t i = 0; i < ids.size(); i++)
+         {
+            try
+            {
+               xvts[i] = getXvt(ids[i], times[i]);
+               found[i] = true;
+               n++;
+            }
+            catch (InvalidRequest&)
+            {
+            }
+         }
+         return n;
+      }
+
          /** Get the satellite health at a specific time.
           * @param[in] id the object's identifier
           * @param[in] t the time to look up
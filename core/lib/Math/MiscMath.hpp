@@ -187,6 +187,64 @@ namespace gpstk
       }
    }  // end void LagrangeInterpolation(vector, vector, const T, T&, T&)
 
+      /** Compute the weights Wi = 1/Di = 1/PROD(j!=i)[Xi-Xj] used by
+       * LagrangeCoefficients().  They depend only on X, so may be
+       * computed once and used to interpolate any number of data
+       * sets at any number of points.
+       * @throw Exception if two of the X are equal.
+       */
+   template <class T>
+   void LagrangeWeights(const std::vector<T>& X, std::vector<T>& W)
+   {
+      std::size_t i,j,N=X.size();
+      W.assign(N,T(1));
+      for(i=0; i<N; i++) {
+         for(j=0; j<N; j++)
+            if(i != j) W[i] *= X[i]-X[j];
+         if(W[i] == T(0)) {
+            GPSTK_THROW(Exception("Input X values must be distinct"));
+         }
+         W[i] = T(1)/W[i];
+      }
+   }  // end void LagrangeWeights(const vector, vector)
+
+      /** Compute the Lagrange coefficients L[i] = Li(x) and
+       * Lp[i] = Lpi(x) (see above) at x, given weights W from
+       * LagrangeWeights(X,W), so that for any data Y on X, Y(x) =
+       * SUM[L[i]*Y[i]] and dY(x)/dx = SUM[Lp[i]*Y[i]].  This costs
+       * O(N^2) for the coefficients and O(N) for each data set, so
+       * is much cheaper than LagrangeInterpolation() when several
+       * data sets are interpolated at the same x.  The results
+       * differ from LagrangeInterpolation() only by rounding error;
+       * if x is equal to one of the X, Y(x) is exactly that Y.
+       */
+   template <class T>
+   void LagrangeCoefficients(const std::vector<T>& X, const std::vector<T>& W,
+                             const T& x, std::vector<T>& L, std::vector<T>& Lp)
+   {
+      std::size_t i,j,N=X.size();
+      L.resize(N);
+      Lp.resize(N);
+      for(i=0; i<N; i++) {
+         // accumulate Pi and Si (see above) one factor at a time
+         T P(1),S(0);
+         for(j=0; j<N; j++) {
+            if(i == j) continue;
+            S = S*(x-X[j]) + P;
+            P *= x-X[j];
+         }
+         L[i] = P*W[i];
+         Lp[i] = S*W[i];
+      }
+      for(i=0; i<N; i++) {
+         if(x == X[i]) {
+            L.assign(N,T(0));
+            L[i] = T(1);
+            break;
+         }
+      }
+   }  // end void LagrangeCoefficients(vector, vector, const T, vector, vector)
+
 
       /// Returns the second derivative of Lagrange interpolation.
    template <class T>
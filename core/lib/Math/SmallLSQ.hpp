@@ -0,0 +1,235 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+
+/**
+ * @file SmallLSQ.hpp
+ * Least squares for small problems, using storage of fixed size.
+ */
+
+#ifndef GPSTK_SMALLLSQ_HPP
+#define GPSTK_SMALLLSQ_HPP
+
+#include <cmath>
+#include "Matrix.hpp"
+
+namespace gpstk
+{
+      /// @ingroup MathGroup
+      //@{
+
+      /**
+       * Solve the normal equations of a small least squares problem, of
+       * dimension n no larger than MaxN, without allocating memory. The
+       * information matrix and data vector are accumulated in arrays of fixed
+       * size, and inverted by Cholesky decomposition; only when that shows the
+       * problem to be ill-conditioned is the inverse computed by SVD, using
+       * gpstk::inverseSVD(), as a general Matrix. So this is meant to live on
+       * the stack of a routine called often, e.g. once per iteration of a
+       * position solution.
+       *
+       * @code
+       * SmallLSQ<double,4> LSQ(4);
+       * for(i=0; i<ndata; i++)
+       *    LSQ.Add(partials[i], data[i], weight[i]);
+       * LSQ.Solve();
+       * for(i=0; i<4; i++)
+       *    cout << LSQ.X(i) << " +/- " << sqrt(LSQ.Cov(i,i)) << endl;
+       * @endcode
+       */
+   template <class T, unsigned int MaxN>
+   class SmallLSQ
+   {
+   public:
+         /// the largest dimension
+      static const unsigned int MaxDim = MaxN;
+
+         /// Constructor given the dimension
+      SmallLSQ(unsigned int n=0) : n_(0) { Reset(n); }
+
+         /** Reset the estimation, i.e. restart with new data, with
+          * new dimension.  Default dimension is 0, meaning do not
+          * change dimension.
+          * @throw MatrixException if n > MaxN
+          */
+      void Reset(unsigned int n=0)
+      {
+         if(n > MaxN) {
+            MatrixException e("SmallLSQ dimension is too large");
+            GPSTK_THROW(e);
+         }
+         if(n != 0) n_ = n;
+         for(unsigned int i=0; i<n_; i++) {
+            Data_[i] = T(0);
+            for(unsigned int j=0; j<n_; j++) Info_[i][j] = T(0);
+         }
+         Cholesky_ = false;
+      }
+
+         /** Add a single (optional: weighted) datum to the estimation,
+          * with partials P (an array of n) and data d.
+          */
+      void Add(const T *P, T d, T w=T(1))
+      {
+         for(unsigned int i=0; i<n_; i++) {
+            const T wp(w*P[i]);
+            Data_[i] += wp*d;
+            for(unsigned int j=0; j<=i; j++) Info_[i][j] += wp*P[j];
+         }
+      }
+
+         /** Element of the information matrix, for direct accumulation;
+          * only the lower triangle (i >= j) is used by Solve(). */
+      inline T& Info(unsigned int i, unsigned int j) { return Info_[i][j]; }
+         /// Element of the information vector, for direct accumulation.
+      inline T& Data(unsigned int i) { return Data_[i]; }
+
+         /** Invert the information matrix and compute the solution.
+          * @return true if Cholesky was used, false if the problem was
+          *   ill-conditioned and SVD was used.
+          * @throw MatrixException if the information matrix is zero
+          */
+      bool Solve(void)
+      {
+         unsigned int i,j,k;
+         T d;
+
+         // Cholesky decomposition Info = L*LT, with L stored in Cov_;
+         // a pivot small relative to its diagonal means ill-conditioned
+         Cholesky_ = true;
+         for(j=0; j<n_ && Cholesky_; j++) {
+            d = Info_[j][j];
+            for(k=0; k<j; k++) d -= Cov_[j][k]*Cov_[j][k];
+            if(!(d > T(1.e-8)*Info_[j][j])) { Cholesky_ = false; break; }
+            Cov_[j][j] = std::sqrt(d);
+            for(i=j+1; i<n_; i++) {
+               d = Info_[i][j];
+               for(k=0; k<j; k++) d -= Cov_[i][k]*Cov_[j][k];
+               Cov_[i][j] = d/Cov_[j][j];
+            }
+         }
+
+         if(Cholesky_) {
+            // invert L in place (lower triangle of Cov_)
+            for(j=0; j<n_; j++) {
+               Cov_[j][j] = T(1)/Cov_[j][j];
+               for(i=j+1; i<n_; i++) {
+                  d = T(0);
+                  for(k=j; k<i; k++) d -= Cov_[i][k]*Cov_[k][j];
+                  Cov_[i][j] = d/Cov_[i][i];
+               }
+            }
+            // Cov = inverse(L)T * inverse(L); fill the upper triangle first,
+            // since it does not overlap inverse(L)
+            for(i=0; i<n_; i++) {
+               for(j=i+1; j<n_; j++) {
+                  d = T(0);
+                  for(k=j; k<n_; k++) d += Cov_[k][i]*Cov_[k][j];
+                  Cov_[i][j] = d;
+               }
+            }
+            for(i=0; i<n_; i++) {
+               d = T(0);
+               for(k=i; k<n_; k++) d += Cov_[k][i]*Cov_[k][i];
+               Cov_[i][i] = d;
+               for(j=0; j<i; j++) Cov_[i][j] = Cov_[j][i];
+            }
+         }
+         else {
+            Matrix<T> Inf(n_,n_);
+            for(i=0; i<n_; i++)
+               for(j=0; j<=i; j++) Inf(i,j) = Inf(j,i) = Info_[i][j];
+            Matrix<T> C(inverseSVD(Inf));
+            for(i=0; i<n_; i++)
+               for(j=0; j<n_; j++) Cov_[i][j] = C(i,j);
+         }
+
+         // solution
+         for(i=0; i<n_; i++) {
+            X_[i] = T(0);
+            for(j=0; j<n_; j++) X_[i] += Cov_[i][j]*Data_[j];
+         }
+
+         return Cholesky_;
+      }
+
+         /// element of the solution vector, after Solve()
+      inline T X(unsigned int i) const { return X_[i]; }
+         /// element of the covariance matrix, after Solve()
+      inline T Cov(unsigned int i, unsigned int j) const { return Cov_[i][j]; }
+         /// was the last Solve() done by Cholesky (well-conditioned)?
+      inline bool isCholesky(void) const { return Cholesky_; }
+         /// get the dimension
+      inline unsigned int Dim(void) const { return n_; }
+
+         /// get the solution vector as a gpstk::Vector
+      Vector<T> Solution(void) const
+      {
+         Vector<T> V(n_);
+         for(unsigned int i=0; i<n_; i++) V(i) = X_[i];
+         return V;
+      }
+         /// get the covariance matrix as a gpstk::Matrix
+      Matrix<T> Covariance(void) const
+      {
+         Matrix<T> M(n_,n_);
+         for(unsigned int i=0; i<n_; i++)
+            for(unsigned int j=0; j<n_; j++) M(i,j) = Cov_[i][j];
+         return M;
+      }
+
+   private:
+         /// dimension of the problem, <= MaxN
+      unsigned int n_;
+         /// lower triangle of the information matrix
+      T Info_[MaxN][MaxN];
+         /// information vector
+      T Data_[MaxN];
+         /// covariance (inverse of information), also workspace in Solve()
+      T Cov_[MaxN][MaxN];
+         /// solution vector
+      T X_[MaxN];
+         /// true if the last Solve() used Cholesky
+      bool Cholesky_;
+
+   }; // end class SmallLSQ
+
+      //@}
+
+}  // namespace gpstk
+
+#endif
@@ -40,6 +40,12 @@
 /// Pseudorange navigation solution, either a simple solution using all the
 /// given data, or a solution including editing via a RAIM algorithm.
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <thread>
 #include "MathBase.hpp"
 #include "PRSolution.hpp"
 #include "GPSEllipsoid.hpp"
@@ -56,6 +62,10 @@ namespace gpstk
    const string PRSolution::gpsfmt = string("%4F %10.3g");
    const string PRSolution::timfmt = gpsfmt + string(" ") + calfmt;
 
+   // the normal equations of SimplePRSolution: 3 position states plus at most
+   // one clock per system
+   typedef SmallLSQ<double, 3+int(SatelliteSystem::Last)> PRSLSQ;
+
    ostream& operator<<(ostream& os, const WtdAveStats& was)
       { was.dump(os,was.getMessage()); return os;}
  
@@ -257,10 +267,21 @@ namespace gpstk
             LOG(DEBUG) << "inv MCov matrix is\n" << fixed << setprecision(4) << iMC;
          }
 
+         // are the weights diagonal?
+         bool diagMC(true);
+         for(i=0; i<iMC.rows() && diagMC; i++)
+            for(j=0; j<iMC.cols(); j++)
+               if(j != i && iMC(i,j) != 0.0) { diagMC = false; break; }
+
          // -----------------------------------------------------------
-         // define for computation
-         Vector<double> CRange(Nsvs),dX(dim);
-         Matrix<double> P(Nsvs,dim,0.0),PT,G(dim,Nsvs),PG(Nsvs,Nsvs),Rotation;
+         // define for computation; the normal equations are solved in LSQ,
+         // with fixed storage, so nothing is allocated in the iteration loop.
+         // WP = iMC * P, which is P when there are no weights
+         Vector<double> CRange(Nsvs);
+         Matrix<double> P(Nsvs,dim,0.0),WP;
+         if(invMC.rows() > 0) WP = Matrix<double>(Nsvs,dim);
+         const Matrix<double>& PW(invMC.rows() > 0 ? WP : P);
+         PRSLSQ LSQ(dim);
          Triple dirCos;
          Xvt SV,RX;
 
@@ -390,41 +411,46 @@ namespace gpstk
                << fixed << setprecision(3) << Resids;
 
             // ------------------------------------------------------
-            // compute information matrix (inverse covariance) and generalized inverse
-            PT = transpose(P);
-
-            // weight matrix = measurement covariance inverse
-            if(invMC.rows() > 0) Covariance = PT * iMC * P;
-            else                 Covariance = PT * P;
+            // weighted partials WP = measurement covariance inverse * P
+            if(invMC.rows() > 0) {
+               for(n=0; n<Nsvs; n++) {
+                  for(k=0; k<dim; k++) {
+                     if(diagMC) WP(n,k) = iMC(n,n)*P(n,k);
+                     else for(WP(n,k)=0.0,i=0; i<Nsvs; i++)
+                        WP(n,k) += iMC(n,i)*P(i,k);
+                  }
+               }
+            }
 
-            // invert using SVD
+            // compute information matrix PT*WP (inverse covariance) and
+            // information vector PT*W*Resids, and invert
+            LSQ.Reset();
+            for(n=0; n<Nsvs; n++) {
+               for(k=0; k<dim; k++) {
+                  LSQ.Data(k) += PW(n,k)*Resids(n);
+                  for(j=0; j<=size_t(k); j++)
+                     LSQ.Info(k,j) += PW(n,k)*P(n,j);
+               }
+            }
             try {
-               Covariance = inverseSVD(Covariance);
+               if(!LSQ.Solve())
+                  LOG(DEBUG) << "Information matrix is ill-conditioned - use SVD";
             }
             catch(SingularMatrixException& sme) { return -2; }
-            LOG(DEBUG) << "InvCov (" << Covariance.rows() << "x" << Covariance.cols()
-               << ")\n" << fixed << setprecision(4) << Covariance;
-
-            // generalized inverse
-            if(invMC.rows() > 0) G = Covariance * PT * iMC;
-            else                 G = Covariance * PT;
-
-            // PG is used for Slope computation
-            PG = P * G;
-            LOG(DEBUG) << "PG (" << PG.rows() << "x" << PG.cols()
-               << ")\n" << fixed << setprecision(4) << PG;
 
             n_iterate++;                        // increment number iterations
 
             // ------------------------------------------------------
-            // compute solution
-            dX = G * Resids;
-            LOG(DEBUG) << "Computed dX(" << dX.size() << ")";
-            Solution += dX;
+            // compute solution; dX = Covariance * PT * W * Resids
+            for(converge=0.0,k=0; k<dim; k++) {
+               Solution(k) += LSQ.X(k);
+               converge += LSQ.X(k)*LSQ.X(k);
+            }
+            LOG(DEBUG) << "Computed dX(" << dim << ")";
 
             // ------------------------------------------------------
             // test for convergence
-            converge = norm(dX);
+            converge = SQRT(converge);
             if(n_iterate > 1 && converge < convLimit) {              // success: quit
                iret = 0;
                break;
@@ -440,18 +466,31 @@ namespace gpstk
          if(TropFlag) LOG(DEBUG) << "Trop correction not applied at time "
                                  << printTime(T,timfmt);
 
-         // compute slopes and find max member
+         // covariance from the last iteration
+         Covariance = LSQ.Covariance();
+         LOG(DEBUG) << "InvCov (" << Covariance.rows() << "x" << Covariance.cols()
+            << ")\n" << fixed << setprecision(4) << Covariance;
+
+         // compute slopes and find max member, using column j of the generalized
+         // inverse G = Covariance * PT * W, and PG(j,j) = row j of P times it
          MaxSlope = 0.0;
          Slopes = 0.0;
          if(iret == 0) for(j=0,i=0; i<Sats.size(); i++) {
             if(Sats[i].id <= 0) continue;
 
+            double Gj[PRSLSQ::MaxDim],PGjj(0.0);
+            for(k=0; k<dim; k++) {
+               Gj[k] = 0.0;
+               for(n=0; n<dim; n++) Gj[k] += LSQ.Cov(k,n)*PW(j,n);
+               PGjj += P(j,k)*Gj[k];
+            }
+
             // NB when one (few) sats have their own clock, PG(j,j) = 1 (nearly 1)
             // and slope is inf (large)
-            if(::fabs(1.0-PG(j,j)) < 1.e-8) continue;
+            if(::fabs(1.0-PGjj) < 1.e-8) continue;
 
-            for(int k=0; k<dim; k++) Slopes(j) += G(k,j)*G(k,j); // TD dim=4 here?
-            Slopes(j) = SQRT(Slopes(j)*double(n-dim)/(1.0-PG(j,j)));
+            for(k=0; k<dim; k++) Slopes(j) += Gj[k]*Gj[k]; // TD dim=4 here?
+            Slopes(j) = SQRT(Slopes(j)*double(Nsvs-dim)/(1.0-PGjj));
             if(Slopes(j) > MaxSlope) MaxSlope = Slopes(j);
             j++;
          }
@@ -516,35 +555,18 @@ namespace gpstk
 
          LOG(DEBUG) << "RAIMCompute at time " << printTime(Tr,gpsfmt);
 
-         int iret,N;
-         size_t i,j;
-         vector<int> GoodIndexes;
-         // use these to save the 'best' solution within the loop.
-         // BestRMS marks the 'Best' set as unused.
-         bool BestTropFlag(false);
-         int BestNIter(0),BestIret(-5);
-         double BestRMS(-1.0),BestSL(0.0),BestConv(0.0);
-         Vector<double> BestSol(3,0.0),BestPFR;
-         vector<SatID> BestSats,SaveSats;
-         Matrix<double> SVP,BestCov,BestInvMCov,BestPartials;
-         vector<SatelliteSystem> BestGNSS;
-
-         // initialize
-         Valid = false;
-         currTime = Tr;
-         TropFlag = SlopeFlag = RMSFlag = false;
-
          // ----------------------------------------------------------------
          // fill the SVP matrix, and use it for every solution
          // NB this routine will reject sat systems not found in allowedGNSS, and
          //    sats without ephemeris.
-         N = PreparePRSolution(Tr, Sats, Pseudorange, pEph, SVP);
+         Matrix<double> SVP;
+         int N = PreparePRSolution(Tr, Sats, Pseudorange, pEph, SVP);
 
          if(LOGlevel >= ConfigureLOG::Level("DEBUG")) {
             LOG(DEBUG) << "Prepare returns " << N;
             ostringstream oss;
             oss << "RAIMCompute: after PrepareAS(): Satellites:";
-            for(i=0; i<Sats.size(); i++) {
+            for(size_t i=0; i<Sats.size(); i++) {
                RinexSatID rs(::abs(Sats[i].id), Sats[i].system);
                oss << " " << (Sats[i].id < 0 ? "-" : "") << rs;
             }
@@ -557,7 +579,47 @@ namespace gpstk
             LOG(DEBUG) << oss.str();
          }
 
-         // return is >=0(number of good sats) or -4(no ephemeris)
+         return RAIMCompute(Tr, Sats, SVP, N, invMC, pTropModel);
+      }
+      catch(Exception& e) {
+         GPSTK_RETHROW(e);
+      }
+   }  // end PRSolution::RAIMCompute()
+
+   // -------------------------------------------------------------------------
+   // Compute a solution using RAIM, given the output of PreparePRSolution().
+   int PRSolution::RAIMCompute(const CommonTime& Tr,
+                               vector<SatID>& Sats,
+                               const Matrix<double>& SVP,
+                               const int& NPrepare,
+                               const Matrix<double>& invMC,
+                               TropModel *pTropModel)
+   {
+      try {
+         // the clock for RAIMTimeLimit
+         const std::chrono::steady_clock::time_point
+            Begin(std::chrono::steady_clock::now());
+
+         int iret,N;
+         size_t i,j;
+         vector<int> GoodIndexes;
+         // use these to save the 'best' solution within the loop.
+         // BestRMS marks the 'Best' set as unused.
+         bool BestTropFlag(false);
+         int BestNIter(0),BestIret(-5);
+         double BestRMS(-1.0),BestSL(0.0),BestConv(0.0);
+         Vector<double> BestSol(3,0.0),BestPFR;
+         vector<SatID> BestSats,SaveSats;
+         Matrix<double> BestCov,BestInvMCov,BestPartials;
+         vector<SatelliteSystem> BestGNSS;
+
+         // initialize
+         Valid = false;
+         currTime = Tr;
+         TropFlag = SlopeFlag = RMSFlag = TimeLimitFlag = false;
+
+         // NPrepare is >=0(number of good sats) or -4(no ephemeris)
+         N = NPrepare;
          if(N <= 0) return -4;
 
          // ----------------------------------------------------------------
@@ -589,20 +651,150 @@ namespace gpstk
          // Resids stores the post-fit data residuals.
          Vector<double> Resids;
 
+         // Threads try the combinations of each stage ahead of the loop below,
+         // which then visits their results in the same order, and with the same
+         // outcome, as when it computes each solution itself. Each thread needs
+         // its own copy of the trop model, and DEBUG output must stay in order.
+         unsigned nthreads(RAIMThreads);
+         if(nthreads == 0) nthreads = std::thread::hardware_concurrency();
+         vector< std::unique_ptr<TropModel> > Trops;
+         if(nthreads > 1 && LOGlevel < ConfigureLOG::Level("DEBUG")) {
+            for(i=1; i<nthreads; i++) {
+               Trops.push_back(std::unique_ptr<TropModel>(pTropModel->clone()));
+               if(!Trops.back()) { Trops.clear(); break; }
+            }
+         }
+         // the marked satellites of the last solution visited by the loop
+         vector<SatID> LastSats;
+         bool Threaded(false);
+
+         // with RAIMDowndate, the all-satellite solution is kept here, and the
+         // combinations in later stages are scored from it by DowndateRMS()
+         bool Downdate(false);
+         Matrix<double> DDPartials,DDCov;
+         Vector<double> DDResids,DDWts,DDPTWr;
+
          // stage is the number of satellites to reject.
          int stage(0);
 
          do {
-            // compute all the combinations of N satellites taken stage at a time
+            // compute all the combinations of N satellites taken stage at a time;
+            // Selected holds the stage indexes into GoodIndexes of each one
+            vector<int> Selected;
             Combinations Combo(N,stage);
-
-            // compute a solution for each combination of marked satellites
+            size_t ncombo(0);
             do {
+               for(j=0; j<size_t(stage); j++)
+                  Selected.push_back(Combo.Selection(j));
+               ncombo++;
+            } while(Combo.Next() != -1);
+
+            // Sats marked for combination c
+            auto markSats = [&](size_t c, vector<SatID>& S) {
+               S = SaveSats;
+               for(size_t m=0; m<size_t(stage); m++) {
+                  int g(GoodIndexes[Selected[c*stage+m]]);
+                  S[g].id = -::abs(S[g].id);
+               }
+            };
+
+            // no more combinations are tried after the time limit, but the
+            // solution with all the satellites always is
+            auto outOfTime = [&](void) -> bool {
+               return (stage > 0 && RAIMTimeLimit > 0.0 &&
+                       std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - Begin).count()
+                       > RAIMTimeLimit);
+            };
+
+            // ----------------------------------------------------------------
+            // try the combinations in threads; ndone of them, the first ndone
+            // in order, are done when the time limit is reached
+            vector<int> Iret(ncombo);
+            vector<double> RMS(ncombo);
+            vector<std::exception_ptr> Errors(ncombo);
+            size_t ndone(ncombo);
+            const bool downdating(Downdate && stage > 0);
+            const bool threaded(!downdating && Trops.size() > 0 && ncombo > 1);
+            if(threaded) {
+               Threaded = true;
+               std::atomic<size_t> next(0);
+               auto work = [&](PRSolution& prs, TropModel *pTrop) {
+                  size_t c;
+                  vector<SatID> S;
+                  Vector<double> R,SL;
+                  while(!outOfTime() && (c = next++) < ncombo) {
+                     try {
+                        markSats(c,S);
+                        Iret[c] = prs.SimplePRSolution(Tr, S, SVP, invMC, pTrop,
+                                    MaxNIterations, ConvergenceLimit, R, SL);
+                        RMS[c] = prs.RMSResidual;
+                     }
+                     catch(...) { Errors[c] = std::current_exception(); }
+                  }
+               };
+               size_t nwork(std::min(Trops.size(), ncombo-1));
+               vector<PRSolution> Workers(nwork, *this);
+               vector<std::thread> threads;
+               for(i=0; i<nwork; i++)
+                  threads.push_back(std::thread(work, std::ref(Workers[i]),
+                                                Trops[i].get()));
+               work(*this, pTropModel);
+               for(i=0; i<threads.size(); i++)
+                  threads[i].join();
+               ndone = std::min(size_t(next), ncombo);
+            }
+
+            // ----------------------------------------------------------------
+            // choose the combinations to visit: all of them, or when downdating,
+            // the one with the smallest predicted RMS residual plus any that
+            // can't be predicted, e.g. because they remove a system's clock
+            vector<size_t> Visit;
+            if(downdating) {
+               int BestScore(-1);
+               double score;
+               for(size_t c=0; c<ncombo; c++) {
+                  if(outOfTime()) {
+                     LOG(DEBUG) << " RAIM: out of time after scoring " << c
+                        << " of " << ncombo << " combinations at stage " << stage;
+                     TimeLimitFlag = true;
+                     break;
+                  }
+                  score = DowndateRMS(DDPartials, DDCov, DDWts, DDResids, DDPTWr,
+                                      &Selected[c*stage], stage);
+                  if(score < 0.0)
+                     Visit.push_back(c);
+                  else if(BestScore < 0 || score < RMS[BestScore]) {
+                     BestScore = c;
+                     RMS[c] = score;
+                  }
+               }
+               if(BestScore >= 0) {
+                  LOG(DEBUG) << " RAIM: best predicted RMS at stage " << stage
+                     << " is " << fixed << setprecision(3) << RMS[BestScore]
+                     << " for combination " << BestScore;
+                  Visit.push_back(BestScore);
+                  std::sort(Visit.begin(),Visit.end());
+               }
+            }
+            else for(size_t c=0; c<ncombo; c++)
+               Visit.push_back(c);
+
+            // ----------------------------------------------------------------
+            // visit the solution for each combination of marked satellites
+            int BestCombo(-1);
+            for(size_t v=0; v<Visit.size(); v++) {
+               const size_t c(Visit[v]);
+               if(!downdating && (threaded ? c >= ndone : outOfTime())) {
+                  LOG(DEBUG) << " RAIM: out of time after " << c << " of "
+                     << ncombo << " combinations at stage " << stage;
+                  TimeLimitFlag = true;
+                  break;
+               }
+
                // Mark the satellites for this combination
-               Sats = SaveSats;
-               for(i=0; i<GoodIndexes.size(); i++)
-                  if(Combo.isSelected(i))
-                     Sats[GoodIndexes[i]].id = -::abs(Sats[GoodIndexes[i]].id);
+               markSats(c,Sats);
+               LastSats = Sats;
 
                if(LOGlevel >= ConfigureLOG::Level("DEBUG")) {
                   ostringstream oss;
@@ -623,12 +815,38 @@ namespace gpstk
                //       -2  singular problem
                //       -3  not enough good data
                //       -4  no ephemeris
-               iret = SimplePRSolution(Tr, Sats, SVP, invMC, pTropModel,
-                       MaxNIterations, ConvergenceLimit, Resids, Slopes);
+               if(threaded) {
+                  if(Errors[c]) std::rethrow_exception(Errors[c]);
+                  iret = Iret[c];
+               }
+               else {
+                  iret = SimplePRSolution(Tr, Sats, SVP, invMC, pTropModel,
+                          MaxNIterations, ConvergenceLimit, Resids, Slopes);
+                  RMS[c] = RMSResidual;
+               }
 
                LOG(DEBUG) << " RAIM: SimplePRS returns " << iret;
                if(iret <= 0 && iret > BestIret) BestIret = iret;
 
+               // keep the all-satellite solution for RAIMDowndate; the weights
+               // must be diagonal for downdating
+               if(RAIMDowndate && stage == 0 && iret == 0) {
+                  Downdate = true;
+                  DDPartials = Partials;
+                  DDCov = Covariance;
+                  DDResids = Resids;
+                  DDWts = Vector<double>(Resids.size(),1.0);
+                  for(i=0; i<invMeasCov.rows(); i++) {
+                     DDWts(i) = invMeasCov(i,i);
+                     for(j=0; j<invMeasCov.cols(); j++)
+                        if(j != i && invMeasCov(i,j) != 0.0) Downdate = false;
+                  }
+                  DDPTWr = Vector<double>(Partials.cols(),0.0);
+                  for(i=0; i<Partials.rows(); i++)
+                     for(j=0; j<Partials.cols(); j++)
+                        DDPTWr(j) += Partials(i,j)*DDWts(i)*Resids(i);
+               }
+
                // ----------------------------------------------------------------
                // if error, either quit or continue with next combo (SPS sets Valid F)
                if(iret < 0) {
@@ -661,26 +879,48 @@ namespace gpstk
 
                // deal with the results of SimplePRSolution()
                // save 'best' solution for later
-               if(BestRMS < 0.0 || RMSResidual < BestRMS) {
-                  BestRMS = RMSResidual;
-                  BestSol = Solution;
-                  BestSats = SatelliteIDs;
-                  BestGNSS = dataGNSS;
-                  BestSL = MaxSlope;
-                  BestConv = Convergence;
-                  BestNIter = NIterations;
-                  BestCov = Covariance;
-                  BestInvMCov = invMeasCov;
-                  BestPartials = Partials;
-                  BestPFR = PreFitResidual;
-                  BestTropFlag = TropFlag;
+               if(BestRMS < 0.0 || RMS[c] < BestRMS) {
+                  BestRMS = RMS[c];
                   BestIret = iret;
+                  BestCombo = c;
+                  if(!threaded) {
+                     BestSol = Solution;
+                     BestSats = SatelliteIDs;
+                     BestGNSS = dataGNSS;
+                     BestSL = MaxSlope;
+                     BestConv = Convergence;
+                     BestNIter = NIterations;
+                     BestCov = Covariance;
+                     BestInvMCov = invMeasCov;
+                     BestPartials = Partials;
+                     BestPFR = PreFitResidual;
+                     BestTropFlag = TropFlag;
+                  }
                }
 
-               if(stage==0 && RMSResidual < RMSLimit)
+               if(stage==0 && RMS[c] < RMSLimit)
                   break;
 
-            } while(Combo.Next() != -1);  // get the next combinations and repeat
+            }  // end loop over combinations
+
+            // a thread found the best solution; compute it again here to keep it
+            if(threaded && BestCombo >= 0) {
+               vector<SatID> S;
+               markSats(BestCombo,S);
+               SimplePRSolution(Tr, S, SVP, invMC, pTropModel,
+                                MaxNIterations, ConvergenceLimit, Resids, Slopes);
+               BestSol = Solution;
+               BestSats = SatelliteIDs;
+               BestGNSS = dataGNSS;
+               BestSL = MaxSlope;
+               BestConv = Convergence;
+               BestNIter = NIterations;
+               BestCov = Covariance;
+               BestInvMCov = invMeasCov;
+               BestPartials = Partials;
+               BestPFR = PreFitResidual;
+               BestTropFlag = TropFlag;
+            }
 
             // end of the stage
             if(BestRMS > 0.0 && BestRMS < RMSLimit) {          // success
@@ -706,10 +946,25 @@ namespace gpstk
                break;
             }
 
+            // or ran out of time
+            if(TimeLimitFlag) {
+               LOG(DEBUG) << " RAIM: break before stage " << stage
+                  << " due to RAIMTimeLimit " << RAIMTimeLimit;
+               break;
+            }
+
             LOG(DEBUG) << " RAIM: go to stage " << stage;
 
          } while(1);    // end loop over stages
 
+         // on failure, the solution is that of the last combination visited;
+         // compute it again if a thread computed it
+         if(iret < 0 && Threaded) {
+            Sats = LastSats;
+            SimplePRSolution(Tr, Sats, SVP, invMC, pTropModel,
+                             MaxNIterations, ConvergenceLimit, Resids, Slopes);
+         }
+
          // ----------------------------------------------------------------
          // copy out the best solution
          if(iret >= 0) {
@@ -787,6 +1042,7 @@ namespace gpstk
             if(BestSL > SlopeLimit/2.0 && Nsvs == 5) { iret = 1; SlopeFlag = true; }
             if(BestRMS >= RMSLimit) { iret = 1; RMSFlag = true; }
             if(TropFlag) iret = 1;
+            if(TimeLimitFlag) iret = 1;
             Valid = true;
          }
          else if(iret == -1) Valid = false;
@@ -802,6 +1058,77 @@ namespace gpstk
    }  // end PRSolution::RAIMCompute()
 
 
+   // -------------------------------------------------------------------------
+   // Predict the RMS residual of a solution without some of the data, by
+   // downdating a converged solution. The information matrix without the nrows
+   // rows R is A - PR^T*WR*PR, where A = Cov^-1; by the matrix inversion lemma
+   // its inverse is Cov + B*Q^-1*B^T, with B = Cov*PR^T and Q = WR^-1 - PR*B.
+   double PRSolution::DowndateRMS(const Matrix<double>& P,
+                                  const Matrix<double>& Cov,
+                                  const Vector<double>& Wts,
+                                  const Vector<double>& Resids,
+                                  const Vector<double>& PTWr,
+                                  const int *Rows,
+                                  const int nrows)
+   {
+      const size_t N(P.rows()), dim(P.cols()), nr(nrows);
+      size_t i,j,k;
+      if(N < dim + nr) return -1.0;
+
+      // B and Q; rows with their own clock, or too little data left for one
+      // of the clocks, make Q singular
+      double maxInvWt(0.0);
+      vector<bool> removed(N,false);
+      Matrix<double> B(dim,nr,0.0),Q(nr,nr,0.0);
+      for(j=0; j<nr; j++) {
+         const int r(Rows[j]);
+         if(Wts(r) <= 0.0) return -1.0;
+         removed[r] = true;
+         for(i=0; i<dim; i++)
+            for(k=0; k<dim; k++)
+               B(i,j) += Cov(i,k)*P(r,k);
+      }
+      for(i=0; i<nr; i++) {
+         Q(i,i) = 1.0/Wts(Rows[i]);
+         if(Q(i,i) > maxInvWt) maxInvWt = Q(i,i);
+         for(j=0; j<nr; j++)
+            for(k=0; k<dim; k++)
+               Q(i,j) -= P(Rows[i],k)*B(k,j);
+      }
+
+      Matrix<double> Qinv;
+      try {
+         double big,small;
+         Qinv = inverseSVD(Q,big,small);
+         if(small < 1.e-8*maxInvWt) return -1.0;
+      }
+      catch(Exception& e) { return -1.0; }
+
+      // the update to the solution is the downdated covariance times
+      // P^T*W*Resids without the removed rows
+      Vector<double> b(PTWr);
+      for(j=0; j<nr; j++) {
+         const double wr(Wts(Rows[j])*Resids(Rows[j]));
+         for(k=0; k<dim; k++)
+            b(k) -= P(Rows[j],k)*wr;
+      }
+      Vector<double> dX(Cov*b + B*(Qinv*(transpose(B)*b)));
+
+      // RMS of the updated residuals of the remaining data
+      double res,sumsq(0.0);
+      for(i=0; i<N; i++) {
+         if(removed[i]) continue;
+         res = Resids(i);
+         for(k=0; k<dim; k++)
+            res -= P(i,k)*dX(k);
+         sumsq += res*res;
+      }
+
+      return SQRT(sumsq/double(N-nr));
+
+   }  // end PRSolution::DowndateRMS()
+
+
    // -------------------------------------------------------------------------
    int PRSolution::DOPCompute(void)
    {
@@ -830,6 +1157,7 @@ namespace gpstk
             if(RMSFlag) oss << " large RMS residual";
             if(SlopeFlag) oss << " large slope";
             if(TropFlag) oss << " missed trop. corr.";
+            if(TimeLimitFlag) oss << " RAIM time limit";
          }
          oss << ") " << (Valid ? "" : "N") << "V";
       }
@@ -1025,6 +1353,9 @@ namespace gpstk
          << "\n   Maximum number of satellites to reject is " << NSatsReject
          << "\n   Memory information IS " << (hasMemory ? "":"NOT ") << "stored"
          ;
+      if(RAIMTimeLimit > 0.0) oss
+         << "\n   RAIM time limit " << fixed << setprecision(3) << RAIMTimeLimit
+         << " seconds";
 
       // output memory information
       //if(APrioriSol.size() >= 4) oss
@@ -51,6 +51,7 @@
 #include "RinexSatID.hpp"
 #include "Stats.hpp"
 #include "Matrix.hpp"
+#include "SmallLSQ.hpp"
 #include "Namelist.hpp"
 #include "XvtStore.hpp"
 #include "TropModel.hpp"
@@ -70,8 +71,21 @@ namespace gpstk
       std::string msg;
       std::string lab[3];
       Stats<double> S[3];
-      Matrix<double> sumInfo;
-      Vector<double> sumInfoState,Sbias;
+      /// total information (position only) and information * state, and the
+      /// first solution, which is removed from the others
+      double sumInfo[3][3],sumInfoState[3],Sbias[3];
+
+      /// the normal equations of the weighted average solution
+      SmallLSQ<double,3> getLSQ(void) const
+      {
+         SmallLSQ<double,3> LSQ(3);
+         for(unsigned int i=0; i<3; i++) {
+            LSQ.Data(i) = sumInfoState[i];
+            for(unsigned int j=0; j<=i; j++) LSQ.Info(i,j) = sumInfo[i][j];
+         }
+         LSQ.Solve();
+         return LSQ;
+      }
 
    public:
 
@@ -90,21 +104,32 @@ namespace gpstk
 
       Vector<double> getSol(void) const
       {
-         return (getCov()*sumInfoState + Sbias);
+         SmallLSQ<double,3> LSQ(getLSQ());
+         Vector<double> Sol(3);
+         for(unsigned int i=0; i<3; i++) Sol(i) = LSQ.X(i) + Sbias[i];
+         return Sol;
       }
 
-      Matrix<double> getCov(void) const { return inverseSVD(sumInfo); }
+      Matrix<double> getCov(void) const { return getLSQ().Covariance(); }
 
-      Matrix<double> getInfo(void) const { return sumInfo; }
+      Matrix<double> getInfo(void) const
+      {
+         if(N == 0) return Matrix<double>();
+         Matrix<double> Info(3,3);
+         for(unsigned int i=0; i<3; i++)
+            for(unsigned int j=0; j<3; j++) Info(i,j) = sumInfo[i][j];
+         return Info;
+      }
 
       int getN(void) const { return N; }
 
       void reset(void)
       {
          N = 0;
-         sumInfo = Matrix<double>();
-         sumInfoState = Vector<double>();
-         Sbias = Vector<double>(3);
+         for(unsigned int i=0; i<3; i++) {
+            sumInfoState[i] = Sbias[i] = 0.0;
+            for(unsigned int j=0; j<3; j++) sumInfo[i][j] = 0.0;
+         }
          S[0].Reset();
          S[1].Reset();
          S[2].Reset();
@@ -116,26 +141,25 @@ namespace gpstk
          try {
             // add to the statistics
             for(unsigned int i=0; i<3; i++) {
-               if(N==0) Sbias(i) = Sol(i);
-               S[i].Add(Sol(i)-Sbias(i));
+               if(N==0) Sbias[i] = Sol(i);
+               S[i].Add(Sol(i)-Sbias[i]);
             }
 
             // NB do NOT include clock(s); this can ruin the position average
-            Vector<double> Sol3(Sol);
-            Sol3.resize(3);               // assumes position states come first
-            Sol3 = Sol3 - Sbias;
-            Matrix<double> Cov3(Cov,0,0,3,3);
-
-            // information matrix (position only)
-            Matrix<double> Info(inverseSVD(Cov3));
-            if(N == 0) {                  // first call: dimension and set to zero
-               sumInfo = Matrix<double>(3,3,0.0);
-               sumInfoState = Vector<double>(3,0.0);
-            }
+            // information matrix (position only) is the inverse of the
+            // position covariance; assumes position states come first
+            SmallLSQ<double,3> Info(3);
+            for(unsigned int i=0; i<3; i++)
+               for(unsigned int j=0; j<=i; j++) Info.Info(i,j) = Cov(i,j);
+            Info.Solve();
 
             // add to the total information
-            sumInfo += Info;
-            sumInfoState += Info * Sol3;
+            for(unsigned int i=0; i<3; i++) {
+               for(unsigned int j=0; j<3; j++) {
+                  sumInfo[i][j] += Info.Cov(i,j);
+                  sumInfoState[i] += Info.Cov(i,j)*(Sol(j)-Sbias[j]);
+               }
+            }
             ++N;
          }
          catch(Exception& e) { GPSTK_RETHROW(e); }
@@ -171,9 +195,8 @@ namespace gpstk
                   << std::endl;
 
                os << "Weighted average " << msg << std::endl;
-               Matrix<double> Cov(inverseSVD(sumInfo));
-               Vector<double> Sol(Cov * sumInfoState + Sbias);
-               os << std::setw(14) << std::setprecision(4) << Sol << "    " << N;
+               os << std::setw(14) << std::setprecision(4) << getSol()
+                  << "    " << N;
             }
             else os << " No data!";
          }
@@ -220,6 +243,9 @@ namespace gpstk
                       NSatsReject(-1),
                       MaxNIterations(10),
                       ConvergenceLimit(3.e-7),
+                      RAIMThreads(1),
+                      RAIMTimeLimit(0.0),
+                      RAIMDowndate(false),
                       hasMemory(true),
                       fixedAPriori(false),
                       nsol(0), ndata(0), APV(0.0),
@@ -254,6 +280,29 @@ namespace gpstk
       /// solution exceeds this.
       double ConvergenceLimit;
 
+      /// Number of threads used by RAIMCompute() to try the combinations of
+      /// rejected satellites; 1 (the default) tries them serially, 0 uses one
+      /// thread per core. The result does not depend on the number of threads.
+      /// Threads are used only when the TropModel can be cloned, and never when
+      /// the log level is DEBUG.
+      unsigned RAIMThreads;
+
+      /// Limit (seconds of wall time) on the search for a RAIM solution in each
+      /// call to RAIMCompute(); if this is exceeded, no further combinations of
+      /// rejected satellites are tried, the best solution found so far is
+      /// returned, and TimeLimitFlag is set. Zero (the default) means no limit.
+      /// The solution using all the satellites is always computed.
+      double RAIMTimeLimit;
+
+      /// If true, RAIMCompute() does not iterate a solution for every
+      /// combination of rejected satellites. Instead it predicts the RMS residual
+      /// of each one by downdating the all-satellite solution (see DowndateRMS()),
+      /// and iterates only the combination with the smallest prediction in each
+      /// stage. This is much faster when many satellites are rejected, but near
+      /// ties may be resolved differently. It is ignored when the measurement
+      /// covariance is not diagonal, or the all-satellite solution fails.
+      bool RAIMDowndate;
+
       /// vector<SatelliteSystem> containing the satellite systems allowed
       /// in the solution. **This vector MUST be defined before computing solutions.**
       /// It is used to determine which clock biases are included in the solution,
@@ -356,6 +405,11 @@ namespace gpstk
       /// the slope is large; applies only after calls to RAIMCompute().
       bool RMSFlag, SlopeFlag;
 
+      /// if true, the returned solution may be degraded because RAIMTimeLimit
+      /// was reached before all combinations of satellites were tried; applies
+      /// only after calls to RAIMCompute().
+      bool TimeLimitFlag;
+
       // member functions -------------------------------------------
 
       /// Compute the satellite position / corrected range matrix (SVP) which is used
@@ -459,7 +513,8 @@ namespace gpstk
       /// @param pTropModel  pointer to gpstk::TropModel for trop correction.
       ///
       /// @return Return values:
-      ///  1  solution is ok, but may be degraded; check TropFlag, RMSFlag, SlopeFlag
+      ///  1  solution is ok, but may be degraded; check TropFlag, RMSFlag,
+      ///     SlopeFlag, TimeLimitFlag
       ///  0  ok
       /// -1  algorithm failed to converge
       /// -2  singular problem, no solution is possible
@@ -473,6 +528,26 @@ namespace gpstk
                       const XvtStore<SatID> *pEph,
                       TropModel *pTropModel);
 
+      /// Compute a RAIM solution, as above, after PreparePRSolution() has
+      /// already been called, e.g. in another thread; PreparePRSolution() is
+      /// const and needs only the ephemeris, while this call depends on the
+      /// state of this object (e.g. the apriori solution) and of the trop model.
+      /// @param Tr          Measured time of reception of the data.
+      /// @param Satellites  std::vector<SatID> of satellites, as returned by
+      ///                    PreparePRSolution(); on output marked as above.
+      /// @param SVP         Matrix<double> as returned by PreparePRSolution().
+      /// @param NPrepare    the return value of PreparePRSolution().
+      /// @param invMC       gpstk::Matrix<double> NXN measurement covariance matrix
+      ///                    inverse (meter^-2), as above.
+      /// @param pTropModel  pointer to gpstk::TropModel for trop correction.
+      /// @return as above.
+      int RAIMCompute(const CommonTime& Tr,
+                      std::vector<SatID>& Satellites,
+                      const Matrix<double>& SVP,
+                      const int& NPrepare,
+                      const Matrix<double>& invMC,
+                      TropModel *pTropModel);
+
       /// Compute DOPs using the partials matrix from the last successful solution.
       /// RAIMCompute(), if successful, calls this before returning.
       /// Results stored in PRSolution::TDOP,PDOP,GDOP.
@@ -628,6 +703,25 @@ namespace gpstk
 
    private:
 
+      /// Predict the RMS post-fit residual of a solution computed without the
+      /// data in some rows, by downdating a converged solution with a
+      /// rank-nrows update rather than iterating again.
+      /// @param P      partials matrix of the converged solution (N x dim)
+      /// @param Cov    its covariance, the inverse of P^T*W*P (dim x dim)
+      /// @param Wts    diagonal of the weight matrix W (N)
+      /// @param Resids its post-fit residuals (N)
+      /// @param PTWr   P^T*W*Resids (dim)
+      /// @param Rows   array of the nrows rows to remove
+      /// @param nrows  number of rows to remove
+      /// @return predicted RMS residual, or -1 if the reduced problem is singular
+      static double DowndateRMS(const Matrix<double>& P,
+                                const Matrix<double>& Cov,
+                                const Vector<double>& Wts,
+                                const Vector<double>& Resids,
+                                const Vector<double>& PTWr,
+                                const int *Rows,
+                                const int nrows);
+
       /// flag: output content is valid.
       bool Valid;
 
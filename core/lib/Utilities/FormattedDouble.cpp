@@ -36,6 +36,9 @@
 //
 //==============================================================================
 
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
 #include "FormattedDouble.hpp"
 
 namespace gpstk
@@ -75,41 +78,91 @@ namespace gpstk
    FormattedDouble& FormattedDouble ::
    operator=(const std::string& s)
    {
-      if ((exponentChar != 'e') && (exponentChar != 'E'))
+      return assign(s.data(), s.length());
+   }
+
+
+   FormattedDouble& FormattedDouble ::
+   assign(const char* s, std::size_t n)
+   {
+         // Like stream input, leave the value alone if there's
+         // nothing but white space.
+      std::size_t start = 0;
+      while ((start < n) && std::isspace(static_cast<unsigned char>(s[start])))
+         start++;
+      if (start == n)
+         return *this;
+      if ((exponentChar == 'e') || (exponentChar == 'E'))
+      {
+         val = StringUtils::asDouble(s + start, n - start);
+      }
+      else if ((exponentChar == 'D') || (exponentChar == 'd'))
+      {
+            // for2doub understands FORTRAN exponents directly.
+         val = StringUtils::for2doub(s + start, n - start);
+      }
+      else
       {
             // If the exponent character is different from standard,
             // we need to do some tweaking.
             // have to make a copy to modify
-         std::string copy(s);
+         std::string copy(s + start, n - start);
          std::string::size_type pos = copy.find(exponentChar);
          if (pos != std::string::npos)
          {
             copy[pos] = 'e'; // change exponent character to a readable one
          }
-         std::istringstream iss(copy);
-         iss >> val;
+         val = StringUtils::asDouble(copy);
       }
-      else
+      return *this;
+   }
+
+
+   FormattedDouble& FormattedDouble ::
+   assign(const std::string& s, std::string::size_type pos)
+   {
+      if (pos > s.length())
       {
-            // If the exponent character is standard, the standard
-            // istream double reading should work fine regardless of
-            // any other tweaks.
-         std::istringstream iss(s);
-         iss >> val;
+         throw std::out_of_range("FormattedDouble::assign: pos (which is " +
+                                 StringUtils::asString(pos) +
+                                 ") > s.length() (which is " +
+                                 StringUtils::asString(s.length()) + ")");
       }
-      return *this;
+      std::size_t n = s.length() - pos;
+      if (totalLen > 0)
+         n = std::min<std::size_t>(totalLen, n);
+      return assign(s.data() + pos, n);
    }
 
 
    std::ostream& operator<<(std::ostream& s, const FormattedDouble& d)
    {
-      s << StringUtils::floatFormat(d.val, d.leadChar, d.mantissaLen,
-                                    d.exponentLen, d.totalLen, d.exponentChar,
-                                    d.leadSign, d.alignment);
+         // Format straight into a buffer unless the stream has a
+         // field width to apply.
+      char buf[64];
+      std::size_t len = sizeof(buf) + 1;
+      if (s.width() == 0)
+      {
+         len = StringUtils::floatFormat(
+            buf, sizeof(buf), d.val, d.leadChar, d.mantissaLen, d.exponentLen,
+            d.totalLen, d.exponentChar, d.leadSign, d.alignment);
+      }
+      if (len <= sizeof(buf))
+      {
+         s.write(buf, len);
+      }
+      else
+      {
+         s << StringUtils::floatFormat(d.val, d.leadChar, d.mantissaLen,
+                                       d.exponentLen, d.totalLen,
+                                       d.exponentChar, d.leadSign,
+                                       d.alignment);
+      }
       return s;
    }
 
 
+
    std::istream& operator>>(std::istream& s, FormattedDouble& d)
    {
       if (d.totalLen)
@@ -175,6 +175,24 @@ namespace gpstk
          /// Assign a value by decoding a string using existing formatting.
       FormattedDouble& operator=(const std::string& s);
 
+         /** Assign a value by decoding the first \a n characters of
+          * \a s using existing formatting, without making a copy.  As
+          * with operator=(const std::string&), the value is left
+          * unchanged if the characters are all white space.
+          * @param[in] s pointer to the first character of the field,
+          *   which need not be null-terminated.
+          * @param[in] n the number of characters to decode. */
+      FormattedDouble& assign(const char* s, std::size_t n);
+
+         /** Assign a value by decoding the field of totalLen
+          * characters starting at \a pos in \a s.  This is the same
+          * as operator=(s.substr(pos,totalLen)) without the copy.
+          * @param[in] s the string containing the field.
+          * @param[in] pos the index of the first character of the field.
+          * @throw std::out_of_range if \a pos is past the end of \a s. */
+      FormattedDouble& assign(const std::string& s,
+                              std::string::size_type pos);
+
          /// debug output all data members
       void dump(std::ostream& s) const;
 
@@ -207,9 +225,9 @@ namespace gpstk
 
    FormattedDouble :: operator std::string()
    {
-      std::ostringstream s;
-      s << *this;
-      return s.str();
+      return StringUtils::floatFormat(val, leadChar, mantissaLen, exponentLen,
+                                      totalLen, exponentChar, leadSign,
+                                      alignment);
    }
 
    FormattedDouble FormattedDouble :: operator/(double d) const
@@ -60,6 +60,11 @@ namespace gpstk
       RNDouble(const std::string& str)
             : FormattedDouble(str, 19, 'D')
       {}
+         /** Decode the 19 character field starting at \a pos in \a str.
+          * @throw std::out_of_range if \a pos is past the end of \a str. */
+      RNDouble(const std::string& str, std::string::size_type pos)
+            : RNDouble()
+      { assign(str, pos); }
 
          /// Assign a value by decoding a string using existing formatting.
       RNDouble& operator=(const std::string& s)
@@ -0,0 +1,188 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+
+/** @file ReadWriteLock.hpp
+ * A lock shared by readers and held exclusively by one writer. */
+
+#ifndef GPSTK_READWRITELOCK_HPP
+#define GPSTK_READWRITELOCK_HPP
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace gpstk
+{
+      /** A lock that any number of readers may hold at once, or one
+       * writer alone.  A writer that is waiting keeps new readers
+       * out, so that a steady stream of readers can't starve it.
+       *
+       * Lock it through ReadGuard and WriteGuard, which also let a
+       * thread that already holds the lock, either way, lock it
+       * again without waiting, so that a locked method may call
+       * other locked methods of the same object.  A thread holding
+       * the lock to read must not then lock it to write. */
+   class ReadWriteLock
+   {
+   public:
+      ReadWriteLock()
+            : readers(0), writing(false), writersWaiting(0)
+      {}
+
+         /// Wait until no other thread holds the lock, then hold it.
+      void lock()
+      {
+         std::unique_lock<std::mutex> lk(mtx);
+         writersWaiting++;
+         cond.wait(lk, [this]{ return !writing && readers == 0; });
+         writersWaiting--;
+         writing = true;
+      }
+
+         /// Release the lock taken by lock().
+      void unlock()
+      {
+         {
+            std::lock_guard<std::mutex> lk(mtx);
+            writing = false;
+         }
+         cond.notify_all();
+      }
+
+         /// Wait until no writer holds or wants the lock, then share it.
+      void lockShared()
+      {
+         std::unique_lock<std::mutex> lk(mtx);
+         cond.wait(lk, [this]{ return !writing && writersWaiting == 0; });
+         readers++;
+      }
+
+         /// Release the lock taken by lockShared().
+      void unlockShared()
+      {
+         bool last;
+         {
+            std::lock_guard<std::mutex> lk(mtx);
+            last = (--readers == 0);
+         }
+         if (last)
+            cond.notify_all();
+      }
+
+         /** Holds a ReadWriteLock, if active, for the lifetime of the
+          * guard, unless this thread already holds it. */
+      class Guard
+      {
+      public:
+         ~Guard()
+         {
+            if (lk == NULL)
+               return;
+            held().pop_back();
+            if (exclusive)
+               lk->unlock();
+            else
+               lk->unlockShared();
+         }
+
+      protected:
+         Guard(ReadWriteLock& l, bool excl, bool active)
+               : lk(NULL), exclusive(excl)
+         {
+            if (!active)
+               return;
+            for (size_t i = 0; i < held().size(); i++)
+            {
+               if (held()[i] == &l)
+                  return;
+            }
+            if (exclusive)
+               l.lock();
+            else
+               l.lockShared();
+            lk = &l;
+            held().push_back(lk);
+         }
+
+      private:
+         Guard(const Guard&);
+         Guard& operator=(const Guard&);
+
+            /// The locks that guards in this thread hold, innermost last.
+         static std::vector<const ReadWriteLock*>& held()
+         {
+            static thread_local std::vector<const ReadWriteLock*> locks;
+            return locks;
+         }
+
+         ReadWriteLock *lk;   ///< the lock held, or NULL
+         bool exclusive;      ///< true if lk is held to write
+      };
+
+         /// Guard holding a ReadWriteLock to read.
+      class ReadGuard : public Guard
+      {
+      public:
+         ReadGuard(ReadWriteLock& l, bool active = true)
+               : Guard(l, false, active)
+         {}
+      };
+
+         /// Guard holding a ReadWriteLock to write.
+      class WriteGuard : public Guard
+      {
+      public:
+         WriteGuard(ReadWriteLock& l, bool active = true)
+               : Guard(l, true, active)
+         {}
+      };
+
+   private:
+      ReadWriteLock(const ReadWriteLock&);
+      ReadWriteLock& operator=(const ReadWriteLock&);
+
+      std::mutex mtx;                ///< guards the members below
+      std::condition_variable cond;  ///< signalled when the lock is released
+      unsigned readers;              ///< number of threads reading
+      bool writing;                  ///< true while a writer holds the lock
+      unsigned writersWaiting;       ///< number of writers in lock()
+   };
+
+} // namespace gpstk
+
+#endif // GPSTK_READWRITELOCK_HPP
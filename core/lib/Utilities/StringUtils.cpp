@@ -41,6 +41,10 @@
  * Implementation of GPSTK string utility functions.
  */
 
+#include <clocale>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include "StringUtils.hpp"
 
 /* The DEBUG_COL macro is used to help debug issues with column
@@ -59,6 +63,344 @@ namespace gpstk
 {
    namespace StringUtils
    {
+      namespace
+      {
+            /// Powers of ten that are exactly representable as doubles.
+         const double exactPow10[] =
+         {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+            1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20,
+            1e21, 1e22
+         };
+         const int maxExactPow10 = 22;
+
+            /// The decimal digits of 0 to 99.
+         const char digitPairs[] =
+            "00010203040506070809101112131415161718192021222324"
+            "25262728293031323334353637383940414243444546474849"
+            "50515253545556575859606162636465666768697071727374"
+            "75767778798081828384858687888990919293949596979899";
+
+            /// Largest integer below which all integers are doubles.
+         const std::uint64_t maxExactInt = 1ULL << 53;
+
+         inline bool isSpace(char c)
+         {
+            return (c == ' ') || ((c >= '\t') && (c <= '\r'));
+         }
+
+         inline bool isDigit(char c)
+         {
+            return (c >= '0') && (c <= '9');
+         }
+
+            /** Convert a number using strtod(), for the cases
+             * parseDouble() doesn't handle itself.  The field is
+             * copied so it can be null terminated, with the decimal
+             * point changed to the one strtod() expects in the
+             * current locale and 'D' exponents changed to 'e'. */
+         double slowParseDouble(const char* s, std::size_t n, bool fortran)
+         {
+            char point = '.';
+            const struct lconv *lc = std::localeconv();
+            if ((lc != nullptr) && (lc->decimal_point != nullptr) &&
+                (lc->decimal_point[0] != 0))
+            {
+               point = lc->decimal_point[0];
+            }
+            char stackBuf[64];
+            std::string heapBuf;
+            char *buf = stackBuf;
+            if (n >= sizeof(stackBuf))
+            {
+               heapBuf.resize(n + 1);
+               buf = &heapBuf[0];
+            }
+            for (std::size_t i = 0; i < n; i++)
+            {
+               char c = s[i];
+               if (c == '.')
+                  c = point;
+               else if (fortran && ((c == 'D') || (c == 'd')))
+                  c = 'e';
+               buf[i] = c;
+            }
+            buf[n] = 0;
+            return std::strtod(buf, nullptr);
+         }
+
+            /** Convert a number the way strtod() does in the "C"
+             * locale.  Numbers with up to 19 significant digits and
+             * a small enough exponent, which covers all the usual
+             * fixed-width fields, are exactly converted by a single
+             * multiplication or division by an exact power of ten
+             * (Clinger's fast path), so the result is correctly
+             * rounded.  Anything else goes to slowParseDouble().
+             * @param[in] fortran if true, 'D' and 'd' also mark the
+             *   exponent. */
+         double parseDouble(const char* s, std::size_t n, bool fortran)
+         {
+            const char *p = s, *end = s + n;
+            while ((p < end) && isSpace(*p))
+               p++;
+            bool negative = false;
+            if ((p < end) && ((*p == '-') || (*p == '+')))
+            {
+               negative = (*p == '-');
+               p++;
+            }
+
+            std::uint64_t mantissa = 0;
+            int sigDigits = 0;
+            int exp10 = 0;
+            bool anyDigits = false;
+            for (; (p < end) && isDigit(*p); p++)
+            {
+               anyDigits = true;
+               if ((mantissa == 0) && (*p == '0'))
+                  continue;
+               if (++sigDigits > 19)
+                  return slowParseDouble(s, n, fortran);
+               mantissa = mantissa * 10 + (*p - '0');
+            }
+            if ((p < end) && (*p == '.'))
+            {
+               for (p++; (p < end) && isDigit(*p); p++)
+               {
+                  anyDigits = true;
+                  exp10--;
+                  if ((mantissa == 0) && (*p == '0'))
+                     continue;
+                  if (++sigDigits > 19)
+                     return slowParseDouble(s, n, fortran);
+                  mantissa = mantissa * 10 + (*p - '0');
+               }
+            }
+               // infinity, NaN, hexadecimal or not a number at all
+            if (!anyDigits || ((p < end) && ((*p == 'x') || (*p == 'X'))))
+               return slowParseDouble(s, n, fortran);
+
+            if ((p < end) &&
+                ((*p == 'e') || (*p == 'E') ||
+                 (fortran && ((*p == 'D') || (*p == 'd')))))
+            {
+                  // Only an exponent if there are digits in it.
+               const char *q = p + 1;
+               bool expNegative = false;
+               if ((q < end) && ((*q == '-') || (*q == '+')))
+               {
+                  expNegative = (*q == '-');
+                  q++;
+               }
+               if ((q < end) && isDigit(*q))
+               {
+                  int exponent = 0;
+                  for (; (q < end) && isDigit(*q); q++)
+                  {
+                     if (exponent < 10000)
+                        exponent = exponent * 10 + (*q - '0');
+                  }
+                  exp10 += (expNegative ? -exponent : exponent);
+               }
+            }
+
+            if (mantissa == 0)
+               return (negative ? -0.0 : 0.0);
+            if ((mantissa > maxExactInt) || (exp10 < -maxExactPow10) ||
+                (exp10 > maxExactPow10))
+            {
+               return slowParseDouble(s, n, fortran);
+            }
+            double value = static_cast<double>(mantissa);
+            if (exp10 < 0)
+               value /= exactPow10[-exp10];
+            else
+               value *= exactPow10[exp10];
+            return (negative ? -value : value);
+         }
+
+            /** snprintf() a number to a string, with a '.' for the
+             * decimal point whatever the current locale, as iostreams
+             * do by default.
+             * @return the length of the string. */
+         int printNumber(std::string& str, const char* format, int precision,
+                         double x)
+         {
+            int len = std::snprintf(nullptr, 0, format, precision, x);
+            if (len < 0)
+               len = 0;
+            str.resize(len + 1);
+            std::snprintf(&str[0], len + 1, format, precision, x);
+            str.resize(len);
+            const struct lconv *lc = std::localeconv();
+            if ((lc != nullptr) && (lc->decimal_point != nullptr) &&
+                (lc->decimal_point[0] != 0) && (lc->decimal_point[0] != '.'))
+            {
+               std::replace(str.begin(), str.end(), lc->decimal_point[0], '.');
+            }
+            return len;
+         }
+      } // anonymous namespace
+
+
+      double asDouble(const char* s, std::size_t n)
+      {
+         return parseDouble(s, n, false);
+      }
+
+
+      double for2doub(const char* s, std::size_t n)
+      {
+         return parseDouble(s, n, true);
+      }
+
+
+      long asInt(const char* s, std::size_t n)
+      {
+         const char *p = s, *end = s + n;
+         while ((p < end) && isSpace(*p))
+            p++;
+         bool negative = false;
+         if ((p < end) && ((*p == '-') || (*p == '+')))
+         {
+            negative = (*p == '-');
+            p++;
+         }
+         const char *digits = p;
+         long value = 0;
+            // 18 digits always fit in a long, leave the rest to
+            // strtol() so overflow is handled the same way.
+         for (; (p < end) && isDigit(*p) && (p - digits < 18); p++)
+         {
+            value = value * 10 + (*p - '0');
+         }
+         if ((p < end) && isDigit(*p))
+         {
+            std::string copy(s, n);
+            return std::strtol(copy.c_str(), nullptr, 10);
+         }
+         return (negative ? -value : value);
+      }
+
+
+      unsigned long asUnsigned(const char* s, std::size_t n)
+      {
+         const char *p = s, *end = s + n;
+         while ((p < end) && isSpace(*p))
+            p++;
+         if ((p < end) && (*p == '+'))
+            p++;
+         const char *digits = p;
+         unsigned long value = 0;
+         for (; (p < end) && isDigit(*p) && (p - digits < 18); p++)
+         {
+            value = value * 10 + (*p - '0');
+         }
+            // Negative numbers wrap around and big numbers saturate
+            // in strtoul(), so it can handle those.
+         if ((p < end) && (isDigit(*p) || ((p == digits) && (*p == '-'))))
+         {
+            std::string copy(s, n);
+            return std::strtoul(copy.c_str(), nullptr, 10);
+         }
+         return value;
+      }
+
+
+      std::size_t formatFixed(char* buf, std::size_t size, double x,
+                              unsigned precision, unsigned width)
+      {
+            // The value is scaled to an integer number of the last
+            // decimal place, which is exact unless the multiplication
+            // rounds.  The rounding error is at most half a unit in
+            // the last place of the product, so the result is the
+            // same as printf() unless the product is within that of
+            // half way between two integers, or is too big for its
+            // integer part to be exact.  Those cases, along with
+            // infinity and NaN, are left to snprintf().
+         double absX = std::fabs(x);
+         if ((precision <= unsigned(maxExactPow10)) && (absX < 1e300))
+         {
+            double scaled = absX * exactPow10[precision];
+            if (scaled < 4503599627370496.0) // 2^52
+            {
+                  // truncating is the same as floor() here
+               std::uint64_t digits = static_cast<std::uint64_t>(scaled);
+               double frac = scaled - static_cast<double>(digits);
+               double tolerance = scaled * 2.3e-16 + 1e-300;
+               if (std::fabs(frac - 0.5) > tolerance)
+               {
+                  if (frac > 0.5)
+                     digits++;
+                     // Write the digits two at a time, with enough
+                     // leading zeros for one before the point, then
+                     // move the integer part over for the point.
+                  char tmp[48];
+                  char *end = tmp + sizeof(tmp);
+                  char *t = end;
+                  while (digits >= 100)
+                  {
+                     unsigned pair = static_cast<unsigned>(digits % 100);
+                     digits /= 100;
+                     t -= 2;
+                     std::memcpy(t, digitPairs + 2*pair, 2);
+                  }
+                  if (digits >= 10)
+                  {
+                     t -= 2;
+                     std::memcpy(t, digitPairs + 2*digits, 2);
+                  }
+                  else
+                  {
+                     *--t = '0' + static_cast<char>(digits);
+                  }
+                  while (end - t < std::ptrdiff_t(precision) + 1)
+                     *--t = '0';
+                  if (precision > 0)
+                  {
+                     std::memmove(t - 1, t, (end - t) - precision);
+                     t--;
+                     end[-std::ptrdiff_t(precision) - 1] = '.';
+                  }
+                  if (std::signbit(x))
+                     *--t = '-';
+                  std::size_t len = end - t;
+                  std::size_t total = (len < width ? width : len);
+                  if (total <= size)
+                  {
+                     std::memset(buf, ' ', total - len);
+                     std::memcpy(buf + total - len, t, len);
+                  }
+                  return total;
+               }
+            }
+         }
+
+         std::string tmp;
+         int len = printNumber(tmp, "%.*f", int(precision), x);
+         std::size_t total = (std::size_t(len) < width ? width : len);
+         if (total <= size)
+         {
+            std::memset(buf, ' ', total - len);
+            std::memcpy(buf + total - len, tmp.data(), len);
+         }
+         return total;
+      }
+
+
+      void appendFixed(std::string& s, double x, unsigned precision,
+                       unsigned width)
+      {
+         char field[64];
+         std::size_t len = formatFixed(field, sizeof(field), x, precision,
+                                       width);
+         if (len <= sizeof(field))
+            s.append(field + len - width, width);
+         else
+            s += rightJustify(asString(x, precision), width);
+      }
+
+
       void hexDumpData(const std::string& data, std::ostream& s,
                        const HexDumpDataConfig& cfg)
       {
@@ -211,74 +553,124 @@ namespace gpstk
                               unsigned exponent, unsigned width, char expChar,
                               FFSign sign, FFAlign align)
       {
-         std::ostringstream oss;
-         std::string rv;
-         std::string::size_type pos;
-         switch (sign)
-         {
-            case FFSign::NegOnly:
-                  // default behavior for iostream
-               break;
-            case FFSign::NegSpace:
-               if (d >= 0)
-                  oss << " ";
-               break;
-            case FFSign::NegPos:
-               oss << std::showpos;
-               break;
-         }
+         char buf[64];
+         std::size_t len = floatFormat(buf, sizeof(buf), d, lead, mantissa,
+                                       exponent, width, expChar, sign, align);
+         if (len <= sizeof(buf))
+            return std::string(buf, len);
+         std::string rv(len, ' ');
+         floatFormat(&rv[0], len, d, lead, mantissa, exponent, width, expChar,
+                     sign, align);
+         return rv;
+      }
+
+
+      std::size_t floatFormat(char* buf, std::size_t size, double d,
+                              FFLead lead, unsigned mantissa,
+                              unsigned exponent, unsigned width, char expChar,
+                              FFSign sign, FFAlign align)
+      {
+            // Format in C scientific notation, then move the decimal
+            // point and adjust the exponent as needed.
+         int precision = 0;
+         double value = d;
          switch (lead)
          {
             case FFLead::Zero:
                   // because we're shifting the decimal point, we multiply by 10
                   // mantissa-2 because we're adding a digit that
                   // isn't present in std c++ iostream.
-               oss << std::scientific << std::setprecision(mantissa-2)
-                   << (d*10);
-               rv = oss.str();
-                  // move the decimal
-               pos = rv.find('.');
-               rv[pos] = rv[pos-1];
-               rv[pos-1] = '.';
-               rv.insert(pos-1, 1, '0');
+               precision = int(mantissa-2);
+               value = d*10;
                break;
             case FFLead::Decimal:
                   // because we're shifting the decimal point, we multiply by 10
-               oss << std::scientific << std::setprecision(mantissa-1)
-                   << (d*10);
-               rv = oss.str();
-                  // move the decimal
-               pos = rv.find('.');
-               rv[pos] = rv[pos-1];
-               rv[pos-1] = '.';
+               precision = int(mantissa-1);
+               value = d*10;
                break;
             case FFLead::NonZero:
-                  // This is the default behavior for C++ iostream.
-               oss << std::scientific << std::setprecision(mantissa-1) << d;
-               rv = oss.str();
+               precision = int(mantissa-1);
                break;
          }
-            // change the exponent size if needed
-         pos = rv.find('e');
-         unsigned currentExpSize = rv.length() - (pos+2);
-         if (currentExpSize < exponent)
-            rv.insert(pos+2, exponent - currentExpSize, '0');
-            // change exponent character
-         rv[pos] = expChar;
-            // fill according to alignment request
-         if (rv.length() < width)
+         char tmpBuf[64];
+         std::string tmpStr;
+         const char *sci = tmpBuf;
+         const char *format = (sign == FFSign::NegPos ? "%+.*e" : "%.*e");
+         int sciLen = std::snprintf(tmpBuf, sizeof(tmpBuf), format, precision,
+                                    value);
+         if ((sciLen < 0) || (std::size_t(sciLen) >= sizeof(tmpBuf)) ||
+             (std::strchr(tmpBuf, '.') == nullptr))
          {
-            switch (align)
-            {
-               case FFAlign::Left:
-                  rv.append(width-rv.length(), ' ');
-                  break;
-               case FFAlign::Right:
-                  rv.insert(0, width-rv.length(), ' ');
-                  break;
-            }
+               // too long, or the decimal point may not be a '.'
+            sciLen = printNumber(tmpStr, format, precision, value);
+            sci = tmpStr.data();
          }
-         return rv;
+         const char *sciEnd = sci + sciLen;
+         const char *point = std::find(sci, sciEnd, '.');
+         const char *expPos = std::find(sci, sciEnd, 'e');
+
+            // Work out the pieces of the result: an optional space
+            // for the sign, the number up to the exponent with the
+            // decimal point moved, the exponent character and sign,
+            // zeros to pad the exponent, and the exponent digits.
+         bool leadSpace = ((sign == FFSign::NegSpace) && (d >= 0));
+         bool movePoint = ((lead != FFLead::NonZero) && (point != sciEnd) &&
+                           (point > sci));
+         bool addZero = (movePoint && (lead == FFLead::Zero));
+         std::size_t expDigits = 0, expPad = 0;
+         if (expPos != sciEnd)
+         {
+            expDigits = (sciEnd - expPos) - 2;
+            if (expDigits < exponent)
+               expPad = exponent - expDigits;
+         }
+         std::size_t len = (leadSpace ? 1 : 0) + sciLen + (addZero ? 1 : 0) +
+            expPad;
+         std::size_t total = (len < width ? width : len);
+         if (total > size)
+            return total;
+
+         char *out = buf;
+         if ((total > len) && (align == FFAlign::Right))
+         {
+            std::memset(out, ' ', total - len);
+            out += total - len;
+         }
+         if (leadSpace)
+            *out++ = ' ';
+         const char *mantEnd = (expPos != sciEnd ? expPos : sciEnd);
+         if (movePoint)
+         {
+               // "-1.2345" becomes "-.12345" or "-0.12345"
+            std::size_t beforeDigit = (point - 1) - sci;
+            std::memcpy(out, sci, beforeDigit);
+            out += beforeDigit;
+            if (addZero)
+               *out++ = '0';
+            *out++ = '.';
+            *out++ = point[-1];
+            std::memcpy(out, point + 1, mantEnd - (point + 1));
+            out += mantEnd - (point + 1);
+         }
+         else
+         {
+            std::memcpy(out, sci, mantEnd - sci);
+            out += mantEnd - sci;
+         }
+         if (expPos != sciEnd)
+         {
+            *out++ = expChar;
+            *out++ = expPos[1];
+            std::memset(out, '0', expPad);
+            out += expPad;
+            std::memcpy(out, expPos + 2, expDigits);
+            out += expDigits;
+         }
+         if ((total > len) && (align == FFAlign::Left))
+         {
+            std::memset(out, ' ', total - len);
+         }
+         return total;
       }
    } // namespace StringUtils
 } // namespace gpstk
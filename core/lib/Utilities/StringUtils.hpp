@@ -44,6 +44,7 @@
 #ifndef GPSTK_STRINGUTILS_HPP
 #define GPSTK_STRINGUTILS_HPP
 
+#include <algorithm>
 #include <string>
 #include <sstream>
 #include <iomanip>
@@ -697,13 +698,51 @@ namespace gpstk
                                 const char pad = ' ')
       { std::string t(s); return center(t, length, pad); }
 
+         /**
+          * Convert the first \a n characters of \a s to a double
+          * precision floating point number.  This gives the same
+          * result as strtod() in the "C" locale, regardless of the
+          * current locale, but does not allocate memory, making it
+          * suitable for parsing fixed-width fields in place.  The
+          * usual fixed point and exponential forms are converted
+          * directly, anything else is passed on to strtod().
+          * @param s pointer to the first character of the field, which
+          *   need not be null-terminated.
+          * @param n the number of characters in the field.
+          * @return double representation of the field, 0 if it does
+          *   not start with a number.
+          */
+      double asDouble(const char* s, std::size_t n);
+
+         /**
+          * Convert the first \a n characters of \a s to an integer.
+          * This is equivalent to asInt(std::string(s,n)) but does not
+          * allocate memory.
+          * @param s pointer to the first character of the field, which
+          *   need not be null-terminated.
+          * @param n the number of characters in the field.
+          * @return long integer representation of the field.
+          */
+      long asInt(const char* s, std::size_t n);
+
+         /**
+          * Convert the first \a n characters of \a s to an unsigned
+          * integer.  This is equivalent to
+          * asUnsigned(std::string(s,n)) but does not allocate memory.
+          * @param s pointer to the first character of the field, which
+          *   need not be null-terminated.
+          * @param n the number of characters in the field.
+          * @return unsigned long integer representation of the field.
+          */
+      unsigned long asUnsigned(const char* s, std::size_t n);
+
          /**
           * Convert a string to a double precision floating point number.
           * @param s string containing a number.
           * @return double representation of string.
           */
       inline double asDouble(const std::string& s)
-      { return strtod(s.c_str(), 0); }
+      { return asDouble(s.c_str(), s.length()); }
 
          /**
           * Convert a string to an integer.
@@ -711,7 +750,7 @@ namespace gpstk
           * @return long integer representation of string.
           */
       inline long asInt(const std::string& s)
-      { return strtol(s.c_str(), 0, 10); }
+      { return asInt(s.c_str(), s.length()); }
 
          /**
           * Convert a string to an unsigned integer.
@@ -719,7 +758,7 @@ namespace gpstk
           * @return unsigned long integer representation of string.
           */
       inline unsigned long asUnsigned(const std::string& s)
-      { return strtoul(s.c_str(), 0, 10); }
+      { return asUnsigned(s.c_str(), s.length()); }
 
          /**
           * Convert a string to a single precision floating point number.
@@ -766,6 +805,41 @@ namespace gpstk
       inline std::string asString(const double x,
                                   const std::string::size_type precision = 17);
 
+         /**
+          * Write a double in fixed notation (FORTRAN F format) to a
+          * buffer, right justified in a field.  When the value fits,
+          * this is equivalent to rightJustify(asString(x, precision),
+          * width), without allocating memory.  A value that doesn't
+          * fit is written in full rather than truncated.  No null
+          * terminator is written.
+          * @param[out] buf where to write the field.
+          * @param[in] size the number of characters available in \a buf.
+          * @param[in] x the value to write.
+          * @param[in] precision the number of decimal places.
+          * @param[in] width the minimum number of characters to write,
+          *   padded with spaces on the left.
+          * @return the number of characters in the field, which is
+          *   more than \a width if \a x doesn't fit in it.  If this is
+          *   more than \a size, nothing is written.
+          */
+      std::size_t formatFixed(char* buf, std::size_t size, double x,
+                              unsigned precision, unsigned width = 0);
+
+         /**
+          * Append a double in fixed notation, right justified in a
+          * field of \a width characters, to \a s.  This is exactly
+          * s += rightJustify(asString(x, precision), width),
+          * including keeping only the rightmost \a width characters
+          * of a value that doesn't fit, but without the temporary
+          * strings.
+          * @param[in,out] s the string to append to.
+          * @param[in] x the value to write.
+          * @param[in] precision the number of decimal places.
+          * @param[in] width the number of characters to append.
+          */
+      void appendFixed(std::string& s, double x, unsigned precision,
+                       unsigned width);
+
          /**
           * Convert any old object to a string.
           * The class must have stream operators defined.
@@ -1250,6 +1324,8 @@ namespace gpstk
           * @param startPos beginning of number in string.
           * @param length length (in characters) of number, including exponent.
           * @return value of the number.
+          * @throw StringException if \a startPos is past the end of
+          *   \a aStr.
           * @deprecated This method is being replaced by
           * FormattedDouble and is scheduled for removal in the first
           * tagged release of Q4 2020.
@@ -1258,6 +1334,19 @@ namespace gpstk
                              const std::string::size_type startPos = 0,
                              const std::string::size_type length = std::string::npos);
 
+         /**
+          * Convert the first \a n characters of \a s, which may be a
+          * number in FORTRAN notation, to a double.  This is the same
+          * as asDouble(const char*,std::size_t), except that the
+          * exponent may also be introduced by 'D' or 'd', e.g.
+          * ".15636D+06" becomes 156360.
+          * @param s pointer to the first character of the field, which
+          *   need not be null-terminated.
+          * @param n the number of characters in the field.
+          * @return value of the number, 0 if the field is blank.
+          */
+      double for2doub(const char* s, std::size_t n);
+
          /** Format a floating point value according to rules not
           * directly supported by C++ stream I/O.
           * @see FormattedDouble which should generally be used rather
@@ -1290,6 +1379,22 @@ namespace gpstk
                               FFSign sign = FFSign::NegOnly,
                               FFAlign align = FFAlign::Left);
 
+         /** Write a floating point value formatted as by
+          * floatFormat(double,FFLead,unsigned,unsigned,unsigned,char,FFSign,FFAlign)
+          * to a buffer, e.g. FORTRAN E or D format, without
+          * allocating memory.  No null terminator is written.
+          * @param[out] buf where to write the formatted value.
+          * @param[in] size the number of characters available in \a buf.
+          * @return the number of characters in the formatted value.
+          *   If this is more than \a size, nothing is written.
+          */
+      std::size_t floatFormat(char* buf, std::size_t size, double d,
+                              FFLead lead, unsigned mantissa,
+                              unsigned exponent, unsigned width = 0,
+                              char expChar = 'e',
+                              FFSign sign = FFSign::NegOnly,
+                              FFAlign align = FFAlign::Left);
+
          /**
           * Change a string into printable characters.  Control
           * characters 0, 1, ... 31 are changed to ^@, ^A, ... ^_ ;
@@ -1676,6 +1781,10 @@ namespace gpstk
 
       inline std::string asString(const double x, const std::string::size_type precision)
       {
+         char buf[64];
+         std::size_t n = formatFixed(buf, sizeof(buf), x, precision);
+         if (n <= sizeof(buf))
+            return std::string(buf, n);
          std::ostringstream ss;
          ss << std::fixed << std::setprecision(precision) << x;
          return ss.str();
@@ -2681,33 +2790,13 @@ namespace gpstk
                              const std::string::size_type startPos,
                              const std::string::size_type length)
       {
-         std::string s(aStr, startPos, length);
-         strip(s);
-
-            // you can blame Rinex for these special checks
-         if (s.empty())
-         {
-            return 0;
-         }
-
-         std::string::size_type pos = s.find_first_of("EDd");
-         if (pos != std::string::npos)
-         {
-            s[pos] = 'e';
-         }
-         else
+         if (startPos > aStr.length())
          {
-               // just treat it like a double
-            return asDouble(aStr.substr(startPos, length));
+            StringException e("for2doub: start position past end of string");
+            GPSTK_THROW(e);
          }
-
-         std::stringstream st;
-         st << s;
-
-         double d;
-         st >> d;
-
-         return d;
+         return for2doub(aStr.data() + startPos,
+                         std::min(length, aStr.length() - startPos));
       }
 
       inline std::string printable(const std::string& aStr)
@@ -0,0 +1,286 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+
+#include <sstream>
+#include "FFTextStream.hpp"
+#include "Rinex3ObsStream.hpp"
+#include "Rinex3ObsData.hpp"
+#include "Rinex3ObsHeader.hpp"
+#include "SP3Stream.hpp"
+#include "SP3Header.hpp"
+#include "SP3Data.hpp"
+#include "build_config.h"
+#include "TestUtil.hpp"
+
+using namespace std;
+using namespace gpstk;
+
+class FFTextStream_T
+{
+public:
+   FFTextStream_T()
+   {
+      init();
+   }
+
+   void init();
+
+      /// Make sure lines are read identically with and without mapping.
+   int getLineTest();
+      /// Make sure mapFile() can pick up where the filebuf left off.
+   int mapFileTest();
+      /// Make sure RINEX 3 obs records are identical with and without mapping.
+   int rinex3ObsTest();
+      /// Make sure SP3 records are identical with and without mapping.
+   int sp3Test();
+
+private:
+      /// Read all the lines in linesFile and record them in a string.
+   string readLines(bool mapped, bool useString);
+
+   string linesFile;
+   string obsFile;
+   string sp3File;
+};
+
+
+void FFTextStream_T ::
+init()
+{
+   TestUtil testUtil;
+   string dp = gpstk::getPathData() + gpstk::getFileSep();
+   string op = gpstk::getPathTestTemp() + gpstk::getFileSep();
+
+   linesFile = op + "test_output_FFTextStream_lines.txt";
+   obsFile = dp + "test_input_rinex3_76193040.14o";
+   sp3File = dp + "test_input_SP3c.sp3";
+
+      // CR-LF, blank lines and a last line with no terminator
+   ofstream ofs(linesFile.c_str(), ios::out | ios::binary);
+   ofs << "first line\n"
+       << "windows line\r\n"
+       << "\n"
+       << "\r\r\n"
+       << "   indented line   \n"
+       << "no terminator";
+}
+
+
+string FFTextStream_T ::
+readLines(bool mapped, bool useString)
+{
+   ostringstream oss;
+   FFTextStream strm;
+   strm.open(linesFile.c_str(), ios::in);
+   if (mapped && !strm.mapFile())
+   {
+      return "mapFile failed";
+   }
+   try
+   {
+      while (true)
+      {
+         if (useString)
+         {
+            string line;
+            strm.formattedGetLine(line, true);
+            oss << strm.lineNumber << ":" << line << "|";
+         }
+         else
+         {
+            const char *line;
+            size_t length;
+            strm.formattedGetLine(line, length, true);
+            oss << strm.lineNumber << ":" << string(line, length) << "|";
+         }
+      }
+   }
+   catch (EndOfFile& e)
+   {
+      oss << "EOF at " << strm.lineNumber;
+   }
+   catch (Exception& e)
+   {
+      oss << "unexpected exception " << e.what();
+   }
+   return oss.str();
+}
+
+
+int FFTextStream_T ::
+getLineTest()
+{
+   TUDEF("FFTextStream", "formattedGetLine");
+   string expected = "1:first line|2:windows line|3:|4:|5:   indented line   |"
+      "6:no terminator|EOF at 7";
+   TUASSERTE(string, expected, readLines(false, true));
+   TUASSERTE(string, expected, readLines(false, false));
+   TUASSERTE(string, expected, readLines(true, true));
+   TUASSERTE(string, expected, readLines(true, false));
+
+      // unexpected EOF is an error
+   FFTextStream strm(linesFile.c_str(), ios::in);
+   TUASSERT(strm.mapFile());
+   string line;
+   for (unsigned i = 0; i < 6; i++)
+   {
+      strm.formattedGetLine(line);
+   }
+   try
+   {
+      strm.formattedGetLine(line, false);
+      TUFAIL("Did not throw Exception");
+   }
+   catch (EndOfFile& e)
+   {
+      TUFAIL("EndOfFile thrown when EOF not expected");
+   }
+   catch (FFStreamError& e)
+   {
+      TUPASS("FFStreamError");
+   }
+   TURETURN();
+}
+
+
+int FFTextStream_T ::
+mapFileTest()
+{
+   TUDEF("FFTextStream", "mapFile");
+   string line;
+   FFTextStream strm(linesFile.c_str(), ios::in);
+   TUASSERT(!strm.isMapped());
+   strm.formattedGetLine(line);
+   TUASSERTE(string, "first line", line);
+   TUASSERT(strm.mapFile());
+   TUASSERT(strm.isMapped());
+   strm.formattedGetLine(line);
+   TUASSERTE(string, "windows line", line);
+      // seekg/tellg work through the mapping
+   streampos pos = strm.tellg();
+   strm.formattedGetLine(line);
+   strm.formattedGetLine(line);
+   strm.seekg(pos);
+   strm.formattedGetLine(line);
+   TUASSERTE(string, "", line);
+      // regular iostream extraction works through the mapping
+   strm.formattedGetLine(line);
+   string word;
+   strm >> word;
+   TUASSERTE(string, "indented", word);
+   strm.close();
+   TUASSERT(!strm.isMapped());
+   TUASSERT(!strm.is_open());
+
+      // output streams are never mapped
+   FFTextStream ostrm(linesFile.c_str(), ios::in|ios::out);
+   TUASSERT(!ostrm.mapFile());
+   TURETURN();
+}
+
+
+int FFTextStream_T ::
+rinex3ObsTest()
+{
+   TUDEF("FFTextStream", "defaultMemoryMap");
+   ostringstream filebufDump, mappedDump;
+   for (unsigned pass = 0; pass < 2; pass++)
+   {
+      ostringstream& oss(pass == 0 ? filebufDump : mappedDump);
+      FFTextStream::defaultMemoryMap = (pass == 1);
+      Rinex3ObsStream strm(obsFile.c_str());
+      TUASSERTE(bool, (pass == 1), strm.isMapped());
+      Rinex3ObsHeader hdr;
+      Rinex3ObsData data;
+      strm >> hdr;
+      hdr.dump(oss);
+      while (strm >> data)
+      {
+         data.dump(oss, hdr);
+      }
+      oss << strm.lineNumber << " " << strm.recordNumber << endl;
+   }
+   FFTextStream::defaultMemoryMap = false;
+   TUASSERT(filebufDump.str().length() > 0);
+   TUASSERTE(string, filebufDump.str(), mappedDump.str());
+   TURETURN();
+}
+
+
+int FFTextStream_T ::
+sp3Test()
+{
+   TUDEF("FFTextStream", "defaultMemoryMap");
+   ostringstream filebufDump, mappedDump;
+   for (unsigned pass = 0; pass < 2; pass++)
+   {
+      ostringstream& oss(pass == 0 ? filebufDump : mappedDump);
+      FFTextStream::defaultMemoryMap = (pass == 1);
+      SP3Stream strm(sp3File.c_str());
+      TUASSERTE(bool, (pass == 1), strm.isMapped());
+      SP3Header hdr;
+      SP3Data data;
+      strm >> hdr;
+      hdr.dump(oss);
+      while (strm >> data)
+      {
+         data.dump(oss);
+      }
+      oss << strm.lineNumber << " " << strm.recordNumber << endl;
+   }
+   FFTextStream::defaultMemoryMap = false;
+   TUASSERT(filebufDump.str().length() > 0);
+   TUASSERTE(string, filebufDump.str(), mappedDump.str());
+   TURETURN();
+}
+
+
+int main()
+{
+   int errorTotal = 0;
+   FFTextStream_T testClass;
+
+   errorTotal += testClass.getLineTest();
+   errorTotal += testClass.mapFileTest();
+   errorTotal += testClass.rinex3ObsTest();
+   errorTotal += testClass.sp3Test();
+
+   cout << "Total Failures for " << __FILE__ << ": " << errorTotal << endl;
+
+   return( errorTotal );
+}
@@ -0,0 +1,294 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#ifndef WIN32
+#include <sys/stat.h>
+#include <utime.h>
+#endif
+#include "Rinex3ObsStream.hpp"
+#include "Rinex3ObsHeader.hpp"
+#include "Rinex3ObsData.hpp"
+#include "Rinex3ObsCache.hpp"
+#include "build_config.h"
+#include "TestUtil.hpp"
+
+using namespace std;
+using namespace gpstk;
+
+class Rinex3ObsCache_T
+{
+public:
+   Rinex3ObsCache_T()
+   {
+      init();
+   }
+
+   void init();
+
+      /// Write a cache and read it back, for several kinds of input.
+   int roundTripTest();
+      /// Make sure a changed file doesn't use its old cache.
+   int invalidateTest();
+      /// Make sure only a file that is read to the end gets a cache.
+   int partialTest();
+
+private:
+      /// Copy a data file to the temp directory, removing any cache.
+   string copyData(const string& fn);
+
+      /** Dump the header and all records in a file.
+       * @param[in] useCache whether the stream should use the cache.
+       * @param[out] cached set to whether the stream read the cache. */
+   string dump(const string& fn, bool useCache, bool& cached);
+
+      /// @return true if the file \a fn exists.
+   bool exists(const string& fn);
+
+   string dataPath;
+   string tempPath;
+};
+
+
+void Rinex3ObsCache_T ::
+init()
+{
+   TestUtil testUtil;
+   dataPath = gpstk::getPathData() + gpstk::getFileSep();
+   tempPath = gpstk::getPathTestTemp() + gpstk::getFileSep();
+}
+
+
+string Rinex3ObsCache_T ::
+copyData(const string& fn)
+{
+   string copy = tempPath + "test_output_Rinex3ObsCache_" + fn;
+   ifstream ifs((dataPath + fn).c_str(), ios::binary);
+   ofstream ofs(copy.c_str(), ios::binary);
+   ofs << ifs.rdbuf();
+   std::remove(Rinex3ObsCache::cacheName(copy).c_str());
+   return copy;
+}
+
+
+string Rinex3ObsCache_T ::
+dump(const string& fn, bool useCache, bool& cached)
+{
+   ostringstream oss;
+   Rinex3ObsStream strm;
+   strm.useCache(useCache);
+   strm.open(fn.c_str(), ios::in);
+   strm.exceptions(ios::failbit);
+   cached = strm.isCached();
+   Rinex3ObsHeader hdr;
+   Rinex3ObsData data;
+   strm >> hdr;
+   hdr.dump(oss);
+   while (strm >> data)
+   {
+      data.dump(oss, hdr);
+      if ((data.epochFlag > 1) && (data.epochFlag < 6))
+         data.auxHeader.dump(oss);
+   }
+   oss << strm.recordNumber << endl;
+   return oss.str();
+}
+
+
+bool Rinex3ObsCache_T ::
+exists(const string& fn)
+{
+   ifstream ifs(fn.c_str());
+   return ifs.good();
+}
+
+
+int Rinex3ObsCache_T ::
+roundTripTest()
+{
+   TUDEF("Rinex3ObsCache", "getRecord");
+   const char *files[] = {
+      "test_input_rinex3_76193040.14o",
+      "test_input_rinex3_76193040_events.14d.Z",
+      "test_input_rinex2_obs_RinexObsFile.06o"
+   };
+   for (unsigned i = 0; i < sizeof(files)/sizeof(files[0]); i++)
+   {
+      try
+      {
+         string fn = copyData(files[i]);
+         string cacheFile = Rinex3ObsCache::cacheName(fn);
+         bool cached;
+         string expected = dump(fn, false, cached);
+         TUASSERT(!cached);
+         TUASSERT(!exists(cacheFile));
+            // the first read writes the cache...
+         string got = dump(fn, true, cached);
+         TUASSERT(!cached);
+         TUASSERT(exists(cacheFile));
+         TUASSERTE(string, expected, got);
+            // ...and the second reads it.
+         got = dump(fn, true, cached);
+         TUASSERT(cached);
+         TUASSERTE(string, expected, got);
+      }
+      catch (Exception& e)
+      {
+         TUFAIL(string(files[i]) + ": unexpected exception: " + e.what());
+      }
+   }
+   TURETURN();
+}
+
+
+int Rinex3ObsCache_T ::
+invalidateTest()
+{
+   TUDEF("Rinex3ObsCache", "open");
+   try
+   {
+      string fn = copyData("test_input_rinex3_76193040.14o");
+      bool cached;
+      dump(fn, true, cached);
+      dump(fn, true, cached);
+      TUASSERT(cached);
+
+         // Change one digit without changing the size or mtime,
+         // which only the hash will notice.
+      string contents;
+      {
+         ifstream ifs(fn.c_str(), ios::binary);
+         ostringstream oss;
+         oss << ifs.rdbuf();
+         contents = oss.str();
+      }
+      string::size_type pos = contents.find("END OF HEADER");
+      pos = contents.find("G05 ", pos) + 8;
+      contents[pos] = (contents[pos] == '1' ? '2' : '1');
+#ifndef WIN32
+      struct stat sb;
+      TUASSERT(::stat(fn.c_str(), &sb) == 0);
+#endif
+      {
+         ofstream ofs(fn.c_str(), ios::binary);
+         ofs << contents;
+      }
+#ifndef WIN32
+      struct utimbuf times;
+      times.actime = sb.st_atime;
+      times.modtime = sb.st_mtime;
+      TUASSERT(::utime(fn.c_str(), &times) == 0);
+#endif
+      string expected = dump(fn, false, cached);
+      string got = dump(fn, true, cached);
+      TUASSERT(!cached);
+      TUASSERTE(string, expected, got);
+         // and there's a new cache
+      got = dump(fn, true, cached);
+      TUASSERT(cached);
+      TUASSERTE(string, expected, got);
+
+#ifndef WIN32
+         // Change only the mtime.
+      times.modtime = sb.st_mtime + 10;
+      TUASSERT(::utime(fn.c_str(), &times) == 0);
+      got = dump(fn, true, cached);
+      TUASSERT(!cached);
+      TUASSERTE(string, expected, got);
+#endif
+
+         // A cache that's not a cache is ignored.
+      {
+         ofstream ofs(Rinex3ObsCache::cacheName(fn).c_str(), ios::binary);
+         ofs << "not a cache";
+      }
+      got = dump(fn, true, cached);
+      TUASSERT(!cached);
+      TUASSERTE(string, expected, got);
+   }
+   catch (Exception& e)
+   {
+      TUFAIL("Unexpected exception: " + e.what());
+   }
+   TURETURN();
+}
+
+
+int Rinex3ObsCache_T ::
+partialTest()
+{
+   TUDEF("Rinex3ObsCacheWriter", "finish");
+   try
+   {
+      string fn = copyData("test_input_rinex3_76193040.14o");
+      {
+         Rinex3ObsStream strm;
+         strm.useCache(true);
+         strm.open(fn.c_str(), ios::in);
+         Rinex3ObsHeader hdr;
+         Rinex3ObsData data;
+         strm >> hdr;
+         strm >> data;
+         strm >> data;
+      }
+      TUASSERT(!exists(Rinex3ObsCache::cacheName(fn)));
+      TUASSERT(!exists(Rinex3ObsCache::cacheName(fn) + ".tmp"));
+   }
+   catch (Exception& e)
+   {
+      TUFAIL("Unexpected exception: " + e.what());
+   }
+   TURETURN();
+}
+
+
+int main()
+{
+   int errorTotal = 0;
+   Rinex3ObsCache_T testClass;
+
+   errorTotal += testClass.roundTripTest();
+   errorTotal += testClass.invalidateTest();
+   errorTotal += testClass.partialTest();
+
+   cout << "Total Failures for " << __FILE__ << ": " << errorTotal << endl;
+
+   return( errorTotal );
+}
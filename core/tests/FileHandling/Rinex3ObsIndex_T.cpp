@@ -0,0 +1,360 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "Rinex3ObsStream.hpp"
+#include "Rinex3ObsHeader.hpp"
+#include "Rinex3ObsData.hpp"
+#include "Rinex3ObsIndex.hpp"
+#include "build_config.h"
+#include "TestUtil.hpp"
+
+using namespace std;
+using namespace gpstk;
+
+class Rinex3ObsIndex_T
+{
+public:
+   Rinex3ObsIndex_T()
+   {
+      init();
+   }
+
+   void init();
+
+      /// Seek to each record in turn, for several kinds of input.
+   int seekTest();
+      /// Read spans of time.
+   int rangeTest();
+      /// Save an index and use it again.
+   int saveTest();
+      /// Make sure streams that can't seek say so.
+   int compressedTest();
+
+private:
+      /// A record read sequentially, with where it was read.
+   struct Record
+   {
+      CommonTime time;
+      string text;
+      unsigned long line, record;
+   };
+
+      /// Copy a data file to the temp directory, removing any index.
+   string copyData(const string& fn);
+
+      /** Read all the records in a file sequentially.
+       * @param[in] useCache whether the stream should use a cache.
+       * @return the records, with the times of records with no time
+       *   replaced by the time of the record before them. */
+   vector<Record> readAll(const string& fn, bool useCache);
+
+      /// @return the dump of a record.
+   string dump(const Rinex3ObsData& rod, Rinex3ObsHeader& hdr);
+
+   string dataPath;
+   string tempPath;
+};
+
+
+void Rinex3ObsIndex_T ::
+init()
+{
+   TestUtil testUtil;
+   dataPath = gpstk::getPathData() + gpstk::getFileSep();
+   tempPath = gpstk::getPathTestTemp() + gpstk::getFileSep();
+}
+
+
+string Rinex3ObsIndex_T ::
+copyData(const string& fn)
+{
+   string copy = tempPath + "test_output_Rinex3ObsIndex_" + fn;
+   ifstream ifs((dataPath + fn).c_str(), ios::binary);
+   ofstream ofs(copy.c_str(), ios::binary);
+   ofs << ifs.rdbuf();
+   std::remove(Rinex3ObsIndex::indexName(copy).c_str());
+   std::remove(Rinex3ObsCache::cacheName(copy).c_str());
+   return copy;
+}
+
+
+string Rinex3ObsIndex_T ::
+dump(const Rinex3ObsData& rod, Rinex3ObsHeader& hdr)
+{
+   ostringstream oss;
+   rod.dump(oss, hdr);
+   if ((rod.epochFlag > 1) && (rod.epochFlag < 6))
+      rod.auxHeader.dump(oss);
+   return oss.str();
+}
+
+
+vector<Rinex3ObsIndex_T::Record> Rinex3ObsIndex_T ::
+readAll(const string& fn, bool useCache)
+{
+   vector<Record> records;
+   Rinex3ObsStream strm;
+   strm.useCache(useCache);
+   strm.open(fn.c_str(), ios::in);
+   strm.exceptions(ios::failbit);
+   Rinex3ObsHeader hdr;
+   Rinex3ObsData data;
+   strm >> hdr;
+   while (true)
+   {
+      Record rec;
+      rec.line = strm.lineNumber;
+      rec.record = strm.recordNumber;
+      if (!(strm >> data))
+         break;
+      rec.time = data.time;
+      if ((rec.time == CommonTime::BEGINNING_OF_TIME) && !records.empty())
+         rec.time = records.back().time;
+      rec.text = dump(data, hdr);
+      records.push_back(rec);
+   }
+   return records;
+}
+
+
+int Rinex3ObsIndex_T ::
+seekTest()
+{
+   TUDEF("Rinex3ObsStream", "seekToTime");
+   const char *files[] = {
+      "test_input_rinex3_76193040.14o",
+      "test_input_rinex3_76193040_events.14d.Z",
+      "test_input_rinex2_obs_RinexObsFile.06o"
+   };
+   for (unsigned i = 0; i < sizeof(files)/sizeof(files[0]); i++)
+   {
+      try
+      {
+         string fn = copyData(files[i]);
+            // Compressed files can only seek once they have a cache.
+         bool useCache = (fn.find(".Z") != string::npos);
+         vector<Record> records = readAll(fn, useCache);
+         TUASSERT(!records.empty());
+         Rinex3ObsStream strm;
+         strm.useCache(useCache);
+         strm.open(fn.c_str(), ios::in);
+         strm.exceptions(ios::failbit);
+         TUASSERTE(bool, useCache, strm.isCached());
+         strm.buildIndex();
+         TUASSERTE(size_t, records.size(), strm.getIndex().size());
+            // Seek backwards so every seek has to move.
+         for (size_t j = records.size(); j > 0; j--)
+         {
+            const Record& rec = records[j-1];
+               // The first of the records with this time.
+            size_t first = j-1;
+            while ((first > 0) && (records[first-1].time == rec.time))
+               first--;
+            TUASSERT(strm.seekToTime(rec.time));
+            TUASSERTE(unsigned long, records[first].record,
+                      strm.recordNumber);
+            if (!useCache)
+            {
+               TUASSERTE(unsigned long, records[first].line,
+                         strm.lineNumber);
+            }
+            Rinex3ObsData data;
+            strm >> data;
+            TUASSERTE(string, records[first].text, dump(data, strm.header));
+         }
+         TUASSERT(!strm.seekToTime(records.back().time + 1));
+         Rinex3ObsData data;
+         TUASSERT(!(strm >> data));
+      }
+      catch (Exception& e)
+      {
+         TUFAIL(string(files[i]) + ": unexpected exception: " + e.what());
+      }
+   }
+   TURETURN();
+}
+
+
+int Rinex3ObsIndex_T ::
+rangeTest()
+{
+   TUDEF("Rinex3ObsStream", "readRange");
+   try
+   {
+      string fn = copyData("test_input_rinex3_76193040.14o");
+      vector<Record> records = readAll(fn, false);
+      TUASSERT(records.size() > 4);
+      Rinex3ObsStream strm(fn.c_str());
+      vector<Rinex3ObsData> got;
+         // a span in the middle, the whole file, and nothing
+      const CommonTime& t1 = records[1].time;
+      const CommonTime& t2 = records[records.size()-2].time;
+      strm.readRange(t1, t2, got);
+      TUASSERTE(size_t, records.size()-2, got.size());
+      for (size_t i = 0; i < got.size(); i++)
+      {
+         TUASSERTE(string, records[i+1].text, dump(got[i], strm.header));
+      }
+      strm.readRange(records[0].time - 1, records.back().time + 1, got);
+      TUASSERTE(size_t, records.size(), got.size());
+      strm.readRange(t1 + 0.5, t1 + 0.6, got);
+      TUASSERTE(size_t, 0, got.size());
+         // a span with a single record
+      strm.readRange(t2, t2, got);
+      TUASSERTE(size_t, 1, got.size());
+      TUASSERTE(string, records[records.size()-2].text,
+                dump(got[0], strm.header));
+   }
+   catch (Exception& e)
+   {
+      TUFAIL("Unexpected exception: " + e.what());
+   }
+   TURETURN();
+}
+
+
+int Rinex3ObsIndex_T ::
+saveTest()
+{
+   TUDEF("Rinex3ObsIndex", "load");
+   try
+   {
+      string fn = copyData("test_input_rinex3_76193040.14o");
+      string indexFile = Rinex3ObsIndex::indexName(fn);
+      Rinex3ObsIndex built;
+      {
+         Rinex3ObsStream strm(fn.c_str());
+         strm.buildIndex(true);
+         built = strm.getIndex();
+      }
+      TUASSERT(!built.empty());
+      Rinex3ObsIndex loaded;
+      TUASSERT(loaded.load(fn));
+      TUASSERTE(size_t, built.size(), loaded.size());
+      for (size_t i = 0; i < built.size(); i++)
+      {
+         TUASSERTE(CommonTime, built[i].time, loaded[i].time);
+         TUASSERTE(long, built[i].pos.offset, loaded[i].pos.offset);
+         TUASSERTE(unsigned long, built[i].pos.line, loaded[i].pos.line);
+         TUASSERTE(unsigned long, built[i].pos.record, loaded[i].pos.record);
+      }
+      TUASSERTE(long, built.dataEnd().offset, loaded.dataEnd().offset);
+
+         // A stream using the saved index reads the same records.
+      vector<Record> records = readAll(fn, false);
+      {
+         Rinex3ObsStream strm(fn.c_str());
+         vector<Rinex3ObsData> got;
+         strm.readRange(records[2].time, records[2].time, got);
+         TUASSERTE(size_t, 1, got.size());
+         TUASSERTE(string, records[2].text, dump(got[0], strm.header));
+      }
+
+         // Once the file changes, the index is ignored.
+      string contents;
+      {
+         ifstream ifs(fn.c_str(), ios::binary);
+         ostringstream oss;
+         oss << ifs.rdbuf();
+         contents = oss.str();
+      }
+         // Drop the first epoch, which changes the size.
+      string::size_type start = contents.find("END OF HEADER");
+      start = contents.find('\n', start) + 1;
+      string::size_type end = contents.find("\n>", start) + 1;
+      contents.erase(start, end - start);
+      {
+         ofstream ofs(fn.c_str(), ios::binary | ios::trunc);
+         ofs << contents;
+      }
+      TUASSERT(!loaded.load(fn));
+      TUASSERT(loaded.empty());
+      {
+         Rinex3ObsStream strm(fn.c_str());
+         vector<Rinex3ObsData> got;
+         strm.readRange(records[2].time, records[2].time, got);
+         TUASSERTE(size_t, 1, got.size());
+         TUASSERTE(string, records[2].text, dump(got[0], strm.header));
+         TUASSERTE(size_t, records.size()-1, strm.getIndex().size());
+      }
+   }
+   catch (Exception& e)
+   {
+      TUFAIL("Unexpected exception: " + e.what());
+   }
+   TURETURN();
+}
+
+
+int Rinex3ObsIndex_T ::
+compressedTest()
+{
+   TUDEF("Rinex3ObsStream", "buildIndex");
+   string fn = copyData("test_input_rinex3_76193040_events.14d.Z");
+   Rinex3ObsStream strm(fn.c_str());
+   try
+   {
+      strm.buildIndex();
+      TUFAIL("Indexed a compressed stream");
+   }
+   catch (FFStreamError& e)
+   {
+      TUPASS("FFStreamError");
+   }
+   TUASSERT(strm.getIndex().empty());
+   TURETURN();
+}
+
+
+int main()
+{
+   int errorTotal = 0;
+   Rinex3ObsIndex_T testClass;
+
+   errorTotal += testClass.seekTest();
+   errorTotal += testClass.rangeTest();
+   errorTotal += testClass.saveTest();
+   errorTotal += testClass.compressedTest();
+
+   cout << "Total Failures for " << __FILE__ << ": " << errorTotal << endl;
+
+   return( errorTotal );
+}
@@ -40,6 +40,7 @@
 #include "Rinex3ObsHeader.hpp"
 #include "Rinex3ObsData.hpp"
 #include "TestUtil.hpp"
+#include "build_config.h"
 #include <iostream>
 #include <string>
 
@@ -64,6 +65,16 @@ public:
       /** Make sure that ionospheric delay pseudo-observables are
        * written to the file correctly. */
    unsigned ionoDelayTest();
+      /** Make sure that reading consecutive records into the same
+       * Rinex3ObsData object, which reuses its storage, gives the
+       * same results as reading into a new object each time. */
+   unsigned recordReuseTest();
+      /** Make sure that the SatelliteSystem-indexed observation types
+       * match mapObsTypes and the string-keyed lookups. */
+   unsigned obsTypeIndexTest();
+      /** Make sure that changing mapObsTypes after a header has
+       * been read is seen by the observation lookups. */
+   unsigned obsTypeEditTest();
       /// generic filling of generic data.
    void setObs(gpstk::TestUtil& testFramework, const std::string& system,
                gpstk::Rinex3ObsHeader& hdr, gpstk::Rinex3ObsData& rod);
@@ -595,6 +606,266 @@ fillHeader304(gpstk::Rinex3ObsHeader& hdr)
 }
 
 
+unsigned Rinex3ObsOther_T ::
+recordReuseTest()
+{
+   TUDEF("Rinex3ObsData", "reallyGetRecord");
+   std::string fn = gpstk::getPathTestTemp() + gpstk::getFileSep() +
+      "test_output_Rinex3ObsOther_Reuse.14o";
+   std::ofstream ofs(fn.c_str());
+   ofs << "     3.02           OBSERVATION DATA    M                   RINEX VERSION / TYPE\n"
+       << "cnvtToRINEX 2.25.0  convertToRINEX OPR  23-Jan-15 22:34 UTC PGM / RUN BY / DATE \n"
+       << "7619                                                        MARKER NAME         \n"
+       << "GEODETIC                                                    MARKER TYPE         \n"
+       << "GNSS Observer       Trimble                                 OBSERVER / AGENCY   \n"
+       << "5239497619          R8 Model 3          4.80                REC # / TYPE / VERS \n"
+       << "                    TRM60158.00                             ANT # / TYPE        \n"
+       << "  -740287.1908 -5457064.3395  3207279.4677                  APPROX POSITION XYZ \n"
+       << "       -0.0650        0.0000        0.0000                  ANTENNA: DELTA H/E/N\n"
+       << "G    3 C1C L1C S1C                                          SYS / # / OBS TYPES \n"
+       << "J    2 C1C L1C                                              SYS / # / OBS TYPES \n"
+       << "  2014    10    31    20    28    0.0000000     GPS         TIME OF FIRST OBS   \n"
+       << "                                                            END OF HEADER       \n"
+       << "> 2014 10 31 20 28  0.0000000  0  3\n"
+       << "G05  23448820.047 5 123224404.83915        45.000  \n"
+       << "G15  20678535.828 5 108666319.37715        47.250  \n"
+       << "J01  38448820.047 7 223224404.839 7\n"
+       << "> 2014 10 31 20 28 15.0000000  0  2\n"
+       << "G15  20673040.539 6\n"
+       << "G 7  21673040.539 6 108637434.531 6        48.000  \n"
+       << "> 2014 10 31 20 28 30.0000000  4  1\n"
+       << "a comment                                                   COMMENT             \n"
+       << "> 2014 10 31 20 28 45.0000000  0  1\n"
+       << "G05  23463576.977 5 123301955.861 5                \n";
+   ofs.close();
+
+   try
+   {
+      gpstk::Rinex3ObsStream reuseStrm(fn.c_str()), newStrm(fn.c_str());
+      gpstk::Rinex3ObsHeader hdr;
+      gpstk::Rinex3ObsData reused;
+      reuseStrm >> hdr;
+      newStrm >> hdr;
+      unsigned count = 0;
+      while (reuseStrm >> reused)
+      {
+         gpstk::Rinex3ObsData fresh;
+         TUASSERT(static_cast<bool>(newStrm >> fresh));
+         TUASSERTE(gpstk::CommonTime, fresh.time, reused.time);
+         TUASSERTE(short, fresh.epochFlag, reused.epochFlag);
+         TUASSERTE(size_t, fresh.obs.size(), reused.obs.size());
+         gpstk::Rinex3ObsData::DataMap::const_iterator fi, ri;
+         for (fi = fresh.obs.begin(), ri = reused.obs.begin();
+              (fi != fresh.obs.end()) && (ri != reused.obs.end()); fi++, ri++)
+         {
+            TUASSERTE(gpstk::RinexSatID, fi->first, ri->first);
+            TUASSERTE(size_t, fi->second.size(), ri->second.size());
+            for (unsigned i = 0; i < fi->second.size(); i++)
+            {
+               TUASSERTFE(fi->second[i].data, ri->second[i].data);
+               TUASSERTE(bool, fi->second[i].dataBlank,
+                         ri->second[i].dataBlank);
+               TUASSERTE(short, fi->second[i].lli, ri->second[i].lli);
+               TUASSERTE(bool, fi->second[i].lliBlank,
+                         ri->second[i].lliBlank);
+               TUASSERTE(short, fi->second[i].ssi, ri->second[i].ssi);
+               TUASSERTE(bool, fi->second[i].ssiBlank,
+                         ri->second[i].ssiBlank);
+            }
+         }
+         switch (count)
+         {
+            case 0:
+                  // QZSS PRN kludge
+               TUASSERTE(size_t, 1, reused.obs.count(
+                            gpstk::RinexSatID(193,
+                                              gpstk::SatelliteSystem::QZSS)));
+               break;
+            case 1:
+                  // G05 and J01 must not be left over from the last epoch
+               TUASSERTE(size_t, 2, reused.obs.size());
+               TUASSERTE(size_t, 1, reused.obs.count(gpstk::RinexSatID("G07")));
+                  // short line is padded with blanks
+               TUASSERTE(bool, true,
+                         reused.obs[gpstk::RinexSatID("G15")][2].dataBlank);
+               break;
+            case 2:
+               TUASSERTE(size_t, 0, reused.obs.size());
+               TUASSERT(reused.auxHeader.commentList.size() == 1);
+               break;
+            case 3:
+               TUASSERTE(size_t, 1, reused.obs.size());
+               TUASSERT(reused.auxHeader.commentList.empty());
+               break;
+         }
+         count++;
+      }
+      TUASSERTE(unsigned, 4, count);
+   }
+   catch (gpstk::Exception& exc)
+   {
+      cerr << exc << endl;
+      TUFAIL("Unexpected exception");
+   }
+   TURETURN();
+}
+
+
+unsigned Rinex3ObsOther_T ::
+obsTypeIndexTest()
+{
+   TUDEF("Rinex3ObsHeader", "getSysObsTypes");
+   double cv = gpstk::Rinex3ObsBase::currentVersion;
+   gpstk::Rinex3ObsHeader hdr;
+   gpstk::RinexObsID gc1c("GC1C", cv), gl1c("GL1C", cv), rc1c("RC1C", cv);
+   hdr.mapObsTypes["G"].push_back(gc1c);
+   hdr.mapObsTypes["G"].push_back(gl1c);
+   hdr.mapObsTypes["R"].push_back(rc1c);
+      // not built yet, so getObsIndex uses the maps
+   TUASSERT(!hdr.sysObsTypesValid);
+   TUASSERT(!hdr.isObsTypeIndexCurrent());
+   TUASSERTE(size_t, 1, hdr.getObsIndex(gpstk::SatelliteSystem::GPS, gl1c));
+   TUASSERT(!hdr.sysObsTypesValid);
+   TUTHROW(hdr.getSysObsTypes(gpstk::SatelliteSystem::GPS));
+   hdr.buildObsTypeIndex();
+   TUASSERT(hdr.sysObsTypesValid);
+   TUASSERT(hdr.isObsTypeIndexCurrent());
+   const gpstk::Rinex3ObsHeader::SysObsTypes *sot;
+   TUCATCH(sot = hdr.getSysObsTypes(gpstk::SatelliteSystem::GPS));
+   TUASSERT(sot != nullptr);
+   TUASSERTE(size_t, 2, sot->obsTypes.size());
+   TUASSERTE(gpstk::RinexObsID, gl1c, sot->obsTypes[1]);
+   TUASSERT(hdr.getSysObsTypes(gpstk::SatelliteSystem::BeiDou) == nullptr);
+   TUASSERTE(size_t, 0, hdr.getObsIndex(gpstk::SatelliteSystem::Glonass,rc1c));
+   TUTHROW(hdr.getObsIndex(gpstk::SatelliteSystem::Glonass, gl1c));
+   TUTHROW(hdr.getObsIndex(gpstk::SatelliteSystem::BeiDou, gl1c));
+
+      // compare with the maps for a RINEX 2 file
+   std::string fn = gpstk::getPathData() + gpstk::getFileSep() +
+      "mixed211.05o";
+   try
+   {
+      gpstk::Rinex3ObsStream strm(fn.c_str());
+      strm >> hdr;
+      TUASSERT(hdr.sysObsTypesValid);
+      TUASSERT(strm.header.sysObsTypesValid);
+      gpstk::Rinex3ObsHeader::RinexObsMap::const_iterator moti;
+      for (moti = hdr.mapObsTypes.begin(); moti != hdr.mapObsTypes.end();
+           moti++)
+      {
+         gpstk::RinexSatID sat(moti->first);
+         sot = hdr.getSysObsTypes(sat.system);
+         TUASSERT(sot != nullptr);
+         if (sot == nullptr)
+            continue;
+         TUASSERT(sot->obsTypes == moti->second);
+         for (unsigned i = 0; i < moti->second.size(); i++)
+         {
+            TUASSERTE(size_t, hdr.getObsIndex(moti->first, moti->second[i]),
+                      hdr.getObsIndex(sat.system, moti->second[i]));
+         }
+         TUASSERTE(size_t, hdr.R2ObsTypes.size(), sot->r2Index.size());
+         for (unsigned i = 0; i < sot->r2Index.size(); i++)
+         {
+            gpstk::RinexObsID r3 =
+               hdr.mapSysR2toR3ObsID[moti->first][hdr.R2ObsTypes[i]];
+            if (sot->r2Index[i] < 0)
+            {
+               TUASSERTE(std::string, "   ", r3.asString());
+            }
+            else
+            {
+               TUASSERTE(gpstk::RinexObsID, r3,
+                         sot->obsTypes[sot->r2Index[i]]);
+            }
+         }
+      }
+   }
+   catch (gpstk::Exception& exc)
+   {
+      cerr << exc << endl;
+      TUFAIL("Unexpected exception");
+   }
+   TURETURN();
+}
+
+
+unsigned Rinex3ObsOther_T ::
+obsTypeEditTest()
+{
+   TUDEF("Rinex3ObsData", "getObs");
+   std::string fn = gpstk::getPathData() + gpstk::getFileSep() +
+      "test_input_rinex3_76193040.14o";
+   try
+   {
+      gpstk::Rinex3ObsStream strm(fn.c_str());
+      gpstk::Rinex3ObsHeader hdr;
+      gpstk::Rinex3ObsData rod;
+      strm >> hdr;
+      TUASSERT(static_cast<bool>(strm >> rod));
+      TUASSERT(hdr.sysObsTypesValid);
+      gpstk::Rinex3ObsHeader::RinexObsVec orig = hdr.mapObsTypes["G"];
+      TUASSERT(orig.size() > 2);
+      if (orig.size() <= 2)
+         TURETURN();
+      gpstk::Rinex3ObsData::DataMap before(rod.obs);
+         // Remove the first GPS observation from the header and the
+         // data, as RinEdit does.
+      hdr.mapObsTypes["G"].erase(hdr.mapObsTypes["G"].begin());
+      TUASSERT(!hdr.isObsTypeIndexCurrent());
+      hdr.buildObsTypeIndex();
+      TUASSERT(hdr.isObsTypeIndexCurrent());
+      gpstk::Rinex3ObsData::DataMap::iterator oi;
+      for (oi = rod.obs.begin(); oi != rod.obs.end(); oi++)
+      {
+         if (oi->first.system == gpstk::SatelliteSystem::GPS)
+            oi->second.erase(oi->second.begin());
+      }
+      unsigned nsat = 0;
+      for (oi = before.begin(); oi != before.end(); oi++)
+      {
+         if (oi->first.system != gpstk::SatelliteSystem::GPS)
+            continue;
+         nsat++;
+         for (unsigned i = 1; i < orig.size(); i++)
+         {
+            TUASSERTE(size_t, i-1, hdr.getObsIndex(oi->first.system,
+                                                   orig[i]));
+            TUASSERTFE(oi->second[i].data,
+                       rod.getObs(oi->first, orig[i], hdr).data);
+         }
+         TUTHROW(rod.getObs(oi->first, orig[0], hdr));
+      }
+      TUASSERT(nsat > 0);
+         // Replace an observation type without changing the size,
+         // in a copy of the header.
+      gpstk::Rinex3ObsHeader copy(hdr);
+      copy.mapObsTypes["G"][0] = orig[0];
+      TUASSERT(!copy.isObsTypeIndexCurrent());
+      copy.buildObsTypeIndex();
+      const gpstk::Rinex3ObsHeader::SysObsTypes *sot =
+         copy.getSysObsTypes(gpstk::SatelliteSystem::GPS);
+      TUASSERT(sot != nullptr);
+      if (sot != nullptr)
+      {
+         TUASSERTE(gpstk::RinexObsID, orig[0], sot->obsTypes[0]);
+      }
+      TUASSERTE(size_t, 0, copy.getObsIndex(gpstk::SatelliteSystem::GPS,
+                                            orig[0]));
+      TUTHROW(copy.getObsIndex(gpstk::SatelliteSystem::GPS, orig[1]));
+         // the original is unaffected
+      TUASSERTE(size_t, 0, hdr.getObsIndex(gpstk::SatelliteSystem::GPS,
+                                           orig[1]));
+   }
+   catch (gpstk::Exception& exc)
+   {
+      cerr << exc << endl;
+      TUFAIL("Unexpected exception");
+   }
+   TURETURN();
+}
+
+
 int main()
 {
    unsigned errorTotal = 0;
@@ -604,6 +875,9 @@ int main()
    errorTotal += testClass.channelNumTest();
    errorTotal += testClass.ionoDelayTest();
    errorTotal += testClass.obsIDVersionTest();
+   errorTotal += testClass.recordReuseTest();
+   errorTotal += testClass.obsTypeIndexTest();
+   errorTotal += testClass.obsTypeEditTest();
    cout << "Total Failures for " << __FILE__ << ": " << errorTotal << endl;
    return errorTotal;
 }
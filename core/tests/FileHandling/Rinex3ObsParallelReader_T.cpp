@@ -0,0 +1,225 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+
+#include <fstream>
+#include <sstream>
+#include "Rinex3ObsParallelReader.hpp"
+#include "Rinex3ObsStream.hpp"
+#include "build_config.h"
+#include "TestUtil.hpp"
+
+using namespace std;
+using namespace gpstk;
+
+class Rinex3ObsParallelReader_T
+{
+public:
+   Rinex3ObsParallelReader_T()
+   {
+      init();
+   }
+
+   void init();
+
+      /// Make sure records are identical to those read serially.
+   int readTest();
+      /// Make sure errors are reported at the same record.
+   int errorTest();
+
+private:
+      /// Dump all the records in a file read using Rinex3ObsStream.
+   string serialDump(const string& fn);
+      /// Dump all the records in a file read using the parallel reader.
+   string parallelDump(const string& fn, unsigned threads, size_t chunk);
+      /// Dump the text of an exception, without the locations.
+   static void dumpError(ostream& s, const Exception& e);
+
+   string obsFile;
+   string eventFile;
+   string v2File;
+   string badFile;
+};
+
+
+void Rinex3ObsParallelReader_T ::
+init()
+{
+   TestUtil testUtil;
+   string dp = gpstk::getPathData() + gpstk::getFileSep();
+   string op = gpstk::getPathTestTemp() + gpstk::getFileSep();
+
+   obsFile = dp + "test_input_rinex3_76193040.14o";
+   eventFile = op + "test_output_Rinex3ObsParallelReader_events.14o";
+   v2File = dp + "test_input_rinex2_obs_RinexObsFile.06o";
+   badFile = dp + "test_input_rinex3_obs_BadEpochFlag.15o";
+
+      // Add a header event before every third epoch, including a
+      // comment starting with '>' that must not be taken for an
+      // epoch line.
+   ifstream ifs(obsFile.c_str());
+   ofstream ofs(eventFile.c_str());
+   string line;
+   unsigned epochs = 0;
+   while (getline(ifs, line))
+   {
+      if (!line.empty() && (line[0] == '>') && ((++epochs % 3) == 0))
+      {
+         ofs << ">                              4  2\n"
+             << ">not an epoch                                               COMMENT\n"
+             << "event " << epochs << "                                                    COMMENT\n";
+      }
+      ofs << line << "\n";
+   }
+}
+
+
+void Rinex3ObsParallelReader_T ::
+dumpError(ostream& s, const Exception& e)
+{
+   for (size_t i = 0; i < e.getTextCount(); i++)
+   {
+      s << e.getText(i) << endl;
+   }
+}
+
+
+string Rinex3ObsParallelReader_T ::
+serialDump(const string& fn)
+{
+   ostringstream oss;
+   Rinex3ObsStream strm(fn.c_str());
+   strm.exceptions(ios::failbit);
+   Rinex3ObsHeader hdr;
+   Rinex3ObsData data;
+   strm >> hdr;
+   hdr.dump(oss);
+   try
+   {
+      while (strm >> data)
+      {
+         data.dump(oss, hdr);
+      }
+   }
+   catch (Exception& e)
+   {
+      dumpError(oss, e);
+   }
+   return oss.str();
+}
+
+
+string Rinex3ObsParallelReader_T ::
+parallelDump(const string& fn, unsigned threads, size_t chunk)
+{
+   ostringstream oss;
+   Rinex3ObsParallelReader reader(fn, threads, chunk);
+   Rinex3ObsHeader hdr(reader.getHeader());
+   Rinex3ObsData data;
+   hdr.dump(oss);
+   try
+   {
+      while (reader.read(data))
+      {
+         data.dump(oss, hdr);
+      }
+   }
+   catch (Exception& e)
+   {
+      dumpError(oss, e);
+   }
+   return oss.str();
+}
+
+
+int Rinex3ObsParallelReader_T ::
+readTest()
+{
+   TUDEF("Rinex3ObsParallelReader", "read");
+   string files[] = { obsFile, eventFile, v2File };
+   for (unsigned i = 0; i < 3; i++)
+   {
+      string expected = serialDump(files[i]);
+      TUASSERT(expected.length() > 0);
+         // One chunk, a few chunks, and a chunk per epoch.
+      TUASSERTE(string, expected, parallelDump(files[i], 1, 1048576));
+      TUASSERTE(string, expected, parallelDump(files[i], 2, 4096));
+      TUASSERTE(string, expected, parallelDump(files[i], 4, 1));
+   }
+   Rinex3ObsParallelReader reader(obsFile, 2, 1);
+   TUASSERT(reader.getNumChunks() > 1);
+      // Closing before reading everything must stop the workers.
+   Rinex3ObsData data;
+   TUASSERT(reader.read(data));
+   reader.close();
+   TUASSERTE(size_t, 0, reader.getNumChunks());
+   TURETURN();
+}
+
+
+int Rinex3ObsParallelReader_T ::
+errorTest()
+{
+   TUDEF("Rinex3ObsParallelReader", "read");
+   string expected = serialDump(badFile);
+   TUASSERTE(string, expected, parallelDump(badFile, 1, 1048576));
+   TUASSERTE(string, expected, parallelDump(badFile, 3, 1));
+   try
+   {
+      Rinex3ObsParallelReader reader(badFile + ".missing");
+      TUFAIL("Did not throw for a missing file");
+   }
+   catch (Exception& e)
+   {
+      TUPASS("Exception");
+   }
+   TURETURN();
+}
+
+
+int main()
+{
+   int errorTotal = 0;
+   Rinex3ObsParallelReader_T testClass;
+
+   errorTotal += testClass.readTest();
+   errorTotal += testClass.errorTest();
+
+   cout << "Total Failures for " << __FILE__ << ": " << errorTotal << endl;
+
+   return( errorTotal );
+}
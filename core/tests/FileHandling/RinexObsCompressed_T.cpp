@@ -0,0 +1,320 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+
+#include <fstream>
+#include <sstream>
+#include "Rinex3ObsStream.hpp"
+#include "Rinex3ObsHeader.hpp"
+#include "Rinex3ObsData.hpp"
+#include "RinexObsStream.hpp"
+#include "RinexObsHeader.hpp"
+#include "RinexObsData.hpp"
+#include "CompressedFileBuf.hpp"
+#include "build_config.h"
+#include "TestUtil.hpp"
+
+using namespace std;
+using namespace gpstk;
+
+   /// RINEX 2 records don't use the header when dumped.
+static void dumpData(ostream& s, RinexObsData& data, RinexObsHeader& hdr)
+{
+   data.dump(s);
+}
+
+static void dumpData(ostream& s, Rinex3ObsData& data, Rinex3ObsHeader& hdr)
+{
+   data.dump(s, hdr);
+}
+
+class RinexObsCompressed_T
+{
+public:
+   RinexObsCompressed_T()
+   {
+      init();
+   }
+
+   void init();
+
+      /// Read Compact RINEX 3 data compressed with Unix compress.
+   int crinex3Test();
+      /// Read gzip compressed RINEX 3 data.
+   int gzipTest();
+      /// Read Compact RINEX 1 data with both RINEX 2 and 3 streams.
+   int crinex1Test();
+      /// Make sure invalid data is reported as such.
+   int errorTest();
+
+private:
+      /** Dump the header and all records in a file.
+       * @param[out] filtered set to whether the stream used any
+       *   input filters. */
+   template <class Stream, class Header, class Data>
+   string dump(const string& fn, bool& filtered);
+
+   string dataPath;
+   string tempPath;
+      /// RINEX 3 file with header events, matching the Compact RINEX file.
+   string eventFile;
+};
+
+
+void RinexObsCompressed_T ::
+init()
+{
+   TestUtil testUtil;
+   dataPath = gpstk::getPathData() + gpstk::getFileSep();
+   tempPath = gpstk::getPathTestTemp() + gpstk::getFileSep();
+   eventFile = tempPath + "test_output_RinexObsCompressed_events.14o";
+
+      // Add a comment event before every third epoch, as was done
+      // to make test_input_rinex3_76193040_events.14d.Z
+   ifstream ifs((dataPath + "test_input_rinex3_76193040.14o").c_str());
+   ofstream ofs(eventFile.c_str());
+   string line;
+   unsigned epochs = 0;
+   while (getline(ifs, line))
+   {
+      if (!line.empty() && (line[0] == '>') && ((++epochs % 3) == 0))
+      {
+         string comment1(">not an epoch"), comment2("event " +
+                                                    StringUtils::asString(epochs));
+         comment1.resize(60, ' ');
+         comment2.resize(60, ' ');
+         ofs << ">                              4  2\n"
+             << comment1 << "COMMENT\n"
+             << comment2 << "COMMENT\n";
+      }
+      ofs << line << "\n";
+   }
+}
+
+
+template <class Stream, class Header, class Data>
+string RinexObsCompressed_T ::
+dump(const string& fn, bool& filtered)
+{
+   ostringstream oss;
+   Stream strm(fn.c_str());
+   strm.exceptions(ios::failbit);
+   filtered = strm.isFiltered();
+   Header hdr;
+   Data data;
+   strm >> hdr;
+   hdr.dump(oss);
+   while (strm >> data)
+   {
+      dumpData(oss, data, hdr);
+   }
+   oss << strm.lineNumber << " " << strm.recordNumber << endl;
+   return oss.str();
+}
+
+
+int RinexObsCompressed_T ::
+crinex3Test()
+{
+   TUDEF("HatanakaBuf", "underflow");
+   bool filtered;
+   string expected;
+   try
+   {
+      expected = dump<Rinex3ObsStream,Rinex3ObsHeader,Rinex3ObsData>(
+         eventFile, filtered);
+      TUASSERT(!filtered);
+      string got = dump<Rinex3ObsStream,Rinex3ObsHeader,Rinex3ObsData>(
+         dataPath + "test_input_rinex3_76193040_events.14d.Z", filtered);
+      TUASSERT(filtered);
+      TUASSERT(expected.length() > 0);
+      TUASSERTE(string, expected, got);
+   }
+   catch (Exception& e)
+   {
+      TUFAIL("Unexpected exception: " + e.what());
+   }
+   TURETURN();
+}
+
+
+int RinexObsCompressed_T ::
+gzipTest()
+{
+   TUDEF("CompressedFileBuf", "underflow");
+      // gzip is only decoded when the library is built with zlib
+   if (!CompressedFileBuf::canDecode(CompressedFileBuf::Gzip))
+   {
+      TUPASS("gzip not supported in this build, skipped");
+      TURETURN();
+   }
+   bool filtered;
+   string expected;
+   try
+   {
+      expected = dump<Rinex3ObsStream,Rinex3ObsHeader,Rinex3ObsData>(
+         dataPath + "test_input_rinex3_76193040.14o", filtered);
+      TUASSERT(!filtered);
+      string got = dump<Rinex3ObsStream,Rinex3ObsHeader,Rinex3ObsData>(
+         dataPath + "test_input_rinex3_76193040.14o.gz", filtered);
+      TUASSERT(filtered);
+      TUASSERTE(string, expected, got);
+   }
+   catch (Exception& e)
+   {
+      TUFAIL("Unexpected exception: " + e.what());
+   }
+   TURETURN();
+}
+
+
+int RinexObsCompressed_T ::
+crinex1Test()
+{
+   TUDEF("HatanakaBuf", "underflow");
+   string rinexFile = dataPath + "test_input_rinex2_obs_RinexObsFile.06o";
+   string crinexFile = dataPath + "test_input_rinex2_obs_RinexObsFile.06d";
+   bool filtered;
+   try
+   {
+      string expected = dump<RinexObsStream,RinexObsHeader,RinexObsData>(
+         rinexFile, filtered);
+      TUASSERT(!filtered);
+      string got = dump<RinexObsStream,RinexObsHeader,RinexObsData>(
+         crinexFile, filtered);
+      TUASSERT(filtered);
+      TUASSERTE(string, expected, got);
+
+      expected = dump<Rinex3ObsStream,Rinex3ObsHeader,Rinex3ObsData>(
+         rinexFile, filtered);
+      got = dump<Rinex3ObsStream,Rinex3ObsHeader,Rinex3ObsData>(
+         crinexFile, filtered);
+      TUASSERTE(string, expected, got);
+   }
+   catch (Exception& e)
+   {
+      TUFAIL("Unexpected exception: " + e.what());
+   }
+   TURETURN();
+}
+
+
+int RinexObsCompressed_T ::
+errorTest()
+{
+   TUDEF("HatanakaBuf", "underflow");
+      // Take a valid Compact RINEX file and drop the initialization
+      // from the first satellite's data.
+   string badFile = tempPath + "test_output_RinexObsCompressed_bad.06d";
+   ifstream ifs((dataPath + "test_input_rinex2_obs_RinexObsFile.06d").c_str());
+   ofstream ofs(badFile.c_str());
+   string line;
+   unsigned dataLine = 0;
+   while (getline(ifs, line))
+   {
+      if (dataLine > 0)
+      {
+         if (++dataLine == 4)
+            line = line.substr(2);
+      }
+      else if (line.find("END OF HEADER") != string::npos)
+      {
+         dataLine = 1;
+      }
+      ofs << line << "\n";
+   }
+   ofs.close();
+
+   Rinex3ObsStream strm(badFile.c_str());
+   strm.exceptions(ios::failbit);
+   Rinex3ObsHeader hdr;
+   Rinex3ObsData data;
+   strm >> hdr;
+   try
+   {
+      strm >> data;
+      TUFAIL("Did not throw for uninitialized data");
+   }
+   catch (FFStreamError& e)
+   {
+      TUASSERT(e.getText(0).find("without initialization") != string::npos);
+   }
+
+      // A truncated gzip file is an error, not just the end of the data.
+   if (!CompressedFileBuf::canDecode(CompressedFileBuf::Gzip))
+   {
+      TURETURN();
+   }
+   string truncFile = tempPath + "test_output_RinexObsCompressed_trunc.gz";
+   ifstream gzs((dataPath + "test_input_rinex3_76193040.14o.gz").c_str(),
+                ios::in | ios::binary);
+   vector<char> buf(8000);
+   gzs.read(&buf[0], buf.size());
+   ofstream truncs(truncFile.c_str(), ios::out | ios::binary);
+   truncs.write(&buf[0], gzs.gcount());
+   truncs.close();
+   Rinex3ObsStream tstrm(truncFile.c_str());
+   tstrm.exceptions(ios::failbit);
+   try
+   {
+      tstrm >> hdr;
+      while (tstrm >> data)
+         ;
+      TUFAIL("Did not throw for truncated file");
+   }
+   catch (FFStreamError& e)
+   {
+      TUPASS("FFStreamError");
+   }
+   TURETURN();
+}
+
+
+int main()
+{
+   int errorTotal = 0;
+   RinexObsCompressed_T testClass;
+
+   errorTotal += testClass.crinex3Test();
+   errorTotal += testClass.gzipTest();
+   errorTotal += testClass.crinex1Test();
+   errorTotal += testClass.errorTest();
+
+   cout << "Total Failures for " << __FILE__ << ": " << errorTotal << endl;
+
+   return( errorTotal );
+}
@@ -0,0 +1,213 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+#include "TestUtil.hpp"
+#include "ArchiveTable.hpp"
+#include "CivilTime.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <iostream>
+
+using namespace std;
+
+   // number of fields in the test records
+static const unsigned nf = 6;
+
+class ArchiveTable_T
+{
+public:
+      /** Make the fields of record k: zero, constant, decimal
+       * positions, values that are not decimal numbers, special
+       * values, and clock biases as read from RINEX clock files. */
+   static void makeRecord(unsigned k, double *f)
+   {
+      f[0] = 0.0;
+      f[1] = pow(1.25, 5.0);
+      f[2] = double(llround(26560.0 * sin(k * 0.02) * 1.e6)) / 1.e6;
+      f[3] = k * M_PI / 7.0;
+      switch (k % 5)
+      {
+         case 0: f[4] = -0.0; break;
+         case 1: f[4] = numeric_limits<double>::quiet_NaN(); break;
+         case 2: f[4] = numeric_limits<double>::infinity(); break;
+         case 3: f[4] = 1.e-300; break;
+         default: f[4] = 12.5; break;
+      }
+      char buf[32];
+      sprintf(buf, "%.12E", 1.234e-4 + k * 2.345678e-9);
+      f[5] = strtod(buf, NULL);
+   }
+
+      /// True if the n values are the same to the bit.
+   static bool identical(const double *a, const double *b, unsigned n)
+   {
+      return memcmp(a, b, n * sizeof(double)) == 0;
+   }
+
+   unsigned codecTest()
+   {
+      TUDEF("ArchiveTable", "getRecords");
+
+      const unsigned n = 3 * gpstk::ArchiveTable::BlockSize + 4;
+      gpstk::CommonTime t0(gpstk::CivilTime(2015,1,2,0,0,0.0,
+                                            gpstk::TimeSystem::GPS));
+      gpstk::ArchiveTable table(nf);
+      vector<double> all(n * nf);
+      for (unsigned k = 0; k < n; k++)
+      {
+         makeRecord(k, &all[k*nf]);
+         TUASSERT(table.append(t0 + k * 900.0, &all[k*nf]));
+      }
+      TUASSERTE(size_t, n, table.size());
+      TUASSERTE(unsigned, nf, table.numFields());
+      TUASSERTE(double, 900.0, table.getStep());
+      TUASSERT(!table.hasHoles());
+      TUASSERTE(gpstk::CommonTime, t0 + (n-1) * 900.0, table.lastTime());
+
+         // every record, alone and in ranges across the blocks
+      vector<double> got;
+      unsigned nbad = 0;
+      for (unsigned k = 0; k < n; k++)
+      {
+         table.getRecords(k, k, got);
+         if (got.size() != nf || !identical(&got[0], &all[k*nf], nf) ||
+             table.getTime(k) != t0 + k * 900.0)
+            nbad++;
+      }
+      TUASSERTE(unsigned, 0, nbad);
+      for (unsigned j1 = 0; j1 < n; j1 += 7)
+      {
+         for (unsigned j2 = j1; j2 < n; j2 += 13)
+         {
+            table.getRecords(j1, j2, got);
+            if (got.size() != (j2-j1+1) * nf ||
+                !identical(&got[0], &all[j1*nf], (j2-j1+1) * nf))
+               nbad++;
+         }
+      }
+      TUASSERTE(unsigned, 0, nbad);
+
+         // at and between the records, and outside the table
+      for (double dt = -1000.0; dt < n * 900.0 + 1000.0; dt += 150.0)
+      {
+         size_t exp = 0;
+         while (exp < n && table.getTime(exp) < t0 + dt)
+            exp++;
+         if (table.lowerBound(t0 + dt) != exp)
+            nbad++;
+      }
+      TUASSERTE(unsigned, 0, nbad);
+
+      table.shrink();
+      TUASSERT(table.memoryUsage() < n * nf * sizeof(double) / 2);
+
+         // appending after shrink() reopens the partial last block
+      const unsigned n2 = n + gpstk::ArchiveTable::BlockSize;
+      all.resize(n2 * nf);
+      for (unsigned k = n; k < n2; k++)
+      {
+         makeRecord(k, &all[k*nf]);
+         TUASSERT(table.append(t0 + k * 900.0, &all[k*nf]));
+      }
+      table.getRecords(0, n2-1, got);
+      TUASSERT(identical(&got[0], &all[0], n2 * nf));
+      TURETURN();
+   }
+
+   unsigned gridTest()
+   {
+      TUDEF("ArchiveTable", "append");
+
+      gpstk::CommonTime t0(gpstk::CivilTime(2015,1,2,0,0,0.0,
+                                            gpstk::TimeSystem::GPS));
+      gpstk::ArchiveTable table(nf);
+      double f[nf];
+      makeRecord(0, f);
+      TUASSERT(table.empty());
+      TUASSERTE(size_t, 0, table.lowerBound(t0));
+      TUASSERT(table.append(t0, f));
+      TUASSERTE(size_t, 0, table.lowerBound(t0));
+      TUASSERTE(size_t, 1, table.lowerBound(t0 + 1.0));
+         // the second record sets the step, which must be positive
+      TUASSERT(!table.append(t0, f));
+      TUASSERT(!table.append(t0 - 30.0, f));
+      TUASSERT(table.append(t0 + 30.0, f));
+      TUASSERTE(double, 30.0, table.getStep());
+         // then records must be later, on the grid
+      TUASSERT(!table.append(t0 + 30.0, f));
+      TUASSERT(!table.append(t0 + 75.0, f));
+      TUASSERT(!table.append(t0 + 60.0 + 1.e-7, f));
+      TUASSERT(table.append(t0 + 60.0, f));
+      TUASSERT(!table.hasHoles());
+         // skipping slots
+      TUASSERT(table.append(t0 + 150.0, f));
+      TUASSERT(table.hasHoles());
+      TUASSERT(table.append(t0 + 180.0, f));
+      for (unsigned k = 0; k < 100; k++)
+         TUASSERT(table.append(t0 + 210.0 + 60.0 * k, f));
+      TUASSERTE(size_t, 105, table.size());
+      TUASSERTE(gpstk::CommonTime, t0 + 150.0, table.getTime(3));
+      TUASSERTE(gpstk::CommonTime, t0 + 6150.0, table.lastTime());
+      TUASSERTE(size_t, 3, table.lowerBound(t0 + 61.0));
+      TUASSERTE(size_t, 3, table.lowerBound(t0 + 150.0));
+      TUASSERTE(size_t, 4, table.lowerBound(t0 + 151.0));
+      TUASSERTE(size_t, 6, table.lowerBound(t0 + 240.0));
+      TUASSERTE(size_t, 105, table.lowerBound(t0 + 6151.0));
+
+      vector<double> got;
+      table.getRecords(104, 104, got);
+      TUASSERT(identical(&got[0], f, nf));
+      TURETURN();
+   }
+};
+
+
+int main() //Main function to initialize and run all tests above
+{
+   unsigned errorTotal = 0;
+   ArchiveTable_T testClass;
+
+   errorTotal += testClass.codecTest();
+   errorTotal += testClass.gridTest();
+
+   std::cout << "Total Failures for " << __FILE__ << ": " << errorTotal
+             << std::endl;
+   return errorTotal; //Return the total number of errors
+}
@@ -0,0 +1,358 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+
+#include "TestUtil.hpp"
+#include "ChebyshevEphemerisStore.hpp"
+#include "SP3EphemerisStore.hpp"
+#include "Rinex3EphemerisStore.hpp"
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+class ChebyshevEphemerisStore_T
+{
+public:
+   ChebyshevEphemerisStore_T() // Default Constructor, set the file names
+   {
+      std::string dataFilePath = gpstk::getPathData();
+      std::string fileSep = gpstk::getFileSep();
+      inputSP3Data = dataFilePath + fileSep +
+         "test_input_sp3_nav_ephemerisData.sp3";
+      inputRN3Data = dataFilePath + fileSep + "mixed.06n";
+   }
+   ~ChebyshevEphemerisStore_T() {} // Default Desructor
+
+
+      /** Compare fit with source for sats every step seconds in
+       * [t0,t1].  Return the worst position and clock differences
+       * and the number of times source had data that fit did not. */
+   static void compare(const gpstk::XvtStore<gpstk::SatID>& source,
+                       const gpstk::ChebyshevEphemerisStore& fit,
+                       const set<gpstk::SatID>& sats,
+                       const gpstk::CommonTime& t0,
+                       const gpstk::CommonTime& t1, double step,
+                       double& posErr, double& clkErr, unsigned& missing)
+   {
+      posErr = clkErr = 0.0;
+      missing = 0;
+      for (set<gpstk::SatID>::const_iterator si = sats.begin();
+           si != sats.end(); ++si)
+      {
+         for (gpstk::CommonTime t = t0; t <= t1; t += step)
+         {
+            gpstk::Xvt src = source.computeXvt(*si, t);
+            if (src.health == gpstk::Xvt::HealthStatus::Unavailable)
+               continue;
+            gpstk::Xvt cheb = fit.computeXvt(*si, t);
+            if (cheb.health == gpstk::Xvt::HealthStatus::Unavailable)
+            {
+               missing++;
+               continue;
+            }
+            posErr = std::max(posErr, (cheb.x - src.x).mag());
+            clkErr = std::max(clkErr, std::abs(cheb.clkbias - src.clkbias));
+         }
+      }
+   }
+
+
+      /// Fit part of an SP3 file and check the fit against it.
+   unsigned sp3FitTest()
+   {
+      TUDEF("ChebyshevEphemerisStore", "fit");
+      try
+      {
+         gpstk::SP3EphemerisStore sp3;
+         sp3.loadFile(inputSP3Data);
+         set<gpstk::SatID> sats;
+         sats.insert(gpstk::SatID(1, gpstk::SatelliteSystem::GPS));
+         sats.insert(gpstk::SatID(15, gpstk::SatelliteSystem::GPS));
+         sats.insert(gpstk::SatID(31, gpstk::SatelliteSystem::GPS));
+            // stay clear of the ends, where the source can't interpolate
+         gpstk::CommonTime t0(sp3.getInitialTime() + 7200.),
+            t1(t0 + 6*3600.);
+
+         gpstk::ChebyshevEphemerisStore cheb;
+         cheb.setClockTolerance(1e-9);
+         for (set<gpstk::SatID>::const_iterator si = sats.begin();
+              si != sats.end(); ++si)
+            cheb.fit(sp3, *si, t0, t1);
+         TUASSERT(cheb.getIndexSet() == sats);
+         TUASSERTE(gpstk::CommonTime, t0, cheb.getInitialTime());
+         TUASSERTE(gpstk::CommonTime, t1, cheb.getFinalTime());
+         TUASSERT(cheb.getMaxPositionError() <= 1e-3);
+         TUASSERT(cheb.getMaxClockError() <= 1e-9);
+
+            // between the check points the tolerance may be exceeded
+            // slightly
+         double posErr, clkErr;
+         unsigned missing;
+         compare(sp3, cheb, sats, t0, t1, 97., posErr, clkErr, missing);
+         TUASSERTE(unsigned, 0, missing);
+         TUASSERT(posErr < 2e-3);
+         TUASSERT(clkErr < 2e-9);
+
+            // velocity and drift are the derivatives of the fit
+         gpstk::SatID sat(15, gpstk::SatelliteSystem::GPS);
+         gpstk::Xvt a(cheb.getXvt(sat, t0 + 1000.)),
+            b(cheb.getXvt(sat, t0 + 1001.)), mid(cheb.getXvt(sat, t0 + 1000.5));
+         TUASSERT(((b.x - a.x) - mid.v).mag() < 1e-4);
+         TUASSERTFEPS(b.clkbias - a.clkbias, mid.clkdrift, 1e-14);
+         TUASSERTE(gpstk::Xvt::HealthStatus, gpstk::Xvt::HealthStatus::Unused,
+                   mid.health);
+         TUASSERTE(gpstk::ReferenceFrame,
+                   sp3.getXvt(sat, t0 + 1000.5).frame, mid.frame);
+
+            // outside the fitted span and for other satellites
+         gpstk::SatID other(2, gpstk::SatelliteSystem::GPS);
+         TUASSERT(!cheb.isPresent(other));
+         TUTHROW(cheb.getXvt(other, t0 + 1000.));
+         TUTHROW(cheb.getXvt(sat, t0 - 1.));
+         TUTHROW(cheb.getXvt(sat, t1 + 1.));
+         TUASSERTE(gpstk::Xvt::HealthStatus,
+                   gpstk::Xvt::HealthStatus::Unavailable,
+                   cheb.computeXvt(sat, t1 + 1.).health);
+         TUASSERTE(gpstk::Xvt::HealthStatus,
+                   gpstk::Xvt::HealthStatus::Unavailable,
+                   cheb.getSVHealth(other, t0));
+
+            // refitting part of the span keeps the rest
+         cheb.fit(sp3, sat, t0 + 3000., t0 + 7000.);
+         compare(sp3, cheb, sats, t0, t1, 97., posErr, clkErr, missing);
+         TUASSERTE(unsigned, 0, missing);
+         TUASSERT(posErr < 2e-3);
+
+            // edit keeps the segments touching the interval
+         cheb.edit(t0 + 4*3600., t1);
+         TUASSERT(cheb.getInitialTime() > t0);
+         TUASSERT(cheb.getInitialTime() <= t0 + 4*3600.);
+         TUASSERTE(gpstk::CommonTime, t1, cheb.getFinalTime());
+         cheb.clear();
+         TUASSERTE(unsigned long, 0, cheb.numSegments());
+         TUTHROW(cheb.getInitialTime());
+      }
+      catch (gpstk::Exception& e)
+      {
+         cerr << e << endl;
+         TUFAIL("Unexpected exception");
+      }
+      TURETURN();
+   }
+
+
+      /** Fit broadcast GPS orbits and check the fit against them,
+       * then round-trip the fit through its binary form. */
+   unsigned broadcastFitTest()
+   {
+      TUDEF("ChebyshevEphemerisStore", "read");
+      try
+      {
+         gpstk::Rinex3EphemerisStore rin;
+         rin.loadFile(inputRN3Data);
+         set<gpstk::SatID> sats;
+         set<gpstk::SatID> all(rin.getIndexSet());
+         for (set<gpstk::SatID>::const_iterator si = all.begin();
+              si != all.end(); ++si)
+            if (si->system == gpstk::SatelliteSystem::GPS)
+               sats.insert(*si);
+         TUASSERT(!sats.empty());
+         gpstk::CommonTime t0(rin.getInitialTime()), t1(rin.getFinalTime());
+         t0.setTimeSystem(gpstk::TimeSystem::GPS);
+         t1.setTimeSystem(gpstk::TimeSystem::GPS);
+
+         gpstk::ChebyshevEphemerisStore cheb;
+         for (set<gpstk::SatID>::const_iterator si = sats.begin();
+              si != sats.end(); ++si)
+            cheb.fit(rin, *si, t0, t1);
+         TUASSERT(cheb.getIndexSet() == sats);
+         double posErr, clkErr;
+         unsigned missing;
+         compare(rin, cheb, sats, t0, t1, 61., posErr, clkErr, missing);
+         TUASSERT(posErr < 2e-3);
+         TUASSERT(clkErr < 2e-12);
+         TUASSERTE(gpstk::Xvt::HealthStatus, gpstk::Xvt::HealthStatus::Healthy,
+                   cheb.getSVHealth(*sats.begin(),
+                                    cheb.getInitialTime() + 1.));
+            // the frame is the source's
+         TUASSERTE(gpstk::ReferenceFrame, gpstk::ReferenceFrame::WGS84,
+                   cheb.getXvt(*sats.begin(),
+                               cheb.getInitialTime() + 1.).frame);
+
+         ostringstream out(ios::out | ios::binary);
+         cheb.write(out);
+         string bytes(out.str());
+         TUASSERT(bytes.size() < 8*cheb.numCoefficients() + 1000);
+
+         gpstk::ChebyshevEphemerisStore copy;
+         istringstream in(bytes, ios::in | ios::binary);
+         copy.read(in);
+         TUASSERT(copy.getIndexSet() == sats);
+         TUASSERTE(unsigned long, cheb.numSegments(), copy.numSegments());
+         TUASSERTE(gpstk::CommonTime, cheb.getInitialTime(),
+                   copy.getInitialTime());
+         TUASSERTE(double, cheb.getMaxPositionError(),
+                   copy.getMaxPositionError());
+         unsigned differ = 0;
+         for (set<gpstk::SatID>::const_iterator si = sats.begin();
+              si != sats.end(); ++si)
+         {
+            for (gpstk::CommonTime t = t0; t <= t1; t += 61.)
+            {
+               gpstk::Xvt a(cheb.computeXvt(*si, t)), b(copy.computeXvt(*si, t));
+               if (!(a.x == b.x) || !(a.v == b.v) || a.clkbias != b.clkbias ||
+                   a.clkdrift != b.clkdrift || a.health != b.health ||
+                   a.frame != b.frame)
+                  differ++;
+            }
+         }
+         TUASSERTE(unsigned, 0, differ);
+
+            // damaged data is refused and leaves the store as it was
+         istringstream truncated(bytes.substr(0, bytes.size() - 3),
+                                 ios::in | ios::binary);
+         try
+         {
+            copy.read(truncated);
+            TUFAIL("Read truncated data");
+         }
+         catch (gpstk::InvalidRequest&)
+         {
+            TUPASS("Truncated data refused");
+         }
+         TUASSERTE(unsigned long, cheb.numSegments(), copy.numSegments());
+         istringstream garbage(string(100, 'x'), ios::in | ios::binary);
+         try
+         {
+            copy.read(garbage);
+            TUFAIL("Read garbage");
+         }
+         catch (gpstk::InvalidRequest&)
+         {
+            TUPASS("Garbage refused");
+         }
+      }
+      catch (gpstk::Exception& e)
+      {
+         cerr << e << endl;
+         TUFAIL("Unexpected exception");
+      }
+      TURETURN();
+   }
+
+
+      /// Check that the fit parameters are validated.
+   unsigned parameterTest()
+   {
+      TUDEF("ChebyshevEphemerisStore", "setPositionTolerance");
+      gpstk::ChebyshevEphemerisStore cheb;
+      try
+      {
+         cheb.setPositionTolerance(0.);
+         TUFAIL("Accepted zero tolerance");
+      }
+      catch (gpstk::InvalidParameter&)
+      {
+         TUPASS("Zero tolerance refused");
+      }
+      try
+      {
+         cheb.setNumNodes(gpstk::ChebyshevEphemerisStore::MaxCoefficients+1);
+         TUFAIL("Accepted too many nodes");
+      }
+      catch (gpstk::InvalidParameter&)
+      {
+         TUPASS("Too many nodes refused");
+      }
+      try
+      {
+         cheb.setSpanLimits(600., 300.);
+         TUFAIL("Accepted min span over max span");
+      }
+      catch (gpstk::InvalidParameter&)
+      {
+         TUPASS("Bad spans refused");
+      }
+      TUASSERTE(double, 1e-3, cheb.getPositionTolerance());
+      TUASSERTE(unsigned, 16, cheb.getNumNodes());
+      TURETURN();
+   }
+
+      /// Check that combined health never reports better than either.
+   unsigned worseHealthTest()
+   {
+      TUDEF("ChebyshevEphemerisStore", "worseHealth");
+      typedef gpstk::Xvt::HealthStatus HS;
+      HS order[] = { HS::Healthy, HS::Unused, HS::Unknown, HS::Degraded,
+                     HS::Uninitialized, HS::Unavailable, HS::Unhealthy };
+      for (unsigned i = 0; i < 7; i++)
+      {
+         for (unsigned j = 0; j < 7; j++)
+         {
+            HS expect = order[i > j ? i : j];
+            TUASSERTE(HS, expect,
+                      gpstk::ChebyshevEphemerisStore::worseHealth(order[i],
+                                                                  order[j]));
+         }
+      }
+         // Unhealthy wins over Unknown, though it is later in the enum
+      TUASSERTE(HS, HS::Unhealthy,
+                gpstk::ChebyshevEphemerisStore::worseHealth(HS::Unknown,
+                                                            HS::Unhealthy));
+      TURETURN();
+   }
+
+   std::string inputSP3Data;
+   std::string inputRN3Data;
+};
+
+
+int main() //Main function to initialize and run all tests above
+{
+   unsigned errorTotal = 0;
+   ChebyshevEphemerisStore_T testClass;
+
+   errorTotal += testClass.sp3FitTest();
+   errorTotal += testClass.broadcastFitTest();
+   errorTotal += testClass.parameterTest();
+   errorTotal += testClass.worseHealthTest();
+
+   std::cout << "Total Failures for " << __FILE__ << ": " << errorTotal
+             << std::endl;
+   return errorTotal; //Return the total number of errors
+}
@@ -37,17 +37,183 @@
 //==============================================================================
 
 #include "TestUtil.hpp"
+#include "EphemerisRange.hpp"
+#include "SP3EphemerisStore.hpp"
+#include "Rinex3EphemerisStore.hpp"
 #include <iostream>
+#include <cmath>
+
+using namespace std;
 
 class EphemerisRange_T
 {
 public:
-   EphemerisRange_T() {} // Default Constructor, set the precision value
+   EphemerisRange_T() // Default Constructor, set the file names
+   {
+      std::string dataFilePath = gpstk::getPathData();
+      std::string fileSep = gpstk::getFileSep();
+      inputSP3Data = dataFilePath + fileSep +
+         "test_input_sp3_nav_ephemerisData.sp3";
+      inputRN3Data = dataFilePath + fileSep + "mixed.06n";
+   }
    ~EphemerisRange_T() {} // Default Desructor
+
+
+      /** Compute the corrected ranges of sats at time t from store,
+       * with the epoch ComputeAtTransmitTime() and with the one for
+       * each satellite, and count the satellites where the two
+       * differ by more than the batch orbit's sub-mm tolerance.  Rx is given in Cartesian and in geodetic
+       * coordinates; nvalid returns the number of valid satellites. */
+   static unsigned countBatchMismatch(
+      const gpstk::XvtStore<gpstk::SatID>& store,
+      const vector<gpstk::SatID>& sats,
+      const gpstk::CommonTime& t,
+      unsigned& nvalid)
+   {
+      unsigned bad = 0;
+      nvalid = 0;
+      gpstk::Position Rx(-740290.932, -5457072.754, 3207245.701);
+      for (int geodetic = 0; geodetic < 2; geodetic++)
+      {
+         if (geodetic)
+            Rx.transformTo(gpstk::Position::Geodetic);
+            // a different pseudorange for each satellite
+         vector<double> prs(sats.size());
+         for (size_t i = 0; i < sats.size(); i++)
+            prs[i] = 2.1e7 + 1.0e5 * i;
+
+         vector<gpstk::CorrectedEphemerisRange> cers;
+         vector<double> ranges;
+         vector<bool> valid;
+         int n = gpstk::CorrectedEphemerisRange::ComputeAtTransmitTime(
+            t, sats, prs, Rx, store, cers, ranges, valid);
+         if (n < 0 || cers.size() != sats.size() ||
+             ranges.size() != sats.size() || valid.size() != sats.size())
+            return sats.size();
+
+         int count = 0;
+         for (size_t i = 0; i < sats.size(); i++)
+         {
+            gpstk::CorrectedEphemerisRange cer;
+            double range;
+            bool ok = true;
+            try
+            {
+               range = cer.ComputeAtTransmitTime(t, prs[i], Rx, sats[i],
+                                                 store);
+            }
+            catch (gpstk::Exception& e)
+            {
+               ok = false;
+            }
+            if (ok != valid[i])
+            {
+               bad++;
+               continue;
+            }
+            if (!ok)
+               continue;
+            count++;
+            const gpstk::CorrectedEphemerisRange& b(cers[i]);
+               // metres, degrees and seconds
+            if (fabs(range - ranges[i]) > 1.e-3 ||
+                fabs(cer.rawrange - b.rawrange) > 1.e-3 ||
+                fabs(cer.svclkbias - b.svclkbias) > 1.e-6 ||
+                fabs(cer.svclkdrift - b.svclkdrift) > 1.e-9 ||
+                fabs(cer.relativity - b.relativity) > 1.e-6 ||
+                fabs(cer.elevation - b.elevation) > 1.e-6 ||
+                fabs(cer.azimuth - b.azimuth) > 1.e-6 ||
+                fabs(cer.elevationGeodetic - b.elevationGeodetic) > 1.e-6 ||
+                fabs(cer.azimuthGeodetic - b.azimuthGeodetic) > 1.e-6 ||
+                fabs(cer.transmit - b.transmit) > 1.e-9 ||
+                (cer.cosines - b.cosines).mag() > 1.e-9 ||
+                (cer.svPosVel.x - b.svPosVel.x).mag() > 1.e-3 ||
+                (cer.svPosVel.v - b.svPosVel.v).mag() > 1.e-6)
+               bad++;
+         }
+         if (count != n)
+            bad++;
+         nvalid += n;
+      }
+      return bad;
+   }
+
+
+      /** Check ComputeAtTransmitTime() for an epoch against
+       * ComputeAtTransmitTime() for each satellite, using an
+       * SP3EphemerisStore, which uses the default XvtStore::getXvts(). */
+   unsigned sp3BatchTest()
+   {
+      TUDEF("CorrectedEphemerisRange", "ComputeAtTransmitTime");
+      try
+      {
+         gpstk::SP3EphemerisStore store;
+         store.loadFile(inputSP3Data);
+         set<gpstk::SatID> satSet(store.getIndexSet());
+         vector<gpstk::SatID> sats(satSet.begin(), satSet.end());
+            // and one that is not in the store
+         sats.push_back(gpstk::SatID(5, gpstk::SatelliteSystem::Galileo));
+         gpstk::CommonTime t(store.getInitialTime());
+         t += (store.getFinalTime() - t) / 2.;
+         unsigned nvalid;
+         TUASSERTE(unsigned, 0, countBatchMismatch(store, sats, t, nvalid));
+         TUASSERTE(unsigned, 2*(sats.size()-1), nvalid);
+      }
+      catch (gpstk::Exception& e)
+      {
+         cerr << e << endl;
+         TUFAIL("Unexpected exception");
+      }
+      TURETURN();
+   }
+
+
+      /** Check ComputeAtTransmitTime() for an epoch against
+       * ComputeAtTransmitTime() for each satellite, using a
+       * Rinex3EphemerisStore holding GPS and GLONASS broadcast
+       * ephemerides, where the GPS satellites are computed together. */
+   unsigned rinex3BatchTest()
+   {
+      TUDEF("CorrectedEphemerisRange", "ComputeAtTransmitTime");
+      try
+      {
+         gpstk::Rinex3EphemerisStore store;
+         store.loadFile(inputRN3Data);
+         set<gpstk::SatID> satSet(store.getIndexSet());
+         vector<gpstk::SatID> sats(satSet.begin(), satSet.end());
+         sats.push_back(gpstk::SatID(5, gpstk::SatelliteSystem::Galileo));
+         gpstk::CommonTime t(store.getInitialTime() + 1800.);
+         t.setTimeSystem(gpstk::TimeSystem::GPS);
+         unsigned nvalid;
+         for (int i = 0; i < 4; i++)
+         {
+            TUASSERTE(unsigned, 0, countBatchMismatch(store, sats, t, nvalid));
+            TUASSERT(nvalid > 0);
+            t += 1800.;
+         }
+      }
+      catch (gpstk::Exception& e)
+      {
+         cerr << e << endl;
+         TUFAIL("Unexpected exception");
+      }
+      TURETURN();
+   }
+
+   std::string inputSP3Data;
+   std::string inputRN3Data;
 };
 
 
 int main() //Main function to initialize and run all tests above
 {
-   return 0; //Return the total number of errors
+   unsigned errorTotal = 0;
+   EphemerisRange_T testClass;
+
+   errorTotal += testClass.sp3BatchTest();
+   errorTotal += testClass.rinex3BatchTest();
+
+   std::cout << "Total Failures for " << __FILE__ << ": " << errorTotal
+             << std::endl;
+   return errorTotal; //Return the total number of errors
 }
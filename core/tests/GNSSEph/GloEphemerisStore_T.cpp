@@ -197,6 +197,87 @@ public:
    }
 
 
+      /** Compare getXvt() using trajectory tables with getXvt()
+       * integrating directly, across the fit interval of every
+       * ephemeris, and make sure disableTrajectories() restores the
+       * direct results exactly. */
+   unsigned trajectoryTest()
+   {
+      TUDEF("GloEphemerisStore", "enableTrajectories");
+      try
+      {
+         gpstk::GloEphemerisStore direct, table;
+         loadNav(direct, testFramework, false);
+         TUASSERT(!table.isTrajectories());
+            // tables for ephemerides added before and after enabling
+         loadNav(table, testFramework, true);
+         table.enableTrajectories();
+         loadNav(table, testFramework, false);
+         TUASSERT(table.isTrajectories());
+
+         double maxdx = 0, maxdv = 0, maxdclk = 0;
+         unsigned count = 0, same = 0;
+         set<gpstk::SatID> sats(direct.getIndexSet());
+         for (set<gpstk::SatID>::const_iterator si = sats.begin();
+              si != sats.end(); si++)
+         {
+            gpstk::CommonTime t0 = direct.getInitialTime(*si) - 900.;
+            gpstk::CommonTime t1 = direct.getFinalTime(*si) + 899.;
+            for (gpstk::CommonTime t = t0; t <= t1; t += 7.3)
+            {
+               gpstk::Xvt exp = direct.computeXvt(*si, t);
+               gpstk::Xvt got = table.computeXvt(*si, t);
+               if (exp.health == gpstk::Xvt::HealthStatus::Unavailable)
+                  continue;
+               maxdx = std::max(maxdx, (exp.x - got.x).mag());
+               maxdv = std::max(maxdv, (exp.v - got.v).mag());
+               maxdclk = std::max(maxdclk,
+                                  std::abs(exp.clkbias - got.clkbias));
+               count++;
+            }
+         }
+         TUASSERT(count > 0);
+         TUASSERT(maxdx < 1e-6);
+         TUASSERT(maxdv < 1e-8);
+         TUASSERT(maxdclk < 1e-15);
+
+         TUCSM("disableTrajectories");
+         table.disableTrajectories();
+         TUASSERT(!table.isTrajectories());
+         for (set<gpstk::SatID>::const_iterator si = sats.begin();
+              si != sats.end(); si++)
+         {
+            gpstk::CommonTime t0 = direct.getInitialTime(*si) - 900.;
+            gpstk::CommonTime t1 = direct.getFinalTime(*si) + 899.;
+            for (gpstk::CommonTime t = t0; t <= t1; t += 7.3)
+            {
+               gpstk::Xvt exp = direct.computeXvt(*si, t);
+               gpstk::Xvt got = table.computeXvt(*si, t);
+               if (exp.health == gpstk::Xvt::HealthStatus::Unavailable)
+                  continue;
+               if (exp.x == got.x && exp.v == got.v &&
+                   exp.clkbias == got.clkbias)
+                  same++;
+            }
+         }
+         TUASSERTE(unsigned, count, same);
+
+         TUCSM("enableTrajectories");
+         TUTHROW(table.enableTrajectories(0.));
+      }
+      catch (gpstk::Exception& e)
+      {
+         cerr << e << endl;
+         TUFAIL("Unexpected exception");
+      }
+      catch (...)
+      {
+         TUFAIL("Unexpected exception");
+      }
+      TURETURN();
+   }
+
+
    gpstk::Rinex3NavData loadNav(gpstk::GloEphemerisStore& store,
                                 gpstk::TestUtil& testFramework,
                                 bool firstOnly)
@@ -246,6 +327,7 @@ int main(int argc, char *argv[])
    total += testClass.doFindEphEmptyTests();
    total += testClass.computeXvtTest();
    total += testClass.getSVHealthTest();
+   total += testClass.trajectoryTest();
 
    cout << "Total Failures for " << __FILE__ << ": " << total << endl;
    return total;
@@ -41,6 +41,9 @@
 #include "TimeString.hpp"
 #include "TestUtil.hpp"
 #include "GPSWeekSecond.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 using namespace std;
 
@@ -209,6 +212,26 @@ public:
          TUASSERTE(gpstk::Xvt::HealthStatus,
                    gpstk::Xvt::HealthStatus::Unavailable, xvt.health);
 
+         TUCSM("getXvt(vector)");
+         vector<gpstk::SatID> sats;
+         sats.push_back(sat1);
+         sats.push_back(sat1);
+         vector<gpstk::Xvt> xvts;
+         TUCATCH(xvts = store.getXvt(sats, to1.ctToe));
+         TUASSERTE(size_t, 2, xvts.size());
+         TUASSERTE(gpstk::Xvt::HealthStatus,
+                   gpstk::Xvt::HealthStatus::Healthy, xvts[1].health);
+         sats.push_back(bogus);
+         TUTHROW(xvts = store.getXvt(sats, to1.ctToe));
+
+         TUCSM("computeXvt(vector)");
+         TUCATCH(xvts = store.computeXvt(sats, to1.ctToe));
+         TUASSERTE(size_t, 3, xvts.size());
+         TUASSERTE(gpstk::Xvt::HealthStatus,
+                   gpstk::Xvt::HealthStatus::Healthy, xvts[0].health);
+         TUASSERTE(gpstk::Xvt::HealthStatus,
+                   gpstk::Xvt::HealthStatus::Unavailable, xvts[2].health);
+
          TUCSM("getSVHealth");
          gpstk::Xvt::HealthStatus health;
          TUCATCH(health = store.getSVHealth(to1.satID, to1.ctToe));
@@ -240,7 +263,354 @@ public:
          TUFAIL("Unexpected exception");
       }
       TURETURN();
-   }    
+   }
+
+
+      /// Make an OrbitEph for sat valid from toe-before to toe+after.
+   static gpstk::OrbitEph makeEph(const gpstk::SatID& sat,
+                                  const gpstk::CommonTime& toe,
+                                  double before, double after)
+   {
+      gpstk::OrbitEph eph;
+      eph.dataLoadedFlag = true;
+      eph.satID = sat;
+      eph.obsID = gpstk::ObsID(gpstk::ObservationType::NavMsg,
+                               gpstk::CarrierBand::L1,
+                               gpstk::TrackingCode::CA);
+      eph.ctToe = toe;
+      eph.ctToc = toe;
+      eph.beginValid = toe - before;
+      eph.endValid = toe + after;
+      return eph;
+   }
+
+
+      /** Count the times, every 150s from t0 to t1, at which
+       * findUserOrbitEph() for sat gives a different ephemeris in
+       * store than in ref. */
+   static unsigned countFindMismatch(const gpstk::OrbitEphStore& store,
+                                     const gpstk::OrbitEphStore& ref,
+                                     const gpstk::SatID& sat,
+                                     const gpstk::CommonTime& t0,
+                                     const gpstk::CommonTime& t1)
+   {
+      unsigned bad = 0;
+      for (gpstk::CommonTime t = t0; t <= t1; t += 150.)
+      {
+         const gpstk::OrbitEph *got = store.findUserOrbitEph(sat, t);
+         const gpstk::OrbitEph *exp = ref.findUserOrbitEph(sat, t);
+         if ((got == NULL) != (exp == NULL) ||
+             (got != NULL && got->ctToe != exp->ctToe))
+            bad++;
+      }
+      return bad;
+   }
+
+
+      /** Check that the findUserOrbitEph() lookup cache gives the
+       * same answers as searching the table, including after the
+       * store is changed, and when called from several threads. */
+   unsigned ephCacheTests()
+   {
+      TUDEF("OrbitEphStore","findUserOrbitEph");
+      try
+      {
+         gpstk::OrbitEphStore store, ref;
+         ref.disableEphCache();
+         TUASSERT(store.isEphCache());
+         TUASSERT(!ref.isEphCache());
+
+         gpstk::SatID sat1(1, gpstk::SatelliteSystem::GPS);
+         gpstk::SatID sat2(2, gpstk::SatelliteSystem::GPS);
+         gpstk::SatID sat3(3, gpstk::SatelliteSystem::GPS);
+         gpstk::CommonTime t0 = gpstk::GPSWeekSecond(1917, 0);
+
+            // sat1 every 2h with 4h fit intervals, except for a gap
+            // between 10h and 14h; sat2 with short, non-overlapping
+            // fit intervals; nothing for sat3
+         vector<gpstk::OrbitEph> ephs;
+         for (int h = 2; h <= 22; h += 2)
+         {
+            if (h == 12)
+               continue;
+            ephs.push_back(makeEph(sat1, t0 + h*3600., 3600., 3600.));
+         }
+         for (int h = 2; h <= 22; h += 4)
+            ephs.push_back(makeEph(sat2, t0 + h*3600., 1800., 900.));
+         for (unsigned i = 0; i < ephs.size(); i++)
+         {
+            store.addEphemeris(&ephs[i]);
+            ref.addEphemeris(&ephs[i]);
+         }
+
+         gpstk::CommonTime tb = t0 - 3600., te = t0 + 26*3600.;
+         TUASSERTE(unsigned, 0, countFindMismatch(store, ref, sat1, tb, te));
+         TUASSERTE(unsigned, 0, countFindMismatch(store, ref, sat2, tb, te));
+         TUASSERTE(unsigned, 0, countFindMismatch(store, ref, sat3, tb, te));
+            // the ephemeris changes 20 times in each sweep of 648 times
+         TUASSERT(store.getEphCacheHits() > 10 * store.getEphCacheMisses());
+         TUASSERTE(unsigned long, 0, ref.getEphCacheHits());
+
+            // fill the gap in sat1, after the cache has seen it
+         TUCSM("addEphemeris");
+         gpstk::OrbitEph fill = makeEph(sat1, t0 + 12*3600., 3600., 3600.);
+         store.addEphemeris(&fill);
+         ref.addEphemeris(&fill);
+         TUASSERT(store.findUserOrbitEph(sat1, t0 + 12*3600.) != NULL);
+         TUASSERTE(unsigned, 0, countFindMismatch(store, ref, sat1, tb, te));
+
+         TUCSM("edit");
+         store.edit(t0 + 8*3600., t0 + 16*3600.);
+         ref.edit(t0 + 8*3600., t0 + 16*3600.);
+         TUASSERTE(unsigned, 0, countFindMismatch(store, ref, sat1, tb, te));
+         TUASSERTE(unsigned, 0, countFindMismatch(store, ref, sat2, tb, te));
+
+            // several threads reading the same store at once
+         TUCSM("findUserOrbitEph");
+         store.resetEphCacheStats();
+         vector<unsigned> bad(4, 0);
+         vector<std::thread> readers;
+         for (unsigned i = 0; i < bad.size(); i++)
+         {
+            readers.push_back(std::thread(
+               [&store, &ref, &bad, i, sat1, sat2, tb, te]()
+               {
+                  for (unsigned j = 0; j < 20; j++)
+                  {
+                     bad[i] += countFindMismatch(store, ref, sat1, tb, te);
+                     bad[i] += countFindMismatch(store, ref, sat2, tb, te);
+                  }
+               }));
+         }
+         for (unsigned i = 0; i < readers.size(); i++)
+            readers[i].join();
+         for (unsigned i = 0; i < bad.size(); i++)
+         {
+            TUASSERTE(unsigned, 0, bad[i]);
+         }
+         TUASSERT(store.getEphCacheHits() > 0);
+
+         TUCSM("clear");
+         store.clear();
+         TUASSERT(store.findUserOrbitEph(sat1, t0 + 12*3600.) == NULL);
+      }
+      catch (gpstk::Exception &exc)
+      {
+         cerr << exc << endl;
+         TUFAIL("Unexpected exception");
+      }
+      catch (...)
+      {
+         TUFAIL("Unexpected exception");
+      }
+      TURETURN();
+   }
+
+
+      /** Make a stream of ephemerides for GPS PRNs 1 to nsat, in
+       * order of beginValid, as a real-time monitor would receive
+       * them: a new Toe every 2h for each satellite, first
+       * transmitted 1h before Toe and valid until 2h after, then
+       * transmitted again 30 minutes later.  The clock bias
+       * identifies each Toe. */
+   static vector<gpstk::OrbitEph> makeStream(int nsat, double hours)
+   {
+      vector<pair<gpstk::CommonTime, gpstk::OrbitEph> > all;
+      gpstk::CommonTime t0 = gpstk::GPSWeekSecond(1917, 0);
+      for (int prn = 1; prn <= nsat; prn++)
+      {
+         gpstk::SatID sat(prn, gpstk::SatelliteSystem::GPS);
+         for (double h = 2; h <= hours; h += 2)
+         {
+            gpstk::CommonTime toe = t0 + h*3600. + prn*60.;
+            for (double before = 3600.; before >= 1800.; before -= 1800.)
+            {
+               gpstk::OrbitEph eph = makeEph(sat, toe, before, 7200.);
+               eph.A = 26.56e6;
+               eph.af0 = (prn * 1000 + h) * 1e-9;
+               all.push_back(make_pair(eph.beginValid, eph));
+            }
+         }
+      }
+      stable_sort(all.begin(), all.end(),
+                  [](const pair<gpstk::CommonTime, gpstk::OrbitEph>& l,
+                     const pair<gpstk::CommonTime, gpstk::OrbitEph>& r)
+                  { return l.first < r.first; });
+      vector<gpstk::OrbitEph> rv;
+      for (unsigned i = 0; i < all.size(); i++)
+         rv.push_back(all[i].second);
+      return rv;
+   }
+
+
+      /** Check that a store with a sliding window finds the same
+       * ephemerides within the window as one that keeps everything,
+       * while holding a bounded number of them, including while one
+       * thread adds ephemerides and others compute positions. */
+   unsigned windowTests()
+   {
+      TUDEF("OrbitEphStore","enableWindow");
+      try
+      {
+         const int nsat = 8;
+         const double length = 6*3600.;
+         vector<gpstk::OrbitEph> ephs = makeStream(nsat, 72);
+         gpstk::OrbitEphStore store, capped, ref;
+         TUASSERT(!store.isWindow());
+         TUTHROW(store.enableWindow(0, 100));
+         TUTHROW(store.enableWindow(length, 0));
+         store.enableWindow(length, 1000);
+         capped.enableWindow(1e6, 20);
+         TUASSERT(store.isWindow());
+         TUASSERT(store.getWindowStart() == gpstk::CommonTime::BEGINNING_OF_TIME);
+
+         TUCSM("addEphemeris");
+         unsigned bad = 0, maxSize = 0;
+         for (unsigned i = 0; i < ephs.size(); i++)
+         {
+            store.addEphemeris(&ephs[i]);
+            capped.addEphemeris(&ephs[i]);
+            ref.addEphemeris(&ephs[i]);
+            gpstk::CommonTime start = store.getWindowStart();
+            TUASSERT(start == ephs[i].beginValid - length);
+            maxSize = std::max(maxSize, store.size());
+            TUASSERT(capped.size() <= 20);
+               // the window is (start, latest]
+            bad += countFindMismatch(store, ref, ephs[i].satID, start + 1.,
+                                     ephs[i].beginValid);
+            if (i % 25 == 0)
+            {
+               for (int prn = 1; prn <= nsat; prn++)
+               {
+                  gpstk::SatID sat(prn, gpstk::SatelliteSystem::GPS);
+                  bad += countFindMismatch(store, ref, sat, start + 1.,
+                                           ephs[i].beginValid + 4*3600.);
+               }
+            }
+         }
+         TUASSERTE(unsigned, 0, bad);
+            // at most 5 Toes per satellite span a 6h window
+         TUASSERT(maxSize <= 5 * nsat);
+         TUASSERTE(unsigned, ref.size(), store.size() + store.getWindowEvictions());
+         TUASSERT(store.getInitialTime() == store.getWindowStart());
+
+            // an ephemeris that expired before the window isn't kept
+         gpstk::OrbitEph late = makeEph(gpstk::SatID(1, gpstk::SatelliteSystem::GPS),
+                                        ephs[0].ctToe, 3600., 7200.);
+         unsigned n = store.size();
+         TUASSERT(store.addEphemeris(&late) == NULL);
+         TUASSERTE(unsigned, n, store.size());
+
+            // an ephemeris replaced by an earlier transmission of the
+            // same Toe counts once against maxEph
+         gpstk::OrbitEphStore replaced;
+         replaced.enableWindow(1e6, 3);
+         gpstk::SatID sat1(1, gpstk::SatelliteSystem::GPS);
+         for (int h = 2; h <= 8; h += 2)
+         {
+            gpstk::CommonTime toe = ephs[0].ctToe + h*3600.;
+            gpstk::OrbitEph later = makeEph(sat1, toe, 1800., 7200.),
+               earlier = makeEph(sat1, toe, 3600., 7200.);
+            TUASSERT(replaced.addEphemeris(&later) != NULL);
+            TUASSERT(replaced.addEphemeris(&earlier) != NULL);
+            TUASSERTE(unsigned, std::min(h/2, 3), replaced.size());
+            const gpstk::OrbitEph *found =
+               replaced.findUserOrbitEph(sat1, toe);
+            TUASSERT(found != NULL && found->beginValid == earlier.beginValid);
+         }
+         TUASSERTE(unsigned long, 1, replaced.getWindowEvictions());
+         TUASSERT(replaced.findUserOrbitEph(sat1, ephs[0].ctToe + 4*3600.)
+                  != NULL);
+
+            // enabling the window on a full store trims it the same way
+         TUCSM("enableWindow");
+         gpstk::OrbitEphStore full;
+         for (unsigned i = 0; i < ephs.size(); i++)
+            full.addEphemeris(&ephs[i]);
+         full.enableWindow(length, 1000);
+            // the last one in the stream is a copy that wasn't kept,
+            // so the window doesn't reach it until it is sent again
+         TUASSERT(full.getWindowStart() < store.getWindowStart());
+         TUASSERT(full.addEphemeris(&ephs.back()) == NULL);
+         TUASSERT(full.getWindowStart() == store.getWindowStart());
+         TUASSERTE(unsigned, store.size(), full.size());
+         bad = 0;
+         for (int prn = 1; prn <= nsat; prn++)
+         {
+            gpstk::SatID sat(prn, gpstk::SatelliteSystem::GPS);
+            bad += countFindMismatch(full, ref, sat, full.getWindowStart() + 1.,
+                                     full.getFinalTime());
+         }
+         TUASSERTE(unsigned, 0, bad);
+
+         TUCSM("disableWindow");
+         full.disableWindow();
+         TUASSERT(!full.isWindow());
+         full.addEphemeris(&late);
+         TUASSERTE(unsigned, store.size() + 1, full.size());
+
+            // one thread adding while others compute positions; a
+            // result is final once an ephemeris with a later
+            // beginValid has been added, and must match ref for as
+            // long as its time stays in the window
+         TUCSM("addEphemeris");
+         gpstk::OrbitEphStore live;
+         live.enableWindow(length, 1000);
+         std::atomic<bool> done(false);
+         vector<unsigned> checked(3, 0), wrong(3, 0);
+         vector<std::thread> threads;
+         for (unsigned i = 0; i < checked.size(); i++)
+         {
+            threads.push_back(std::thread(
+               [&live, &ref, &done, &checked, &wrong, i, length, nsat]()
+               {
+                  for (unsigned j = 0; !done; j++)
+                  {
+                     gpstk::CommonTime start = live.getWindowStart();
+                     if (start == gpstk::CommonTime::BEGINNING_OF_TIME)
+                        continue;
+                     gpstk::SatID sat(1 + (i+j) % nsat,
+                                      gpstk::SatelliteSystem::GPS);
+                     gpstk::CommonTime t = start + 1. + (j % 97) * 222.;
+                     gpstk::Xvt got = live.computeXvt(sat, t);
+                     if (t >= start + length ||
+                         !(live.getWindowStart() < t))
+                        continue;
+                     gpstk::Xvt exp = ref.computeXvt(sat, t);
+                     checked[i]++;
+                     if (got.health != exp.health ||
+                         got.clkbias != exp.clkbias || !(got.x == exp.x))
+                        wrong[i]++;
+                  }
+               }));
+         }
+         for (unsigned i = 0; i < ephs.size(); i++)
+         {
+            live.addEphemeris(&ephs[i]);
+            if (i % 10 == 0)
+               std::this_thread::yield();
+         }
+         done = true;
+         for (unsigned i = 0; i < threads.size(); i++)
+            threads[i].join();
+         for (unsigned i = 0; i < checked.size(); i++)
+         {
+            TUASSERT(checked[i] > 0);
+            TUASSERTE(unsigned, 0, wrong[i]);
+         }
+         TUASSERTE(unsigned, store.size(), live.size());
+      }
+      catch (gpstk::Exception &exc)
+      {
+         cerr << exc << endl;
+         TUFAIL("Unexpected exception");
+      }
+      catch (...)
+      {
+         TUFAIL("Unexpected exception");
+      }
+      TURETURN();
+   }
 };
 
 
@@ -250,6 +620,8 @@ int main(int argc, char *argv[])
    OrbitEphStore_T testClass;
    total += testClass.doFindEphEmptyTests();
    total += testClass.basicTests();
+   total += testClass.ephCacheTests();
+   total += testClass.windowTests();
 
    cout << "Total Failures for " << __FILE__ << ": " << total << endl;
    return total;
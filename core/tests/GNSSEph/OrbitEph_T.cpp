@@ -54,16 +54,16 @@ class OrbitEph_T
 {
 public:
    unsigned testSvXvt();
+   unsigned testSvXvtBatch();
+   static void setOrbitEph(gpstk::OrbitEph& oe);
 };
 
 
-unsigned OrbitEph_T ::
-testSvXvt()
+void OrbitEph_T ::
+setOrbitEph(gpstk::OrbitEph& oe)
 {
-   TUDEF("OrbitEph", "svXvt");
       // Hard code orbital parameters mostly so we can copy and paste
       // the data into other similar tests with minimal changes.
-   gpstk::OrbitEph oe;
    oe.Cuc    = -.324845314026e-05;
    oe.Cus    =  .101532787085e-04;
    oe.Crc    =  .168968750000e+03;
@@ -97,6 +97,15 @@ testSvXvt()
       // iodc .700000000000e+01
       // xmit time .360000000000e+04
       // fit int .400000000000e+01
+}
+
+
+unsigned OrbitEph_T ::
+testSvXvt()
+{
+   TUDEF("OrbitEph", "svXvt");
+   gpstk::OrbitEph oe;
+   setOrbitEph(oe);
    bool testFailed = false;
    try
    {
@@ -177,11 +186,87 @@ testSvXvt()
 }
 
 
+unsigned OrbitEph_T ::
+testSvXvtBatch()
+{
+   TUDEF("OrbitEph", "svXvt(vector)");
+   gpstk::OrbitEph oe, oe2, oe3, oe4;
+   setOrbitEph(oe);
+      // a second satellite, with dndot and BeiDou's different
+      // relativity computation
+   oe2 = oe;
+   oe2.satID = gpstk::SatID(12, gpstk::SatelliteSystem::BeiDou);
+   oe2.M0 += 1.5;
+   oe2.dndot = 1.e-13;
+   oe2.Adot = 0.01;
+      // a very eccentric orbit, which takes more Kepler iterations
+   oe4 = oe;
+   oe4.ecc = 0.7;
+   oe4.M0 = 0.3;
+   try
+   {
+         // one ephemeris over a span of times
+      vector<gpstk::CommonTime> times;
+      for (unsigned ii = 0; ii < 7200; ii += 7)
+         times.push_back(oe.ctToc + ii);
+         // and far from Toe, where the angles are large
+      for (unsigned ii = 0; ii < 50; ii++)
+         times.push_back(oe.ctToc + 7*86400. + ii*300.);
+      vector<gpstk::Xvt> sv;
+      oe.svXvt(times, sv);
+      TUASSERTE(size_t, times.size(), sv.size());
+
+         // several ephemerides, each at its own time
+      vector<const gpstk::OrbitEph*> ephs;
+      for (unsigned ii = 0; ii < times.size(); ii++)
+         ephs.push_back((ii % 5) == 4 ? &oe4 : ((ii % 3) ? &oe : &oe2));
+      vector<gpstk::Xvt> sv2;
+      gpstk::OrbitEph::svXvt(ephs, times, sv2);
+      TUASSERTE(size_t, times.size(), sv2.size());
+
+      double maxdx = 0, maxdv = 0, maxdclk = 0;
+      for (unsigned ii = 0; ii < times.size(); ii++)
+      {
+         gpstk::Xvt exp = oe.svXvt(times[ii]);
+         maxdx = max(maxdx, (exp.x - sv[ii].x).mag());
+         maxdv = max(maxdv, (exp.v - sv[ii].v).mag());
+         maxdclk = max(maxdclk, fabs(exp.clkbias - sv[ii].clkbias) +
+                       fabs(exp.clkdrift - sv[ii].clkdrift) +
+                       fabs(exp.relcorr - sv[ii].relcorr));
+         exp = ephs[ii]->svXvt(times[ii]);
+         maxdx = max(maxdx, (exp.x - sv2[ii].x).mag());
+         maxdv = max(maxdv, (exp.v - sv2[ii].v).mag());
+         maxdclk = max(maxdclk, fabs(exp.clkbias - sv2[ii].clkbias) +
+                       fabs(exp.clkdrift - sv2[ii].clkdrift) +
+                       fabs(exp.relcorr - sv2[ii].relcorr));
+      }
+      TUASSERT(maxdx < 1.e-3);
+      TUASSERT(maxdv < 1.e-6);
+      TUASSERT(maxdclk < 1.e-15);
+
+         // mismatched sizes and missing data are errors
+      times.pop_back();
+      TUTHROW(gpstk::OrbitEph::svXvt(ephs, times, sv2));
+      ephs.resize(1);
+      ephs[0] = &oe3;
+      times.resize(1);
+      TUTHROW(gpstk::OrbitEph::svXvt(ephs, times, sv2));
+   }
+   catch (gpstk::Exception& exc)
+   {
+      cerr << exc;
+      TUFAIL("Exception");
+   }
+   TURETURN();
+}
+
+
 int main()
 {
    unsigned total = 0;
    OrbitEph_T testClass;
    total += testClass.testSvXvt();
+   total += testClass.testSvXvtBatch();
 
    cout << "Total Failures for " << __FILE__ << ": " << total << endl;
    return total;
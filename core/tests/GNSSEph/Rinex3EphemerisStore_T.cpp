@@ -0,0 +1,178 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+
+#include <sstream>
+#include "Rinex3EphemerisStore.hpp"
+#include "TestUtil.hpp"
+#include "build_config.h"
+
+using namespace std;
+
+class Rinex3EphemerisStore_T
+{
+public:
+   Rinex3EphemerisStore_T();
+
+      /** Make sure that loading a list of files in parallel gives
+       * the same store as loading them one at a time. */
+   unsigned loadFilesTest();
+      /** Make sure that loadFiles stops at the first file that can't
+       * be read, just as loading them one at a time would. */
+   unsigned loadFilesErrorTest();
+
+      /// Dump the contents of a store for comparison.
+   static std::string storeString(const gpstk::Rinex3EphemerisStore& store);
+
+   std::vector<std::string> files;
+};
+
+
+Rinex3EphemerisStore_T ::
+Rinex3EphemerisStore_T()
+{
+   std::string dataPath = gpstk::getPathData() + gpstk::getFileSep();
+      // These overlap, so that duplicate ephemerides must be handled
+      // the same way in both cases.
+   files.push_back(dataPath + "nga002.15n");
+   files.push_back(dataPath + "arlm2000.15n");
+   files.push_back(dataPath + "mixed.06n");
+   files.push_back(dataPath + "arlm200a.15n");
+   files.push_back(dataPath + "test_input_rinex3_76193040.14n");
+   files.push_back(dataPath + "arlm200b.15n");
+   files.push_back(dataPath + "nga003.15n");
+}
+
+
+std::string Rinex3EphemerisStore_T ::
+storeString(const gpstk::Rinex3EphemerisStore& store)
+{
+   std::ostringstream oss;
+   store.dump(oss, 2);
+   oss << store.size() << " " << store.mapTimeCorr.size() << std::endl;
+   return oss.str();
+}
+
+
+unsigned Rinex3EphemerisStore_T ::
+loadFilesTest()
+{
+   TUDEF("Rinex3EphemerisStore", "loadFiles");
+   try
+   {
+      gpstk::Rinex3EphemerisStore serial;
+      int expCount = 0;
+      for (unsigned i = 0; i < files.size(); i++)
+      {
+         int n = serial.loadFile(files[i]);
+         TUASSERT(n >= 0);
+         expCount += n;
+      }
+      std::string expected = storeString(serial);
+
+      for (unsigned numThreads = 1; numThreads <= 4; numThreads++)
+      {
+         gpstk::Rinex3EphemerisStore parallel;
+         TUASSERTE(int, expCount, parallel.loadFiles(files, numThreads));
+         TUASSERTE(std::string, expected, storeString(parallel));
+         TUASSERTE(std::string, serial.Rhead.fileProgram,
+                   parallel.Rhead.fileProgram);
+         TUASSERTE(gpstk::CommonTime, serial.getInitialTime(),
+                   parallel.getInitialTime());
+         TUASSERTE(gpstk::CommonTime, serial.getFinalTime(),
+                   parallel.getFinalTime());
+      }
+         // an empty list loads nothing
+      gpstk::Rinex3EphemerisStore empty;
+      TUASSERTE(int, 0, empty.loadFiles(std::vector<std::string>()));
+      TUASSERTE(int, 0, empty.size());
+   }
+   catch (gpstk::Exception& exc)
+   {
+      cerr << exc << endl;
+      TUFAIL("Unexpected exception");
+   }
+   TURETURN();
+}
+
+
+unsigned Rinex3EphemerisStore_T ::
+loadFilesErrorTest()
+{
+   TUDEF("Rinex3EphemerisStore", "loadFiles");
+   try
+   {
+      std::vector<std::string> badFiles(files.begin(), files.begin()+3);
+      badFiles.push_back(gpstk::getPathData() + gpstk::getFileSep() +
+                         "no_such_file.15n");
+      badFiles.push_back(files[3]);
+      gpstk::Rinex3EphemerisStore serial, parallel;
+      for (unsigned i = 0; i < 3; i++)
+      {
+         serial.loadFile(files[i]);
+      }
+      TUASSERTE(int, -1, serial.loadFile(badFiles[3]));
+      TUASSERTE(int, -1, parallel.loadFiles(badFiles, 2));
+      TUASSERTE(std::string, serial.what, parallel.what);
+      TUASSERTE(std::string, storeString(serial), storeString(parallel));
+
+         // not a nav file, so the header can't be read
+      badFiles[3] = gpstk::getPathData() + gpstk::getFileSep() +
+         "test_input_rinex2_nav_NotaNavFile.99n";
+      gpstk::Rinex3EphemerisStore parallel2;
+      TUASSERTE(int, -2, parallel2.loadFiles(badFiles, 2));
+      TUASSERTE(std::string, storeString(serial), storeString(parallel2));
+   }
+   catch (gpstk::Exception& exc)
+   {
+      cerr << exc << endl;
+      TUFAIL("Unexpected exception");
+   }
+   TURETURN();
+}
+
+
+int main(int argc, char *argv[])
+{
+   unsigned total = 0;
+   Rinex3EphemerisStore_T testClass;
+   total += testClass.loadFilesTest();
+   total += testClass.loadFilesErrorTest();
+
+   cout << "Total Failures for " << __FILE__ << ": " << total << endl;
+   return total;
+}
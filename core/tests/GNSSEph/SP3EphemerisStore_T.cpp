@@ -696,6 +696,289 @@ public:
       TURETURN();
    }
 
+//=============================================================================
+// Test for the flat table backend
+// Compares getXvt from stores using flat tables with a store that
+// doesn't, at and between the tabulated epochs and past both ends,
+// including the errors thrown.
+//=============================================================================
+   unsigned flatTableTest()
+   {
+      TUDEF("SP3EphemerisStore", "enableFlatTables");
+
+      try
+      {
+         SP3EphemerisStore mapStore, flatStore;
+         mapStore.loadFile(inputSP3Data);
+            // load into one store with flat tables already enabled,
+            // and enable them in a copy of the other after loading
+         flatStore.enableFlatTables();
+         flatStore.loadFile(inputSP3Data);
+         SP3EphemerisStore copyStore(mapStore);
+         copyStore.enableFlatTables();
+
+            // add a record between two epochs, so the table for one
+            // satellite is no longer evenly spaced
+         SatID sid1(1,SatelliteSystem::GPS);
+         CommonTime tOdd(mapStore.getInitialTime() +
+                         mapStore.getPositionTimeStep(sid1) * 10.0 + 300.0);
+         Triple pos(mapStore.getPosition(sid1,tOdd)), sig(0,0,0);
+         mapStore.addPositionData(sid1, tOdd, pos*1.e-3, sig);
+         flatStore.addPositionData(sid1, tOdd, pos*1.e-3, sig);
+         copyStore.addPositionData(sid1, tOdd, pos*1.e-3, sig);
+
+         compareXvt(testFramework, mapStore, flatStore);
+         compareXvt(testFramework, mapStore, copyStore);
+
+         mapStore.setPosGapInterval(600.);
+         mapStore.setPosMaxInterval(6000.);
+         flatStore.setPosGapInterval(600.);
+         flatStore.setPosMaxInterval(6000.);
+         compareXvt(testFramework, mapStore, flatStore);
+
+         flatStore.disableFlatTables();
+         compareXvt(testFramework, mapStore, flatStore);
+      }
+      catch (...)
+      {
+         TUFAIL("Unexpected exception");
+      }
+
+      TURETURN();
+   }
+
+//=============================================================================
+// Test for the interpolation cache
+// Compares getXvt from a store caching the interpolation intervals with
+// one that doesn't, for satellites evaluated repeatedly within each
+// interval, in SP3 files with and without velocities.
+//=============================================================================
+   unsigned interpCacheTest()
+   {
+      TUDEF("SP3EphemerisStore", "enableInterpCache");
+
+      try
+      {
+         string files[] = { inputSP3Data, inputAPCData };
+         for (unsigned f = 0; f < 2; f++)
+         {
+            SP3EphemerisStore expStore, gotStore;
+            expStore.loadFile(files[f]);
+            gotStore.loadFile(files[f]);
+            gotStore.enableInterpCache();
+            TUASSERTE(unsigned long, 0, gotStore.getInterpCacheHits());
+
+            vector<SatID> sats(expStore.getSatList());
+            CommonTime t0(expStore.getInitialTime());
+            CommonTime t1(expStore.getFinalTime());
+            unsigned long nxvt = 0;
+            double maxdx = 0, maxdv = 0, maxdb = 0, maxdd = 0;
+            for (unsigned i = 0; i < sats.size(); i++)
+            {
+                  // both on and between the tabulated epochs
+               for (CommonTime t = t0; t <= t1; t += 150.)
+               {
+                  Xvt exp, got;
+                  try { exp = expStore.getXvt(sats[i], t); }
+                  catch (InvalidRequest& e)
+                  {
+                     TUTHROW(gotStore.getXvt(sats[i], t));
+                     continue;
+                  }
+                  got = gotStore.getXvt(sats[i], t);
+                  nxvt++;
+                  maxdx = max(maxdx, (exp.x - got.x).mag());
+                  maxdv = max(maxdv, (exp.v - got.v).mag());
+                  maxdb = max(maxdb, fabs(exp.clkbias - got.clkbias));
+                  maxdd = max(maxdd, fabs(exp.clkdrift - got.clkdrift));
+               }
+            }
+               // differences due to rounding only
+            TUASSERT(maxdx < 1.e-6);
+            TUASSERT(maxdv < 1.e-9);
+            TUASSERT(maxdb < 1.e-17);
+            TUASSERT(maxdd < 1.e-20);
+               // at most one position and one clock interpolation
+               // per getXvt, and six getXvt per 15-minute interval
+            TUASSERT(gotStore.getInterpCacheHits() +
+                     gotStore.getInterpCacheMisses() <= 2*nxvt);
+            TUASSERT(gotStore.getInterpCacheHits() >
+                     3*gotStore.getInterpCacheMisses());
+         }
+      }
+      catch (...)
+      {
+         TUFAIL("Unexpected exception");
+      }
+
+      TURETURN();
+   }
+
+//=============================================================================
+// Test for the archive mode
+// Compares getXvt from stores with archived tables with
+// a store that uses maps, for SP3 files with and without velocities and
+// sigmas, after adding data off the time grid, and after editing.
+//=============================================================================
+   unsigned archiveTest()
+   {
+      TUDEF("SP3EphemerisStore", "enableArchive");
+
+      try
+      {
+         string files[] = { inputSP3Data, inputSP3cData, inputAPCData };
+         for (unsigned f = 0; f < 3; f++)
+         {
+            SP3EphemerisStore mapStore, arcStore;
+            mapStore.loadFile(files[f]);
+               // archive while loading, and in a copy after loading
+            arcStore.enableArchive();
+            TUASSERT(arcStore.isArchive());
+            arcStore.loadFile(files[f]);
+            SP3EphemerisStore copyStore(mapStore);
+            copyStore.enableArchive();
+
+            TUASSERTE(int, mapStore.ndata(), arcStore.ndata());
+            TUASSERTE(int, mapStore.ndataClock(), arcStore.ndataClock());
+            TUASSERT(mapStore.getSatList() == arcStore.getSatList());
+            TUASSERTE(CommonTime, mapStore.getInitialTime(),
+                      arcStore.getInitialTime());
+            TUASSERTE(CommonTime, mapStore.getFinalTime(),
+                      arcStore.getFinalTime());
+               // less than half the size of just the records in the
+               // maps, even for these short files
+            TUASSERT(arcStore.archiveMemoryUsage() <
+                     (mapStore.ndata() * sizeof(PositionRecord) +
+                      mapStore.ndataClock() * sizeof(ClockRecord)) / 2);
+            TUASSERTE(std::size_t, arcStore.archiveMemoryUsage(),
+                      copyStore.archiveMemoryUsage());
+
+            compareXvt(testFramework, mapStore, arcStore);
+            compareXvt(testFramework, mapStore, copyStore);
+
+               // a record off the grid puts one table back in a map
+            SatID sid1(1,SatelliteSystem::GPS);
+            CommonTime tOdd(mapStore.getInitialTime() +
+                            mapStore.getPositionTimeStep(sid1) * 10.0 + 300.0);
+            Triple pos(mapStore.getPosition(sid1,tOdd)), sig(0,0,0);
+            mapStore.addPositionData(sid1, tOdd, pos*1.e-3, sig);
+            arcStore.addPositionData(sid1, tOdd, pos*1.e-3, sig);
+            copyStore.addPositionData(sid1, tOdd, pos*1.e-3, sig);
+            compareXvt(testFramework, mapStore, arcStore);
+
+            mapStore.setPosGapInterval(600.);
+            mapStore.setPosMaxInterval(6000.);
+            arcStore.setPosGapInterval(600.);
+            arcStore.setPosMaxInterval(6000.);
+            copyStore.setPosGapInterval(600.);
+            copyStore.setPosMaxInterval(6000.);
+            compareXvt(testFramework, mapStore, arcStore);
+
+            CommonTime t0(mapStore.getInitialTime() + 3600.);
+            CommonTime t1(mapStore.getFinalTime() - 3600.);
+            mapStore.edit(t0, t1);
+            arcStore.edit(t0, t1);
+            copyStore.edit(t0, t1);
+            TUASSERTE(int, mapStore.ndata(), arcStore.ndata());
+            TUASSERTE(int, mapStore.ndataClock(), copyStore.ndataClock());
+            compareXvt(testFramework, mapStore, arcStore);
+            compareXvt(testFramework, mapStore, copyStore);
+
+            arcStore.disableArchive();
+            TUASSERTE(std::size_t, 0, arcStore.archiveMemoryUsage());
+            compareXvt(testFramework, mapStore, arcStore);
+         }
+      }
+      catch (...)
+      {
+         TUFAIL("Unexpected exception");
+      }
+
+      TURETURN();
+   }
+
+//=============================================================================
+// Test that the intervals found in archived tables stay valid after
+// searches in another store
+//=============================================================================
+   unsigned archiveIntervalTest()
+   {
+      TUDEF("PositionSatStore", "getTableInterval");
+
+      try
+      {
+         SatID sid(1,SatelliteSystem::GPS);
+         CommonTime t0(CivilTime(2020,1,1,0,0,0.0,TimeSystem::GPS));
+         PositionSatStore storeA, storeB;
+         storeA.enableArchive();
+         storeB.enableArchive();
+         for (int i = 0; i < 200; i++)
+         {
+            storeA.addPositionData(sid, t0 + i*900., Triple(i, 2*i, 3*i));
+            storeB.addPositionData(sid, t0 + i*900., Triple(-i, 0, 0));
+         }
+         storeA.compactArchive();
+         storeB.compactArchive();
+         TUASSERTE(int, 1, storeA.narchived());
+         TUASSERTE(int, 1, storeB.narchived());
+
+         PositionSatStore::DataTable::const_iterator it1, it2, jt1, jt2;
+         storeA.getTableInterval(sid, t0 + 10*900. + 450., 5, it1, it2, false);
+         storeB.getTableInterval(sid, t0 + 150*900. + 450., 5, jt1, jt2,
+                                 false);
+            // a later search in the same store within the window
+         storeA.getTableInterval(sid, t0 + 11*900. + 450., 5, jt1, jt2,
+                                 false);
+
+         TUASSERTE(CommonTime, t0 + 6*900., it1->first);
+         TUASSERTE(CommonTime, t0 + 15*900., it2->first);
+         int i = 6;
+         for (PositionSatStore::DataTable::const_iterator kt = it1; ; ++kt, ++i)
+         {
+            TUASSERTFE(double(2*i), kt->second.Pos[1]);
+            if (kt == it2) break;
+         }
+         TUASSERTE(int, 15, i);
+      }
+      catch (...)
+      {
+         TUFAIL("Unexpected exception");
+      }
+
+      TURETURN();
+   }
+
+      /** Check that getXvt gives the same results, or throws the
+       * same error, from both stores for all the satellites. */
+   void compareXvt(TestUtil& testFramework,
+                   const SP3EphemerisStore& expStore,
+                   const SP3EphemerisStore& gotStore)
+   {
+      vector<SatID> sats(expStore.getSatList());
+      CommonTime t0(expStore.getInitialTime()), t1(expStore.getFinalTime());
+      for (unsigned i = 0; i < sats.size(); i++)
+      {
+         unsigned nbad = 0;
+            // steps of 225 seconds land on every 4th tabulated epoch
+         for (double dt = -1000.; t0 + dt < t1 + 1000.; dt += 225.)
+         {
+            CommonTime t(t0 + dt);
+            Xvt exp, got;
+            string expErr, gotErr;
+            try { exp = expStore.getXvt(sats[i], t); }
+            catch (InvalidRequest& e) { expErr = e.getText(); }
+            try { got = gotStore.getXvt(sats[i], t); }
+            catch (InvalidRequest& e) { gotErr = e.getText(); }
+            if (expErr != gotErr || !(exp.x == got.x) || !(exp.v == got.v) ||
+                exp.clkbias != got.clkbias || exp.clkdrift != got.clkdrift)
+            {
+               nbad++;
+            }
+         }
+         TUASSERTE(unsigned, 0, nbad);
+      }
+   }
+
 private:
    double epsilon; // Floating point error threshold
    std::string dataFilePath;
@@ -730,6 +1013,10 @@ int main() // Main function to initialize and run all tests above
    errorTotal += testClass.getFinalTimeTest();
    errorTotal += testClass.getPositionTest();
    errorTotal += testClass.getVelocityTest();
+   errorTotal += testClass.flatTableTest();
+   errorTotal += testClass.interpCacheTest();
+   errorTotal += testClass.archiveTest();
+   errorTotal += testClass.archiveIntervalTest();
 
    cout << "Total Failures for " << __FILE__ << ": " << errorTotal << endl;
 
@@ -37,17 +37,176 @@
 //==============================================================================
 
 #include "TestUtil.hpp"
+#include "SP3EphemerisStore.hpp"
+#include "Rinex3EphemerisStore.hpp"
 #include <iostream>
+#include <thread>
+
+using namespace std;
 
 class XvtStore_T
 {
 public:
-   XvtStore_T() {} // Default Constructor, set the precision value
+   XvtStore_T() // Default Constructor, set the file names
+   {
+      std::string dataFilePath = gpstk::getPathData();
+      std::string fileSep = gpstk::getFileSep();
+      inputSP3Data = dataFilePath + fileSep +
+         "test_input_sp3_nav_ephemerisData.sp3";
+      inputRN3Data = dataFilePath + fileSep + "mixed.06n";
+   }
    ~XvtStore_T() {} // Default Desructor
+
+
+      /// Return true if a and b are identical.
+   static bool sameXvt(const gpstk::Xvt& a, const gpstk::Xvt& b)
+   {
+      return (a.x == b.x && a.v == b.v && a.clkbias == b.clkbias &&
+              a.clkdrift == b.clkdrift && a.relcorr == b.relcorr &&
+              a.health == b.health);
+   }
+
+
+      /** Call computeXvt() on store for every satellite in sats at
+       * every time in times, first in one thread and then in
+       * numThreads threads at once, each visiting the satellites
+       * and times in a different order, and count the results that
+       * differ from the single-threaded ones. */
+   static unsigned countParallelMismatch(
+      const gpstk::XvtStore<gpstk::SatID>& store,
+      const vector<gpstk::SatID>& sats,
+      const vector<gpstk::CommonTime>& times,
+      unsigned numThreads)
+   {
+      size_t npairs = sats.size() * times.size();
+      vector<gpstk::Xvt> serial(npairs);
+      for (size_t k = 0; k < npairs; k++)
+         serial[k] = store.computeXvt(sats[k % sats.size()],
+                                      times[k / sats.size()]);
+
+      vector< vector<gpstk::Xvt> > parallel(numThreads,
+                                            vector<gpstk::Xvt>(npairs));
+      vector<std::thread> threads;
+      for (unsigned n = 0; n < numThreads; n++)
+      {
+         threads.push_back(std::thread(
+            [&store, &sats, &times, &parallel, n, npairs, numThreads]()
+            {
+                  // odd threads go backwards; all start at
+                  // different places
+               size_t start = n * npairs / numThreads;
+               for (size_t i = 0; i < npairs; i++)
+               {
+                  size_t k = (n % 2 ? npairs - 1 - i : i);
+                  k = (k + start) % npairs;
+                  parallel[n][k] =
+                     store.computeXvt(sats[k % sats.size()],
+                                      times[k / sats.size()]);
+               }
+            }));
+      }
+      for (unsigned n = 0; n < numThreads; n++)
+         threads[n].join();
+
+      unsigned bad = 0;
+      for (unsigned n = 0; n < numThreads; n++)
+         for (size_t k = 0; k < npairs; k++)
+            if (!sameXvt(serial[k], parallel[n][k]))
+               bad++;
+      return bad;
+   }
+
+
+      /// Times from t0 to t1, step seconds apart.
+   static vector<gpstk::CommonTime> timeList(const gpstk::CommonTime& t0,
+                                             const gpstk::CommonTime& t1,
+                                             double step)
+   {
+      vector<gpstk::CommonTime> times;
+      for (gpstk::CommonTime t = t0; t <= t1; t += step)
+         times.push_back(t);
+      return times;
+   }
+
+
+      /** Check that concurrent queries of a shared
+       * SP3EphemerisStore, with each combination of its lookup
+       * options, give the same results as serial queries. */
+   unsigned sp3ConcurrencyTest()
+   {
+      TUDEF("SP3EphemerisStore", "computeXvt");
+      try
+      {
+         for (int opts = 0; opts < 4; opts++)
+         {
+            gpstk::SP3EphemerisStore store;
+            store.loadFile(inputSP3Data);
+            if (opts & 1)
+               store.enableFlatTables();
+            if (opts & 2)
+               store.enableInterpCache();
+            set<gpstk::SatID> satSet(store.getIndexSet());
+            vector<gpstk::SatID> sats(satSet.begin(), satSet.end());
+               // off the table times, plus some outside it
+            vector<gpstk::CommonTime> times(
+               timeList(store.getInitialTime() - 1000.,
+                        store.getFinalTime() + 1000., 613.));
+            TUASSERTE(unsigned, 0,
+                      countParallelMismatch(store, sats, times, 4));
+         }
+      }
+      catch (gpstk::Exception& e)
+      {
+         cerr << e << endl;
+         TUFAIL("Unexpected exception");
+      }
+      TURETURN();
+   }
+
+
+      /** Check that concurrent queries of a shared
+       * Rinex3EphemerisStore, holding GPS and GLONASS broadcast
+       * ephemerides, give the same results as serial queries. */
+   unsigned rinex3ConcurrencyTest()
+   {
+      TUDEF("Rinex3EphemerisStore", "computeXvt");
+      try
+      {
+         gpstk::Rinex3EphemerisStore store;
+         store.loadFile(inputRN3Data);
+         set<gpstk::SatID> satSet(store.getIndexSet());
+         vector<gpstk::SatID> sats(satSet.begin(), satSet.end());
+         TUASSERT(sats.size() > 0);
+         gpstk::CommonTime t0(store.getInitialTime()),
+            t1(store.getFinalTime());
+         t0.setTimeSystem(gpstk::TimeSystem::GPS);
+         t1.setTimeSystem(gpstk::TimeSystem::GPS);
+         vector<gpstk::CommonTime> times(timeList(t0, t1, 120.));
+         TUASSERTE(unsigned, 0,
+                   countParallelMismatch(store, sats, times, 4));
+      }
+      catch (gpstk::Exception& e)
+      {
+         cerr << e << endl;
+         TUFAIL("Unexpected exception");
+      }
+      TURETURN();
+   }
+
+   std::string inputSP3Data;
+   std::string inputRN3Data;
 };
 
 
 int main() //Main function to initialize and run all tests above
 {
-   return 0; //Return the total number of errors
+   unsigned errorTotal = 0;
+   XvtStore_T testClass;
+
+   errorTotal += testClass.sp3ConcurrencyTest();
+   errorTotal += testClass.rinex3ConcurrencyTest();
+
+   std::cout << "Total Failures for " << __FILE__ << ": " << errorTotal
+             << std::endl;
+   return errorTotal; //Return the total number of errors
 }
@@ -36,19 +36,94 @@
 //
 //==============================================================================
 
+#include "MiscMath.hpp"
 #include "TestUtil.hpp"
 #include <iostream>
+#include <cmath>
 
+using namespace std;
+using namespace gpstk;
 
 class MiscMath_T
 {
-        public: 
-		MiscMath_T(){}// Default Constructor, set the precision value
-		~MiscMath_T() {} // Default Desructor
+public:
+   MiscMath_T() {}
+   ~MiscMath_T() {}
+
+      /** Check that the coefficients from LagrangeCoefficients()
+       * interpolate a polynomial and its derivative, and agree with
+       * LagrangeInterpolation(). */
+   unsigned lagrangeCoefficientsTest()
+   {
+      TUDEF("MiscMath", "LagrangeCoefficients");
+
+      vector<double> X, Y, W, L, Lp;
+         // a polynomial of degree 7 on 8 unevenly spaced points
+      for (int i = 0; i < 8; i++)
+      {
+         double x = 900.*i + (i%3)*10.;
+         X.push_back(x);
+         Y.push_back(poly(x));
+      }
+      LagrangeWeights(X, W);
+      TUASSERTE(size_t, X.size(), W.size());
+
+      for (double x = X[3]; x <= X[4]; x += 150.)
+      {
+         LagrangeCoefficients(X, W, x, L, Lp);
+         double y = 0, dydx = 0, expy, expdydx, err;
+         for (size_t i = 0; i < X.size(); i++)
+         {
+            y += L[i]*Y[i];
+            dydx += Lp[i]*Y[i];
+         }
+         TUASSERTFEPS(poly(x), y, 1.e-8);
+         TUASSERTFEPS(dpoly(x), dydx, 1.e-10);
+         TUASSERTFEPS(LagrangeInterpolation(X, Y, x, err), y, 1.e-8);
+         LagrangeInterpolation(X, Y, x, expy, expdydx);
+         TUASSERTFEPS(expdydx, dydx, 1.e-10);
+      }
+
+         // exact at the data points
+      LagrangeCoefficients(X, W, X[4], L, Lp);
+      double y = 0;
+      for (size_t i = 0; i < X.size(); i++)
+         y += L[i]*Y[i];
+      TUASSERTE(double, Y[4], y);
+
+         // points must be distinct
+      X[1] = X[2];
+      TUTHROW(LagrangeWeights(X, W));
+
+      TURETURN();
+   }
+
+private:
+      /// polynomial to interpolate
+   static double poly(double x)
+   {
+      x /= 1000.;
+      return 2.e4 + x*(-3.e3 + x*(50. + x*(7. + x*(-0.3 + x*(0.02 +
+                      x*(-0.001 + x*1.e-5))))));
+   }
+      /// derivative of poly()
+   static double dpoly(double x)
+   {
+      x /= 1000.;
+      return (-3.e3 + x*(100. + x*(21. + x*(-1.2 + x*(0.1 +
+                 x*(-0.006 + x*7.e-5)))))) / 1000.;
+   }
 };
 
 
 int main() //Main function to initialize and run all tests above
 {
-	return 0; //Return the total number of errors
+   unsigned errorTotal = 0;
+   MiscMath_T testClass;
+
+   errorTotal += testClass.lagrangeCoefficientsTest();
+
+   cout << "Total Failures for " << __FILE__ << ": " << errorTotal << endl;
+
+   return errorTotal; //Return the total number of errors
 }
@@ -0,0 +1,206 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//  
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024 
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public 
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+
+#include "SmallLSQ.hpp"
+#include "Matrix.hpp"
+#include "TestUtil.hpp"
+#include <iostream>
+#include <cmath>
+
+using namespace std;
+using namespace gpstk;
+
+class SmallLSQ_T
+{
+public:
+   SmallLSQ_T() : eps(1.e-10) {}
+
+      /// A range-like problem: 4 states, 7 data, with weights
+   void fill(SmallLSQ<double,6>& LSQ, Matrix<double>& P, Vector<double>& d,
+             Vector<double>& w)
+   {
+      double part[7][4] = { { 0.3, -0.8,  0.5, 1.0}, {-0.6, -0.2,  0.7, 1.0},
+                            { 0.1,  0.9,  0.4, 1.0}, { 0.8,  0.3,  0.5, 1.0},
+                            {-0.4,  0.6,  0.7, 1.0}, { 0.5, -0.5, -0.7, 1.0},
+                            {-0.9,  0.1,  0.4, 1.0} };
+      double data[7] = { 1.5, -2.3, 0.7, 4.1, -0.2, 2.8, -3.3 };
+      double wts[7] = { 1.0, 2.0, 0.5, 1.5, 1.0, 3.0, 0.8 };
+      P = Matrix<double>(7,4);
+      d = Vector<double>(7);
+      w = Vector<double>(7);
+      LSQ.Reset(4);
+      for(int i=0; i<7; i++) {
+         for(int j=0; j<4; j++) P(i,j) = part[i][j];
+         d(i) = data[i];
+         w(i) = wts[i];
+         LSQ.Add(part[i], data[i], wts[i]);
+      }
+   }
+
+      /// Compare to the normal equations solved with gpstk::Matrix and SVD
+   int solveTest(void)
+   {
+      TUDEF("SmallLSQ", "Solve");
+      SmallLSQ<double,6> LSQ;
+      Matrix<double> P;
+      Vector<double> d,w;
+      fill(LSQ, P, d, w);
+      TUASSERTE(unsigned int, 4, LSQ.Dim());
+
+      Matrix<double> W(7,7,0.0);
+      for(int i=0; i<7; i++) W(i,i) = w(i);
+      Matrix<double> Cov(inverseSVD(transpose(P)*W*P));
+      Vector<double> X(Cov*transpose(P)*W*d);
+
+      TUASSERT(LSQ.Solve());
+      TUASSERT(LSQ.isCholesky());
+      for(int i=0; i<4; i++) {
+         TUASSERTFEPS(X(i), LSQ.X(i), eps);
+         for(int j=0; j<4; j++)
+            TUASSERTFEPS(Cov(i,j), LSQ.Cov(i,j), eps);
+      }
+
+      // the conversions
+      Matrix<double> C(LSQ.Covariance());
+      Vector<double> S(LSQ.Solution());
+      TUASSERTE(size_t, 4, C.rows());
+      TUASSERTE(size_t, 4, S.size());
+      TUASSERTFE(LSQ.Cov(1,3), C(1,3));
+      TUASSERTFE(LSQ.X(2), S(2));
+
+      // direct accumulation gives the same answer
+      SmallLSQ<double,6> Direct(4);
+      for(int k=0; k<7; k++) {
+         for(int i=0; i<4; i++) {
+            Direct.Data(i) += P(k,i)*w(k)*d(k);
+            for(int j=0; j<=i; j++) Direct.Info(i,j) += P(k,i)*w(k)*P(k,j);
+         }
+      }
+      Direct.Solve();
+      for(int i=0; i<4; i++)
+         TUASSERTFEPS(LSQ.X(i), Direct.X(i), eps);
+
+      TURETURN();
+   }
+
+      /// An ill-conditioned problem falls back to SVD
+   int illConditionedTest(void)
+   {
+      TUDEF("SmallLSQ", "Solve");
+      // the second column is (nearly) twice the first
+      double part[3][2] = { {1.0, 2.0}, {2.0, 4.0+1.e-12}, {3.0, 6.0} };
+      Matrix<double> Inf(2,2,0.0);
+      SmallLSQ<double,2> LSQ(2);
+      for(int i=0; i<3; i++) {
+         LSQ.Add(part[i], 1.0);
+         for(int j=0; j<2; j++)
+            for(int k=0; k<2; k++) Inf(j,k) += part[i][j]*part[i][k];
+      }
+      TUASSERT(!LSQ.Solve());
+      TUASSERT(!LSQ.isCholesky());
+      Matrix<double> Cov(inverseSVD(Inf));
+      for(int i=0; i<2; i++)
+         for(int j=0; j<2; j++)
+            TUASSERTFEPS(Cov(i,j), LSQ.Cov(i,j), eps);
+
+      // the zero matrix can't be inverted
+      LSQ.Reset();
+      try {
+         LSQ.Solve();
+         TUFAIL("Solve() of the zero matrix did not throw");
+      }
+      catch(MatrixException& e) { TUPASS("Solve() of the zero matrix threw"); }
+
+      TURETURN();
+   }
+
+      /// Reset() clears the data and checks the dimension
+   int resetTest(void)
+   {
+      TUDEF("SmallLSQ", "Reset");
+      SmallLSQ<double,6> LSQ;
+      Matrix<double> P;
+      Vector<double> d,w;
+      fill(LSQ, P, d, w);
+      LSQ.Solve();
+      double x0(LSQ.X(0));
+
+      // reset and refill; the answer must not depend on the old data
+      LSQ.Reset();
+      TUASSERTE(unsigned int, 4, LSQ.Dim());
+      for(int i=0; i<7; i++) {
+         double part[4] = { P(i,0), P(i,1), P(i,2), P(i,3) };
+         LSQ.Add(part, d(i), w(i));
+      }
+      LSQ.Solve();
+      TUASSERTFEPS(x0, LSQ.X(0), eps);
+
+      // new dimension
+      LSQ.Reset(3);
+      TUASSERTE(unsigned int, 3, LSQ.Dim());
+
+      // too large
+      try {
+         LSQ.Reset(7);
+         TUFAIL("Reset() to a dimension larger than MaxN did not throw");
+      }
+      catch(MatrixException& e) { TUPASS("Reset() too large threw"); }
+      TUASSERTE(unsigned int, 3, LSQ.Dim());
+
+      TURETURN();
+   }
+
+private:
+   double eps;
+};
+
+
+int main()
+{
+   int errorCounter = 0;
+   SmallLSQ_T testClass;
+
+   errorCounter += testClass.solveTest();
+   errorCounter += testClass.illConditionedTest();
+   errorCounter += testClass.resetTest();
+
+   std::cout << "Total Failures for " << __FILE__ << ": " << errorCounter
+             << std::endl;
+
+   return errorCounter;
+}
@@ -88,6 +88,7 @@ public:
    unsigned streamTest();
    unsigned castTest();
    unsigned scaleTest();
+   unsigned assignTest();
 };
 
 
@@ -290,6 +291,46 @@ scaleTest()
 }
 
 
+unsigned FormattedDouble_T ::
+assignTest()
+{
+   TUDEF("FormattedDouble", "assign(string,size_type)");
+   std::string line(" -.123450000000D+01  .250000000000D-02");
+   gpstk::FormattedDouble fd(0, gpstk::StringUtils::FFLead::Decimal, 12, 2,
+                             19, 'D');
+   fd.assign(line, 0);
+   TUASSERTFE(-1.2345, fd.val);
+   fd.assign(line, 19);
+   TUASSERTFE(0.0025, fd.val);
+      // a short field at the end of the line
+   line += "  -2.5D-01";
+   fd.assign(line, 38);
+   TUASSERTFE(-0.25, fd.val);
+      // blank fields leave the value alone
+   fd.assign(line, line.length());
+   TUASSERTFE(-0.25, fd.val);
+   fd = 5.0;
+   fd.assign("      ", 6);
+   TUASSERTFE(5.0, fd.val);
+   try
+   {
+      fd.assign(line, line.length()+1);
+      TUFAIL("assign past the end of the string did not throw");
+   }
+   catch (std::out_of_range&)
+   {
+      TUPASS("assign past the end of the string");
+   }
+
+   TUCSM("assign(const char*,size_t)");
+   gpstk::FormattedDouble fde(0, gpstk::StringUtils::FFLead::Zero, 5, 2, 11,
+                              'E');
+   fde.assign("0.1234E+01xx", 10);
+   TUASSERTFE(1.234, fde.val);
+   TURETURN();
+}
+
+
 int main()
 {
    unsigned errorTotal = 0;
@@ -298,6 +339,7 @@ int main()
    errorTotal += testClass.streamTest();
    errorTotal += testClass.castTest();
    errorTotal += testClass.scaleTest();
+   errorTotal += testClass.assignTest();
    std::cout << "Total Failures for " << __FILE__ << ": " << errorTotal
              << std::endl;
    return errorTotal;
@@ -36,6 +36,7 @@
 //
 //==============================================================================
 
+#include <iomanip>
 #include <iostream>
 #include <string>
 #include <sstream>
@@ -1243,6 +1244,82 @@ public:
 
       TURETURN();
    }
+
+      /** Make sure the non-allocating conversions give the same
+       * results as the string versions. */
+   unsigned bufferConversionTest()
+   {
+      TUDEF("StringUtils", "formatFixed");
+
+      char buf[64];
+      const double values[] =
+         { 0, -0.0, 1.2345, -1.2345, 0.0005, 0.0015, 2.5, -2.5,
+           20183437.8216, -1234567.890125, 1e15, 1e21, 123456789.1234565 };
+      for (unsigned i = 0; i < sizeof(values)/sizeof(values[0]); i++)
+      {
+         for (unsigned prec = 0; prec < 10; prec += 3)
+         {
+            ostringstream oss;
+            oss << fixed << setprecision(prec) << values[i];
+            string expected = oss.str();
+            if (expected.length() < 14)
+               expected.insert(0, 14 - expected.length(), ' ');
+            size_t len = formatFixed(buf, sizeof(buf), values[i], prec, 14);
+            TUASSERTE(string, expected, string(buf, len));
+         }
+      }
+         // too wide for the field, not truncated
+      TUASSERTE(size_t, 12, formatFixed(buf, sizeof(buf), 123456789.25, 2, 8));
+      TUASSERTE(string, "123456789.25", string(buf, 12));
+         // too big for the buffer, nothing written
+      buf[0] = 'x';
+      TUASSERTE(size_t, 14, formatFixed(buf, 10, 1.5, 3, 14));
+      TUASSERTE(char, 'x', buf[0]);
+
+      TUCSM("appendFixed");
+      string line("P");
+      appendFixed(line, -1234.56789, 6, 14);
+      appendFixed(line, 1e12, 6, 14);
+      TUASSERTE(string, "P  -1234.5678900000000.000000", line);
+
+      TUCSM("floatFormat");
+      size_t len = floatFormat(buf, sizeof(buf), -1.2345, FFLead::Decimal,
+                               12, 2, 19, 'D', FFSign::NegOnly,
+                               FFAlign::Right);
+      TUASSERTE(string, " -.123450000000D+01", string(buf, len));
+      len = floatFormat(buf, sizeof(buf), 6.25e-123, FFLead::Zero, 5, 2);
+      TUASSERTE(string, "0.6250e-122", string(buf, len));
+      TUASSERTE(size_t, 19, floatFormat(buf, 4, 1.0, FFLead::Decimal, 12, 2,
+                                        19, 'D'));
+
+      TUCSM("asDouble");
+      const char field[] = "  -12.375e+02xx";
+      TUASSERTFE(-1237.5, asDouble(field, 13));
+      TUASSERTFE(-12.375, asDouble(field, 9));
+      TUASSERTFE(0, asDouble(field, 2));
+      TUASSERTFE(0.1, asDouble(".1", 2));
+      TUASSERTE(double, 20183437.8216, asDouble("20183437.8216", 13));
+      TUASSERTE(double, 1234567890.12345678,
+                asDouble("1234567890.12345678", 19));
+
+      TUCSM("for2doub");
+      TUASSERTFE(156360, for2doub(" .15636D+06", 11));
+      TUASSERTFE(-156360, for2doub("-.15636d+06", 11));
+      TUASSERTFE(156360, for2doub(" .15636E+06", 11));
+      TUASSERTFE(0, for2doub("      ", 6));
+      TUASSERTFE(156360, for2doub(string("xx .15636D+06yy"), 2, 11));
+
+      TUCSM("asInt");
+      TUASSERTE(long, -42, asInt(" -42x", 5));
+      TUASSERTE(long, 4, asInt("42", 1));
+      TUASSERTE(long, 0, asInt("   ", 3));
+      TUCSM("asUnsigned");
+      TUASSERTE(unsigned long, 42, asUnsigned(" +42 ", 5));
+      TUASSERTE(unsigned long, 12345678901234567890UL,
+                asUnsigned("12345678901234567890", 20));
+
+      TURETURN();
+   }
 };
 
 int main() // Main function to initialize and run all tests above
@@ -1268,6 +1345,7 @@ int main() // Main function to initialize and run all tests above
    errorTotal += testClass.hexDumpDataConfigTest();
    errorTotal += testClass.hexToAsciiTest();
    errorTotal += testClass.floatFormatTest();
+   errorTotal += testClass.bufferConversionTest();
 
    std::cout << "Total Failures for " << __FILE__ << ": " << errorTotal
              << std::endl;
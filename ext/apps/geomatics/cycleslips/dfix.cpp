@@ -1000,7 +1000,7 @@ try {
 
    // dump the data - NB setTimeFormat()
    // could also get data store and dump each element
-   //const vector<Rinex3ObsData>& datastore(rofl.getStore());
+   //const vector<Rinex3ObsFileLoader::SatColumns>& cols(rofl.getStoreColumns());
    //if(DUMP(DATA)) rofl.dumpStoreData(LOGstrm);
 
    // now write to SatPass -------------------------------------------
@@ -43,6 +43,11 @@
 #ifndef GPSTK_MOST_COMMON_VALUE_INCLUDE
 #define GPSTK_MOST_COMMON_VALUE_INCLUDE
 
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iomanip>
+
 //--------------------------------------------------------------------------------
 /// Simple class to find the most common value, within a given tolerance, in a given
 /// set of values. Used to find, e.g. the time interval of a RINEX obs file.
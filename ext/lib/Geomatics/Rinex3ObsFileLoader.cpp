@@ -42,6 +42,7 @@
 //------------------------------------------------------------------------------------
 // system includes
 #include <iostream>
+#include <algorithm>
 
 // GPSTk
 #include "Exception.hpp"
@@ -87,10 +88,13 @@ try {
    // roh = rinex obs header
    Rinex3ObsHeader roh;
    // Rinex3ObsData from Rinex3ObsData class in GPSTk
-   // rod = rinex obs data, and outrod = output rinex obs data?
-   Rinex3ObsData rod, outrod;
+   // rod = rinex obs data
+   Rinex3ObsData rod;
    vector<string>::const_iterator vit;
    map< RinexSatID, vector<int> >::iterator soit;     // SatObsCountMap
+   // hdrWanted[sys][i] = index in wantedObsTypes of the header's i-th obs type
+   // for SatelliteSystem sys, or -1 if not wanted; empty if sys not in header
+   vector< vector<int> > hdrWanted;
    ostringstream oss, ossx;
 
    prevtime = CommonTime::BEGINNING_OF_TIME;
@@ -123,7 +127,9 @@ try {
       for(;;) {
          // open file ---------------------------------------------
          // converts file name from a string to a vector of characters using c_str
-         Rinex3ObsStream strm(filename.c_str());
+         Rinex3ObsStream strm;
+         strm.useCache(useCaches);
+         strm.open(filename.c_str(), ios::in);
          // if the obs stream is not successfully opened
          if(!strm.is_open()) {
             oss << "Error - could not open file " << filename << endl;
@@ -197,6 +203,23 @@ try {
                }
             }
 
+            // new wanted obs types need new columns in the store
+            if(saveData) extendStoreColumns();
+
+            // for each system in the header, the index in wantedObsTypes
+            // of each of its obs types, or -1 if not wanted
+            hdrWanted.assign(static_cast<size_t>(SatelliteSystem::Last),
+                             vector<int>());
+            for(SatelliteSystem ss : SatelliteSystemIterator()) {
+               const Rinex3ObsHeader::SysObsTypes *sot(roh.getSysObsTypes(ss));
+               if(!sot) continue;
+               string sys(1, RinexSatID(-1,ss).systemChar());
+               vector<int>& v(hdrWanted[static_cast<size_t>(ss)]);
+               for(i=0; i<sot->obsTypes.size(); i++)
+                  v.push_back(vectorindex(wantedObsTypes,
+                                          sys + sot->obsTypes[i].asString(currVer)));
+            }
+
             headers.push_back(roh);
          }
          catch(Exception& e) {
@@ -273,74 +296,86 @@ try {
             nepochs++;
             if(nepochsToRead > -1 && nepochs >= nepochsToRead) break;
 
-            // prepare output rod
-            outrod.time = rod.time;
-            outrod.clockOffset = rod.clockOffset;
-            outrod.epochFlag = rod.epochFlag;
-            //?? outrod.auxHeader.clear();
-            outrod.numSVs = 0;
-            outrod.obs.clear();
+            // the row in the store's time axis for this epoch, if it has data
+            const unsigned int row(storeTimes.size());
+            bool saved(false);
 
             // loop over satellites, counting data per ObsID
             Rinex3ObsData::DataMap::const_iterator it;
             for(it=rod.obs.begin(); it != rod.obs.end(); ++it) {
-               // Create new RinexSatID variable called sat, initialize with the
-               // it->first pointer from rod.obs current iteration
-               RinexSatID sat(it->first);
+               const RinexSatID& sat(it->first);
 
                // is the sat excluded?  NB it does not exclude sat=(sys,-1)
                if(exSats.size() > 0 &&
                   find(exSats.begin(), exSats.end(), sat) != exSats.end())
                      continue;
 
-               // Exract GNSS system from sat ID, creating new string variable sys
-               string sys(sat.toString().substr(0,1));
-               // Extract the observation types from the rinex obs header object
-               // roh corresponding to the GNSS system from the sat ID, creating
-               // new RinexObsID vector types
-               const vector<RinexObsID> types(roh.mapObsTypes[sys]);
+               // indexes into wantedObsTypes of this system's obs types
+               const size_t ss(static_cast<size_t>(sat.system));
+               if(ss >= hdrWanted.size() || hdrWanted[ss].empty()) continue;
+               const vector<int>& wanted(hdrWanted[ss]);
+
+               vector<int> *counts(NULL);    // SatObsCountMap[sat]
+               SatColumns *cols(NULL);       // this sat's columns in the store
 
                // loop over obs
-               for(i=0; i<it->second.size(); i++) {
+               for(i=0; i<it->second.size() && i<wanted.size(); i++) {
                   // if the obs data is equal to zero, then do not consider that
                   // obs value (equivalent to missing data)
                   if(it->second[i].data == 0.0) continue;   // don't count missing
 
-                  // combine the system and obs type into total rinex obs ID
-                  string srot = sys + types[i].asString(currVer); // 4-char RinexObsID
-
                   // is it wanted? nint is the index into
-                  // wantedObsTypes, SatObsCountMap and outrod.obs
-                  // vectorindex returns the index of the value srot in wantedObsTypes
-                  // if it doesn't exist in that vector, return -1
-                  nint = vectorindex(wantedObsTypes,srot);
+                  // wantedObsTypes, SatObsCountMap and the store columns
+                  nint = wanted[i];
                   if(nint == -1) continue;
 
                   // count the sat/obs
-                  // map<RinexSatID, std::vector<int>>
-                  soit = SatObsCountMap.find(sat);
-                  if(soit == SatObsCountMap.end()) {           // add the sat
-                     vector<int> v(wantedObsTypes.size(),0);   // keep parallel
-                     SatObsCountMap[sat] = v;                  // creates map entry
+                  if(!counts) {
+                     soit = SatObsCountMap.find(sat);
+                     if(soit == SatObsCountMap.end()) {        // add the sat
+                        vector<int> v(wantedObsTypes.size(),0);// keep parallel
+                        soit = SatObsCountMap.insert(make_pair(sat,v)).first;
+                     }
+                     counts = &soit->second;
                   }
-                  SatObsCountMap[sat][nint]++;
+                  (*counts)[nint]++;
                   countWantedObsTypes[nint]++;
 
-                  // add it to outrod
+                  // add it to the store
                   if(saveData) {
-                     // if the satellite is not in outrod.obs
-                     if(outrod.obs.find(sat) == outrod.obs.end()) {
-                        vector<RinexDatum> v(wantedObsTypes.size());
-                        outrod.obs[sat] = v;
-                        outrod.numSVs++;
+                     if(!cols) {
+                        map<RinexSatID, unsigned int>::const_iterator sit;
+                        sit = satStoreIndex.find(sat);
+                        if(sit == satStoreIndex.end()) {       // add the sat
+                           sit = satStoreIndex.insert(
+                                    make_pair(sat,satStore.size())).first;
+                           satStore.push_back(SatColumns());
+                           satStore.back().sat = sat;
+                           extendStoreColumns();
+                        }
+                        cols = &satStore[sit->second];
+
+                        // add a row, all missing
+                        cols->epochIndex.push_back(row);
+                        for(j=0; j<cols->data.size(); j++) {
+                           cols->data[j].push_back(0.0);
+                           cols->flags[j].push_back(SatColumns::BLANK);
+                        }
                      }
-                     outrod.obs[sat][nint] = it->second[i];
+                     cols->data[nint].back() = it->second[i].data;
+                     cols->flags[nint].back() =
+                        SatColumns::packFlags(it->second[i]);
+                     saved = true;
                   }
                }
             }
 
-            // if saving data, save
-            if(saveData && outrod.obs.size() > 0) datastore.push_back(outrod);
+            // if data was saved, add the epoch to the time axis
+            if(saved) {
+               storeTimes.push_back(rod.time);
+               storeClock.push_back(rod.clockOffset);
+               storeFlags.push_back(rod.epochFlag);
+            }
 
          }  // end loop over epochs
 
@@ -367,6 +402,14 @@ try {
 
    }  // end loop over files
 
+   // sort the store on satellite
+   if(saveData) {
+      sort(satStore.begin(), satStore.end(),
+           [](const SatColumns& a, const SatColumns& b) { return a.sat < b.sat; });
+      for(i=0; i<satStore.size(); i++)
+         satStoreIndex[satStore[i].sat] = i;
+   }
+
    if(!errmsg.empty()) errmsg += string("\n");
    errmsg += oss.str();
    if(!errmsg.empty()) {
@@ -398,7 +441,7 @@ string Rinex3ObsFileLoader::asString(void)
          << filenames[i] << endl;
    oss << " Interval " << fixed << setprecision(2) << getDT() << "sec, obs types";
    for(i=0; i<wantedObsTypes.size(); i++) oss << " " << wantedObsTypes[i];
-   oss << ", store size " << datastore.size();
+   oss << ", store size " << storeTimes.size();
    oss << "\n";
    oss << " Time limits: begin  " << printTime(begDataTime,longfmt) << "\n"
        << "                end  " << printTime(endDataTime,longfmt) << "\n";
@@ -430,11 +473,11 @@ int Rinex3ObsFileLoader::WriteSatPassList(const map<char, vector<string> >& sysS
 {
 try {
    if(!dataSaved()) return -3;
-   if(datastore.size() == 0) return -4;
+   if(storeTimes.size() == 0) return -4;
 
    char sys;
    int npass(0);
-   unsigned int i;
+   unsigned int i,ns;
    unsigned short flag;
    GSatID sat;
    map<GSatID,unsigned int> indexForSat;
@@ -461,48 +504,64 @@ try {
    vector<double> data(nobs,0.0);
    vector<unsigned short> ssi(nobs,0), lli(nobs,0);
 
-   // loop over the data store = vector<Rinex3ObsData>
-   for(unsigned int nds=0; nds<datastore.size(); nds++) {
+   // for each sat in the store, its indexes into the loader's ObsIDs and its
+   // SatPass obstypes; NULL for an unwanted system
+   vector<const vector<int> *> satIndexes(satStore.size(),
+                                          static_cast<const vector<int> *>(NULL));
+   vector<const vector<string> *> satObstypes(satStore.size(),
+                                          static_cast<const vector<string> *>(NULL));
+   for(ns=0; ns<satStore.size(); ns++) {
+      sys = satStore[ns].sat.systemChar();
+      map<char, vector<int> >::const_iterator jt(indexLoadOT.find(sys));
+      if(jt == indexLoadOT.end())      // skip unwanted system
+         continue;
+      satIndexes[ns] = &jt->second;
+      obsit = sysSPOT.find(sys);
+      if(obsit != sysSPOT.end())
+         satObstypes[ns] = &obsit->second;
+   }
+
+   // next row of each sat in the store
+   vector<unsigned int> nextRow(satStore.size(),0);
 
-      //LOG(INFO) << "WriteSPL " << printTime(datastore[nds].time,timefmt)
-      //<< " Nsats " << datastore[nds].obs.size();
-      //dumpStoreEpoch(LOGstrm,datastore[nds]);
+   // loop over the time axis of the store, then over satellites in sat order,
+   // so that the passes are created in time order
+   for(unsigned int nds=0; nds<storeTimes.size(); nds++) {
+
+      //LOG(INFO) << "WriteSPL " << printTime(storeTimes[nds],timefmt);
 
       // loop over satellites
-      Rinex3ObsData::DataMap::const_iterator it;
-      map<char, vector<int> >::const_iterator jt;
-      for(it = datastore[nds].obs.begin(); it != datastore[nds].obs.end(); ++it) {
-         sys = it->first.systemChar();
-         jt = indexLoadOT.find(sys);
-         if(jt == indexLoadOT.end())      // skip unwanted system
+      for(ns=0; ns<satStore.size(); ns++) {
+         const SatColumns& cols(satStore[ns]);
+         const unsigned int row(nextRow[ns]);
+         if(row >= cols.size() || cols.epochIndex[row] != nds)
+            continue;                     // no data for this sat at this epoch
+         nextRow[ns]++;
+
+         if(satIndexes[ns] == NULL)       // skip unwanted system
             continue;
-         sat = GSatID(it->first);         // converts from RinexSatID
+         const vector<int>& indexes(*satIndexes[ns]);
 
          // get obstypes for this sys
-         obsit = sysSPOT.find(sys);
-         if(obsit == sysSPOT.end())       // sysSPOT not found for system sys
+         if(satObstypes[ns] == NULL)      // sysSPOT not found for system sys
             return -5;
+         const vector<string>& obstypes(*satObstypes[ns]);
+
+         sat = GSatID(cols.sat);          // converts from RinexSatID
 
          // pull data out of store and put in arrays
          flag = SatPass::OK;
-         for(i=0; i<jt->second.size(); i++) {
-            int ind = jt->second[i];
-            //LOG(INFO) << " ind " << ind << " SPOT " << obsit->second[i]
-            //<< " R3OT " << (ind >= 0 ? wantedObsTypes[ind]:"NA")
-            //<< " sat " << sat
-            //<< " data " << fixed << setprecision(4)
-            //<< (ind >= 0 ? it->second[ind].data : 0.0) << "/"
-            //<< (ind >= 0 ? it->second[ind].ssi : 0) << "/"
-            //<< (ind >= 0 ? it->second[ind].lli : 0);
+         for(i=0; i<indexes.size(); i++) {
+            int ind = indexes[i];
             if(ind < 0) {
                data[i] = 0.0;
                ssi[i] = lli[i] = 0;
                // don't flag BAD as there may be empty obs types in this SatPass
             }
             else {
-               data[i] = it->second[ind].data;
-               ssi[i] = it->second[ind].ssi;
-               lli[i] = it->second[ind].lli;
+               data[i] = cols.data[ind][row];
+               ssi[i] = SatColumns::SSI(cols.flags[ind][row]);
+               lli[i] = SatColumns::LLI(cols.flags[ind][row]);
                // NB so one bad obs makes the sat/epoch bad
                // TD does loader keep epochs with no good data?
                if(::fabs(data[i]) < 1.e-8) flag = SatPass::BAD;
@@ -512,7 +571,7 @@ try {
          // find the current SatPass for this sat
          satit = indexForSat.find(sat);
          if(satit == indexForSat.end()) {       // create a new one
-            SatPass newSP(sat,nominalDT,obsit->second);
+            SatPass newSP(sat,nominalDT,obstypes);
             SPList.push_back(newSP);
             npass++;
             indexForSat[sat] = SPList.size()-1;
@@ -520,19 +579,20 @@ try {
          }
 
          // add the data to the SatPass
+         int iret;
          do {
-            i = SPList[satit->second].addData(
-                  datastore[nds].time, obsit->second, data, lli, ssi, flag);
+            iret = SPList[satit->second].addData(
+                  storeTimes[nds], obstypes, data, lli, ssi, flag);
 
-            if(i == -1) {        // there was a gap - break into two passes
-               SatPass newSP(sat,nominalDT,obsit->second);
+            if(iret == -1) {     // there was a gap - break into two passes
+               SatPass newSP(sat,nominalDT,obstypes);
                SPList.push_back(newSP);
                npass++;
                indexForSat[sat] = SPList.size()-1;
                satit = indexForSat.find(sat);
             }
 
-         } while(i == -1);       // will iterate only once, if there is a gap
+         } while(iret == -1);    // will iterate only once, if there is a gap
 
       }  // end loop over satellites
 
@@ -607,13 +667,89 @@ void Rinex3ObsFileLoader::dumpStoreEpoch(ostream& s, const Rinex3ObsData& rod) c
 // param ostream s to which to write
 void Rinex3ObsFileLoader::dumpStoreData(ostream& s) const
 {
-   s << "\nDump the ROFL data(" << datastore.size() << "):" << endl;
-   for(unsigned int i=0; i<datastore.size(); i++) {
-      const Rinex3ObsData& rod(datastore[i]);
+   s << "\nDump the ROFL data(" << storeTimes.size() << "):" << endl;
+   for(unsigned int i=0; i<storeTimes.size(); i++) {
+      const Rinex3ObsData rod(getStoreEpoch(i));
       dumpStoreEpoch(s,rod);
    }
 }
 
+//------------------------------------------------------------------------------------
+// Extend every satellite's columns to the current number of wanted obs types;
+// new columns are missing (0, flags BLANK) at every row.
+void Rinex3ObsFileLoader::extendStoreColumns(void)
+{
+   const unsigned int nobs(wantedObsTypes.size());
+   for(unsigned int ns=0; ns<satStore.size(); ns++) {
+      SatColumns& cols(satStore[ns]);
+      if(cols.data.size() >= nobs) continue;
+      cols.data.resize(nobs, vector<double>(cols.size(),0.0));
+      cols.flags.resize(nobs,
+                        vector<unsigned short>(cols.size(),SatColumns::BLANK));
+   }
+}
+
+//------------------------------------------------------------------------------------
+// Find the columns for one satellite
+// param[in] sat satellite of interest
+// return pointer to its columns in the store, or NULL if it has no data
+const Rinex3ObsFileLoader::SatColumns *
+Rinex3ObsFileLoader::getStoreColumns(const RinexSatID& sat) const
+{
+   map<RinexSatID, unsigned int>::const_iterator it(satStoreIndex.find(sat));
+   if(it == satStoreIndex.end()) return NULL;
+   return &satStore[it->second];
+}
+
+//------------------------------------------------------------------------------------
+// Build one epoch of the data store, with obs parallel to getWantedObsTypes().
+// param[in] nepoch index of the epoch in the store, 0 <= nepoch < size
+// return Rinex3ObsData for the epoch
+Rinex3ObsData Rinex3ObsFileLoader::getStoreEpoch(unsigned int nepoch) const
+{
+   if(nepoch >= storeTimes.size()) {
+      Exception e("Invalid epoch index " + StringUtils::asString(nepoch));
+      GPSTK_THROW(e);
+   }
+
+   Rinex3ObsData rod;
+   rod.time = storeTimes[nepoch];
+   rod.clockOffset = storeClock[nepoch];
+   rod.epochFlag = storeFlags[nepoch];
+   rod.numSVs = 0;
+
+   for(unsigned int ns=0; ns<satStore.size(); ns++) {
+      const SatColumns& cols(satStore[ns]);
+      // rows are in time order, so binary search for this epoch
+      vector<unsigned int>::const_iterator it;
+      it = lower_bound(cols.epochIndex.begin(), cols.epochIndex.end(), nepoch);
+      if(it == cols.epochIndex.end() || *it != nepoch) continue;
+      const unsigned int row(it - cols.epochIndex.begin());
+
+      vector<RinexDatum>& v(rod.obs[cols.sat]);
+      v.resize(cols.data.size());
+      for(unsigned int j=0; j<cols.data.size(); j++) {
+         v[j].data = cols.data[j][row];
+         SatColumns::unpackFlags(cols.flags[j][row], v[j]);
+      }
+      rod.numSVs++;
+   }
+
+   return rod;
+}
+
+//------------------------------------------------------------------------------------
+// Deprecated: build the whole data store as Rinex3ObsData, one per epoch.
+// return vector of Rinex3ObsData parallel to getStoreTimes()
+vector<Rinex3ObsData> Rinex3ObsFileLoader::getStore(void) const
+{
+   vector<Rinex3ObsData> store;
+   store.reserve(storeTimes.size());
+   for(unsigned int i=0; i<storeTimes.size(); i++)
+      store.push_back(getStoreEpoch(i));
+   return store;
+}
+
 //------------------------------------------------------------------------------------
 //------------------------------------------------------------------------------------
 // dump a table of all valid RinexObsIDs
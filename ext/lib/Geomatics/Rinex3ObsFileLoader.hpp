@@ -73,6 +73,8 @@ namespace gpstk {
 /// 3. Specify which ObsIDs to save - e.g. GC1* GC2* GL1* GL2*
 /// 4. Run loadFiles(msg) to read the files (any error messages output in msg)
 /// 5. Read the output: dumpSatObsTable() or dumpData() [if saved], and access output
+///    The saved data is stored in columns, one contiguous array per satellite and
+///    obs type, on a common time axis; cf. getStoreTimes() and getStoreColumns().
 /// 6. Optionally write the output to vector of SatPass with WriteSatPassList()
 /// 7. Reset and go again reset() or reset(vector<files>)
 class Rinex3ObsFileLoader
@@ -84,6 +86,7 @@ private:
    std::vector<std::string> filenames;    ///< input RINEX obs file names
    int nepochsToRead;                     ///< number of epochs to read (default:all)
    bool saveData;                         ///< if true save the data (F)
+   bool useCaches;                        ///< if true use file caches (F)
    std::string timefmt;                   ///< format for time tags in output
    // editing
    double dtdec;                          ///< decimate to this time step
@@ -120,13 +123,75 @@ private:
    std::vector<std::string> obstypes;     ///< RINEX obs types found in data
    std::vector<Rinex3ObsHeader> headers;  ///< headers from reading filenames
 
-   /// vector of all input data - filled only if saveData is true.
-   std::vector<Rinex3ObsData> datastore;
+public:
+   /// Stored data for one satellite, in columns: one contiguous array per wanted
+   /// obs type, all parallel to epochIndex, which holds the rows (indexes into
+   /// the store's time axis, cf. getStoreTimes()) at which the satellite has data.
+   /// A datum of 0.0 is missing. LLI, SSI and the RinexDatum blank flags are
+   /// packed into one word per datum, cf. packFlags() and unpackFlags();
+   /// a missing datum has flags BLANK.
+   class SatColumns
+   {
+   public:
+      RinexSatID sat;                                 ///< the satellite
+      std::vector<unsigned int> epochIndex;           ///< rows in the time axis
+      std::vector< std::vector<double> > data;        ///< data[obs][row]
+      std::vector< std::vector<unsigned short> > flags;///< flags[obs][row]
+
+      /// bits in the flags word for the RinexDatum blank flags
+      enum BlankBits
+      {
+         DATABLANK = 0x100,   ///< dataBlank
+         LLIBLANK = 0x200,    ///< lliBlank
+         SSIBLANK = 0x400,    ///< ssiBlank
+         BLANK = 0x700        ///< all fields blank, as for a missing datum
+      };
+
+      /// pack LLI, SSI and the blank flags of a RinexDatum into a flags word
+      static unsigned short packFlags(const RinexDatum& rd)
+      {
+         return static_cast<unsigned short>((rd.lli & 0x0F) | ((rd.ssi & 0x0F) << 4)
+                  | (rd.dataBlank ? DATABLANK : 0) | (rd.lliBlank ? LLIBLANK : 0)
+                  | (rd.ssiBlank ? SSIBLANK : 0));
+      }
+      /// unpack a flags word into LLI, SSI and the blank flags of a RinexDatum;
+      /// the data is not changed
+      static void unpackFlags(unsigned short f, RinexDatum& rd)
+      {
+         rd.lli = LLI(f);
+         rd.ssi = SSI(f);
+         rd.dataBlank = ((f & DATABLANK) != 0);
+         rd.lliBlank = ((f & LLIBLANK) != 0);
+         rd.ssiBlank = ((f & SSIBLANK) != 0);
+      }
+      /// unpack the LLI from a flags word
+      static unsigned short LLI(unsigned short f) { return (f & 0x0F); }
+      /// unpack the SSI from a flags word
+      static unsigned short SSI(unsigned short f) { return ((f >> 4) & 0x0F); }
+
+      /// number of rows (epochs with data) for this satellite
+      inline unsigned int size(void) const { return epochIndex.size(); }
+   };
+
+private:
+   /// Columnar store of all input data - filled only if saveData is true.
+   /// storeTimes, storeClock and storeFlags form the time axis, one element per
+   /// stored epoch; satStore holds the data, one SatColumns per satellite,
+   /// sorted on satellite after loadFiles().
+   std::vector<CommonTime> storeTimes;
+   std::vector<double> storeClock;        ///< clock offset at each stored epoch
+   std::vector<short> storeFlags;         ///< epoch flag at each stored epoch
+   std::vector<SatColumns> satStore;      ///< columns for each satellite
+   std::map<RinexSatID, unsigned int> satStoreIndex;  ///< index into satStore
+
+   /// extend every satellite's columns to the current number of wanted obs types
+   void extendStoreColumns(void);
 
    /// initialization used by the constructors
    void init(void)
    {
       saveData = false;
+      useCaches = false;
       nepochsToRead = -1;
       timefmt = std::string("%04Y/%02m/%02d %02H:%02M:%02S");
       reset();
@@ -178,7 +243,11 @@ public:
 
       obstypes.clear();
       mcv.reset();
-      datastore.clear();
+      storeTimes.clear();
+      storeClock.clear();
+      storeFlags.clear();
+      satStore.clear();
+      satStoreIndex.clear();
       exSats.clear();
       headers.clear();
       inputWantedObsTypes.clear();
@@ -238,6 +307,12 @@ public:
    /// @return bool if true, then save the data, otherwise just the headers
    inline bool dataSaved(void) { return saveData; }
 
+   /// set use cache flag; if set, files are read from their binary caches when
+   /// these are valid, and caches are written for files read to the end.
+   /// cf. Rinex3ObsStream::useCache()
+   /// @param b bool if true, then use caches
+   inline void useCache(bool b) { useCaches = b; }
+
    /// set the start time
    /// @param[in] tt start time, ignore data before this time
    inline void setStartTime(const CommonTime& tt) { startTime = tt; }
@@ -301,12 +376,34 @@ public:
 
    /// get the size of the data store
    /// @return size (number of epochs) in the store
-   inline const int getStoreSize(void) const { return datastore.size(); }
-
-   /// access the data store
-   /// @return const ref to the datastore: vector<Rinex3ObsData>
-   inline const std::vector<Rinex3ObsData>& getStore(void) const
-      { return datastore; }
+   inline const int getStoreSize(void) const { return storeTimes.size(); }
+
+   /// access the time axis of the data store
+   /// @return const ref to the times of the stored epochs, in order
+   inline const std::vector<CommonTime>& getStoreTimes(void) const
+      { return storeTimes; }
+
+   /// access the columns of the data store; obs types are parallel to
+   /// getWantedObsTypes(), and the satellites are sorted.
+   /// @return const ref to the columns, one SatColumns per satellite
+   inline const std::vector<SatColumns>& getStoreColumns(void) const
+      { return satStore; }
+
+   /// find the columns for one satellite
+   /// @param[in] sat satellite of interest
+   /// @return pointer to its columns in the store, or NULL if it has no data
+   const SatColumns *getStoreColumns(const RinexSatID& sat) const;
+
+   /// build one epoch of the data store, as Rinex3ObsData with obs parallel to
+   /// getWantedObsTypes(). This is slow; prefer the columns for bulk access.
+   /// @param[in] nepoch index of the epoch in the store, 0 <= nepoch < size
+   /// @return Rinex3ObsData for the epoch
+   Rinex3ObsData getStoreEpoch(unsigned int nepoch) const;
+
+   /// @deprecated the store is kept in columns, cf. getStoreColumns(); this builds
+   /// every epoch with getStoreEpoch(), which is slow and uses a lot of memory.
+   /// @return copy of the data store, one Rinex3ObsData per epoch
+   std::vector<Rinex3ObsData> getStore(void) const;
 
    // Read the files ----------------------------------------------------
 
@@ -665,6 +665,7 @@ int SatPassToRinex3File(string filename,
             header.mapObsTypes[sysstr].push_back(roid);
          }
       }
+      header.buildObsTypeIndex();
       
       // create the iterator
       SatPassIterator spit(SPList);
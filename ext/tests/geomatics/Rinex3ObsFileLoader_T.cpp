@@ -0,0 +1,208 @@
+//==============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 3.0 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin.
+//  Copyright 2004-2020, The Board of Regents of The University of Texas System
+//
+//==============================================================================
+
+//==============================================================================
+//
+//  This software was developed by Applied Research Laboratories at the
+//  University of Texas at Austin, under contract to an agency or agencies
+//  within the U.S. Department of Defense. The U.S. Government retains all
+//  rights to use, duplicate, distribute, disclose, or release this software.
+//
+//  Pursuant to DoD Directive 523024
+//
+//  DISTRIBUTION STATEMENT A: This software has been approved for public
+//                            release, distribution is unlimited.
+//
+//==============================================================================
+
+/// @file Rinex3ObsFileLoader_T.cpp Test the data store of Rinex3ObsFileLoader:
+/// each stored epoch must reproduce the epoch read directly from the file.
+
+#include <string>
+#include <vector>
+#include "Rinex3ObsFileLoader.hpp"
+#include "Rinex3ObsStream.hpp"
+#include "Rinex3ObsHeader.hpp"
+#include "Rinex3ObsData.hpp"
+
+#include "build_config.h"
+#include "TestUtil.hpp"
+
+using namespace std;
+using namespace gpstk;
+
+class Rinex3ObsFileLoader_T
+{
+public:
+   Rinex3ObsFileLoader_T()
+   {
+      // GPS only; C2X, L2X and the C1C data have blank fields
+      inputFile = getPathData() + getFileSep() + "test_input_rinex3_76193040.14o";
+   }
+
+      /// compare getStoreEpoch(), getStoreTimes() and getStoreColumns() with
+      /// the epochs read directly from the file
+   unsigned storeTest();
+
+   string inputFile;
+};
+
+//------------------------------------------------------------------------------------
+unsigned Rinex3ObsFileLoader_T::storeTest()
+{
+   TUDEF("Rinex3ObsFileLoader", "getStoreEpoch");
+
+   Rinex3ObsFileLoader rofl(inputFile);
+   TUASSERT(rofl.loadObsID("GC1C"));
+   TUASSERT(rofl.loadObsID("GC2X"));
+   TUASSERT(rofl.loadObsID("GL1C"));
+   TUASSERT(rofl.loadObsID("GL2X"));
+   rofl.saveTheData(true);
+
+   string errmsg, msg;
+   int iret(rofl.loadFiles(errmsg, msg));
+   TUASSERT(iret > 0);
+   TUASSERTE(string, "", errmsg);
+
+   const vector<string> wanted(rofl.getWantedObsTypes());
+   const vector<CommonTime>& times(rofl.getStoreTimes());
+   TUASSERTE(unsigned, 4, wanted.size());
+   TUASSERTE(int, times.size(), rofl.getStoreSize());
+
+      // read the file directly
+   Rinex3ObsStream strm(inputFile.c_str());
+   Rinex3ObsHeader hdr;
+   strm >> hdr;
+
+      // index of each wanted obs type in the header's GPS obs types
+   vector<int> hdrIndex(wanted.size(),-1);
+   const vector<RinexObsID>& hdrTypes(hdr.mapObsTypes["G"]);
+   for(unsigned int k=0; k<wanted.size(); k++)
+      for(unsigned int j=0; j<hdrTypes.size(); j++)
+         if(wanted[k] == "G" + hdrTypes[j].asString())
+            hdrIndex[k] = j;
+   for(unsigned int k=0; k<wanted.size(); k++)
+      TUASSERT(hdrIndex[k] >= 0);
+
+   Rinex3ObsData rod;
+   unsigned int nepoch(0), nblank(0), nlliBlank(0), nssiBlank(0);
+   while(strm >> rod) {
+         // epochs with no wanted data are not stored
+      bool hasData(false);
+      Rinex3ObsData::DataMap::const_iterator it;
+      for(it=rod.obs.begin(); it != rod.obs.end() && !hasData; ++it)
+         for(unsigned int k=0; k<wanted.size(); k++)
+            if(it->second[hdrIndex[k]].data != 0.0) hasData = true;
+      if(!hasData) continue;
+
+      if(nepoch >= times.size()) {
+         TUFAIL("Store has too few epochs");
+         break;
+      }
+      TUASSERTE(CommonTime, rod.time, times[nepoch]);
+
+      const Rinex3ObsData stored(rofl.getStoreEpoch(nepoch));
+      TUASSERTE(CommonTime, rod.time, stored.time);
+      TUASSERTE(short, rod.epochFlag, stored.epochFlag);
+
+      for(it=rod.obs.begin(); it != rod.obs.end(); ++it) {
+         const RinexSatID& sat(it->first);
+         Rinex3ObsData::DataMap::const_iterator jt(stored.obs.find(sat));
+         const Rinex3ObsFileLoader::SatColumns *cols(rofl.getStoreColumns(sat));
+
+            // a sat with no wanted data at this epoch is not stored
+         bool satData(false);
+         for(unsigned int k=0; k<wanted.size(); k++)
+            if(it->second[hdrIndex[k]].data != 0.0) satData = true;
+         if(!satData) {
+            TUASSERT(jt == stored.obs.end());
+            continue;
+         }
+         if(jt == stored.obs.end() || cols == NULL) {
+            TUFAIL("Missing stored data for " + sat.toString());
+            continue;
+         }
+         TUASSERTE(unsigned, wanted.size(), jt->second.size());
+
+            // this epoch's row in the sat's columns
+         vector<unsigned int>::const_iterator rt;
+         rt = lower_bound(cols->epochIndex.begin(), cols->epochIndex.end(), nepoch);
+         TUASSERT(rt != cols->epochIndex.end() && *rt == nepoch);
+         if(rt == cols->epochIndex.end()) continue;
+         const unsigned int row(rt - cols->epochIndex.begin());
+
+         for(unsigned int k=0; k<wanted.size(); k++) {
+            const RinexDatum& raw(it->second[hdrIndex[k]]);
+            const RinexDatum& rd(jt->second[k]);
+            TUASSERTFE(raw.data, rd.data);
+            TUASSERTFE(raw.data, cols->data[k][row]);
+            if(raw.data == 0.0) {
+                  // missing in the store: every field is blank
+               TUASSERT(rd.dataBlank);
+               TUASSERT(rd.lliBlank);
+               TUASSERT(rd.ssiBlank);
+               nblank++;
+               continue;
+            }
+            TUASSERTE(bool, raw.dataBlank, rd.dataBlank);
+            TUASSERTE(bool, raw.lliBlank, rd.lliBlank);
+            TUASSERTE(bool, raw.ssiBlank, rd.ssiBlank);
+            TUASSERTE(short, raw.lli, rd.lli);
+            TUASSERTE(short, raw.ssi, rd.ssi);
+            if(raw.lliBlank) nlliBlank++;
+            if(raw.ssiBlank) nssiBlank++;
+         }
+      }
+      nepoch++;
+   }
+   TUASSERTE(unsigned, times.size(), nepoch);
+
+      // the data must exercise the blank flags
+   TUASSERT(nblank > 0);
+   TUASSERT(nlliBlank > 0);
+
+   TUTHROW(rofl.getStoreEpoch(times.size()));
+
+      // the deprecated getStore() holds the same epochs
+   const vector<Rinex3ObsData> store(rofl.getStore());
+   TUASSERTE(unsigned, times.size(), store.size());
+   for(unsigned int i=0; i<store.size(); i++) {
+      TUASSERTE(CommonTime, times[i], store[i].time);
+      TUASSERTE(unsigned, rofl.getStoreEpoch(i).obs.size(), store[i].obs.size());
+   }
+
+   TURETURN();
+}
+
+//------------------------------------------------------------------------------------
+int main()
+{
+   unsigned errorTotal = 0;
+   Rinex3ObsFileLoader_T testClass;
+
+   errorTotal += testClass.storeTest();
+
+   cout << "Total Failures for " << __FILE__ << ": " << errorTotal << endl;
+   return errorTotal;
+}